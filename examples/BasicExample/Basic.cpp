@@ -97,7 +97,7 @@ void setup()
   delay(100);
   Serial.printf("ID: %s", chipid.c_str());
   client.logInToDatabaseSession();
-  Serial.printf("Response     logInToDatabaseSession: %s\n", client.getToken().c_str());
+  Serial.printf("Response     logInToDatabaseSession: %s\n", client.getTokenPtr());
   //----------------------------------------------------------------------
   /* delay(2000);
   vector<RecordField> fields;
@@ -0,0 +1,199 @@
+#include <Arduino.h>
+#include "Esp.h"
+#include "FMDataClient.h"
+#include "RequestScheduler.h"
+#include "RecordStore.h"
+#include <algorithm>
+#include <atomic>
+
+// Load harness, drives the client against a test server and reports
+// p50/p99 latency and throughput per operation.
+// Point host/port/cert to a staging server or a local stand-in, the client
+// uses the configured port for every request.
+
+#define ROUNDS 100
+#define MAX_CONNECTIONS 4
+#define SOURCES 40
+
+const char *cert = "xxxx";
+const char *host = "192.168.1.10";
+const int port = 8443;
+const char *ssid = "xxxx";
+const char *psk = "xxxx";
+const char *database = "xxxx";
+const char *userName = "xxxx";
+const char *password = "xxxx";
+const char *layout = "xxxx";
+WiFiClientSecure wifi;
+UserCredentials dC(database, userName, password);
+FMDataClient client(wifi, dC, host, cert, port);
+
+/**
+ * @brief Latency samples of one operation
+ */
+class OperationStatistics
+{
+public:
+  OperationStatistics(const char *name) : name(name), errors(0), bytes(0) {}
+  const char *name;
+  vector<unsigned long> samples;
+  int errors;
+  size_t bytes;
+
+  void add(unsigned long start, const String &response)
+  {
+    this->samples.push_back(micros() - start);
+    if (response == EMPTY_STRING)
+      this->errors++;
+    this->bytes += response.length();
+  }
+
+  unsigned long percentile(int p)
+  {
+    if (this->samples.empty())
+      return 0;
+    vector<unsigned long> sorted(this->samples);
+    std::sort(sorted.begin(), sorted.end());
+    return sorted[(sorted.size() - 1) * p / 100];
+  }
+
+  void report(void)
+  {
+    unsigned long total = 0;
+    for (unsigned long sample : this->samples)
+      total += sample;
+    float seconds = total / 1000000.0f;
+    Serial.printf("%-16s n=%4d err=%3d p50=%7lu ms p99=%7lu ms %6.2f op/s %8.0f B/s\n",
+                  this->name,
+                  this->samples.size(),
+                  this->errors,
+                  this->percentile(50) / 1000,
+                  this->percentile(99) / 1000,
+                  seconds > 0 ? this->samples.size() / seconds : 0,
+                  seconds > 0 ? this->bytes / seconds : 0);
+  }
+};
+
+OperationStatistics createStatistics("createRecord");
+OperationStatistics editStatistics("editRecord");
+OperationStatistics findStatistics("performFind");
+
+void wifiConnect()
+{
+  Serial.print("Attempting to connect to SSID: ");
+  Serial.println(ssid);
+  while (WiFi.status() != WL_CONNECTED)
+  {
+    WiFi.begin(ssid, psk);
+    Serial.print(".");
+    delay(1000);
+  }
+  Serial.print("Connected to ");
+  Serial.println(ssid);
+}
+
+/**
+ * @brief Creates ROUNDS records from SOURCES sources through a scheduler
+ * with 1 to MAX_CONNECTIONS connections and reports the throughput
+ */
+void measureScaling(const vector<RecordField> &fields)
+{
+  for (uint8_t connections = 1; connections <= MAX_CONNECTIONS; connections++)
+  {
+    RequestScheduler scheduler(dC, host, cert, port, connections);
+    scheduler.getConnection(0).setToken(client.getTokenPtr());
+    if (!scheduler.begin())
+    {
+      Serial.println("Scheduler could not start");
+      return;
+    }
+    std::atomic<int> errors(0);
+    RequestJob create = [&fields, &errors](FMDataClient &connection) {
+      ResponseStatus status;
+      if (!connection.createRecord(database, layout, fields.data(), fields.size(), status))
+        errors++;
+    };
+    unsigned long start = millis();
+    for (int i = 0; i < ROUNDS; i++)
+    {
+      scheduler.submit(create, i % SOURCES);
+    }
+    scheduler.wait();
+    unsigned long elapsed = millis() - start;
+    Serial.printf("%u connections: %d creates in %lu ms, %6.2f op/s, err=%d\n",
+                  connections, ROUNDS, elapsed, elapsed > 0 ? ROUNDS * 1000.0f / elapsed : 0, errors.load());
+  }
+}
+
+/**
+ * @brief Compares finds answered by a local record store with the same finds on the server
+ */
+void measureLocalFind(const vector<FindCriteria *> &findCriterias)
+{
+  RecordStore store;
+  store.addIndex("field1");
+  size_t found = 0;
+  StoredRecordCallback count = [&found](const StoredRecord &record) { found++; };
+  // The first find misses and fills the store
+  store.find(client, database, layout, findCriterias, count);
+  unsigned long start = micros();
+  for (int i = 0; i < ROUNDS; i++)
+  {
+    store.findLocal(findCriterias, count);
+  }
+  unsigned long local = micros() - start;
+  start = micros();
+  for (int i = 0; i < ROUNDS; i++)
+  {
+    client.performFind(database, layout, findCriterias, 10);
+  }
+  unsigned long remote = micros() - start;
+  Serial.printf("find: local %lu us/op, remote %lu us/op, %u records stored\n",
+                local / ROUNDS, remote / ROUNDS, store.size());
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(100);
+  wifiConnect();
+  client.logInToDatabaseSession();
+  Serial.printf("Token: %s\n", client.getTokenPtr());
+}
+
+void loop()
+{
+  vector<RecordField> fields;
+  fields.push_back(RecordField("field1", "data1"));
+  fields.push_back(RecordField("field2", 42));
+
+  vector<RecordFindCriteria *> records;
+  RecordFindCriteria fr1("field1", "==data1");
+  records.push_back(&fr1);
+  FindCriteria f1(records);
+  vector<FindCriteria *> findCriterias;
+  findCriterias.push_back(&f1);
+
+  unsigned long roundStart = millis();
+  for (int i = 0; i < ROUNDS; i++)
+  {
+    unsigned long start = micros();
+    String response = client.createRecord(database, layout, fields);
+    createStatistics.add(start, response);
+
+    start = micros();
+    response = client.editRecord(database, layout, "1", fields);
+    editStatistics.add(start, response);
+
+    start = micros();
+    response = client.performFind(database, layout, findCriterias, 10);
+    findStatistics.add(start, response);
+  }
+  Serial.printf("%d rounds in %lu ms, free heap %u\n", ROUNDS, millis() - roundStart, ESP.getFreeHeap());
+  createStatistics.report();
+  editStatistics.report();
+  findStatistics.report();
+  measureScaling(fields);
+  measureLocalFind(findCriterias);
+  delay(20000);
+}
@@ -0,0 +1,152 @@
+#include <Arduino.h>
+#include "Esp.h"
+#include "FMDataClient.h"
+#include "RecordCodec.h"
+
+// Payload generation benchmark, runs offline, no WiFi or server needed.
+// Prints the average time and the heap left over per operation, compare
+// the output before and after a change to catch regressions.
+
+#define ITERATIONS 1000
+
+const char *cert = "";
+const char *host = "localhost";
+const int port = 443;
+const char *database = "benchmark";
+const char *userName = "benchmark";
+const char *password = "benchmark";
+WiFiClientSecure wifi;
+UserCredentials dC(database, userName, password);
+FMDataClient client(wifi, dC, host, cert, port);
+
+vector<RecordField> fields;
+ScriptParameters scripts("testScript", "1", "testScript", "2", "testScript", "3");
+RecordFindCriteria fr1("field1", "data11");
+RecordFindCriteria fr2("field2", ">=100");
+RecordSortCriteria s1("CreationTimestamp", SortOrder::descend);
+vector<FindCriteria *> findCriterias;
+vector<RecordFindCriteria *> records;
+vector<RecordSortCriteria *> sRecords;
+
+size_t sink = 0;
+
+void report(const char *name, unsigned long start, uint32_t freeHeap)
+{
+  unsigned long elapsed = micros() - start;
+  Serial.printf("%-32s %8.2f us/op %8d bytes retained\n",
+                name,
+                (float)elapsed / ITERATIONS,
+                (int)(freeHeap - ESP.getFreeHeap()));
+}
+
+void benchmarkGeneratePayload()
+{
+  uint32_t freeHeap = ESP.getFreeHeap();
+  unsigned long start = micros();
+  for (int i = 0; i < ITERATIONS; i++)
+    sink += FMDataClient::generatePayload(fields.data(), fields.size()).length();
+  report("generatePayload", start, freeHeap);
+
+  freeHeap = ESP.getFreeHeap();
+  start = micros();
+  for (int i = 0; i < ITERATIONS; i++)
+    sink += FMDataClient::generatePayload(fields.data(), fields.size(), &scripts).length();
+  report("generatePayload + scripts", start, freeHeap);
+}
+
+void benchmarkGenerateFindPayload()
+{
+  SortCriteria sort(sRecords);
+  uint32_t freeHeap = ESP.getFreeHeap();
+  unsigned long start = micros();
+  for (int i = 0; i < ITERATIONS; i++)
+    sink += client.generateFindPayload(findCriterias).length();
+  report("generateFindPayload", start, freeHeap);
+
+  freeHeap = ESP.getFreeHeap();
+  start = micros();
+  for (int i = 0; i < ITERATIONS; i++)
+    sink += client.generateFindPayload(findCriterias, 100, 10, &sort, &scripts).length();
+  report("generateFindPayload + sort", start, freeHeap);
+}
+
+void benchmarkQueryString()
+{
+  uint32_t freeHeap = ESP.getFreeHeap();
+  unsigned long start = micros();
+  for (int i = 0; i < ITERATIONS; i++)
+    sink += scripts.toQueryString().length();
+  report("ScriptParameters::toQueryString", start, freeHeap);
+}
+
+/**
+ * @brief Bytes per record and encode/decode throughput of the binary record encoding against json
+ */
+void benchmarkRecordCodec()
+{
+  RecordCodec codec(fields);
+  vector<uint8_t> record;
+  char payload[1024];
+  size_t binarySize = codec.encode(fields.data(), fields.size(), record);
+  size_t jsonSize = FMDataClient::generatePayload(fields.data(), fields.size(), payload, sizeof(payload));
+  Serial.printf("%-32s %8u bytes binary %8u bytes json\n", "record size", binarySize, jsonSize);
+
+  uint32_t freeHeap = ESP.getFreeHeap();
+  unsigned long start = micros();
+  for (int i = 0; i < ITERATIONS; i++)
+  {
+    record.clear();
+    sink += codec.encode(fields.data(), fields.size(), record);
+  }
+  report("RecordCodec::encode", start, freeHeap);
+
+  freeHeap = ESP.getFreeHeap();
+  start = micros();
+  for (int i = 0; i < ITERATIONS; i++)
+    sink += codec.toPayload(record.data(), record.size(), payload, sizeof(payload));
+  report("RecordCodec::toPayload", start, freeHeap);
+
+  freeHeap = ESP.getFreeHeap();
+  start = micros();
+  for (int i = 0; i < ITERATIONS; i++)
+  {
+    vector<RecordField> decoded;
+    codec.decode(record.data(), record.size(), decoded);
+    sink += decoded.size();
+  }
+  report("RecordCodec::decode", start, freeHeap);
+
+  freeHeap = ESP.getFreeHeap();
+  start = micros();
+  for (int i = 0; i < ITERATIONS; i++)
+    sink += FMDataClient::generatePayload(fields.data(), fields.size(), payload, sizeof(payload));
+  report("generatePayload into buffer", start, freeHeap);
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(100);
+  for (int i = 0; i < 12; i++)
+  {
+    fields.push_back(RecordField(String("field") + String(i), String("value") + String(i)));
+  }
+  fields.push_back(RecordField("temperature", 21.5f));
+  fields.push_back(RecordField("counter", 42));
+  records.push_back(&fr1);
+  records.push_back(&fr2);
+  FindCriteria *f1 = new FindCriteria(records);
+  findCriterias.push_back(f1);
+  sRecords.push_back(&s1);
+  Serial.printf("Payload benchmark, %d iterations, CPU %d MHz\n", ITERATIONS, getCpuFrequencyMhz());
+}
+
+void loop()
+{
+  benchmarkGeneratePayload();
+  benchmarkGenerateFindPayload();
+  benchmarkQueryString();
+  benchmarkRecordCodec();
+  Serial.printf("--------------------------(%u)\n", sink % 10);
+  delay(10000);
+}
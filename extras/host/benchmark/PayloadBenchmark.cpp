@@ -0,0 +1,243 @@
+/*
+  PayloadBenchmark.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include <benchmark/benchmark.h>
+#include "Esp.h"
+#include "FMDataClient.h"
+#include "RecordCodec.h"
+
+// Host counterpart of examples/PayloadBenchmark, same inputs. Besides the
+// time per operation every benchmark reports the heap left allocated after
+// the run ("retained"), which should stay 0. The RecordCodec benchmarks and
+// the JSON ones they compare with report the size of one record ("bytes").
+
+namespace
+{
+const char *cert = "";
+const char *host = "localhost";
+const int port = 443;
+
+struct PayloadFixture
+{
+  PayloadFixture(void)
+      : credentials("benchmark", "benchmark", "benchmark"),
+        client(wifi, credentials, host, cert, port),
+        scripts("testScript", "1", "testScript", "2", "testScript", "3"),
+        fr1("field1", "data11"),
+        fr2("field2", ">=100"),
+        s1("CreationTimestamp", SortOrder::descend)
+  {
+    for (int i = 0; i < 12; i++)
+    {
+      fields.push_back(RecordField(String("field") + String(i), String("value") + String(i)));
+    }
+    fields.push_back(RecordField("temperature", 21.5f));
+    fields.push_back(RecordField("counter", 42));
+    records.push_back(&fr1);
+    records.push_back(&fr2);
+    findCriterias.push_back(new FindCriteria(records));
+    sRecords.push_back(&s1);
+    codec = RecordCodec(fields);
+    codec.encode(fields.data(), fields.size(), encoded);
+  }
+
+  ~PayloadFixture(void)
+  {
+    for (FindCriteria *criteria : findCriterias)
+      delete criteria;
+  }
+
+  WiFiClientSecure wifi;
+  UserCredentials credentials;
+  FMDataClient client;
+  vector<RecordField> fields;
+  ScriptParameters scripts;
+  RecordFindCriteria fr1;
+  RecordFindCriteria fr2;
+  RecordSortCriteria s1;
+  vector<FindCriteria *> findCriterias;
+  vector<RecordFindCriteria *> records;
+  vector<RecordSortCriteria *> sRecords;
+  RecordCodec codec;
+  vector<uint8_t> encoded;
+};
+
+PayloadFixture &fixture(void)
+{
+  static PayloadFixture instance;
+  return instance;
+}
+
+/**
+ * @brief Measures the heap taken by the benchmark loop
+ */
+class HeapCounter
+{
+public:
+  explicit HeapCounter(benchmark::State &state)
+      : _state(state),
+        _freeHeap(ESP.getFreeHeap())
+  {
+  }
+
+  ~HeapCounter(void)
+  {
+    this->_state.counters["retained"] = (double)this->_freeHeap - ESP.getFreeHeap();
+  }
+
+private:
+  benchmark::State &_state;
+  uint32_t _freeHeap;
+};
+} // namespace
+
+static void BM_GeneratePayload(benchmark::State &state)
+{
+  PayloadFixture &f = fixture();
+  HeapCounter heap(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(FMDataClient::generatePayload(f.fields.data(), f.fields.size()));
+}
+BENCHMARK(BM_GeneratePayload);
+
+static void BM_GeneratePayloadScripts(benchmark::State &state)
+{
+  PayloadFixture &f = fixture();
+  HeapCounter heap(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(FMDataClient::generatePayload(f.fields.data(), f.fields.size(), &f.scripts));
+}
+BENCHMARK(BM_GeneratePayloadScripts);
+
+static void BM_GeneratePayloadBuffer(benchmark::State &state)
+{
+  PayloadFixture &f = fixture();
+  char payload[1024];
+  HeapCounter heap(state);
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(FMDataClient::generatePayload(f.fields.data(), f.fields.size(), payload, sizeof(payload)));
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_GeneratePayloadBuffer);
+
+static void BM_RecordCodecEncode(benchmark::State &state)
+{
+  PayloadFixture &f = fixture();
+  vector<uint8_t> encoded;
+  encoded.reserve(f.encoded.size());
+  state.counters["bytes"] = f.encoded.size();
+  {
+    HeapCounter heap(state);
+    for (auto _ : state)
+    {
+      encoded.clear();
+      benchmark::DoNotOptimize(f.codec.encode(f.fields.data(), f.fields.size(), encoded));
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RecordCodecEncode);
+
+static void BM_RecordCodecDecode(benchmark::State &state)
+{
+  PayloadFixture &f = fixture();
+  vector<RecordField> fields;
+  fields.reserve(f.fields.size());
+  state.counters["bytes"] = f.encoded.size();
+  {
+    HeapCounter heap(state);
+    for (auto _ : state)
+    {
+      fields.clear();
+      benchmark::DoNotOptimize(f.codec.decode(f.encoded.data(), f.encoded.size(), fields));
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RecordCodecDecode);
+
+static void BM_RecordCodecToPayload(benchmark::State &state)
+{
+  PayloadFixture &f = fixture();
+  char payload[1024];
+  state.counters["bytes"] = f.codec.measurePayload(f.encoded.data(), f.encoded.size());
+  {
+    HeapCounter heap(state);
+    for (auto _ : state)
+    {
+      benchmark::DoNotOptimize(f.codec.toPayload(f.encoded.data(), f.encoded.size(), payload, sizeof(payload)));
+      benchmark::ClobberMemory();
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RecordCodecToPayload);
+
+static void BM_JsonPayloadEncode(benchmark::State &state)
+{
+  PayloadFixture &f = fixture();
+  char payload[1024];
+  state.counters["bytes"] = FMDataClient::generatePayload(f.fields.data(), f.fields.size(), payload, sizeof(payload));
+  {
+    HeapCounter heap(state);
+    for (auto _ : state)
+    {
+      benchmark::DoNotOptimize(FMDataClient::generatePayload(f.fields.data(), f.fields.size(), payload, sizeof(payload)));
+      benchmark::ClobberMemory();
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_JsonPayloadEncode);
+
+static void BM_JsonPayloadDecode(benchmark::State &state)
+{
+  PayloadFixture &f = fixture();
+  char payload[1024];
+  size_t length = FMDataClient::generatePayload(f.fields.data(), f.fields.size(), payload, sizeof(payload));
+  DynamicJsonDocument doc(2048);
+  state.counters["bytes"] = length;
+  {
+    HeapCounter heap(state);
+    for (auto _ : state)
+    {
+      benchmark::DoNotOptimize(deserializeJson(doc, (const char *)payload, length));
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_JsonPayloadDecode);
+
+static void BM_GenerateFindPayload(benchmark::State &state)
+{
+  PayloadFixture &f = fixture();
+  HeapCounter heap(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(f.client.generateFindPayload(f.findCriterias));
+}
+BENCHMARK(BM_GenerateFindPayload);
+
+static void BM_GenerateFindPayloadSort(benchmark::State &state)
+{
+  PayloadFixture &f = fixture();
+  SortCriteria sort(f.sRecords);
+  HeapCounter heap(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(f.client.generateFindPayload(f.findCriterias, 100, 10, &sort, &f.scripts));
+}
+BENCHMARK(BM_GenerateFindPayloadSort);
+
+static void BM_ScriptParametersToQueryString(benchmark::State &state)
+{
+  PayloadFixture &f = fixture();
+  HeapCounter heap(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(f.scripts.toQueryString());
+}
+BENCHMARK(BM_ScriptParametersToQueryString);
+
+BENCHMARK_MAIN();
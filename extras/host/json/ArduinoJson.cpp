@@ -0,0 +1,1264 @@
+/*
+  ArduinoJson.cpp - offline stand-in for a subset of the ArduinoJson 6.14 API
+  The API, its names and its memory accounting are those of ArduinoJson,
+  Copyright (c) Benoit Blanchon, MIT License, https://arduinojson.org.
+  This is not ArduinoJson and not its code, only used by the host build
+  when ArduinoJson 6.14.1 can not be downloaded.
+*/
+
+#include "ArduinoJson.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace ArduinoJson
+{
+namespace detail
+{
+MemoryPool::MemoryPool(char *buffer, size_t capacity)
+    : _buffer(buffer),
+      _bufferSize(buffer != NULL ? bufferSize(capacity) : 0),
+      _capacity(buffer != NULL ? capacity : 0),
+      _slots(0),
+      _strings(0)
+{
+}
+
+/**
+ * @brief Bytes needed on the host for a pool of the given ESP32 capacity
+ */
+size_t MemoryPool::bufferSize(size_t capacity)
+{
+  return (capacity / ARDUINOJSON_SLOT_SIZE + 1) * sizeof(VariantSlot) + capacity;
+}
+
+VariantSlot *MemoryPool::allocSlot(void)
+{
+  if (this->available() < ARDUINOJSON_SLOT_SIZE)
+    return NULL;
+  VariantSlot *slot = (VariantSlot *)(this->_buffer + this->_slots * sizeof(VariantSlot));
+  this->_slots++;
+  memset(slot, 0, sizeof(VariantSlot));
+  return slot;
+}
+
+char *MemoryPool::allocString(size_t size)
+{
+  if (this->available() < size)
+    return NULL;
+  this->_strings += size;
+  return this->_buffer + this->_bufferSize - this->_strings;
+}
+
+void MemoryPool::clear(void)
+{
+  this->_slots = 0;
+  this->_strings = 0;
+}
+
+static char *copyString(const char *str, size_t length, MemoryPool *pool)
+{
+  char *copy = pool->allocString(length + 1);
+  if (copy == NULL)
+    return NULL;
+  memcpy(copy, str, length);
+  copy[length] = '\0';
+  return copy;
+}
+
+void slotSetNull(VariantSlot *slot)
+{
+  if (slot == NULL)
+    return;
+  slot->flags &= ARDUINOJSON_KEY_IS_OWNED;
+  slot->content.asCollection = {NULL, NULL};
+}
+
+static void slotSetType(VariantSlot *slot, uint8_t type)
+{
+  slot->flags = (slot->flags & ARDUINOJSON_KEY_IS_OWNED) | type;
+}
+
+bool slotSetString(VariantSlot *slot, StringRef value, MemoryPool *pool)
+{
+  if (slot == NULL)
+    return false;
+  if (value.str == NULL)
+  {
+    slotSetNull(slot);
+    return false;
+  }
+  if (value.linked)
+  {
+    slotSetType(slot, VALUE_IS_LINKED_STRING);
+    slot->content.asString = value.str;
+    return true;
+  }
+  char *copy = copyString(value.str, value.length, pool);
+  if (copy == NULL)
+  {
+    slotSetNull(slot);
+    return false;
+  }
+  slotSetType(slot, VALUE_IS_OWNED_STRING);
+  slot->content.asString = copy;
+  return true;
+}
+
+void slotSetInteger(VariantSlot *slot, int64_t value)
+{
+  if (slot == NULL)
+    return;
+  slotSetType(slot, VALUE_IS_INTEGER);
+  slot->content.asInteger = value;
+}
+
+void slotSetFloat(VariantSlot *slot, float value)
+{
+  if (slot == NULL)
+    return;
+  slotSetType(slot, VALUE_IS_FLOAT);
+  slot->content.asFloat = value;
+}
+
+void slotSetBoolean(VariantSlot *slot, bool value)
+{
+  if (slot == NULL)
+    return;
+  slotSetType(slot, VALUE_IS_BOOLEAN);
+  slot->content.asBoolean = value;
+}
+
+VariantSlot *slotToArray(VariantSlot *slot)
+{
+  if (slot == NULL)
+    return NULL;
+  slotSetType(slot, VALUE_IS_ARRAY);
+  slot->content.asCollection = {NULL, NULL};
+  return slot;
+}
+
+VariantSlot *slotToObject(VariantSlot *slot)
+{
+  if (slot == NULL)
+    return NULL;
+  slotSetType(slot, VALUE_IS_OBJECT);
+  slot->content.asCollection = {NULL, NULL};
+  return slot;
+}
+
+static VariantSlot *appendSlot(VariantSlot *collection, MemoryPool *pool)
+{
+  VariantSlot *slot = pool->allocSlot();
+  if (slot == NULL)
+    return NULL;
+  CollectionData &data = collection->content.asCollection;
+  if (data.tail != NULL)
+    data.tail->next = slot;
+  else
+    data.head = slot;
+  data.tail = slot;
+  return slot;
+}
+
+static void unlinkSlot(VariantSlot *collection, VariantSlot *slot)
+{
+  CollectionData &data = collection->content.asCollection;
+  VariantSlot *previous = NULL;
+  for (VariantSlot *current = data.head; current != NULL; current = current->next)
+  {
+    if (current == slot)
+    {
+      if (previous != NULL)
+        previous->next = slot->next;
+      else
+        data.head = slot->next;
+      if (data.tail == slot)
+        data.tail = previous;
+      return;
+    }
+    previous = current;
+  }
+}
+
+static bool slotSetKey(VariantSlot *slot, StringRef key, MemoryPool *pool)
+{
+  if (key.linked)
+  {
+    slot->key = key.str;
+    slot->flags &= ~ARDUINOJSON_KEY_IS_OWNED;
+    return true;
+  }
+  char *copy = copyString(key.str, key.length, pool);
+  if (copy == NULL)
+    return false;
+  slot->key = copy;
+  slot->flags |= ARDUINOJSON_KEY_IS_OWNED;
+  return true;
+}
+
+bool slotCopy(VariantSlot *dst, const VariantSlot *src, MemoryPool *pool)
+{
+  if (dst == NULL)
+    return false;
+  if (src == NULL)
+  {
+    slotSetNull(dst);
+    return true;
+  }
+  switch (src->type())
+  {
+  case VALUE_IS_LINKED_STRING:
+    return slotSetString(dst, {src->content.asString, strlen(src->content.asString), true}, pool);
+  case VALUE_IS_OWNED_STRING:
+    return slotSetString(dst, {src->content.asString, strlen(src->content.asString), false}, pool);
+  case VALUE_IS_ARRAY:
+    slotToArray(dst);
+    for (const VariantSlot *element = src->content.asCollection.head; element != NULL; element = element->next)
+    {
+      VariantSlot *copy = slotAddElement(dst, pool);
+      if (copy == NULL || !slotCopy(copy, element, pool))
+        return false;
+    }
+    return true;
+  case VALUE_IS_OBJECT:
+    slotToObject(dst);
+    for (const VariantSlot *member = src->content.asCollection.head; member != NULL; member = member->next)
+    {
+      StringRef key = {member->key, strlen(member->key), !(member->flags & ARDUINOJSON_KEY_IS_OWNED)};
+      VariantSlot *copy = slotAddMember(dst, key, pool);
+      if (copy == NULL || !slotCopy(copy, member, pool))
+        return false;
+    }
+    return true;
+  default:
+    slotSetType(dst, src->type());
+    dst->content = src->content;
+    return true;
+  }
+}
+
+const VariantSlot *slotGetMember(const VariantSlot *object, const char *key)
+{
+  if (object == NULL || key == NULL || object->type() != VALUE_IS_OBJECT)
+    return NULL;
+  for (const VariantSlot *member = object->content.asCollection.head; member != NULL; member = member->next)
+    if (strcmp(member->key, key) == 0)
+      return member;
+  return NULL;
+}
+
+VariantSlot *slotGetMember(VariantSlot *object, const char *key)
+{
+  return const_cast<VariantSlot *>(slotGetMember(const_cast<const VariantSlot *>(object), key));
+}
+
+VariantSlot *slotAddMember(VariantSlot *object, StringRef key, MemoryPool *pool)
+{
+  if (object == NULL || key.str == NULL || object->type() != VALUE_IS_OBJECT)
+    return NULL;
+  VariantSlot *slot = appendSlot(object, pool);
+  if (slot == NULL)
+    return NULL;
+  if (!slotSetKey(slot, key, pool))
+  {
+    unlinkSlot(object, slot);
+    return NULL;
+  }
+  return slot;
+}
+
+VariantSlot *slotGetOrAddMember(VariantSlot *object, StringRef key, MemoryPool *pool)
+{
+  if (object == NULL)
+    return NULL;
+  if (object->type() == VALUE_IS_NULL)
+    slotToObject(object);
+  VariantSlot *member = slotGetMember(object, key.str);
+  if (member != NULL)
+    return member;
+  return slotAddMember(object, key, pool);
+}
+
+void slotRemoveMember(VariantSlot *object, const char *key)
+{
+  VariantSlot *member = slotGetMember(object, key);
+  if (member != NULL)
+    unlinkSlot(object, member);
+}
+
+const VariantSlot *slotGetElement(const VariantSlot *array, size_t index)
+{
+  if (array == NULL || array->type() != VALUE_IS_ARRAY)
+    return NULL;
+  const VariantSlot *element = array->content.asCollection.head;
+  while (element != NULL && index > 0)
+  {
+    element = element->next;
+    index--;
+  }
+  return element;
+}
+
+VariantSlot *slotGetElement(VariantSlot *array, size_t index)
+{
+  return const_cast<VariantSlot *>(slotGetElement(const_cast<const VariantSlot *>(array), index));
+}
+
+VariantSlot *slotAddElement(VariantSlot *array, MemoryPool *pool)
+{
+  if (array == NULL || array->type() != VALUE_IS_ARRAY)
+    return NULL;
+  return appendSlot(array, pool);
+}
+
+VariantSlot *slotGetOrAddElement(VariantSlot *array, size_t index, MemoryPool *pool)
+{
+  if (array == NULL)
+    return NULL;
+  if (array->type() == VALUE_IS_NULL)
+    slotToArray(array);
+  if (array->type() != VALUE_IS_ARRAY)
+    return NULL;
+  VariantSlot *element = array->content.asCollection.head;
+  if (element == NULL)
+  {
+    element = slotAddElement(array, pool);
+    if (element == NULL)
+      return NULL;
+  }
+  while (index > 0)
+  {
+    if (element->next == NULL && slotAddElement(array, pool) == NULL)
+      return NULL;
+    element = element->next;
+    index--;
+  }
+  return element;
+}
+
+size_t slotSize(const VariantSlot *slot)
+{
+  if (slot == NULL || (slot->type() != VALUE_IS_ARRAY && slot->type() != VALUE_IS_OBJECT))
+    return 0;
+  size_t size = 0;
+  for (const VariantSlot *child = slot->content.asCollection.head; child != NULL; child = child->next)
+    size++;
+  return size;
+}
+
+const char *slotAsString(const VariantSlot *slot)
+{
+  if (slot == NULL)
+    return NULL;
+  if (slot->type() == VALUE_IS_LINKED_STRING || slot->type() == VALUE_IS_OWNED_STRING)
+    return slot->content.asString;
+  return NULL;
+}
+
+bool slotAsBoolean(const VariantSlot *slot)
+{
+  if (slot == NULL)
+    return false;
+  switch (slot->type())
+  {
+  case VALUE_IS_BOOLEAN:
+    return slot->content.asBoolean;
+  case VALUE_IS_INTEGER:
+    return slot->content.asInteger != 0;
+  case VALUE_IS_FLOAT:
+    return slot->content.asFloat != 0;
+  default:
+    return false;
+  }
+}
+
+/**
+ * @brief Parses a whole string as a number, anything else gives 0
+ */
+static bool parseNumber(const char *text, int64_t &integer, double &real, bool &isInteger)
+{
+  if (text == NULL || *text == '\0')
+    return false;
+  char *end;
+  errno = 0;
+  long long parsed = strtoll(text, &end, 10);
+  if (*end == '\0' && errno == 0)
+  {
+    integer = parsed;
+    isInteger = true;
+    return true;
+  }
+  real = strtod(text, &end);
+  if (*end != '\0')
+    return false;
+  isInteger = false;
+  return true;
+}
+
+int64_t slotAsInteger(const VariantSlot *slot)
+{
+  if (slot == NULL)
+    return 0;
+  switch (slot->type())
+  {
+  case VALUE_IS_BOOLEAN:
+    return slot->content.asBoolean ? 1 : 0;
+  case VALUE_IS_INTEGER:
+    return slot->content.asInteger;
+  case VALUE_IS_FLOAT:
+    return (int64_t)slot->content.asFloat;
+  case VALUE_IS_LINKED_STRING:
+  case VALUE_IS_OWNED_STRING:
+  {
+    int64_t integer = 0;
+    double real = 0;
+    bool isInteger = false;
+    if (!parseNumber(slot->content.asString, integer, real, isInteger))
+      return 0;
+    return isInteger ? integer : (int64_t)real;
+  }
+  default:
+    return 0;
+  }
+}
+
+uint64_t slotAsUnsigned(const VariantSlot *slot)
+{
+  return (uint64_t)slotAsInteger(slot);
+}
+
+float slotAsFloat(const VariantSlot *slot)
+{
+  if (slot == NULL)
+    return 0;
+  switch (slot->type())
+  {
+  case VALUE_IS_BOOLEAN:
+    return slot->content.asBoolean ? 1 : 0;
+  case VALUE_IS_INTEGER:
+    return (float)slot->content.asInteger;
+  case VALUE_IS_FLOAT:
+    return slot->content.asFloat;
+  case VALUE_IS_LINKED_STRING:
+  case VALUE_IS_OWNED_STRING:
+  {
+    int64_t integer = 0;
+    double real = 0;
+    bool isInteger = false;
+    if (!parseNumber(slot->content.asString, integer, real, isInteger))
+      return 0;
+    return isInteger ? (float)integer : (float)real;
+  }
+  default:
+    return 0;
+  }
+}
+
+size_t JsonWriter::write(const uint8_t *s, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    this->write(s[i]);
+  return n;
+}
+
+class StringWriter : public JsonWriter
+{
+public:
+  explicit StringWriter(String &output)
+      : _output(output)
+  {
+  }
+  size_t write(uint8_t c) override
+  {
+    this->_output += (char)c;
+    return 1;
+  }
+  size_t write(const uint8_t *s, size_t n) override
+  {
+    this->_output.reserve(this->_output.length() + n);
+    for (size_t i = 0; i < n; i++)
+      this->_output += (char)s[i];
+    return n;
+  }
+
+private:
+  String &_output;
+};
+
+class BufferWriter : public JsonWriter
+{
+public:
+  BufferWriter(char *buffer, size_t size)
+      : _position(buffer),
+        _end(buffer + size - 1)
+  {
+  }
+  size_t write(uint8_t c) override
+  {
+    if (this->_position >= this->_end)
+      return 0;
+    *this->_position++ = (char)c;
+    return 1;
+  }
+  void terminate(void)
+  {
+    *this->_position = '\0';
+  }
+
+private:
+  char *_position;
+  char *_end;
+};
+
+class PrintWriter : public JsonWriter
+{
+public:
+  explicit PrintWriter(Print &output)
+      : _output(output)
+  {
+  }
+  size_t write(uint8_t c) override
+  {
+    return this->_output.write(c);
+  }
+  size_t write(const uint8_t *s, size_t n) override
+  {
+    return this->_output.write(s, n);
+  }
+
+private:
+  Print &_output;
+};
+
+class CountingWriter : public JsonWriter
+{
+public:
+  size_t write(uint8_t c) override
+  {
+    return 1;
+  }
+  size_t write(const uint8_t *s, size_t n) override
+  {
+    return n;
+  }
+};
+
+static size_t writeRaw(JsonWriter &writer, const char *text)
+{
+  return writer.write((const uint8_t *)text, strlen(text));
+}
+
+static size_t writeString(JsonWriter &writer, const char *text)
+{
+  size_t count = writer.write('"');
+  for (const char *c = text; *c != '\0'; c++)
+  {
+    char escape = 0;
+    switch (*c)
+    {
+    case '"':
+      escape = '"';
+      break;
+    case '\\':
+      escape = '\\';
+      break;
+    case '\b':
+      escape = 'b';
+      break;
+    case '\f':
+      escape = 'f';
+      break;
+    case '\n':
+      escape = 'n';
+      break;
+    case '\r':
+      escape = 'r';
+      break;
+    case '\t':
+      escape = 't';
+      break;
+    }
+    if (escape != 0)
+    {
+      count += writer.write('\\');
+      count += writer.write(escape);
+    }
+    else
+      count += writer.write(*c);
+  }
+  return count + writer.write('"');
+}
+
+static size_t writeFloat(JsonWriter &writer, float value)
+{
+  if (isnan(value))
+    return writeRaw(writer, "NaN");
+  if (isinf(value))
+    return writeRaw(writer, value > 0 ? "Infinity" : "-Infinity");
+  char text[32];
+  if (value == floorf(value) && fabsf(value) < 1e7f)
+    snprintf(text, sizeof(text), "%ld", (long)value);
+  else
+  {
+    snprintf(text, sizeof(text), "%.7g", value);
+    // 1.5e+10 is written 1.5e10, as ArduinoJson does
+    char *exponent = strchr(text, 'e');
+    if (exponent != NULL)
+    {
+      char *digits = exponent + 1;
+      bool negative = *digits == '-';
+      if (*digits == '+' || *digits == '-')
+        digits++;
+      while (*digits == '0' && digits[1] != '\0')
+        digits++;
+      char *out = exponent + 1;
+      if (negative)
+        *out++ = '-';
+      memmove(out, digits, strlen(digits) + 1);
+    }
+  }
+  return writeRaw(writer, text);
+}
+
+size_t serialize(const VariantSlot *slot, JsonWriter &writer)
+{
+  if (slot == NULL)
+    return writeRaw(writer, "null");
+  switch (slot->type())
+  {
+  case VALUE_IS_LINKED_STRING:
+  case VALUE_IS_OWNED_STRING:
+    return writeString(writer, slot->content.asString);
+  case VALUE_IS_BOOLEAN:
+    return writeRaw(writer, slot->content.asBoolean ? "true" : "false");
+  case VALUE_IS_INTEGER:
+  {
+    char text[24];
+    snprintf(text, sizeof(text), "%lld", (long long)slot->content.asInteger);
+    return writeRaw(writer, text);
+  }
+  case VALUE_IS_FLOAT:
+    return writeFloat(writer, slot->content.asFloat);
+  case VALUE_IS_ARRAY:
+  {
+    size_t count = writer.write('[');
+    for (const VariantSlot *element = slot->content.asCollection.head; element != NULL; element = element->next)
+    {
+      if (element != slot->content.asCollection.head)
+        count += writer.write(',');
+      count += serialize(element, writer);
+    }
+    return count + writer.write(']');
+  }
+  case VALUE_IS_OBJECT:
+  {
+    size_t count = writer.write('{');
+    for (const VariantSlot *member = slot->content.asCollection.head; member != NULL; member = member->next)
+    {
+      if (member != slot->content.asCollection.head)
+        count += writer.write(',');
+      count += writeString(writer, member->key);
+      count += writer.write(':');
+      count += serialize(member, writer);
+    }
+    return count + writer.write('}');
+  }
+  default:
+    return writeRaw(writer, "null");
+  }
+}
+
+size_t serializeToString(const VariantSlot *slot, String &output)
+{
+  StringWriter writer(output);
+  return serialize(slot, writer);
+}
+
+size_t serializeToBuffer(const VariantSlot *slot, char *buffer, size_t size)
+{
+  if (buffer == NULL || size == 0)
+    return 0;
+  BufferWriter writer(buffer, size);
+  size_t count = serialize(slot, writer);
+  writer.terminate();
+  return count < size ? count : size - 1;
+}
+
+size_t serializeToPrint(const VariantSlot *slot, Print &output)
+{
+  PrintWriter writer(output);
+  return serialize(slot, writer);
+}
+
+size_t measure(const VariantSlot *slot)
+{
+  CountingWriter writer;
+  return serialize(slot, writer);
+}
+
+/**
+ * @brief Reads from a buffer with a known length
+ */
+class BufferReader
+{
+public:
+  BufferReader(const char *input, size_t length)
+      : _position(input),
+        _end(input + length)
+  {
+  }
+  int peek(void)
+  {
+    return this->_position < this->_end ? (unsigned char)*this->_position : -1;
+  }
+  int read(void)
+  {
+    return this->_position < this->_end ? (unsigned char)*this->_position++ : -1;
+  }
+  const char *position(void) const
+  {
+    return this->_position;
+  }
+
+private:
+  const char *_position;
+  const char *_end;
+};
+
+/**
+ * @brief Reads a Stream one byte at a time, as ArduinoJson does
+ */
+class StreamReader
+{
+public:
+  explicit StreamReader(Stream &input)
+      : _input(input),
+        _peeked(-2)
+  {
+  }
+  int peek(void)
+  {
+    if (this->_peeked == -2)
+    {
+      char c;
+      this->_peeked = this->_input.readBytes(&c, 1) == 1 ? (unsigned char)c : -1;
+    }
+    return this->_peeked;
+  }
+  int read(void)
+  {
+    int c = this->peek();
+    if (c >= 0)
+      this->_peeked = -2;
+    return c;
+  }
+
+private:
+  Stream &_input;
+  int _peeked;
+};
+
+/**
+ * @brief Collects a string and copies it into the pool
+ */
+class StringCopier
+{
+public:
+  explicit StringCopier(MemoryPool *pool)
+      : _pool(pool)
+  {
+  }
+  void begin(const char *position)
+  {
+    this->_text.clear();
+  }
+  void append(char c)
+  {
+    this->_text.push_back(c);
+  }
+  const char *save(void)
+  {
+    return copyString(this->_text.data(), this->_text.size(), this->_pool);
+  }
+  uint8_t type(void) const
+  {
+    return VALUE_IS_OWNED_STRING;
+  }
+
+private:
+  MemoryPool *_pool;
+  std::string _text;
+};
+
+/**
+ * @brief Decodes a string over the input it was read from
+ */
+class StringMover
+{
+public:
+  void begin(const char *position)
+  {
+    this->_start = this->_write = const_cast<char *>(position);
+  }
+  void append(char c)
+  {
+    *this->_write++ = c;
+  }
+  const char *save(void)
+  {
+    *this->_write++ = '\0';
+    return this->_start;
+  }
+  uint8_t type(void) const
+  {
+    return VALUE_IS_OWNED_STRING;
+  }
+
+private:
+  char *_start;
+  char *_write;
+};
+
+template <typename TReader, typename TStrings>
+class Parser
+{
+public:
+  Parser(TReader &reader, TStrings &strings, MemoryPool *pool)
+      : _reader(reader),
+        _strings(strings),
+        _pool(pool)
+  {
+  }
+
+  DeserializationError parse(VariantSlot *root, uint8_t nestingLimit)
+  {
+    this->skipSpaces();
+    if (this->_reader.peek() < 0)
+      return DeserializationError::IncompleteInput;
+    return this->parseVariant(root, nestingLimit);
+  }
+
+private:
+  void skipSpaces(void)
+  {
+    for (;;)
+    {
+      int c = this->_reader.peek();
+      if (c != ' ' && c != '\t' && c != '\r' && c != '\n')
+        return;
+      this->_reader.read();
+    }
+  }
+
+  DeserializationError parseVariant(VariantSlot *slot, uint8_t nestingLimit)
+  {
+    this->skipSpaces();
+    int c = this->_reader.peek();
+    switch (c)
+    {
+    case -1:
+      return DeserializationError::IncompleteInput;
+    case '{':
+      return this->parseObject(slot, nestingLimit);
+    case '[':
+      return this->parseArray(slot, nestingLimit);
+    case '"':
+    case '\'':
+      return this->parseStringValue(slot);
+    default:
+      return this->parseLiteral(slot);
+    }
+  }
+
+  DeserializationError parseObject(VariantSlot *slot, uint8_t nestingLimit)
+  {
+    if (nestingLimit == 0)
+      return DeserializationError::TooDeep;
+    this->_reader.read();
+    slotToObject(slot);
+    this->skipSpaces();
+    if (this->_reader.peek() == '}')
+    {
+      this->_reader.read();
+      return DeserializationError::Ok;
+    }
+    for (;;)
+    {
+      this->skipSpaces();
+      const char *key;
+      bool colonConsumed = false;
+      DeserializationError error = this->parseKey(key, colonConsumed);
+      if (error)
+        return error;
+      if (!colonConsumed)
+      {
+        this->skipSpaces();
+        int c = this->_reader.read();
+        if (c < 0)
+          return DeserializationError::IncompleteInput;
+        if (c != ':')
+          return DeserializationError::InvalidInput;
+      }
+      // A duplicated key reuses its member, its copied name stays in the pool
+      VariantSlot *member = slotGetMember(slot, key);
+      if (member == NULL)
+      {
+        member = appendSlot(slot, this->_pool);
+        if (member == NULL)
+          return DeserializationError::NoMemory;
+        member->key = key;
+        member->flags |= ARDUINOJSON_KEY_IS_OWNED;
+      }
+      error = this->parseVariant(member, nestingLimit - 1);
+      if (error)
+        return error;
+      this->skipSpaces();
+      int c = this->_reader.read();
+      if (c < 0)
+        return DeserializationError::IncompleteInput;
+      if (c == '}')
+        return DeserializationError::Ok;
+      if (c != ',')
+        return DeserializationError::InvalidInput;
+    }
+  }
+
+  DeserializationError parseArray(VariantSlot *slot, uint8_t nestingLimit)
+  {
+    if (nestingLimit == 0)
+      return DeserializationError::TooDeep;
+    this->_reader.read();
+    slotToArray(slot);
+    this->skipSpaces();
+    if (this->_reader.peek() == ']')
+    {
+      this->_reader.read();
+      return DeserializationError::Ok;
+    }
+    for (;;)
+    {
+      VariantSlot *element = appendSlot(slot, this->_pool);
+      if (element == NULL)
+        return DeserializationError::NoMemory;
+      DeserializationError error = this->parseVariant(element, nestingLimit - 1);
+      if (error)
+        return error;
+      this->skipSpaces();
+      int c = this->_reader.read();
+      if (c < 0)
+        return DeserializationError::IncompleteInput;
+      if (c == ']')
+        return DeserializationError::Ok;
+      if (c != ',')
+        return DeserializationError::InvalidInput;
+    }
+  }
+
+  static bool isKeyChar(int c)
+  {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '+' || c == '-' || c == '.';
+  }
+
+  DeserializationError parseKey(const char *&key, bool &colonConsumed)
+  {
+    int c = this->_reader.peek();
+    if (c == '"' || c == '\'')
+      return this->parseQuotedString(key);
+    if (c < 0)
+      return DeserializationError::IncompleteInput;
+    if (!isKeyChar(c))
+      return DeserializationError::InvalidInput;
+    this->_strings.begin(this->position());
+    while (isKeyChar(this->_reader.peek()))
+      this->_strings.append((char)this->_reader.read());
+    if (this->_reader.peek() == ':')
+    {
+      // The terminating zero may overwrite the colon when decoding in place
+      this->_reader.read();
+      colonConsumed = true;
+    }
+    key = this->_strings.save();
+    return key != NULL ? DeserializationError::Ok : DeserializationError::NoMemory;
+  }
+
+  DeserializationError parseStringValue(VariantSlot *slot)
+  {
+    const char *value;
+    DeserializationError error = this->parseQuotedString(value);
+    if (error)
+      return error;
+    slotSetType(slot, this->_strings.type());
+    slot->content.asString = value;
+    return DeserializationError::Ok;
+  }
+
+  static int hexValue(int c)
+  {
+    if (c >= '0' && c <= '9')
+      return c - '0';
+    if (c >= 'a' && c <= 'f')
+      return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+      return c - 'A' + 10;
+    return -1;
+  }
+
+  DeserializationError parseCodepoint(uint16_t &codepoint)
+  {
+    codepoint = 0;
+    for (int i = 0; i < 4; i++)
+    {
+      int c = this->_reader.read();
+      if (c < 0)
+        return DeserializationError::IncompleteInput;
+      int digit = hexValue(c);
+      if (digit < 0)
+        return DeserializationError::InvalidInput;
+      codepoint = (codepoint << 4) | digit;
+    }
+    return DeserializationError::Ok;
+  }
+
+  void appendUtf8(uint32_t codepoint)
+  {
+    if (codepoint < 0x80)
+      this->_strings.append((char)codepoint);
+    else if (codepoint < 0x800)
+    {
+      this->_strings.append((char)(0xC0 | (codepoint >> 6)));
+      this->_strings.append((char)(0x80 | (codepoint & 0x3F)));
+    }
+    else if (codepoint < 0x10000)
+    {
+      this->_strings.append((char)(0xE0 | (codepoint >> 12)));
+      this->_strings.append((char)(0x80 | ((codepoint >> 6) & 0x3F)));
+      this->_strings.append((char)(0x80 | (codepoint & 0x3F)));
+    }
+    else
+    {
+      this->_strings.append((char)(0xF0 | (codepoint >> 18)));
+      this->_strings.append((char)(0x80 | ((codepoint >> 12) & 0x3F)));
+      this->_strings.append((char)(0x80 | ((codepoint >> 6) & 0x3F)));
+      this->_strings.append((char)(0x80 | (codepoint & 0x3F)));
+    }
+  }
+
+  DeserializationError parseQuotedString(const char *&result)
+  {
+    this->_strings.begin(this->position());
+    int quote = this->_reader.read();
+#if ARDUINOJSON_DECODE_UNICODE
+    uint16_t highSurrogate = 0;
+#endif
+    for (;;)
+    {
+      int c = this->_reader.read();
+      if (c < 0)
+        return DeserializationError::IncompleteInput;
+      if (c == quote)
+        break;
+      if (c == '\\')
+      {
+        c = this->_reader.read();
+        switch (c)
+        {
+        case -1:
+          return DeserializationError::IncompleteInput;
+        case 'b':
+          c = '\b';
+          break;
+        case 'f':
+          c = '\f';
+          break;
+        case 'n':
+          c = '\n';
+          break;
+        case 'r':
+          c = '\r';
+          break;
+        case 't':
+          c = '\t';
+          break;
+        case 'u':
+        {
+#if ARDUINOJSON_DECODE_UNICODE
+          uint16_t codepoint;
+          DeserializationError error = this->parseCodepoint(codepoint);
+          if (error)
+            return error;
+          if (codepoint >= 0xD800 && codepoint < 0xDC00)
+            highSurrogate = codepoint;
+          else if (codepoint >= 0xDC00 && codepoint < 0xE000 && highSurrogate != 0)
+          {
+            this->appendUtf8(0x10000 + ((uint32_t)(highSurrogate - 0xD800) << 10) + (codepoint - 0xDC00));
+            highSurrogate = 0;
+          }
+          else
+            this->appendUtf8(codepoint);
+          continue;
+#else
+          return DeserializationError::NotSupported;
+#endif
+        }
+        default:
+          break;
+        }
+      }
+      this->_strings.append((char)c);
+    }
+    result = this->_strings.save();
+    return result != NULL ? DeserializationError::Ok : DeserializationError::NoMemory;
+  }
+
+  static bool isLiteralChar(int c)
+  {
+    return isKeyChar(c);
+  }
+
+  DeserializationError parseLiteral(VariantSlot *slot)
+  {
+    char text[64];
+    size_t length = 0;
+    while (isLiteralChar(this->_reader.peek()) && length < sizeof(text) - 1)
+      text[length++] = (char)this->_reader.read();
+    text[length] = '\0';
+    if (length == 0)
+      return this->_reader.peek() < 0 ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+    if (strcmp(text, "true") == 0)
+      slotSetBoolean(slot, true);
+    else if (strcmp(text, "false") == 0)
+      slotSetBoolean(slot, false);
+    else if (strcmp(text, "null") == 0)
+      slotSetNull(slot);
+    else if (strcmp(text, "NaN") == 0)
+      slotSetFloat(slot, NAN);
+    else if (strcmp(text, "Infinity") == 0)
+      slotSetFloat(slot, INFINITY);
+    else if (strcmp(text, "-Infinity") == 0)
+      slotSetFloat(slot, -INFINITY);
+    else
+    {
+      int64_t integer = 0;
+      double real = 0;
+      bool isInteger = false;
+      if (!parseNumber(text, integer, real, isInteger))
+        return DeserializationError::InvalidInput;
+      if (isInteger)
+        slotSetInteger(slot, integer);
+      else
+        slotSetFloat(slot, (float)real);
+    }
+    return DeserializationError::Ok;
+  }
+
+  const char *position(void) const
+  {
+    return this->positionOf(this->_reader);
+  }
+
+  static const char *positionOf(const BufferReader &reader)
+  {
+    return reader.position();
+  }
+
+  static const char *positionOf(const StreamReader &reader)
+  {
+    return NULL;
+  }
+
+  TReader &_reader;
+  TStrings &_strings;
+  MemoryPool *_pool;
+};
+
+DeserializationError deserialize(JsonDocument &doc, const char *input, size_t length, uint8_t nestingLimit)
+{
+  doc.clear();
+  if (input == NULL)
+    return DeserializationError::IncompleteInput;
+  BufferReader reader(input, length);
+  StringCopier strings(doc.getPool());
+  Parser<BufferReader, StringCopier> parser(reader, strings, doc.getPool());
+  return parser.parse(doc.getData(), nestingLimit);
+}
+
+DeserializationError deserializeInPlace(JsonDocument &doc, char *input, uint8_t nestingLimit)
+{
+  doc.clear();
+  if (input == NULL)
+    return DeserializationError::IncompleteInput;
+  BufferReader reader(input, strlen(input));
+  StringMover strings;
+  Parser<BufferReader, StringMover> parser(reader, strings, doc.getPool());
+  return parser.parse(doc.getData(), nestingLimit);
+}
+
+DeserializationError deserialize(JsonDocument &doc, Stream &input, uint8_t nestingLimit)
+{
+  doc.clear();
+  StreamReader reader(input);
+  StringCopier strings(doc.getPool());
+  Parser<StreamReader, StringCopier> parser(reader, strings, doc.getPool());
+  return parser.parse(doc.getData(), nestingLimit);
+}
+} // namespace detail
+
+DynamicJsonDocument::DynamicJsonDocument(size_t capacity)
+    : JsonDocument(NULL, 0)
+{
+  this->reallocPool(capacity);
+}
+
+DynamicJsonDocument::DynamicJsonDocument(const DynamicJsonDocument &src)
+    : JsonDocument(NULL, 0)
+{
+  this->reallocPool(src.capacity());
+  this->set(src);
+}
+
+DynamicJsonDocument::DynamicJsonDocument(DynamicJsonDocument &&src)
+    : JsonDocument(NULL, 0)
+{
+  this->reallocPool(src.capacity());
+  this->set(src);
+}
+
+DynamicJsonDocument::DynamicJsonDocument(const JsonDocument &src)
+    : JsonDocument(NULL, 0)
+{
+  this->reallocPool(src.memoryUsage());
+  this->set(src);
+}
+
+DynamicJsonDocument::~DynamicJsonDocument(void)
+{
+  free(this->_pool.buffer());
+}
+
+DynamicJsonDocument &DynamicJsonDocument::operator=(const DynamicJsonDocument &src)
+{
+  if (this == &src)
+    return *this;
+  if (src.capacity() > this->capacity())
+    this->reallocPool(src.capacity());
+  this->set(src);
+  return *this;
+}
+
+DynamicJsonDocument &DynamicJsonDocument::operator=(DynamicJsonDocument &&src)
+{
+  return *this = static_cast<const DynamicJsonDocument &>(src);
+}
+
+void DynamicJsonDocument::reallocPool(size_t capacity)
+{
+  free(this->_pool.buffer());
+  capacity = addPadding(capacity);
+  char *buffer = (char *)malloc(detail::MemoryPool::bufferSize(capacity));
+  this->_pool = detail::MemoryPool(buffer, buffer != NULL ? capacity : 0);
+  detail::slotSetNull(&this->_root);
+}
+} // namespace ArduinoJson
@@ -0,0 +1,2019 @@
+/*
+  ArduinoJson.h - offline stand-in for a subset of the ArduinoJson 6.14 API
+  The API, its names and its memory accounting are those of ArduinoJson,
+  Copyright (c) Benoit Blanchon, MIT License, https://arduinojson.org.
+  This is not ArduinoJson and not its code, only used by the host build
+  when ArduinoJson 6.14.1 can not be downloaded.
+*/
+
+// ensure this library description is only included once
+#ifndef ArduinoJson_h
+#define ArduinoJson_h
+
+/*
+ * Host build stand-in for the part of ArduinoJson 6.14 the library uses,
+ * for offline builds only: CMakeLists.txt builds against ArduinoJson 6.14.1
+ * itself whenever it can be downloaded or ARDUINOJSON_DIR is set. Memory is counted like ArduinoJson counts it on the
+ * ESP32: every value or member takes one 16 byte slot, a copied string
+ * takes its length plus one. So a capacity that is too small on the board
+ * is too small here as well, which is what the capacity tests rely on.
+ *
+ * Behaviour kept from 6.14:
+ * - const char * keys and values are linked, char *, String and
+ *   std::string are copied into the document
+ * - writes that do not fit are silently dropped
+ * - deserializeJson() copies every string, except from a char * input
+ *   which is parsed in place, and answers NoMemory when the document is full
+ * - \u escapes are NotSupported unless ARDUINOJSON_DECODE_UNICODE is 1
+ * - as<String>() serializes values that are not strings
+ */
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+
+#define ARDUINOJSON_VERSION "6.14.1"
+#define ARDUINOJSON_VERSION_MAJOR 6
+#define ARDUINOJSON_VERSION_MINOR 14
+#define ARDUINOJSON_VERSION_REVISION 1
+
+// Slot size and alignment of ArduinoJson on the ESP32
+#define ARDUINOJSON_SLOT_SIZE 16
+#define ARDUINOJSON_ALIGNMENT 4
+
+#ifndef ARDUINOJSON_DEFAULT_NESTING_LIMIT
+#define ARDUINOJSON_DEFAULT_NESTING_LIMIT 10
+#endif
+
+#ifndef ARDUINOJSON_DECODE_UNICODE
+#define ARDUINOJSON_DECODE_UNICODE 0
+#endif
+
+#define JSON_ARRAY_SIZE(NUMBER_OF_ELEMENTS) ((NUMBER_OF_ELEMENTS)*ARDUINOJSON_SLOT_SIZE)
+#define JSON_OBJECT_SIZE(NUMBER_OF_ELEMENTS) ((NUMBER_OF_ELEMENTS)*ARDUINOJSON_SLOT_SIZE)
+#define JSON_STRING_SIZE(SIZE) ((SIZE) + 1)
+
+namespace ArduinoJson
+{
+class JsonVariant;
+class JsonVariantConst;
+class JsonObject;
+class JsonObjectConst;
+class JsonArray;
+class JsonArrayConst;
+class JsonDocument;
+
+namespace detail
+{
+enum : uint8_t
+{
+  VALUE_IS_NULL = 0,
+  VALUE_IS_LINKED_STRING,
+  VALUE_IS_OWNED_STRING,
+  VALUE_IS_BOOLEAN,
+  VALUE_IS_INTEGER,
+  VALUE_IS_FLOAT,
+  VALUE_IS_ARRAY,
+  VALUE_IS_OBJECT
+};
+
+#define ARDUINOJSON_TYPE_MASK 0x7F
+#define ARDUINOJSON_KEY_IS_OWNED 0x80
+
+struct VariantSlot;
+
+struct CollectionData
+{
+  VariantSlot *head;
+  VariantSlot *tail;
+};
+
+union VariantContent
+{
+  float asFloat;
+  int64_t asInteger;
+  bool asBoolean;
+  const char *asString;
+  CollectionData asCollection;
+};
+
+/**
+ * @brief A value, the member of an object or the element of an array
+ */
+struct VariantSlot
+{
+  VariantContent content;
+  VariantSlot *next;
+  const char *key;
+  uint8_t flags;
+
+  uint8_t type(void) const
+  {
+    return this->flags & ARDUINOJSON_TYPE_MASK;
+  }
+};
+
+/**
+ * @brief Slots from the front of the buffer, strings from the back
+ * The capacity is counted in ESP32 sizes, the buffer is large enough for
+ * the host's bigger slots.
+ */
+class MemoryPool
+{
+public:
+  MemoryPool(char *buffer = NULL, size_t capacity = 0);
+
+  static size_t bufferSize(size_t capacity);
+
+  VariantSlot *allocSlot(void);
+  char *allocString(size_t size);
+
+  size_t capacity(void) const
+  {
+    return this->_capacity;
+  }
+  size_t size(void) const
+  {
+    return this->_slots * ARDUINOJSON_SLOT_SIZE + this->_strings;
+  }
+  size_t available(void) const
+  {
+    return this->_capacity - this->size();
+  }
+  char *buffer(void) const
+  {
+    return this->_buffer;
+  }
+  void clear(void);
+
+private:
+  char *_buffer;
+  size_t _bufferSize;
+  size_t _capacity;
+  size_t _slots;
+  size_t _strings;
+};
+
+/**
+ * @brief A string to store, either linked or copied into the pool
+ */
+struct StringRef
+{
+  const char *str;
+  size_t length;
+  bool linked;
+};
+
+inline StringRef makeStringRef(const char *str)
+{
+  return {str, str != NULL ? strlen(str) : 0, true};
+}
+
+inline StringRef makeStringRef(char *str)
+{
+  return {str, str != NULL ? strlen(str) : 0, false};
+}
+
+inline StringRef makeStringRef(const String &str)
+{
+  return {str.c_str(), str.length(), false};
+}
+
+inline StringRef makeStringRef(const std::string &str)
+{
+  return {str.c_str(), str.length(), false};
+}
+
+void slotSetNull(VariantSlot *slot);
+bool slotSetString(VariantSlot *slot, StringRef value, MemoryPool *pool);
+void slotSetInteger(VariantSlot *slot, int64_t value);
+void slotSetFloat(VariantSlot *slot, float value);
+void slotSetBoolean(VariantSlot *slot, bool value);
+VariantSlot *slotToArray(VariantSlot *slot);
+VariantSlot *slotToObject(VariantSlot *slot);
+bool slotCopy(VariantSlot *dst, const VariantSlot *src, MemoryPool *pool);
+
+const VariantSlot *slotGetMember(const VariantSlot *object, const char *key);
+VariantSlot *slotGetMember(VariantSlot *object, const char *key);
+VariantSlot *slotGetOrAddMember(VariantSlot *object, StringRef key, MemoryPool *pool);
+VariantSlot *slotAddMember(VariantSlot *object, StringRef key, MemoryPool *pool);
+void slotRemoveMember(VariantSlot *object, const char *key);
+const VariantSlot *slotGetElement(const VariantSlot *array, size_t index);
+VariantSlot *slotGetElement(VariantSlot *array, size_t index);
+VariantSlot *slotGetOrAddElement(VariantSlot *array, size_t index, MemoryPool *pool);
+VariantSlot *slotAddElement(VariantSlot *array, MemoryPool *pool);
+size_t slotSize(const VariantSlot *slot);
+
+const char *slotAsString(const VariantSlot *slot);
+bool slotAsBoolean(const VariantSlot *slot);
+int64_t slotAsInteger(const VariantSlot *slot);
+uint64_t slotAsUnsigned(const VariantSlot *slot);
+float slotAsFloat(const VariantSlot *slot);
+
+/**
+ * @brief Output of the serializer, an Arduino String, a char buffer, a Print or nothing
+ */
+class JsonWriter
+{
+public:
+  virtual ~JsonWriter(void)
+  {
+  }
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *s, size_t n);
+};
+
+size_t serialize(const VariantSlot *slot, JsonWriter &writer);
+size_t serializeToString(const VariantSlot *slot, String &output);
+size_t serializeToBuffer(const VariantSlot *slot, char *buffer, size_t size);
+size_t serializeToPrint(const VariantSlot *slot, Print &output);
+size_t measure(const VariantSlot *slot);
+
+template <typename T>
+struct IsIntegral
+{
+  static const bool value = std::is_integral<T>::value && !std::is_same<T, bool>::value;
+};
+
+template <typename T, typename Enable = void>
+struct Converter
+{
+};
+
+template <typename T, typename Enable = void>
+struct RefConverter
+{
+  static T read(VariantSlot *slot, MemoryPool *pool)
+  {
+    return Converter<T>::read(slot);
+  }
+};
+
+// Turns a value into an empty object or array, used by to<T>()
+template <typename T>
+struct ToConverter
+{
+};
+
+// Upstream of a proxy, a document, an object, an array or another proxy
+class DocumentRef;
+template <typename TUpstream>
+class MemberProxy;
+template <typename TUpstream>
+class ElementProxy;
+} // namespace detail
+
+/**
+ * @brief A key or string value and whether it is linked or owned by the document
+ */
+class JsonString
+{
+public:
+  JsonString(void)
+      : _data(NULL),
+        _linked(false)
+  {
+  }
+  JsonString(const char *data, bool linked = false)
+      : _data(data),
+        _linked(linked)
+  {
+  }
+
+  const char *c_str(void) const
+  {
+    return this->_data;
+  }
+  bool isNull(void) const
+  {
+    return this->_data == NULL;
+  }
+  bool isStatic(void) const
+  {
+    return this->_linked;
+  }
+  size_t size(void) const
+  {
+    return this->_data != NULL ? strlen(this->_data) : 0;
+  }
+  bool operator==(const JsonString &other) const
+  {
+    if (this->_data == other._data)
+      return true;
+    if (this->_data == NULL || other._data == NULL)
+      return false;
+    return strcmp(this->_data, other._data) == 0;
+  }
+  bool operator!=(const JsonString &other) const
+  {
+    return !(*this == other);
+  }
+  operator bool() const
+  {
+    return this->_data != NULL;
+  }
+
+private:
+  const char *_data;
+  bool _linked;
+};
+
+namespace detail
+{
+inline StringRef makeStringRef(JsonString str)
+{
+  return {str.c_str(), str.size(), str.isStatic()};
+}
+
+// Setting a value: the overloads decide what is linked and what is copied
+inline bool setValue(VariantSlot *slot, MemoryPool *pool, bool value)
+{
+  slotSetBoolean(slot, value);
+  return true;
+}
+
+template <typename T>
+inline typename std::enable_if<IsIntegral<T>::value, bool>::type setValue(VariantSlot *slot, MemoryPool *pool, T value)
+{
+  slotSetInteger(slot, (int64_t)value);
+  return true;
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value, bool>::type setValue(VariantSlot *slot, MemoryPool *pool, T value)
+{
+  slotSetFloat(slot, (float)value);
+  return true;
+}
+
+inline bool setValue(VariantSlot *slot, MemoryPool *pool, const char *value)
+{
+  return slotSetString(slot, makeStringRef(value), pool);
+}
+
+inline bool setValue(VariantSlot *slot, MemoryPool *pool, char *value)
+{
+  return slotSetString(slot, makeStringRef(value), pool);
+}
+
+inline bool setValue(VariantSlot *slot, MemoryPool *pool, const String &value)
+{
+  return slotSetString(slot, makeStringRef(value), pool);
+}
+
+inline bool setValue(VariantSlot *slot, MemoryPool *pool, const std::string &value)
+{
+  return slotSetString(slot, makeStringRef(value), pool);
+}
+
+inline bool setValue(VariantSlot *slot, MemoryPool *pool, JsonString value)
+{
+  return slotSetString(slot, makeStringRef(value), pool);
+}
+
+inline bool setValue(VariantSlot *slot, MemoryPool *pool, std::nullptr_t)
+{
+  slotSetNull(slot);
+  return true;
+}
+
+// Any variant, object, array, document or proxy is deep copied
+template <typename T>
+inline auto setValue(VariantSlot *slot, MemoryPool *pool, const T &value) -> decltype(value.getData(), bool())
+{
+  return slotCopy(slot, value.getData(), pool);
+}
+} // namespace detail
+
+/**
+ * @brief Read only view of a value
+ */
+class JsonVariantConst
+{
+public:
+  JsonVariantConst(void)
+      : _data(NULL)
+  {
+  }
+  explicit JsonVariantConst(const detail::VariantSlot *data)
+      : _data(data)
+  {
+  }
+
+  template <typename T>
+  T as(void) const
+  {
+    return detail::Converter<T>::read(this->_data);
+  }
+
+  template <typename T>
+  bool is(void) const
+  {
+    return detail::Converter<T>::is(this->_data);
+  }
+
+  template <typename T>
+  operator T() const
+  {
+    return this->as<T>();
+  }
+
+  bool isNull(void) const
+  {
+    return this->_data == NULL || this->_data->type() == detail::VALUE_IS_NULL;
+  }
+  size_t size(void) const
+  {
+    return detail::slotSize(this->_data);
+  }
+
+  JsonVariantConst operator[](const char *key) const
+  {
+    return JsonVariantConst(detail::slotGetMember(this->_data, key));
+  }
+  JsonVariantConst operator[](char *key) const
+  {
+    return JsonVariantConst(detail::slotGetMember(this->_data, key));
+  }
+  JsonVariantConst operator[](const String &key) const
+  {
+    return JsonVariantConst(detail::slotGetMember(this->_data, key.c_str()));
+  }
+  JsonVariantConst operator[](const std::string &key) const
+  {
+    return JsonVariantConst(detail::slotGetMember(this->_data, key.c_str()));
+  }
+  JsonVariantConst operator[](JsonString key) const
+  {
+    return JsonVariantConst(detail::slotGetMember(this->_data, key.c_str()));
+  }
+  template <typename TIndex>
+  typename std::enable_if<std::is_integral<TIndex>::value, JsonVariantConst>::type operator[](TIndex index) const
+  {
+    return JsonVariantConst(detail::slotGetElement(this->_data, index));
+  }
+
+  bool containsKey(const char *key) const
+  {
+    return detail::slotGetMember(this->_data, key) != NULL;
+  }
+
+  const detail::VariantSlot *getData(void) const
+  {
+    return this->_data;
+  }
+
+private:
+  const detail::VariantSlot *_data;
+};
+
+class JsonPairConst
+{
+public:
+  explicit JsonPairConst(const detail::VariantSlot *slot)
+      : _slot(slot)
+  {
+  }
+  JsonString key(void) const
+  {
+    return JsonString(this->_slot->key, !(this->_slot->flags & ARDUINOJSON_KEY_IS_OWNED));
+  }
+  JsonVariantConst value(void) const
+  {
+    return JsonVariantConst(this->_slot);
+  }
+
+private:
+  const detail::VariantSlot *_slot;
+};
+
+class JsonObjectConstIterator
+{
+public:
+  explicit JsonObjectConstIterator(const detail::VariantSlot *slot)
+      : _slot(slot)
+  {
+  }
+  JsonPairConst operator*(void) const
+  {
+    return JsonPairConst(this->_slot);
+  }
+  JsonObjectConstIterator &operator++(void)
+  {
+    this->_slot = this->_slot->next;
+    return *this;
+  }
+  bool operator!=(const JsonObjectConstIterator &other) const
+  {
+    return this->_slot != other._slot;
+  }
+  bool operator==(const JsonObjectConstIterator &other) const
+  {
+    return this->_slot == other._slot;
+  }
+
+private:
+  const detail::VariantSlot *_slot;
+};
+
+class JsonArrayConstIterator
+{
+public:
+  explicit JsonArrayConstIterator(const detail::VariantSlot *slot)
+      : _slot(slot)
+  {
+  }
+  JsonVariantConst operator*(void) const
+  {
+    return JsonVariantConst(this->_slot);
+  }
+  JsonArrayConstIterator &operator++(void)
+  {
+    this->_slot = this->_slot->next;
+    return *this;
+  }
+  bool operator!=(const JsonArrayConstIterator &other) const
+  {
+    return this->_slot != other._slot;
+  }
+  bool operator==(const JsonArrayConstIterator &other) const
+  {
+    return this->_slot == other._slot;
+  }
+
+private:
+  const detail::VariantSlot *_slot;
+};
+
+/**
+ * @brief Read only view of an object, null when the value is not an object
+ */
+class JsonObjectConst
+{
+public:
+  JsonObjectConst(void)
+      : _data(NULL)
+  {
+  }
+  explicit JsonObjectConst(const detail::VariantSlot *data)
+      : _data(data != NULL && data->type() == detail::VALUE_IS_OBJECT ? data : NULL)
+  {
+  }
+
+  JsonObjectConstIterator begin(void) const
+  {
+    return JsonObjectConstIterator(this->_data != NULL ? this->_data->content.asCollection.head : NULL);
+  }
+  JsonObjectConstIterator end(void) const
+  {
+    return JsonObjectConstIterator(NULL);
+  }
+
+  JsonVariantConst operator[](const char *key) const
+  {
+    return JsonVariantConst(detail::slotGetMember(this->_data, key));
+  }
+  JsonVariantConst operator[](char *key) const
+  {
+    return JsonVariantConst(detail::slotGetMember(this->_data, key));
+  }
+  JsonVariantConst operator[](const String &key) const
+  {
+    return JsonVariantConst(detail::slotGetMember(this->_data, key.c_str()));
+  }
+  JsonVariantConst operator[](const std::string &key) const
+  {
+    return JsonVariantConst(detail::slotGetMember(this->_data, key.c_str()));
+  }
+  JsonVariantConst operator[](JsonString key) const
+  {
+    return JsonVariantConst(detail::slotGetMember(this->_data, key.c_str()));
+  }
+
+  bool containsKey(const char *key) const
+  {
+    return detail::slotGetMember(this->_data, key) != NULL;
+  }
+  bool isNull(void) const
+  {
+    return this->_data == NULL;
+  }
+  size_t size(void) const
+  {
+    return detail::slotSize(this->_data);
+  }
+  operator bool() const
+  {
+    return this->_data != NULL;
+  }
+
+  const detail::VariantSlot *getData(void) const
+  {
+    return this->_data;
+  }
+
+private:
+  const detail::VariantSlot *_data;
+};
+
+/**
+ * @brief Read only view of an array, null when the value is not an array
+ */
+class JsonArrayConst
+{
+public:
+  JsonArrayConst(void)
+      : _data(NULL)
+  {
+  }
+  explicit JsonArrayConst(const detail::VariantSlot *data)
+      : _data(data != NULL && data->type() == detail::VALUE_IS_ARRAY ? data : NULL)
+  {
+  }
+
+  JsonArrayConstIterator begin(void) const
+  {
+    return JsonArrayConstIterator(this->_data != NULL ? this->_data->content.asCollection.head : NULL);
+  }
+  JsonArrayConstIterator end(void) const
+  {
+    return JsonArrayConstIterator(NULL);
+  }
+
+  template <typename TIndex>
+  typename std::enable_if<std::is_integral<TIndex>::value, JsonVariantConst>::type operator[](TIndex index) const
+  {
+    return JsonVariantConst(detail::slotGetElement(this->_data, index));
+  }
+
+  bool isNull(void) const
+  {
+    return this->_data == NULL;
+  }
+  size_t size(void) const
+  {
+    return detail::slotSize(this->_data);
+  }
+  operator bool() const
+  {
+    return this->_data != NULL;
+  }
+
+  const detail::VariantSlot *getData(void) const
+  {
+    return this->_data;
+  }
+
+private:
+  const detail::VariantSlot *_data;
+};
+
+namespace detail
+{
+/**
+ * @brief The writable side shared by variants and proxies
+ * TDerived provides getData(), getOrAddData() and getPool().
+ */
+template <typename TDerived>
+class VariantOperations
+{
+public:
+  template <typename T>
+  T as(void) const
+  {
+    return RefConverter<T>::read(this->derived().getData(), this->derived().getPool());
+  }
+
+  template <typename T>
+  bool is(void) const
+  {
+    return Converter<T>::is(this->derived().getData());
+  }
+
+  template <typename T>
+  operator T() const
+  {
+    return this->as<T>();
+  }
+
+  template <typename T>
+  bool set(const T &value) const
+  {
+    VariantSlot *slot = this->derived().getOrAddData();
+    if (slot == NULL)
+      return false;
+    return setValue(slot, this->derived().getPool(), value);
+  }
+
+  template <typename T>
+  bool set(T *value) const
+  {
+    VariantSlot *slot = this->derived().getOrAddData();
+    if (slot == NULL)
+      return false;
+    return setValue(slot, this->derived().getPool(), value);
+  }
+
+  bool isNull(void) const
+  {
+    const VariantSlot *slot = this->derived().getData();
+    return slot == NULL || slot->type() == VALUE_IS_NULL;
+  }
+
+  size_t size(void) const
+  {
+    return slotSize(this->derived().getData());
+  }
+
+  bool containsKey(const char *key) const
+  {
+    return slotGetMember(this->derived().getData(), key) != NULL;
+  }
+
+  template <typename TKey>
+  MemberProxy<TDerived> operator[](const TKey &key) const
+  {
+    return MemberProxy<TDerived>(this->derived(), makeStringRef(key));
+  }
+
+  template <typename TKey>
+  MemberProxy<TDerived> operator[](TKey *key) const
+  {
+    return MemberProxy<TDerived>(this->derived(), makeStringRef(key));
+  }
+
+  MemberProxy<TDerived> operator[](JsonString key) const
+  {
+    return MemberProxy<TDerived>(this->derived(), makeStringRef(key));
+  }
+
+  ElementProxy<TDerived> operator[](int index) const
+  {
+    return ElementProxy<TDerived>(this->derived(), index);
+  }
+
+  ElementProxy<TDerived> operator[](unsigned int index) const
+  {
+    return ElementProxy<TDerived>(this->derived(), index);
+  }
+
+  ElementProxy<TDerived> operator[](unsigned long index) const
+  {
+    return ElementProxy<TDerived>(this->derived(), index);
+  }
+
+  ElementProxy<TDerived> operator[](long index) const
+  {
+    return ElementProxy<TDerived>(this->derived(), index);
+  }
+
+  JsonArray createNestedArray(void) const;
+  JsonObject createNestedObject(void) const;
+  template <typename TKey>
+  JsonArray createNestedArray(const TKey &key) const;
+  template <typename TKey>
+  JsonObject createNestedObject(const TKey &key) const;
+  template <typename TKey>
+  JsonArray createNestedArray(TKey *key) const;
+  template <typename TKey>
+  JsonObject createNestedObject(TKey *key) const;
+
+  JsonVariant add(void) const;
+  template <typename T>
+  bool add(const T &value) const;
+  template <typename T>
+  bool add(T *value) const;
+
+private:
+  const TDerived &derived(void) const
+  {
+    return static_cast<const TDerived &>(*this);
+  }
+};
+} // namespace detail
+
+/**
+ * @brief Writable reference to a value in a document
+ */
+class JsonVariant : public detail::VariantOperations<JsonVariant>
+{
+public:
+  JsonVariant(void)
+      : _data(NULL),
+        _pool(NULL)
+  {
+  }
+  JsonVariant(detail::VariantSlot *data, detail::MemoryPool *pool)
+      : _data(data),
+        _pool(pool)
+  {
+  }
+
+  operator JsonVariantConst() const
+  {
+    return JsonVariantConst(this->_data);
+  }
+
+  detail::VariantSlot *getData(void) const
+  {
+    return this->_data;
+  }
+  detail::VariantSlot *getOrAddData(void) const
+  {
+    return this->_data;
+  }
+  detail::MemoryPool *getPool(void) const
+  {
+    return this->_pool;
+  }
+
+private:
+  detail::VariantSlot *_data;
+  detail::MemoryPool *_pool;
+};
+
+class JsonPair
+{
+public:
+  JsonPair(detail::VariantSlot *slot, detail::MemoryPool *pool)
+      : _slot(slot),
+        _pool(pool)
+  {
+  }
+  JsonString key(void) const
+  {
+    return JsonString(this->_slot->key, !(this->_slot->flags & ARDUINOJSON_KEY_IS_OWNED));
+  }
+  JsonVariant value(void) const
+  {
+    return JsonVariant(this->_slot, this->_pool);
+  }
+
+private:
+  detail::VariantSlot *_slot;
+  detail::MemoryPool *_pool;
+};
+
+class JsonObjectIterator
+{
+public:
+  JsonObjectIterator(detail::VariantSlot *slot, detail::MemoryPool *pool)
+      : _slot(slot),
+        _pool(pool)
+  {
+  }
+  JsonPair operator*(void) const
+  {
+    return JsonPair(this->_slot, this->_pool);
+  }
+  JsonObjectIterator &operator++(void)
+  {
+    this->_slot = this->_slot->next;
+    return *this;
+  }
+  bool operator!=(const JsonObjectIterator &other) const
+  {
+    return this->_slot != other._slot;
+  }
+  bool operator==(const JsonObjectIterator &other) const
+  {
+    return this->_slot == other._slot;
+  }
+
+private:
+  detail::VariantSlot *_slot;
+  detail::MemoryPool *_pool;
+};
+
+class JsonArrayIterator
+{
+public:
+  JsonArrayIterator(detail::VariantSlot *slot, detail::MemoryPool *pool)
+      : _slot(slot),
+        _pool(pool)
+  {
+  }
+  JsonVariant operator*(void) const
+  {
+    return JsonVariant(this->_slot, this->_pool);
+  }
+  JsonArrayIterator &operator++(void)
+  {
+    this->_slot = this->_slot->next;
+    return *this;
+  }
+  bool operator!=(const JsonArrayIterator &other) const
+  {
+    return this->_slot != other._slot;
+  }
+  bool operator==(const JsonArrayIterator &other) const
+  {
+    return this->_slot == other._slot;
+  }
+
+private:
+  detail::VariantSlot *_slot;
+  detail::MemoryPool *_pool;
+};
+
+/**
+ * @brief Writable reference to an object, null when the value is not an object
+ */
+class JsonObject
+{
+public:
+  JsonObject(void)
+      : _data(NULL),
+        _pool(NULL)
+  {
+  }
+  JsonObject(detail::VariantSlot *data, detail::MemoryPool *pool)
+      : _data(data != NULL && data->type() == detail::VALUE_IS_OBJECT ? data : NULL),
+        _pool(pool)
+  {
+  }
+
+  operator JsonObjectConst() const
+  {
+    return JsonObjectConst(this->_data);
+  }
+  operator JsonVariant() const
+  {
+    return JsonVariant(this->_data, this->_pool);
+  }
+  operator JsonVariantConst() const
+  {
+    return JsonVariantConst(this->_data);
+  }
+
+  JsonObjectIterator begin(void) const
+  {
+    return JsonObjectIterator(this->_data != NULL ? this->_data->content.asCollection.head : NULL, this->_pool);
+  }
+  JsonObjectIterator end(void) const
+  {
+    return JsonObjectIterator(NULL, this->_pool);
+  }
+
+  template <typename TKey>
+  detail::MemberProxy<JsonObject> operator[](const TKey &key) const;
+  template <typename TKey>
+  detail::MemberProxy<JsonObject> operator[](TKey *key) const;
+  detail::MemberProxy<JsonObject> operator[](JsonString key) const;
+
+  template <typename TKey>
+  JsonArray createNestedArray(const TKey &key) const;
+  template <typename TKey>
+  JsonArray createNestedArray(TKey *key) const;
+  template <typename TKey>
+  JsonObject createNestedObject(const TKey &key) const;
+  template <typename TKey>
+  JsonObject createNestedObject(TKey *key) const;
+
+  void remove(const char *key) const
+  {
+    detail::slotRemoveMember(this->_data, key);
+  }
+  void remove(const String &key) const
+  {
+    detail::slotRemoveMember(this->_data, key.c_str());
+  }
+  bool containsKey(const char *key) const
+  {
+    return detail::slotGetMember(this->_data, key) != NULL;
+  }
+  bool containsKey(const String &key) const
+  {
+    return detail::slotGetMember(this->_data, key.c_str()) != NULL;
+  }
+  void clear(void) const
+  {
+    if (this->_data != NULL)
+      this->_data->content.asCollection = {NULL, NULL};
+  }
+  bool set(JsonObjectConst src) const
+  {
+    if (this->_data == NULL || src.isNull())
+      return false;
+    this->clear();
+    for (JsonPairConst pair : src)
+    {
+      detail::VariantSlot *member = detail::slotAddMember(this->_data, detail::makeStringRef(pair.key()), this->_pool);
+      if (member == NULL || !detail::slotCopy(member, pair.value().getData(), this->_pool))
+        return false;
+    }
+    return true;
+  }
+
+  bool isNull(void) const
+  {
+    return this->_data == NULL;
+  }
+  size_t size(void) const
+  {
+    return detail::slotSize(this->_data);
+  }
+  operator bool() const
+  {
+    return this->_data != NULL;
+  }
+
+  detail::VariantSlot *getData(void) const
+  {
+    return this->_data;
+  }
+  detail::VariantSlot *getOrAddData(void) const
+  {
+    return this->_data;
+  }
+  detail::MemoryPool *getPool(void) const
+  {
+    return this->_pool;
+  }
+
+private:
+  detail::VariantSlot *_data;
+  detail::MemoryPool *_pool;
+};
+
+/**
+ * @brief Writable reference to an array, null when the value is not an array
+ */
+class JsonArray
+{
+public:
+  JsonArray(void)
+      : _data(NULL),
+        _pool(NULL)
+  {
+  }
+  JsonArray(detail::VariantSlot *data, detail::MemoryPool *pool)
+      : _data(data != NULL && data->type() == detail::VALUE_IS_ARRAY ? data : NULL),
+        _pool(pool)
+  {
+  }
+
+  operator JsonArrayConst() const
+  {
+    return JsonArrayConst(this->_data);
+  }
+  operator JsonVariant() const
+  {
+    return JsonVariant(this->_data, this->_pool);
+  }
+  operator JsonVariantConst() const
+  {
+    return JsonVariantConst(this->_data);
+  }
+
+  JsonArrayIterator begin(void) const
+  {
+    return JsonArrayIterator(this->_data != NULL ? this->_data->content.asCollection.head : NULL, this->_pool);
+  }
+  JsonArrayIterator end(void) const
+  {
+    return JsonArrayIterator(NULL, this->_pool);
+  }
+
+  template <typename TIndex>
+  typename std::enable_if<std::is_integral<TIndex>::value, detail::ElementProxy<JsonArray>>::type operator[](TIndex index) const
+  {
+    return detail::ElementProxy<JsonArray>(*this, index);
+  }
+
+  JsonVariant add(void) const
+  {
+    return JsonVariant(detail::slotAddElement(this->_data, this->_pool), this->_pool);
+  }
+  template <typename T>
+  bool add(const T &value) const
+  {
+    detail::VariantSlot *slot = detail::slotAddElement(this->_data, this->_pool);
+    return slot != NULL && detail::setValue(slot, this->_pool, value);
+  }
+  template <typename T>
+  bool add(T *value) const
+  {
+    detail::VariantSlot *slot = detail::slotAddElement(this->_data, this->_pool);
+    return slot != NULL && detail::setValue(slot, this->_pool, value);
+  }
+
+  JsonArray createNestedArray(void) const
+  {
+    return JsonArray(detail::slotToArray(detail::slotAddElement(this->_data, this->_pool)), this->_pool);
+  }
+  JsonObject createNestedObject(void) const
+  {
+    return JsonObject(detail::slotToObject(detail::slotAddElement(this->_data, this->_pool)), this->_pool);
+  }
+
+  void clear(void) const
+  {
+    if (this->_data != NULL)
+      this->_data->content.asCollection = {NULL, NULL};
+  }
+
+  bool isNull(void) const
+  {
+    return this->_data == NULL;
+  }
+  size_t size(void) const
+  {
+    return detail::slotSize(this->_data);
+  }
+  operator bool() const
+  {
+    return this->_data != NULL;
+  }
+
+  detail::VariantSlot *getData(void) const
+  {
+    return this->_data;
+  }
+  detail::VariantSlot *getOrAddData(void) const
+  {
+    return this->_data;
+  }
+  detail::MemoryPool *getPool(void) const
+  {
+    return this->_pool;
+  }
+
+private:
+  detail::VariantSlot *_data;
+  detail::MemoryPool *_pool;
+};
+
+namespace detail
+{
+/**
+ * @brief obj[key], resolved when read or written
+ */
+template <typename TUpstream>
+class MemberProxy : public VariantOperations<MemberProxy<TUpstream>>
+{
+public:
+  MemberProxy(const TUpstream &upstream, StringRef key)
+      : _upstream(upstream),
+        _key(key)
+  {
+  }
+
+  MemberProxy(const MemberProxy &) = default;
+
+  MemberProxy &operator=(const MemberProxy &src)
+  {
+    this->set(src);
+    return *this;
+  }
+  template <typename T>
+  MemberProxy &operator=(const T &value)
+  {
+    this->set(value);
+    return *this;
+  }
+  template <typename T>
+  MemberProxy &operator=(T *value)
+  {
+    this->set(value);
+    return *this;
+  }
+
+  VariantSlot *getData(void) const
+  {
+    return slotGetMember(this->_upstream.getData(), this->_key.str);
+  }
+  VariantSlot *getOrAddData(void) const
+  {
+    return slotGetOrAddMember(this->_upstream.getOrAddData(), this->_key, this->_upstream.getPool());
+  }
+  MemoryPool *getPool(void) const
+  {
+    return this->_upstream.getPool();
+  }
+
+private:
+  TUpstream _upstream;
+  StringRef _key;
+};
+
+/**
+ * @brief array[index], resolved when read or written
+ */
+template <typename TUpstream>
+class ElementProxy : public VariantOperations<ElementProxy<TUpstream>>
+{
+public:
+  ElementProxy(const TUpstream &upstream, size_t index)
+      : _upstream(upstream),
+        _index(index)
+  {
+  }
+
+  ElementProxy(const ElementProxy &) = default;
+
+  ElementProxy &operator=(const ElementProxy &src)
+  {
+    this->set(src);
+    return *this;
+  }
+  template <typename T>
+  ElementProxy &operator=(const T &value)
+  {
+    this->set(value);
+    return *this;
+  }
+  template <typename T>
+  ElementProxy &operator=(T *value)
+  {
+    this->set(value);
+    return *this;
+  }
+
+  VariantSlot *getData(void) const
+  {
+    return slotGetElement(this->_upstream.getData(), this->_index);
+  }
+  VariantSlot *getOrAddData(void) const
+  {
+    return slotGetOrAddElement(this->_upstream.getOrAddData(), this->_index, this->_upstream.getPool());
+  }
+  MemoryPool *getPool(void) const
+  {
+    return this->_upstream.getPool();
+  }
+
+private:
+  TUpstream _upstream;
+  size_t _index;
+};
+
+class DocumentRef
+{
+public:
+  DocumentRef(VariantSlot *root, MemoryPool *pool)
+      : _root(root),
+        _pool(pool)
+  {
+  }
+  VariantSlot *getData(void) const
+  {
+    return this->_root;
+  }
+  VariantSlot *getOrAddData(void) const
+  {
+    return this->_root;
+  }
+  MemoryPool *getPool(void) const
+  {
+    return this->_pool;
+  }
+
+private:
+  VariantSlot *_root;
+  MemoryPool *_pool;
+};
+
+template <typename TDerived>
+JsonArray VariantOperations<TDerived>::createNestedArray(void) const
+{
+  VariantSlot *slot = this->derived().getOrAddData();
+  if (slot != NULL && slot->type() == VALUE_IS_NULL)
+    slotToArray(slot);
+  return JsonArray(slotToArray(slotAddElement(slot, this->derived().getPool())), this->derived().getPool());
+}
+
+template <typename TDerived>
+JsonObject VariantOperations<TDerived>::createNestedObject(void) const
+{
+  VariantSlot *slot = this->derived().getOrAddData();
+  if (slot != NULL && slot->type() == VALUE_IS_NULL)
+    slotToArray(slot);
+  return JsonObject(slotToObject(slotAddElement(slot, this->derived().getPool())), this->derived().getPool());
+}
+
+template <typename TDerived>
+template <typename TKey>
+JsonArray VariantOperations<TDerived>::createNestedArray(const TKey &key) const
+{
+  return JsonArray(slotToArray(slotGetOrAddMember(this->derived().getOrAddData(), makeStringRef(key), this->derived().getPool())), this->derived().getPool());
+}
+
+template <typename TDerived>
+template <typename TKey>
+JsonObject VariantOperations<TDerived>::createNestedObject(const TKey &key) const
+{
+  return JsonObject(slotToObject(slotGetOrAddMember(this->derived().getOrAddData(), makeStringRef(key), this->derived().getPool())), this->derived().getPool());
+}
+
+template <typename TDerived>
+template <typename TKey>
+JsonArray VariantOperations<TDerived>::createNestedArray(TKey *key) const
+{
+  return JsonArray(slotToArray(slotGetOrAddMember(this->derived().getOrAddData(), makeStringRef(key), this->derived().getPool())), this->derived().getPool());
+}
+
+template <typename TDerived>
+template <typename TKey>
+JsonObject VariantOperations<TDerived>::createNestedObject(TKey *key) const
+{
+  return JsonObject(slotToObject(slotGetOrAddMember(this->derived().getOrAddData(), makeStringRef(key), this->derived().getPool())), this->derived().getPool());
+}
+
+template <typename TDerived>
+JsonVariant VariantOperations<TDerived>::add(void) const
+{
+  VariantSlot *slot = this->derived().getOrAddData();
+  if (slot != NULL && slot->type() == VALUE_IS_NULL)
+    slotToArray(slot);
+  return JsonVariant(slotAddElement(slot, this->derived().getPool()), this->derived().getPool());
+}
+
+template <typename TDerived>
+template <typename T>
+bool VariantOperations<TDerived>::add(const T &value) const
+{
+  return this->add().set(value);
+}
+
+template <typename TDerived>
+template <typename T>
+bool VariantOperations<TDerived>::add(T *value) const
+{
+  return this->add().set(value);
+}
+} // namespace detail
+
+template <typename TKey>
+detail::MemberProxy<JsonObject> JsonObject::operator[](const TKey &key) const
+{
+  return detail::MemberProxy<JsonObject>(*this, detail::makeStringRef(key));
+}
+
+template <typename TKey>
+detail::MemberProxy<JsonObject> JsonObject::operator[](TKey *key) const
+{
+  return detail::MemberProxy<JsonObject>(*this, detail::makeStringRef(key));
+}
+
+inline detail::MemberProxy<JsonObject> JsonObject::operator[](JsonString key) const
+{
+  return detail::MemberProxy<JsonObject>(*this, detail::makeStringRef(key));
+}
+
+template <typename TKey>
+JsonArray JsonObject::createNestedArray(const TKey &key) const
+{
+  return JsonArray(detail::slotToArray(detail::slotGetOrAddMember(this->_data, detail::makeStringRef(key), this->_pool)), this->_pool);
+}
+
+template <typename TKey>
+JsonArray JsonObject::createNestedArray(TKey *key) const
+{
+  return JsonArray(detail::slotToArray(detail::slotGetOrAddMember(this->_data, detail::makeStringRef(key), this->_pool)), this->_pool);
+}
+
+template <typename TKey>
+JsonObject JsonObject::createNestedObject(const TKey &key) const
+{
+  return JsonObject(detail::slotToObject(detail::slotGetOrAddMember(this->_data, detail::makeStringRef(key), this->_pool)), this->_pool);
+}
+
+template <typename TKey>
+JsonObject JsonObject::createNestedObject(TKey *key) const
+{
+  return JsonObject(detail::slotToObject(detail::slotGetOrAddMember(this->_data, detail::makeStringRef(key), this->_pool)), this->_pool);
+}
+
+/**
+ * @brief Owns the memory pool and the root value
+ */
+class JsonDocument : public detail::VariantOperations<JsonDocument>
+{
+public:
+  JsonDocument(const JsonDocument &) = delete;
+  JsonDocument &operator=(const JsonDocument &) = delete;
+
+  template <typename T>
+  T to(void)
+  {
+    this->clear();
+    return detail::ToConverter<T>::to(&this->_root, &this->_pool);
+  }
+
+  template <typename T>
+  T as(void)
+  {
+    return detail::RefConverter<T>::read(&this->_root, &this->_pool);
+  }
+
+  template <typename T>
+  T as(void) const
+  {
+    return detail::Converter<T>::read(&this->_root);
+  }
+
+  void clear(void)
+  {
+    this->_pool.clear();
+    detail::slotSetNull(&this->_root);
+  }
+
+  size_t capacity(void) const
+  {
+    return this->_pool.capacity();
+  }
+
+  size_t memoryUsage(void) const
+  {
+    return this->_pool.size();
+  }
+
+  bool set(const JsonDocument &src)
+  {
+    this->clear();
+    return detail::slotCopy(&this->_root, &src._root, &this->_pool);
+  }
+
+  template <typename T>
+  bool set(const T &src)
+  {
+    return detail::VariantOperations<JsonDocument>::set(src);
+  }
+
+  template <typename TKey>
+  detail::MemberProxy<detail::DocumentRef> operator[](const TKey &key)
+  {
+    return detail::MemberProxy<detail::DocumentRef>(this->getRef(), detail::makeStringRef(key));
+  }
+  template <typename TKey>
+  detail::MemberProxy<detail::DocumentRef> operator[](TKey *key)
+  {
+    return detail::MemberProxy<detail::DocumentRef>(this->getRef(), detail::makeStringRef(key));
+  }
+  detail::MemberProxy<detail::DocumentRef> operator[](JsonString key)
+  {
+    return detail::MemberProxy<detail::DocumentRef>(this->getRef(), detail::makeStringRef(key));
+  }
+  template <typename TIndex>
+  typename std::enable_if<std::is_integral<TIndex>::value, detail::ElementProxy<detail::DocumentRef>>::type operator[](TIndex index)
+  {
+    return detail::ElementProxy<detail::DocumentRef>(this->getRef(), index);
+  }
+
+  JsonVariantConst operator[](const char *key) const
+  {
+    return JsonVariantConst(detail::slotGetMember(&this->_root, key));
+  }
+  JsonVariantConst operator[](const String &key) const
+  {
+    return JsonVariantConst(detail::slotGetMember(&this->_root, key.c_str()));
+  }
+
+  template <typename TKey>
+  JsonArray createNestedArray(const TKey &key)
+  {
+    return detail::VariantOperations<JsonDocument>::createNestedArray(key);
+  }
+  template <typename TKey>
+  JsonArray createNestedArray(TKey *key)
+  {
+    return detail::VariantOperations<JsonDocument>::createNestedArray(key);
+  }
+  template <typename TKey>
+  JsonObject createNestedObject(const TKey &key)
+  {
+    return detail::VariantOperations<JsonDocument>::createNestedObject(key);
+  }
+  template <typename TKey>
+  JsonObject createNestedObject(TKey *key)
+  {
+    return detail::VariantOperations<JsonDocument>::createNestedObject(key);
+  }
+  JsonArray createNestedArray(void)
+  {
+    return detail::VariantOperations<JsonDocument>::createNestedArray();
+  }
+  JsonObject createNestedObject(void)
+  {
+    return detail::VariantOperations<JsonDocument>::createNestedObject();
+  }
+
+  JsonVariant getVariant(void)
+  {
+    return JsonVariant(&this->_root, &this->_pool);
+  }
+
+  operator JsonVariant()
+  {
+    return this->getVariant();
+  }
+
+  operator JsonVariantConst() const
+  {
+    return JsonVariantConst(&this->_root);
+  }
+
+  detail::VariantSlot *getData(void) const
+  {
+    return const_cast<detail::VariantSlot *>(&this->_root);
+  }
+  detail::VariantSlot *getOrAddData(void) const
+  {
+    return const_cast<detail::VariantSlot *>(&this->_root);
+  }
+  detail::MemoryPool *getPool(void) const
+  {
+    return const_cast<detail::MemoryPool *>(&this->_pool);
+  }
+
+protected:
+  JsonDocument(char *buffer, size_t capacity)
+      : _pool(buffer, capacity)
+  {
+    memset(&this->_root, 0, sizeof(this->_root));
+  }
+
+  detail::DocumentRef getRef(void)
+  {
+    return detail::DocumentRef(&this->_root, &this->_pool);
+  }
+
+  detail::MemoryPool _pool;
+  detail::VariantSlot _root;
+};
+
+/**
+ * @brief Document with its pool on the heap, one block sized at construction
+ */
+class DynamicJsonDocument : public JsonDocument
+{
+public:
+  explicit DynamicJsonDocument(size_t capacity);
+  DynamicJsonDocument(const DynamicJsonDocument &src);
+  DynamicJsonDocument(DynamicJsonDocument &&src);
+  DynamicJsonDocument(const JsonDocument &src);
+  ~DynamicJsonDocument(void);
+
+  DynamicJsonDocument &operator=(const DynamicJsonDocument &src);
+  DynamicJsonDocument &operator=(DynamicJsonDocument &&src);
+
+  template <typename T>
+  DynamicJsonDocument &operator=(const T &src)
+  {
+    this->set(src);
+    return *this;
+  }
+
+private:
+  static size_t addPadding(size_t capacity)
+  {
+    return (capacity + ARDUINOJSON_ALIGNMENT - 1) & ~(size_t)(ARDUINOJSON_ALIGNMENT - 1);
+  }
+  void reallocPool(size_t capacity);
+};
+
+/**
+ * @brief Document with its pool inside the object
+ */
+template <size_t Capacity>
+class StaticJsonDocument : public JsonDocument
+{
+public:
+  StaticJsonDocument(void)
+      : JsonDocument(this->_buffer, Capacity)
+  {
+  }
+  StaticJsonDocument(const StaticJsonDocument &src)
+      : StaticJsonDocument()
+  {
+    this->set(src);
+  }
+  StaticJsonDocument &operator=(const StaticJsonDocument &src)
+  {
+    this->set(src);
+    return *this;
+  }
+  template <typename T>
+  StaticJsonDocument &operator=(const T &src)
+  {
+    this->set(src);
+    return *this;
+  }
+
+private:
+  alignas(8) char _buffer[(Capacity / ARDUINOJSON_SLOT_SIZE + 1) * sizeof(detail::VariantSlot) + Capacity];
+};
+
+namespace detail
+{
+// Reading a value: what each type converts from
+template <>
+struct Converter<bool>
+{
+  static bool read(const VariantSlot *slot)
+  {
+    return slotAsBoolean(slot);
+  }
+  static bool is(const VariantSlot *slot)
+  {
+    return slot != NULL && slot->type() == VALUE_IS_BOOLEAN;
+  }
+};
+
+template <typename T>
+struct Converter<T, typename std::enable_if<IsIntegral<T>::value>::type>
+{
+  static T read(const VariantSlot *slot)
+  {
+    if (std::is_unsigned<T>::value)
+      return (T)slotAsUnsigned(slot);
+    return (T)slotAsInteger(slot);
+  }
+  static bool is(const VariantSlot *slot)
+  {
+    return slot != NULL && slot->type() == VALUE_IS_INTEGER;
+  }
+};
+
+template <typename T>
+struct Converter<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+  static T read(const VariantSlot *slot)
+  {
+    return (T)slotAsFloat(slot);
+  }
+  static bool is(const VariantSlot *slot)
+  {
+    return slot != NULL && (slot->type() == VALUE_IS_FLOAT || slot->type() == VALUE_IS_INTEGER);
+  }
+};
+
+template <>
+struct Converter<const char *>
+{
+  static const char *read(const VariantSlot *slot)
+  {
+    return slotAsString(slot);
+  }
+  static bool is(const VariantSlot *slot)
+  {
+    return slotAsString(slot) != NULL;
+  }
+};
+
+template <>
+struct Converter<char *> : Converter<const char *>
+{
+};
+
+template <>
+struct Converter<JsonString>
+{
+  static JsonString read(const VariantSlot *slot)
+  {
+    return JsonString(slotAsString(slot), slot != NULL && slot->type() == VALUE_IS_LINKED_STRING);
+  }
+  static bool is(const VariantSlot *slot)
+  {
+    return slotAsString(slot) != NULL;
+  }
+};
+
+template <>
+struct Converter<String>
+{
+  static String read(const VariantSlot *slot)
+  {
+    const char *text = slotAsString(slot);
+    if (text != NULL)
+      return String(text);
+    String serialized;
+    serializeToString(slot, serialized);
+    return serialized;
+  }
+  static bool is(const VariantSlot *slot)
+  {
+    return slotAsString(slot) != NULL;
+  }
+};
+
+template <>
+struct Converter<std::string>
+{
+  static std::string read(const VariantSlot *slot)
+  {
+    String text = Converter<String>::read(slot);
+    return std::string(text.c_str(), text.length());
+  }
+  static bool is(const VariantSlot *slot)
+  {
+    return slotAsString(slot) != NULL;
+  }
+};
+
+template <>
+struct Converter<JsonVariantConst>
+{
+  static JsonVariantConst read(const VariantSlot *slot)
+  {
+    return JsonVariantConst(slot);
+  }
+  static bool is(const VariantSlot *slot)
+  {
+    return true;
+  }
+};
+
+template <>
+struct Converter<JsonObjectConst>
+{
+  static JsonObjectConst read(const VariantSlot *slot)
+  {
+    return JsonObjectConst(slot);
+  }
+  static bool is(const VariantSlot *slot)
+  {
+    return slot != NULL && slot->type() == VALUE_IS_OBJECT;
+  }
+};
+
+template <>
+struct Converter<JsonArrayConst>
+{
+  static JsonArrayConst read(const VariantSlot *slot)
+  {
+    return JsonArrayConst(slot);
+  }
+  static bool is(const VariantSlot *slot)
+  {
+    return slot != NULL && slot->type() == VALUE_IS_ARRAY;
+  }
+};
+
+template <>
+struct Converter<JsonObject> : Converter<JsonObjectConst>
+{
+};
+
+template <>
+struct Converter<JsonArray> : Converter<JsonArrayConst>
+{
+};
+
+template <>
+struct Converter<JsonVariant> : Converter<JsonVariantConst>
+{
+};
+
+template <>
+struct RefConverter<JsonVariant>
+{
+  static JsonVariant read(VariantSlot *slot, MemoryPool *pool)
+  {
+    return JsonVariant(slot, pool);
+  }
+};
+
+template <>
+struct RefConverter<JsonObject>
+{
+  static JsonObject read(VariantSlot *slot, MemoryPool *pool)
+  {
+    return JsonObject(slot, pool);
+  }
+};
+
+template <>
+struct RefConverter<JsonArray>
+{
+  static JsonArray read(VariantSlot *slot, MemoryPool *pool)
+  {
+    return JsonArray(slot, pool);
+  }
+};
+
+template <>
+struct ToConverter<JsonObject>
+{
+  static JsonObject to(VariantSlot *slot, MemoryPool *pool)
+  {
+    return JsonObject(slotToObject(slot), pool);
+  }
+};
+
+template <>
+struct ToConverter<JsonArray>
+{
+  static JsonArray to(VariantSlot *slot, MemoryPool *pool)
+  {
+    return JsonArray(slotToArray(slot), pool);
+  }
+};
+
+template <>
+struct ToConverter<JsonVariant>
+{
+  static JsonVariant to(VariantSlot *slot, MemoryPool *pool)
+  {
+    slotSetNull(slot);
+    return JsonVariant(slot, pool);
+  }
+};
+
+template <typename TSource>
+inline auto getSourceData(const TSource &source) -> decltype(source.getData())
+{
+  return source.getData();
+}
+} // namespace detail
+
+/**
+ * @brief Status of deserializeJson()
+ */
+class DeserializationError
+{
+public:
+  enum Code
+  {
+    Ok,
+    IncompleteInput,
+    InvalidInput,
+    NoMemory,
+    NotSupported,
+    TooDeep
+  };
+
+  DeserializationError(void)
+      : _code(Ok)
+  {
+  }
+  DeserializationError(Code code)
+      : _code(code)
+  {
+  }
+
+  friend bool operator==(const DeserializationError &lhs, const DeserializationError &rhs)
+  {
+    return lhs._code == rhs._code;
+  }
+  friend bool operator!=(const DeserializationError &lhs, const DeserializationError &rhs)
+  {
+    return lhs._code != rhs._code;
+  }
+  friend bool operator==(const DeserializationError &lhs, Code rhs)
+  {
+    return lhs._code == rhs;
+  }
+  friend bool operator==(Code lhs, const DeserializationError &rhs)
+  {
+    return lhs == rhs._code;
+  }
+  friend bool operator!=(const DeserializationError &lhs, Code rhs)
+  {
+    return lhs._code != rhs;
+  }
+  friend bool operator!=(Code lhs, const DeserializationError &rhs)
+  {
+    return lhs != rhs._code;
+  }
+
+  explicit operator bool() const
+  {
+    return this->_code != Ok;
+  }
+
+  Code code(void) const
+  {
+    return this->_code;
+  }
+
+  const char *c_str(void) const
+  {
+    switch (this->_code)
+    {
+    case Ok:
+      return "Ok";
+    case TooDeep:
+      return "TooDeep";
+    case NoMemory:
+      return "NoMemory";
+    case InvalidInput:
+      return "InvalidInput";
+    case IncompleteInput:
+      return "IncompleteInput";
+    case NotSupported:
+      return "NotSupported";
+    default:
+      return "???";
+    }
+  }
+
+private:
+  Code _code;
+};
+
+class DeserializationOption
+{
+public:
+  struct NestingLimit
+  {
+    explicit NestingLimit(uint8_t value = ARDUINOJSON_DEFAULT_NESTING_LIMIT)
+        : value(value)
+    {
+    }
+    uint8_t value;
+  };
+};
+
+namespace detail
+{
+DeserializationError deserialize(JsonDocument &doc, const char *input, size_t length, uint8_t nestingLimit);
+DeserializationError deserializeInPlace(JsonDocument &doc, char *input, uint8_t nestingLimit);
+DeserializationError deserialize(JsonDocument &doc, Stream &input, uint8_t nestingLimit);
+} // namespace detail
+
+inline DeserializationError deserializeJson(JsonDocument &doc, const String &input,
+                                            DeserializationOption::NestingLimit nestingLimit = DeserializationOption::NestingLimit())
+{
+  return detail::deserialize(doc, input.c_str(), input.length(), nestingLimit.value);
+}
+
+inline DeserializationError deserializeJson(JsonDocument &doc, const std::string &input,
+                                            DeserializationOption::NestingLimit nestingLimit = DeserializationOption::NestingLimit())
+{
+  return detail::deserialize(doc, input.c_str(), input.length(), nestingLimit.value);
+}
+
+inline DeserializationError deserializeJson(JsonDocument &doc, const char *input,
+                                            DeserializationOption::NestingLimit nestingLimit = DeserializationOption::NestingLimit())
+{
+  return detail::deserialize(doc, input, input != NULL ? strlen(input) : 0, nestingLimit.value);
+}
+
+inline DeserializationError deserializeJson(JsonDocument &doc, const char *input, size_t length,
+                                            DeserializationOption::NestingLimit nestingLimit = DeserializationOption::NestingLimit())
+{
+  return detail::deserialize(doc, input, length, nestingLimit.value);
+}
+
+/**
+ * @brief Parses in place, strings stay in the input, which must outlive the document
+ */
+inline DeserializationError deserializeJson(JsonDocument &doc, char *input,
+                                            DeserializationOption::NestingLimit nestingLimit = DeserializationOption::NestingLimit())
+{
+  return detail::deserializeInPlace(doc, input, nestingLimit.value);
+}
+
+inline DeserializationError deserializeJson(JsonDocument &doc, Stream &input,
+                                            DeserializationOption::NestingLimit nestingLimit = DeserializationOption::NestingLimit())
+{
+  return detail::deserialize(doc, input, nestingLimit.value);
+}
+
+template <typename TSource>
+size_t serializeJson(const TSource &source, String &output)
+{
+  return detail::serializeToString(detail::getSourceData(source), output);
+}
+
+template <typename TSource>
+size_t serializeJson(const TSource &source, std::string &output)
+{
+  String text;
+  size_t length = detail::serializeToString(detail::getSourceData(source), text);
+  output.append(text.c_str(), text.length());
+  return length;
+}
+
+template <typename TSource>
+size_t serializeJson(const TSource &source, char *buffer, size_t size)
+{
+  return detail::serializeToBuffer(detail::getSourceData(source), buffer, size);
+}
+
+template <typename TSource, size_t N>
+size_t serializeJson(const TSource &source, char (&buffer)[N])
+{
+  return detail::serializeToBuffer(detail::getSourceData(source), buffer, N);
+}
+
+template <typename TSource>
+size_t serializeJson(const TSource &source, Print &output)
+{
+  return detail::serializeToPrint(detail::getSourceData(source), output);
+}
+
+template <typename TSource>
+size_t measureJson(const TSource &source)
+{
+  return detail::measure(detail::getSourceData(source));
+}
+} // namespace ArduinoJson
+
+using namespace ArduinoJson;
+
+#endif
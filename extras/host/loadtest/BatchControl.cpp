@@ -0,0 +1,168 @@
+/*
+  BatchControl.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "BatchController.h"
+#include "FMDataClient.h"
+#include "LoadHarness.h"
+#include <deque>
+
+// BatchController against the mock server while its network conditions
+// change: a good link, a slow link with little bandwidth, a link that
+// fails requests and the good link again. Records arrive at a fixed rate
+// and are batched the way the network task of RecordPipeline does, which
+// needs FreeRTOS and does not build on the host: a batch is sent when it
+// is full or its oldest record waited the flush interval, back to back
+// over the kept alive connection, and its outcome is fed to the controller.
+// Exits with 1 when the batch does not shrink on the slow and the failing
+// link or does not grow again once the link recovered.
+//
+//   batch_control --port 8443 --ca extras/mock/localhost.crt
+//                 [--phase-ms 5000] [--rate 20] [--target 1000] [--max-batch 8] [--queue 32]
+
+/**
+ * @brief Network conditions of one phase
+ */
+struct BatchPhase
+{
+  const char *name;
+  const char *settings;
+};
+
+/**
+ * @brief What the controller did in one phase
+ */
+struct PhaseResult
+{
+  float meanBatch;
+  uint16_t finalBatch;
+};
+
+int main(int argc, char **argv)
+{
+  HarnessOptions options(argc, argv);
+  String hostName = options.get("host", "localhost");
+  const char *host = hostName.c_str();
+  const char *cert = options.getCACert();
+  const int port = options.getInt("port", 8443);
+  String database = options.get("database", "loadtest");
+  String layout = options.get("layout", "sensors");
+  String userName = options.get("user", "admin");
+  String password = options.get("password", "admin");
+  unsigned long phaseTime = options.getInt("phase-ms", 5000);
+  unsigned long arrivalInterval = 1000000 / max(options.getInt("rate", 20), 1L);
+  size_t queueSize = options.getInt("queue", 32);
+
+  UserCredentials credentials(database.c_str(), userName.c_str(), password.c_str());
+  FMDataClient client(credentials, host, cert, port);
+  client.setKeepAlive(true);
+  MockControl mock(host, port, cert);
+
+  BatchController controller;
+  controller.setBatchBounds(1, options.getInt("max-batch", 8));
+  controller.setLatencyTarget(options.getInt("target", 1000));
+
+  vector<RecordField> fields;
+  fields.push_back(RecordField("sensor", "gateway"));
+  fields.push_back(RecordField("temperature", 21));
+  fields.push_back(RecordField("description", "A reading queued for the next batch"));
+  size_t payloadSize = FMDataClient::generatePayload(fields.data(), fields.size()).length();
+
+  const BatchPhase phases[] = {
+      {"good", "{\"latency_ms\": 5, \"bandwidth\": 0, \"error_rate\": 0}"},
+      {"slow", "{\"latency_ms\": 150, \"bandwidth\": 4000, \"error_rate\": 0}"},
+      {"failing", "{\"latency_ms\": 5, \"bandwidth\": 0, \"error_rate\": 0.2}"},
+      {"recovered", "{\"latency_ms\": 5, \"bandwidth\": 0, \"error_rate\": 0}"},
+  };
+  const size_t phaseCount = sizeof(phases) / sizeof(phases[0]);
+  PhaseResult results[phaseCount];
+
+  if (client.logInToDatabaseSession().isEmpty())
+  {
+    Serial.printf("Could not log in to %s:%d\n", host, port);
+    return 1;
+  }
+
+  Serial.printf("%-10s %7s %7s %5s %7s %6s %6s %9s %7s %9s %10s %10s %10s\n",
+                "phase", "batches", "records", "err", "dropped", "mean", "batch", "interval",
+                "rtt ms", "B/s", "batch p99", "deliv p50", "deliv p99");
+  std::deque<unsigned long> queued;
+  for (size_t p = 0; p < phaseCount; p++)
+  {
+    if (!mock.configure(phases[p].settings))
+    {
+      Serial.println("The mock refused the settings");
+      return 1;
+    }
+    OperationStatistics batches("batch");
+    OperationStatistics delivery("delivery");
+    uint32_t dropped = 0;
+    unsigned long phaseStart = micros();
+    unsigned long nextArrival = phaseStart;
+    while (micros() - phaseStart < phaseTime * 1000)
+    {
+      unsigned long now = micros();
+      while ((long)(now - nextArrival) >= 0)
+      {
+        // Like the pipeline's default overflow policy, the newest write is dropped
+        if (queued.size() < queueSize)
+          queued.push_back(nextArrival);
+        else
+          dropped++;
+        nextArrival += arrivalInterval;
+      }
+      uint16_t batch = controller.getBatchSize();
+      if (queued.empty() ||
+          (queued.size() < batch && (now - queued.front()) / 1000 < controller.getFlushInterval()))
+      {
+        delay(1);
+        continue;
+      }
+
+      unsigned long start = micros();
+      uint16_t sent = 0;
+      uint16_t errors = 0;
+      while (sent < batch && !queued.empty())
+      {
+        ResponseStatus status;
+        boolean ok = client.createRecord(database, layout, fields.data(), fields.size(), status);
+        delivery.add(queued.front(), ok);
+        queued.pop_front();
+        if (!ok)
+          errors++;
+        sent++;
+      }
+      batches.add(start, errors == 0, sent * payloadSize);
+      controller.record(sent, errors, (micros() - start) / 1000, sent * payloadSize);
+    }
+    results[p].meanBatch = batches.count() > 0 ? (float)delivery.count() / batches.count() : 0;
+    results[p].finalBatch = controller.getBatchSize();
+    Serial.printf("%-10s %7u %7u %5d %7u %6.2f %6u %9u %7u %9u %10.2f %10.2f %10.2f\n",
+                  phases[p].name, (unsigned)batches.count(), (unsigned)delivery.count(),
+                  delivery.errors(), dropped, results[p].meanBatch, controller.getBatchSize(), controller.getFlushInterval(),
+                  controller.getRoundTrip(), controller.getThroughput(), batches.percentile(99) / 1000.0,
+                  delivery.percentile(50) / 1000.0, delivery.percentile(99) / 1000.0);
+  }
+  mock.configure("{\"latency_ms\": 0, \"bandwidth\": 0, \"error_rate\": 0}");
+  client.logOutDatabaseSession();
+
+  int failures = 0;
+  if (results[1].finalBatch >= results[0].finalBatch)
+  {
+    Serial.println("The batch did not shrink on the slow link");
+    failures++;
+  }
+  // Failures are random and so is the size a phase ends with, compare the means
+  if (results[2].meanBatch > results[0].meanBatch / 2)
+  {
+    Serial.println("The batch did not shrink while requests failed");
+    failures++;
+  }
+  if (results[3].meanBatch <= results[2].meanBatch)
+  {
+    Serial.println("The batch did not grow again after the link recovered");
+    failures++;
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,150 @@
+/*
+  HostFailover.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "HostPool.h"
+#include "LoadHarness.h"
+
+// HostPool against two mock servers, a primary and a standby, one of them
+// degraded at a time. The request counts of the mocks show where reads and
+// writes went:
+//
+//   slow primary    reads go to the fast standby, writes stay on the primary
+//   slow standby    the standby's smoothed latency rises, reads move back
+//   fast standby    the primary slows down, the idle standby's latency
+//                   decays until it gets a read, reads go to it again
+//   primary down    reads and writes fail over to the standby, the primary
+//                   leaves the rotation
+//
+// Exits with 1 when a request failed or went to the wrong host.
+//
+//   host_failover --port0 8443 --port1 8444 --ca extras/mock/localhost.crt
+//                 [--requests 40] [--idle-ms 500]
+
+/**
+ * @brief Requests a mock received in one phase
+ */
+struct HostCounts
+{
+  int finds;
+  int creates;
+};
+
+static HostCounts countRequests(MockControl &mock)
+{
+  HostCounts counts = {0, 0};
+  DynamicJsonDocument stats(4096);
+  if (mock.stats(stats))
+  {
+    counts.finds = stats["operations"]["performFind"]["requests"].as<int>();
+    counts.creates = stats["operations"]["createRecord"]["requests"].as<int>();
+  }
+  return counts;
+}
+
+int main(int argc, char **argv)
+{
+  HarnessOptions options(argc, argv);
+  String hostName = options.get("host", "localhost");
+  const char *host = hostName.c_str();
+  const char *cert = options.getCACert();
+  const int ports[] = {(int)options.getInt("port0", 8443), (int)options.getInt("port1", 8444)};
+  String database = options.get("database", "loadtest");
+  String layout = options.get("layout", "sensors");
+  String userName = options.get("user", "admin");
+  String password = options.get("password", "admin");
+  int requests = options.getInt("requests", 40);
+
+  UserCredentials credentials(database.c_str(), userName.c_str(), password.c_str());
+  HostPool pool(credentials);
+  pool.setIdleTime(options.getInt("idle-ms", 500));
+  pool.addHost(host, cert, ports[0]);
+  pool.addHost(host, cert, ports[1]);
+  MockControl mocks[] = {MockControl(host, ports[0], cert), MockControl(host, ports[1], cert)};
+  mocks[0].configure("{\"latency_ms\": 80}");
+  mocks[1].configure("{\"latency_ms\": 5}");
+  if (!pool.begin())
+  {
+    Serial.printf("Could not log in to %s:%d or %s:%d\n", host, ports[0], host, ports[1]);
+    return 1;
+  }
+
+  vector<RecordField> fields;
+  fields.push_back(RecordField("sensor", "gateway"));
+  fields.push_back(RecordField("temperature", 21));
+  // Both hosts hold the record the reads find
+  for (uint8_t i = 0; i < pool.getHostCount(); i++)
+  {
+    ResponseStatus status;
+    pool.getClient(i).createRecord(database, layout, fields.data(), fields.size(), status);
+  }
+  RecordFindCriteria sensor("sensor", "==gateway");
+  vector<RecordFindCriteria *> records{&sensor};
+  FindCriteria find(records);
+  vector<FindCriteria *> findCriterias{&find};
+
+  struct
+  {
+    const char *name;
+    const char *primary;
+    const char *standby;
+  } phases[] = {
+      {"slow primary", "{\"latency_ms\": 80}", "{\"latency_ms\": 5}"},
+      {"slow standby", "{\"latency_ms\": 5}", "{\"latency_ms\": 150}"},
+      {"fast standby", "{\"latency_ms\": 40}", "{\"latency_ms\": 5}"},
+      {"primary down", "{\"latency_ms\": 5, \"down_ms\": 6000}", "{\"latency_ms\": 40}"},
+  };
+  const size_t phaseCount = sizeof(phases) / sizeof(phases[0]);
+  HostCounts counts[phaseCount][2];
+  int errors = 0;
+
+  Serial.printf("%-14s %5s %12s %12s %12s %12s %10s %10s %8s\n", "phase", "err",
+                "finds 0", "finds 1", "creates 0", "creates 1", "ewma 0 ms", "ewma 1 ms", "healthy");
+  for (size_t p = 0; p < phaseCount; p++)
+  {
+    mocks[0].resetStatistics();
+    mocks[1].resetStatistics();
+    mocks[1].configure(phases[p].standby);
+    // Last, a mock that is down does not answer its admin endpoints either
+    mocks[0].configure(phases[p].primary);
+
+    int failed = 0;
+    for (int i = 0; i < requests; i++)
+    {
+      DynamicJsonDocument response(2048);
+      if (!pool.performFind(database, layout, findCriterias, response, 1))
+        failed++;
+      ResponseStatus status;
+      if (!pool.createRecord(database, layout, fields.data(), fields.size(), status))
+        failed++;
+    }
+    // Wait for the end of the outage to read the counts
+    unsigned long waitStart = millis();
+    while (mocks[0].stats().isEmpty() && millis() - waitStart < 10000)
+      delay(100);
+    for (int m = 0; m < 2; m++)
+      counts[p][m] = countRequests(mocks[m]);
+    errors += failed;
+
+    Serial.printf("%-14s %5d %12d %12d %12d %12d %10u %10u %5d/%-2d\n", phases[p].name, failed,
+                  counts[p][0].finds, counts[p][1].finds, counts[p][0].creates, counts[p][1].creates,
+                  pool.getLatency(0), pool.getLatency(1), pool.isHealthy(0), pool.isHealthy(1));
+  }
+
+  auto check = [&errors](boolean condition, const char *message) {
+    if (!condition)
+    {
+      Serial.println(message);
+      errors++;
+    }
+  };
+  check(counts[0][1].finds >= requests * 9 / 10, "Reads did not go to the fast standby");
+  check(counts[0][0].creates == requests, "Writes did not stay on the healthy primary");
+  check(counts[1][0].finds >= requests / 2, "Reads did not move back to the primary");
+  check(counts[2][1].finds >= requests / 2, "Reads did not return to the idle standby");
+  check(counts[3][1].creates == requests, "Writes did not fail over to the standby");
+  check(counts[3][1].finds == requests, "Reads did not fail over to the standby");
+  check(!pool.isHealthy(0), "The primary is still in rotation");
+  return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+/*
+  LoadHarness.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "LoadHarness.h"
+#include <HTTPClient.h>
+#include <WiFiClientSecure.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+HarnessOptions::HarnessOptions(int argc, char **argv)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    if (strncmp(argv[i], "--", 2) != 0)
+      continue;
+    std::string name(argv[i] + 2);
+    if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0)
+      this->_values[name] = argv[++i];
+    else
+      this->_values[name] = "1";
+  }
+}
+
+String HarnessOptions::get(const char *name, const char *fallback) const
+{
+  auto value = this->_values.find(name);
+  return String(value != this->_values.end() ? value->second.c_str() : fallback);
+}
+
+long HarnessOptions::getInt(const char *name, long fallback) const
+{
+  auto value = this->_values.find(name);
+  return value != this->_values.end() ? atol(value->second.c_str()) : fallback;
+}
+
+float HarnessOptions::getFloat(const char *name, float fallback) const
+{
+  auto value = this->_values.find(name);
+  return value != this->_values.end() ? atof(value->second.c_str()) : fallback;
+}
+
+boolean HarnessOptions::has(const char *name) const
+{
+  return this->_values.find(name) != this->_values.end();
+}
+
+const char *HarnessOptions::getCACert(void)
+{
+  if (this->_caCert.isEmpty() && this->has("ca"))
+  {
+    std::ifstream file(this->get("ca", "").c_str());
+    std::stringstream contents;
+    contents << file.rdbuf();
+    this->_caCert = contents.str().c_str();
+  }
+  return this->_caCert.c_str();
+}
+
+OperationStatistics::OperationStatistics(const char *name)
+    : _name(name),
+      _errors(0),
+      _bytes(0)
+{
+}
+
+void OperationStatistics::add(unsigned long start, boolean ok, size_t bytes)
+{
+  unsigned long elapsed = micros() - start;
+  std::lock_guard<std::mutex> lock(this->_lock);
+  this->_samples.push_back(elapsed);
+  if (!ok)
+    this->_errors++;
+  this->_bytes += bytes;
+}
+
+unsigned long OperationStatistics::percentile(int p) const
+{
+  std::lock_guard<std::mutex> lock(this->_lock);
+  if (this->_samples.empty())
+    return 0;
+  std::vector<unsigned long> sorted(this->_samples);
+  std::sort(sorted.begin(), sorted.end());
+  return sorted[(sorted.size() - 1) * p / 100];
+}
+
+size_t OperationStatistics::count(void) const
+{
+  std::lock_guard<std::mutex> lock(this->_lock);
+  return this->_samples.size();
+}
+
+int OperationStatistics::errors(void) const
+{
+  std::lock_guard<std::mutex> lock(this->_lock);
+  return this->_errors;
+}
+
+void OperationStatistics::printHeader(void)
+{
+  Serial.printf("%-20s %6s %5s %10s %10s %10s %12s\n", "operation", "n", "err", "p50 ms", "p99 ms", "op/s", "B/s");
+}
+
+void OperationStatistics::report(unsigned long elapsed) const
+{
+  unsigned long p50 = this->percentile(50);
+  unsigned long p99 = this->percentile(99);
+  std::lock_guard<std::mutex> lock(this->_lock);
+  if (elapsed == 0)
+  {
+    for (unsigned long sample : this->_samples)
+      elapsed += sample;
+  }
+  double seconds = elapsed / 1000000.0;
+  Serial.printf("%-20s %6u %5d %10.2f %10.2f %10.2f %12.0f\n",
+                this->_name,
+                (unsigned)this->_samples.size(),
+                this->_errors,
+                p50 / 1000.0,
+                p99 / 1000.0,
+                seconds > 0 ? this->_samples.size() / seconds : 0,
+                seconds > 0 ? this->_bytes / seconds : 0);
+}
+
+MockControl::MockControl(const char *host, int port, const char *cert)
+    : _host(host),
+      _port(port),
+      _cert(cert)
+{
+}
+
+String MockControl::request(const char *method, const char *path, const String &body)
+{
+  WiFiClientSecure client;
+  client.setCACert(this->_cert);
+  HTTPClient http;
+  if (!http.begin(client, this->_host, this->_port, path, true))
+    return "";
+  http.setReuse(false);
+  http.addHeader("Content-Type", "application/json");
+  int httpCode = http.sendRequest(method, body);
+  String response = httpCode == HTTP_CODE_OK ? http.getString() : String("");
+  http.end();
+  return response;
+}
+
+boolean MockControl::configure(const String &json)
+{
+  return !this->request("POST", "/_mock/config", json).isEmpty();
+}
+
+String MockControl::stats(void)
+{
+  return this->request("GET", "/_mock/stats", "");
+}
+
+boolean MockControl::stats(JsonDocument &stats)
+{
+  String response = this->stats();
+  return !response.isEmpty() && !deserializeJson(stats, response);
+}
+
+boolean MockControl::reset(void)
+{
+  return !this->request("POST", "/_mock/reset", "{}").isEmpty();
+}
+
+boolean MockControl::resetStatistics(void)
+{
+  return !this->request("POST", "/_mock/reset", "{\"statistics_only\": true}").isEmpty();
+}
@@ -0,0 +1,129 @@
+/*
+  LoadHarness.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef LoadHarness_h
+#define LoadHarness_h
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Command line of the load tests, --name value pairs
+ */
+class HarnessOptions
+{
+public:
+  HarnessOptions(int argc, char **argv);
+
+  String get(const char *name, const char *fallback) const;
+  long getInt(const char *name, long fallback) const;
+  float getFloat(const char *name, float fallback) const;
+  boolean has(const char *name) const;
+
+  /**
+   * @brief Contents of the file named by --ca, the mock certificate
+   */
+  const char *getCACert(void);
+
+private:
+  std::map<std::string, std::string> _values;
+  String _caCert;
+};
+
+/**
+ * @brief Latency samples and bytes of one operation
+ */
+class OperationStatistics
+{
+public:
+  explicit OperationStatistics(const char *name);
+
+  /**
+   * @brief Records one request
+   *
+   * @param start micros() when the request started
+   * @param ok The request had the expected outcome
+   * @param bytes Payload and response bytes
+   */
+  void add(unsigned long start, boolean ok, size_t bytes = 0);
+
+  /**
+   * @brief Latency percentile in microseconds
+   */
+  unsigned long percentile(int p) const;
+
+  size_t count(void) const;
+  int errors(void) const;
+
+  /**
+   * @brief Prints n, errors, p50/p99 latency and throughput
+   *
+   * @param elapsed Wall time the operation ran in microseconds, 0 to use the sum of the samples
+   */
+  void report(unsigned long elapsed = 0) const;
+
+  static void printHeader(void);
+
+private:
+  const char *_name;
+  mutable std::mutex _lock;
+  std::vector<unsigned long> _samples;
+  int _errors;
+  size_t _bytes;
+};
+
+/**
+ * @brief Talks to the admin endpoints of the mock server
+ */
+class MockControl
+{
+public:
+  MockControl(const char *host, int port, const char *cert);
+
+  /**
+   * @brief Changes the network conditions, see fms_mock.py
+   *
+   * @param json Settings to change, {"latency_ms": 100}
+   * @return boolean false when the mock did not accept them
+   */
+  boolean configure(const String &json);
+
+  /**
+   * @brief Request statistics of the mock as json
+   */
+  String stats(void);
+
+  /**
+   * @brief Request statistics of the mock
+   *
+   * @param stats Document receiving them
+   * @return boolean false when they could not be read
+   */
+  boolean stats(JsonDocument &stats);
+
+  /**
+   * @brief Drops all records, sessions and statistics
+   */
+  boolean reset(void);
+
+  /**
+   * @brief Starts the statistics over, keeps records and sessions
+   */
+  boolean resetStatistics(void);
+
+private:
+  String request(const char *method, const char *path, const String &body);
+
+  String _host;
+  int _port;
+  const char *_cert;
+};
+
+#endif
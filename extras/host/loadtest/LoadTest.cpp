@@ -0,0 +1,185 @@
+/*
+  LoadTest.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "FMDataClient.h"
+#include "LoadHarness.h"
+
+// Host version of examples/LoadTest, drives the client against the mock
+// server in extras/mock and reports p50/p99 latency and throughput per
+// operation. Exits with 1 when a request did not have the expected outcome.
+//
+//   load_test --host localhost --port 8443 --ca extras/mock/localhost.crt
+//             [--rounds 100] [--keep-alive] [--compression] [--container-size 4096]
+//             [--dns-cache]
+
+/**
+ * @brief Destination of container downloads, only counts the bytes
+ */
+class CountingStream : public Stream
+{
+public:
+  CountingStream(void) : bytes(0) {}
+  size_t bytes;
+  int available(void) { return 0; }
+  int read(void) { return -1; }
+  int peek(void) { return -1; }
+  void flush(void) {}
+  size_t write(uint8_t data)
+  {
+    this->bytes++;
+    return 1;
+  }
+  size_t write(const uint8_t *buffer, size_t size)
+  {
+    this->bytes += size;
+    return size;
+  }
+};
+
+int main(int argc, char **argv)
+{
+  HarnessOptions options(argc, argv);
+  String hostName = options.get("host", "localhost");
+  const char *host = hostName.c_str();
+  const char *cert = options.getCACert();
+  const int port = options.getInt("port", 8443);
+  String database = options.get("database", "loadtest");
+  String layout = options.get("layout", "records");
+  String userName = options.get("user", "admin");
+  String password = options.get("password", "admin");
+  int rounds = options.getInt("rounds", 100);
+  size_t containerSize = options.getInt("container-size", 4096);
+
+  UserCredentials credentials(database.c_str(), userName.c_str(), password.c_str());
+  FMDataClient client(credentials, host, cert, port);
+  client.setKeepAlive(options.has("keep-alive"));
+  client.setResponseCompression(options.has("compression"));
+  // With a cache the client resolves and connects itself, downloads included
+  DnsCache dnsCache;
+  if (options.has("dns-cache"))
+    client.setDnsCache(&dnsCache);
+
+  OperationStatistics logIn("logIn");
+  OperationStatistics create("createRecord");
+  OperationStatistics edit("editRecord");
+  OperationStatistics find("performFind");
+  OperationStatistics findEmpty("performFind 401");
+  OperationStatistics upload("uploadContainer");
+  OperationStatistics download("downloadContainer");
+  OperationStatistics remove("deleteRecord");
+  OperationStatistics invalidToken("invalid token 952");
+  OperationStatistics logOut("logOut");
+
+  uint32_t startFreeHeap = ESP.getFreeHeap();
+  unsigned long start = micros();
+  String response = client.logInToDatabaseSession();
+  logIn.add(start, !response.isEmpty(), response.length());
+  if (response.isEmpty())
+  {
+    Serial.printf("Could not log in to %s:%d\n", host, port);
+    return 1;
+  }
+
+  vector<RecordField> fields;
+  fields.push_back(RecordField("field1", "data1"));
+  fields.push_back(RecordField("field2", 42));
+  fields.push_back(RecordField("description", "A record written by the load test"));
+
+  RecordFindCriteria missing("field1", "==nothing");
+  vector<RecordFindCriteria *> missingRecords;
+  missingRecords.push_back(&missing);
+  FindCriteria missingFind(missingRecords);
+  vector<FindCriteria *> missingCriterias;
+  missingCriterias.push_back(&missingFind);
+
+  String contents;
+  unsigned long downloadRequests = 0;
+  contents.reserve(containerSize);
+  for (size_t i = 0; i < containerSize; i++)
+    contents += (char)('a' + i % 26);
+
+  unsigned long roundStart = micros();
+  for (int i = 0; i < rounds; i++)
+  {
+    ResponseStatus status;
+    start = micros();
+    boolean ok = client.createRecord(database, layout, fields.data(), fields.size(), status);
+    create.add(start, ok);
+    if (!ok)
+      continue;
+    String recordId = status.recordId;
+
+    start = micros();
+    ok = client.editRecord(database, layout, recordId, fields.data(), fields.size(), status);
+    edit.add(start, ok);
+
+    RecordFindCriteria byId("RecordID", String("==") + recordId);
+    vector<RecordFindCriteria *> records;
+    records.push_back(&byId);
+    FindCriteria findById(records);
+    vector<FindCriteria *> findCriterias;
+    findCriterias.push_back(&findById);
+    start = micros();
+    response = client.performFind(database, layout, findCriterias, 10);
+    find.add(start, !response.isEmpty(), response.length());
+
+    DynamicJsonDocument doc(1024);
+    start = micros();
+    ok = client.performFind(database, layout, missingCriterias, doc);
+    findEmpty.add(start, !ok && client.getLastHttpCode() == 500 && doc["messages"][0]["code"].as<int>() == 401);
+
+    start = micros();
+    response = client.uploadContainerData(database, layout, recordId, "container", 1, contents, "load.txt", "text/plain");
+    upload.add(start, !response.isEmpty(), contents.length());
+
+    if (client.performFind(database, layout, findCriterias, doc))
+    {
+      String url = doc["response"]["data"][0]["fieldData"]["container"].as<String>();
+      CountingStream destination;
+      DownloadStatistics statistics;
+      start = micros();
+      ok = client.downloadContainerData(url, destination, 0, &statistics);
+      download.add(start, ok && destination.bytes == contents.length(), destination.bytes);
+      downloadRequests += statistics.requests;
+    }
+    else
+    {
+      download.add(micros(), false);
+    }
+
+    start = micros();
+    ok = client.deleteRecord(database, layout, recordId);
+    remove.add(start, ok);
+  }
+  unsigned long elapsed = micros() - roundStart;
+
+  // An unknown token is answered with 952
+  String token(client.getToken());
+  client.setToken("invalid");
+  ResponseStatus status;
+  start = micros();
+  boolean ok = client.createRecord(database, layout, fields.data(), fields.size(), status);
+  invalidToken.add(start, !ok && status.httpCode == 401 && status.code == 952);
+  client.setToken(token);
+
+  start = micros();
+  response = client.logOutDatabaseSession();
+  logOut.add(start, !response.isEmpty(), response.length());
+
+  Serial.printf("%d rounds in %lu ms against %s:%d, free heap %u (%u at start)\n",
+                rounds, elapsed / 1000, host, port, ESP.getFreeHeap(), startFreeHeap);
+  Serial.printf("%lu requests for %u container downloads, redirects and resumed transfers included\n",
+                downloadRequests, (unsigned)download.count());
+  OperationStatistics::printHeader();
+  const OperationStatistics *operations[] = {&logIn, &create, &edit, &find, &findEmpty, &upload, &download, &remove, &invalidToken, &logOut};
+  int errors = 0;
+  for (const OperationStatistics *operation : operations)
+  {
+    operation->report();
+    errors += operation->errors();
+  }
+  Serial.println("setGlobalVariables is not implemented by the client, the mock serves it for other clients");
+  return errors == 0 ? 0 : 1;
+}
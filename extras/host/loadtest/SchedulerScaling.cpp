@@ -0,0 +1,99 @@
+/*
+  SchedulerScaling.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "LoadHarness.h"
+#include "RequestScheduler.h"
+
+// Throughput of RequestScheduler with 1 to --connections connections
+// against the mock server, 40 sources queueing createRecord requests like
+// the gateway's downstream sensors. The mock's latency makes every request
+// wait on the network, so throughput should grow with the connections.
+// Exits with 1 when a request failed, the mock did not see the requests in
+// parallel or the speedup with the most connections is below --min-speedup.
+//
+//   scheduler_scaling --port 8443 --ca extras/mock/localhost.crt
+//                     [--connections 4] [--requests 200] [--sources 40] [--min-speedup 2]
+
+int main(int argc, char **argv)
+{
+  HarnessOptions options(argc, argv);
+  String hostName = options.get("host", "localhost");
+  const char *host = hostName.c_str();
+  const char *cert = options.getCACert();
+  const int port = options.getInt("port", 8443);
+  String database = options.get("database", "loadtest");
+  String layout = options.get("layout", "sensors");
+  String userName = options.get("user", "admin");
+  String password = options.get("password", "admin");
+  int maximum = constrain(options.getInt("connections", 4), 1, SCHEDULER_MAX_CONNECTIONS);
+  int requests = options.getInt("requests", 200);
+  int sources = options.getInt("sources", 40);
+  float minimumSpeedup = options.getFloat("min-speedup", 0);
+
+  UserCredentials credentials(database.c_str(), userName.c_str(), password.c_str());
+  MockControl mock(host, port, cert);
+
+  vector<RecordField> fields;
+  fields.push_back(RecordField("sensor", "gateway"));
+  fields.push_back(RecordField("temperature", 21));
+  fields.push_back(RecordField("humidity", 48));
+
+  Serial.printf("%d createRecord requests from %d sources against %s:%d\n", requests, sources, host, port);
+  Serial.printf("%-12s %6s %5s %10s %10s %10s %8s %10s\n",
+                "connections", "n", "err", "p50 ms", "p99 ms", "op/s", "speedup", "in flight");
+  double baseline = 0;
+  double speedup = 0;
+  int errors = 0;
+  for (int connections = 1; connections <= maximum; connections++)
+  {
+    RequestScheduler scheduler(credentials, host, cert, port, connections);
+    if (!scheduler.begin())
+    {
+      Serial.printf("Could not log in to %s:%d\n", host, port);
+      return 1;
+    }
+    // The log in is not part of the measurement
+    mock.resetStatistics();
+
+    OperationStatistics create("createRecord");
+    unsigned long start = micros();
+    for (int i = 0; i < requests; i++)
+    {
+      scheduler.submit([&](FMDataClient &client) {
+        ResponseStatus status;
+        unsigned long requestStart = micros();
+        boolean ok = client.createRecord(database, layout, fields.data(), fields.size(), status);
+        create.add(requestStart, ok);
+      },
+                       i % sources);
+    }
+    scheduler.wait();
+    unsigned long elapsed = micros() - start;
+    scheduler.end();
+
+    DynamicJsonDocument stats(4096);
+    int inFlight = mock.stats(stats) ? stats["max_in_flight"].as<int>() : 0;
+    double throughput = create.count() * 1000000.0 / elapsed;
+    if (connections == 1)
+      baseline = throughput;
+    speedup = baseline > 0 ? throughput / baseline : 0;
+    Serial.printf("%-12d %6u %5d %10.2f %10.2f %10.2f %8.2f %10d\n",
+                  connections, (unsigned)create.count(), create.errors(),
+                  create.percentile(50) / 1000.0, create.percentile(99) / 1000.0,
+                  throughput, speedup, inFlight);
+    errors += create.errors();
+    if (inFlight < connections)
+    {
+      Serial.printf("The mock saw at most %d requests at once with %d connections\n", inFlight, connections);
+      errors++;
+    }
+  }
+  if (minimumSpeedup > 0 && speedup < minimumSpeedup)
+  {
+    Serial.printf("Speedup %.2f with %d connections is below %.2f\n", speedup, maximum, minimumSpeedup);
+    errors++;
+  }
+  return errors == 0 ? 0 : 1;
+}
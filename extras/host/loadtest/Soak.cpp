@@ -0,0 +1,202 @@
+/*
+  Soak.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "FMDataClient.h"
+#include "HeapModel.h"
+#include "LoadHarness.h"
+
+// Long running create, edit, find and delete against the mock server, with
+// the heap of the board modelled by the shim. Like a logging sketch it keeps
+// the last records it wrote, so short lived request buffers are allocated
+// between long lived field values. Every sample prints free heap, largest
+// free block and fragmentation, 1 - largest block / free heap.
+//
+// soak_test uses the inline capacities of FMDataClient.h, soak_test_heap is
+// built with all capacities at 1, so every identifier and field value takes
+// a heap block of its own as it did with String.
+//
+// Exits with 1 when a request failed or the free heap dropped by more than
+// --max-drift bytes after all kept records were written once.
+//
+//   soak_test --port 8443 --ca extras/mock/localhost.crt
+//             [--duration-s 86400] [--sample-s 60] [--kept 16] [--max-drift 1024]
+
+/**
+ * @brief A record the sketch holds on to after writing it
+ */
+struct KeptRecord
+{
+  InlineString<FMDATA_ID_CAPACITY> recordId;
+  vector<RecordField> fields;
+};
+
+/**
+ * @brief Requests and failures of one operation
+ * OperationStatistics keeps every latency, that would grow the heap that is
+ * being watched.
+ */
+struct OperationCount
+{
+  const char *name;
+  unsigned long requests;
+  unsigned long errors;
+  void add(boolean ok)
+  {
+    this->requests++;
+    if (!ok)
+      this->errors++;
+  }
+};
+
+/**
+ * @brief Heap figures of one sample
+ */
+struct HeapSample
+{
+  uint32_t free;
+  uint32_t largest;
+  size_t blocks;
+  float fragmentation;
+};
+
+static HeapSample sampleHeap(void)
+{
+  HeapSample sample;
+  sample.free = ESP.getFreeHeap();
+  sample.largest = ESP.getMaxAllocHeap();
+  sample.blocks = HeapModel::getBlocks();
+  sample.fragmentation = sample.free > 0 ? 100.0f * (1.0f - (float)sample.largest / sample.free) : 0;
+  return sample;
+}
+
+static vector<RecordField> readingFields(unsigned long round)
+{
+  vector<RecordField> fields;
+  fields.push_back(RecordField("sensor", stringf("S-%03lu", round % 50)));
+  fields.push_back(RecordField("reading", (float)(round % 1000) / 10));
+  fields.push_back(RecordField("count", (int)round));
+  fields.push_back(RecordField("unit", "degC"));
+  fields.push_back(RecordField("note", stringf("Reading %lu of the soak test, kept until replaced", round)));
+  return fields;
+}
+
+int main(int argc, char **argv)
+{
+  HarnessOptions options(argc, argv);
+  String hostName = options.get("host", "localhost");
+  const char *host = hostName.c_str();
+  const char *cert = options.getCACert();
+  const int port = options.getInt("port", 8443);
+  String database = options.get("database", "loadtest");
+  String layout = options.get("layout", "readings");
+  String userName = options.get("user", "admin");
+  String password = options.get("password", "admin");
+  unsigned long duration = options.getInt("duration-s", 86400) * 1000UL;
+  unsigned long sampleInterval = options.getInt("sample-s", 60) * 1000UL;
+  size_t keptCount = options.getInt("kept", 16);
+  long maxDrift = options.getInt("max-drift", 1024);
+
+  UserCredentials credentials(database.c_str(), userName.c_str(), password.c_str());
+  FMDataClient client(credentials, host, cert, port);
+  client.setKeepAlive(options.has("keep-alive"));
+
+  OperationCount create = {"createRecord", 0, 0};
+  OperationCount edit = {"editRecord", 0, 0};
+  OperationCount find = {"performFind", 0, 0};
+  OperationCount remove = {"deleteRecord", 0, 0};
+
+  if (client.logInToDatabaseSession().isEmpty())
+  {
+    Serial.printf("Could not log in to %s:%d\n", host, port);
+    return 1;
+  }
+
+  Serial.printf("capacities: field value %d, script parameter %d, token %d, host %d, id %d\n",
+                FIELD_VALUE_CAPACITY, SCRIPT_PARAMETER_CAPACITY, FMDATA_TOKEN_CAPACITY, FMDATA_HOST_CAPACITY, FMDATA_ID_CAPACITY);
+  Serial.printf("%8s %8s %8s %8s %8s %7s %7s\n", "s", "rounds", "free", "min", "largest", "frag %", "blocks");
+
+  vector<KeptRecord> kept(keptCount);
+  ScriptParameters script("AfterCreate", "soak");
+  unsigned long start = millis();
+  unsigned long nextSample = start;
+  unsigned long round = 0;
+  HeapSample baseline = {0, 0, 0, 0};
+  HeapSample last = baseline;
+  float worstFragmentation = 0;
+  boolean warm = false;
+  for (;;)
+  {
+    unsigned long now = millis();
+    if ((long)(now - nextSample) >= 0 || now - start >= duration)
+    {
+      last = sampleHeap();
+      if (!warm && round >= keptCount)
+      {
+        baseline = last;
+        warm = true;
+      }
+      if (last.fragmentation > worstFragmentation)
+        worstFragmentation = last.fragmentation;
+      Serial.printf("%8lu %8lu %8u %8u %8u %7.1f %7u\n",
+                    (now - start) / 1000, round, last.free, ESP.getMinFreeHeap(), last.largest, last.fragmentation, (unsigned)last.blocks);
+      nextSample += sampleInterval;
+      if (now - start >= duration)
+        break;
+    }
+
+    KeptRecord &slot = kept[round % keptCount];
+    if (!slot.recordId.isEmpty())
+    {
+      remove.add(client.deleteRecord(database, layout, slot.recordId.toString()));
+    }
+
+    slot.fields = readingFields(round);
+    ResponseStatus status;
+    boolean ok = client.createRecord(database, layout, slot.fields.data(), slot.fields.size(), status, &script);
+    create.add(ok);
+    slot.recordId = ok ? status.recordId : String("");
+
+    // Correct a reading written earlier, the way a sketch fixes a value
+    KeptRecord &earlier = kept[(round + keptCount / 2) % keptCount];
+    if (!earlier.recordId.isEmpty())
+    {
+      earlier.fields[1] = RecordField("reading", (float)(round % 1000) / 10 + 0.5f);
+      edit.add(client.editRecord(database, layout, earlier.recordId.toString(), earlier.fields.data(), earlier.fields.size(), status));
+
+      RecordFindCriteria byId("RecordID", String("==") + earlier.recordId.toString());
+      vector<RecordFindCriteria *> records;
+      records.push_back(&byId);
+      FindCriteria findById(records);
+      vector<FindCriteria *> findCriterias;
+      findCriterias.push_back(&findById);
+      find.add(!client.performFind(database, layout, findCriterias, 1).isEmpty());
+    }
+    round++;
+  }
+
+  for (KeptRecord &slot : kept)
+  {
+    if (!slot.recordId.isEmpty())
+      client.deleteRecord(database, layout, slot.recordId.toString());
+  }
+  client.logOutDatabaseSession();
+
+  long drift = warm ? (long)baseline.free - (long)last.free : 0;
+  Serial.printf("%lu rounds, free heap %u after warm up, %u at the end, worst fragmentation %.1f %%\n",
+                round, baseline.free, last.free, worstFragmentation);
+  const OperationCount *operations[] = {&create, &edit, &find, &remove};
+  unsigned long errors = 0;
+  for (const OperationCount *operation : operations)
+  {
+    Serial.printf("%-20s %8lu requests %5lu errors\n", operation->name, operation->requests, operation->errors);
+    errors += operation->errors;
+  }
+  if (drift > maxDrift)
+  {
+    Serial.printf("Free heap dropped by %ld bytes, more than %ld\n", drift, maxDrift);
+    return 1;
+  }
+  return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,564 @@
+/*
+  Arduino.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "HeapModel.h"
+#include <Arduino.h>
+#include <arpa/inet.h>
+#include <sched.h>
+#include <sys/random.h>
+#include <time.h>
+#include <unistd.h>
+
+#define HOST_CPU_FREQUENCY_MHZ 240
+
+HardwareSerial Serial;
+EspClass ESP;
+
+static uint64_t monotonicMicros(void)
+{
+  static struct timespec start = {0, 0};
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (start.tv_sec == 0 && start.tv_nsec == 0)
+    start = now;
+  return (uint64_t)(now.tv_sec - start.tv_sec) * 1000000 + (now.tv_nsec - start.tv_nsec) / 1000;
+}
+
+unsigned long millis(void)
+{
+  return (unsigned long)(uint32_t)(monotonicMicros() / 1000);
+}
+
+unsigned long micros(void)
+{
+  return (unsigned long)(uint32_t)monotonicMicros();
+}
+
+void delay(uint32_t ms)
+{
+  struct timespec request = {(time_t)(ms / 1000), (long)(ms % 1000) * 1000000};
+  while (nanosleep(&request, &request) != 0)
+    ;
+}
+
+void delayMicroseconds(uint32_t us)
+{
+  struct timespec request = {(time_t)(us / 1000000), (long)(us % 1000000) * 1000};
+  while (nanosleep(&request, &request) != 0)
+    ;
+}
+
+void yield(void)
+{
+  sched_yield();
+}
+
+uint32_t esp_random(void)
+{
+  uint32_t value;
+  if (getrandom(&value, sizeof(value), 0) != sizeof(value))
+    value = (uint32_t)random();
+  return value;
+}
+
+uint32_t getCpuFrequencyMhz(void)
+{
+  return HOST_CPU_FREQUENCY_MHZ;
+}
+
+void log_printf(const char letter, const char *file, int line, const char *function, const char *format, ...)
+{
+  const char *name = strrchr(file, '/');
+  fprintf(stderr, "[%c][%s:%d] %s(): ", letter, name != NULL ? name + 1 : file, line, function);
+  va_list arguments;
+  va_start(arguments, format);
+  vfprintf(stderr, format, arguments);
+  va_end(arguments);
+  fputc('\n', stderr);
+}
+
+static char *formatNumber(unsigned long value, char *result, int base, boolean negative)
+{
+  char digits[sizeof(unsigned long) * 8 + 1];
+  int count = 0;
+  do
+  {
+    int digit = value % base;
+    digits[count++] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+    value /= base;
+  } while (value > 0);
+  char *out = result;
+  if (negative)
+    *out++ = '-';
+  while (count > 0)
+    *out++ = digits[--count];
+  *out = '\0';
+  return result;
+}
+
+char *itoa(int value, char *result, int base)
+{
+  return ltoa(value, result, base);
+}
+
+char *ltoa(long value, char *result, int base)
+{
+  if (base < 2 || base > 36)
+  {
+    *result = '\0';
+    return result;
+  }
+  if (value < 0 && base == 10)
+    return formatNumber(-(unsigned long)value, result, base, true);
+  return formatNumber((unsigned long)value, result, base, false);
+}
+
+char *utoa(unsigned value, char *result, int base)
+{
+  return ultoa(value, result, base);
+}
+
+char *ultoa(unsigned long value, char *result, int base)
+{
+  if (base < 2 || base > 36)
+  {
+    *result = '\0';
+    return result;
+  }
+  return formatNumber(value, result, base, false);
+}
+
+char *dtostrf(double number, signed char width, unsigned char prec, char *s)
+{
+  sprintf(s, "%*.*f", width, prec, number);
+  return s;
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+  size_t n = 0;
+  while (size--)
+  {
+    n += this->write(*buffer++);
+  }
+  return n;
+}
+
+size_t Print::printf(const char *format, ...)
+{
+  char loc_buf[64];
+  char *temp = loc_buf;
+  va_list arg;
+  va_list copy;
+  va_start(arg, format);
+  va_copy(copy, arg);
+  int len = vsnprintf(temp, sizeof(loc_buf), format, copy);
+  va_end(copy);
+  if (len < 0)
+  {
+    va_end(arg);
+    return 0;
+  }
+  if (len >= (int)sizeof(loc_buf))
+  {
+    temp = (char *)malloc(len + 1);
+    if (temp == NULL)
+    {
+      va_end(arg);
+      return 0;
+    }
+    len = vsnprintf(temp, len + 1, format, arg);
+  }
+  va_end(arg);
+  len = this->write((uint8_t *)temp, len);
+  if (temp != loc_buf)
+    free(temp);
+  return len;
+}
+
+size_t Print::print(const String &s)
+{
+  return this->write(s.c_str(), s.length());
+}
+
+size_t Print::print(const char str[])
+{
+  return this->write(str);
+}
+
+size_t Print::print(char c)
+{
+  return this->write((uint8_t)c);
+}
+
+size_t Print::print(unsigned char b, int base)
+{
+  return this->print((unsigned long)b, base);
+}
+
+size_t Print::print(int n, int base)
+{
+  return this->print((long)n, base);
+}
+
+size_t Print::print(unsigned int n, int base)
+{
+  return this->print((unsigned long)n, base);
+}
+
+size_t Print::print(long n, int base)
+{
+  if (base == 0)
+    return this->write((uint8_t)n);
+  if (base == 10 && n < 0)
+  {
+    int t = this->print('-');
+    return this->printNumber(-(unsigned long)n, 10) + t;
+  }
+  return this->printNumber(n, base);
+}
+
+size_t Print::print(unsigned long n, int base)
+{
+  if (base == 0)
+    return this->write((uint8_t)n);
+  return this->printNumber(n, base);
+}
+
+size_t Print::print(double n, int digits)
+{
+  return this->printFloat(n, digits);
+}
+
+size_t Print::println(void)
+{
+  return this->print("\r\n");
+}
+
+size_t Print::println(const String &s)
+{
+  size_t n = this->print(s);
+  return n + this->println();
+}
+
+size_t Print::println(const char c[])
+{
+  size_t n = this->print(c);
+  return n + this->println();
+}
+
+size_t Print::println(char c)
+{
+  size_t n = this->print(c);
+  return n + this->println();
+}
+
+size_t Print::println(unsigned char b, int base)
+{
+  size_t n = this->print(b, base);
+  return n + this->println();
+}
+
+size_t Print::println(int num, int base)
+{
+  size_t n = this->print(num, base);
+  return n + this->println();
+}
+
+size_t Print::println(unsigned int num, int base)
+{
+  size_t n = this->print(num, base);
+  return n + this->println();
+}
+
+size_t Print::println(long num, int base)
+{
+  size_t n = this->print(num, base);
+  return n + this->println();
+}
+
+size_t Print::println(unsigned long num, int base)
+{
+  size_t n = this->print(num, base);
+  return n + this->println();
+}
+
+size_t Print::println(double num, int digits)
+{
+  size_t n = this->print(num, digits);
+  return n + this->println();
+}
+
+size_t Print::printNumber(unsigned long n, uint8_t base)
+{
+  char buf[8 * sizeof(n) + 1];
+  if (base < 2)
+    base = 10;
+  return this->write(ultoa(n, buf, base));
+}
+
+size_t Print::printFloat(double number, uint8_t digits)
+{
+  char buf[64];
+  if (isnan(number))
+    return this->print("nan");
+  if (isinf(number))
+    return this->print("inf");
+  if (number > 4294967040.0 || number < -4294967040.0)
+    return this->print("ovf");
+  snprintf(buf, sizeof(buf), "%.*f", digits, number);
+  return this->write(buf);
+}
+
+void Stream::setTimeout(unsigned long timeout)
+{
+  this->_timeout = timeout;
+}
+
+/**
+ * @brief Reads a byte, waiting up to the timeout like the core does
+ * The core spins on read(), the host yields between attempts so an idle
+ * wait does not take a whole CPU.
+ */
+int Stream::timedRead()
+{
+  int c;
+  this->_startMillis = millis();
+  do
+  {
+    c = this->read();
+    if (c >= 0)
+      return c;
+    yield();
+  } while (millis() - this->_startMillis < this->_timeout);
+  return -1;
+}
+
+int Stream::timedPeek()
+{
+  int c;
+  this->_startMillis = millis();
+  do
+  {
+    c = this->peek();
+    if (c >= 0)
+      return c;
+    yield();
+  } while (millis() - this->_startMillis < this->_timeout);
+  return -1;
+}
+
+bool Stream::find(const char *target)
+{
+  return this->find(target, strlen(target));
+}
+
+bool Stream::find(const char *target, size_t length)
+{
+  if (length == 0)
+    return true;
+  size_t index = 0;
+  int c;
+  while ((c = this->timedRead()) > 0)
+  {
+    if (c != target[index])
+      index = 0;
+    if (c == target[index])
+    {
+      if (++index >= length)
+        return true;
+    }
+  }
+  return false;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length)
+{
+  size_t count = 0;
+  while (count < length)
+  {
+    int c = this->timedRead();
+    if (c < 0)
+      break;
+    *buffer++ = (char)c;
+    count++;
+  }
+  return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char *buffer, size_t length)
+{
+  if (length < 1)
+    return 0;
+  size_t index = 0;
+  while (index < length)
+  {
+    int c = this->timedRead();
+    if (c < 0 || c == terminator)
+      break;
+    *buffer++ = (char)c;
+    index++;
+  }
+  return index;
+}
+
+String Stream::readString()
+{
+  String ret;
+  int c = this->timedRead();
+  while (c >= 0)
+  {
+    ret += (char)c;
+    c = this->timedRead();
+  }
+  return ret;
+}
+
+String Stream::readStringUntil(char terminator)
+{
+  String ret;
+  int c = this->timedRead();
+  while (c >= 0 && c != terminator)
+  {
+    ret += (char)c;
+    c = this->timedRead();
+  }
+  return ret;
+}
+
+IPAddress::IPAddress()
+{
+  this->_address.dword = 0;
+}
+
+IPAddress::IPAddress(uint8_t first_octet, uint8_t second_octet, uint8_t third_octet, uint8_t fourth_octet)
+{
+  this->_address.bytes[0] = first_octet;
+  this->_address.bytes[1] = second_octet;
+  this->_address.bytes[2] = third_octet;
+  this->_address.bytes[3] = fourth_octet;
+}
+
+IPAddress::IPAddress(uint32_t address)
+{
+  this->_address.dword = address;
+}
+
+IPAddress::IPAddress(const uint8_t *address)
+{
+  memcpy(this->_address.bytes, address, sizeof(this->_address.bytes));
+}
+
+IPAddress &IPAddress::operator=(const uint8_t *address)
+{
+  memcpy(this->_address.bytes, address, sizeof(this->_address.bytes));
+  return *this;
+}
+
+IPAddress &IPAddress::operator=(uint32_t address)
+{
+  this->_address.dword = address;
+  return *this;
+}
+
+bool IPAddress::operator==(const uint8_t *addr) const
+{
+  return memcmp(addr, this->_address.bytes, sizeof(this->_address.bytes)) == 0;
+}
+
+String IPAddress::toString() const
+{
+  char szRet[16];
+  sprintf(szRet, "%u.%u.%u.%u", this->_address.bytes[0], this->_address.bytes[1], this->_address.bytes[2], this->_address.bytes[3]);
+  return String(szRet);
+}
+
+bool IPAddress::fromString(const char *address)
+{
+  struct in_addr parsed;
+  if (address == NULL || inet_pton(AF_INET, address, &parsed) != 1)
+    return false;
+  this->_address.dword = parsed.s_addr;
+  return true;
+}
+
+void HardwareSerial::begin(unsigned long baud)
+{
+}
+
+int HardwareSerial::available(void)
+{
+  return 0;
+}
+
+int HardwareSerial::read(void)
+{
+  return -1;
+}
+
+int HardwareSerial::peek(void)
+{
+  return -1;
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+  return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+  return fwrite(buffer, 1, size, stdout);
+}
+
+void HardwareSerial::flush(void)
+{
+  fflush(stdout);
+}
+
+static uint32_t minimumFreeHeap = ESP_HOST_HEAP_SIZE;
+
+uint32_t EspClass::getHeapSize(void)
+{
+  return ESP_HOST_HEAP_SIZE;
+}
+
+uint32_t EspClass::getFreeHeap(void)
+{
+  // The host process allocates for itself (test framework, statics), only
+  // what was allocated after the first call is placed in the nominal heap
+  HeapModel::begin(ESP_HOST_HEAP_SIZE);
+  uint32_t free = HeapModel::getFree();
+  if (free < minimumFreeHeap)
+    minimumFreeHeap = free;
+  return free;
+}
+
+uint32_t EspClass::getMinFreeHeap(void)
+{
+  this->getFreeHeap();
+  return minimumFreeHeap;
+}
+
+uint32_t EspClass::getMaxAllocHeap(void)
+{
+  HeapModel::begin(ESP_HOST_HEAP_SIZE);
+  return HeapModel::getLargestFree();
+}
+
+uint8_t EspClass::getCpuFreqMHz(void)
+{
+  return HOST_CPU_FREQUENCY_MHZ;
+}
+
+uint64_t EspClass::getEfuseMac(void)
+{
+  return (uint64_t)gethostid();
+}
+
+void EspClass::restart(void)
+{
+  exit(0);
+}
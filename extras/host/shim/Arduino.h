@@ -0,0 +1,274 @@
+/*
+  Arduino.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef Arduino_h
+#define Arduino_h
+
+/*
+ * Host build stand-in for the parts of the arduino-esp32 1.0.4 core the
+ * library uses. The String, Print and Stream classes follow the core's
+ * behaviour (allocation pattern, timeouts, printf), so sizes and timings
+ * measured on the host are comparable to the board.
+ */
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#include "WString.h"
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+using std::max;
+using std::min;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define F(string_literal) (string_literal)
+#define IRAM_ATTR
+
+#define ARDUHAL_LOG_LEVEL_NONE (0)
+#define ARDUHAL_LOG_LEVEL_ERROR (1)
+#define ARDUHAL_LOG_LEVEL_WARN (2)
+#define ARDUHAL_LOG_LEVEL_INFO (3)
+#define ARDUHAL_LOG_LEVEL_DEBUG (4)
+#define ARDUHAL_LOG_LEVEL_VERBOSE (5)
+
+#ifndef CORE_DEBUG_LEVEL
+#define CORE_DEBUG_LEVEL ARDUHAL_LOG_LEVEL_NONE
+#endif
+#define ARDUHAL_LOG_LEVEL CORE_DEBUG_LEVEL
+
+void log_printf(const char letter, const char *file, int line, const char *function, const char *format, ...);
+
+#if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_ERROR
+#define log_e(format, ...) log_printf('E', __FILE__, __LINE__, __FUNCTION__, format, ##__VA_ARGS__)
+#else
+#define log_e(format, ...)
+#endif
+#if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_WARN
+#define log_w(format, ...) log_printf('W', __FILE__, __LINE__, __FUNCTION__, format, ##__VA_ARGS__)
+#else
+#define log_w(format, ...)
+#endif
+#if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
+#define log_i(format, ...) log_printf('I', __FILE__, __LINE__, __FUNCTION__, format, ##__VA_ARGS__)
+#else
+#define log_i(format, ...)
+#endif
+#if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_DEBUG
+#define log_d(format, ...) log_printf('D', __FILE__, __LINE__, __FUNCTION__, format, ##__VA_ARGS__)
+#else
+#define log_d(format, ...)
+#endif
+#if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_VERBOSE
+#define log_v(format, ...) log_printf('V', __FILE__, __LINE__, __FUNCTION__, format, ##__VA_ARGS__)
+#else
+#define log_v(format, ...)
+#endif
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield(void);
+
+uint32_t esp_random(void);
+uint32_t getCpuFrequencyMhz(void);
+
+char *itoa(int value, char *result, int base);
+char *ltoa(long value, char *result, int base);
+char *utoa(unsigned value, char *result, int base);
+char *ultoa(unsigned long value, char *result, int base);
+char *dtostrf(double number, signed char width, unsigned char prec, char *s);
+
+class Print
+{
+public:
+  Print()
+      : write_error(0)
+  {
+  }
+  virtual ~Print()
+  {
+  }
+  int getWriteError()
+  {
+    return this->write_error;
+  }
+  void clearWriteError()
+  {
+    this->write_error = 0;
+  }
+
+  virtual size_t write(uint8_t) = 0;
+  size_t write(const char *str)
+  {
+    if (str == NULL)
+      return 0;
+    return this->write((const uint8_t *)str, strlen(str));
+  }
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  size_t write(const char *buffer, size_t size)
+  {
+    return this->write((const uint8_t *)buffer, size);
+  }
+
+  size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+  size_t print(const String &);
+  size_t print(const char[]);
+  size_t print(char);
+  size_t print(unsigned char, int = 10);
+  size_t print(int, int = 10);
+  size_t print(unsigned int, int = 10);
+  size_t print(long, int = 10);
+  size_t print(unsigned long, int = 10);
+  size_t print(double, int = 2);
+
+  size_t println(const String &s);
+  size_t println(const char[]);
+  size_t println(char);
+  size_t println(unsigned char, int = 10);
+  size_t println(int, int = 10);
+  size_t println(unsigned int, int = 10);
+  size_t println(long, int = 10);
+  size_t println(unsigned long, int = 10);
+  size_t println(double, int = 2);
+  size_t println(void);
+
+  virtual void flush()
+  {
+  }
+
+protected:
+  void setWriteError(int err = 1)
+  {
+    this->write_error = err;
+  }
+
+private:
+  int write_error;
+  size_t printNumber(unsigned long, uint8_t);
+  size_t printFloat(double, uint8_t);
+};
+
+class Stream : public Print
+{
+protected:
+  unsigned long _timeout;
+  unsigned long _startMillis;
+  int timedRead();
+  int timedPeek();
+
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  Stream()
+      : _timeout(1000),
+        _startMillis(0)
+  {
+  }
+  virtual ~Stream()
+  {
+  }
+
+  void setTimeout(unsigned long timeout);
+  unsigned long getTimeout(void)
+  {
+    return this->_timeout;
+  }
+
+  bool find(const char *target);
+  bool find(const char *target, size_t length);
+
+  virtual size_t readBytes(char *buffer, size_t length);
+  virtual size_t readBytes(uint8_t *buffer, size_t length)
+  {
+    return this->readBytes((char *)buffer, length);
+  }
+  size_t readBytesUntil(char terminator, char *buffer, size_t length);
+
+  virtual String readString();
+  String readStringUntil(char terminator);
+};
+
+class IPAddress : public Print
+{
+public:
+  IPAddress();
+  IPAddress(uint8_t first_octet, uint8_t second_octet, uint8_t third_octet, uint8_t fourth_octet);
+  IPAddress(uint32_t address);
+  IPAddress(const uint8_t *address);
+
+  bool fromString(const char *address);
+  bool fromString(const String &address)
+  {
+    return this->fromString(address.c_str());
+  }
+
+  /**
+   * @brief The address in network byte order, as in in_addr.s_addr
+   */
+  operator uint32_t() const
+  {
+    return this->_address.dword;
+  }
+  bool operator==(const IPAddress &addr) const
+  {
+    return this->_address.dword == addr._address.dword;
+  }
+  bool operator==(const uint8_t *addr) const;
+
+  uint8_t operator[](int index) const
+  {
+    return this->_address.bytes[index];
+  }
+  uint8_t &operator[](int index)
+  {
+    return this->_address.bytes[index];
+  }
+
+  IPAddress &operator=(const uint8_t *address);
+  IPAddress &operator=(uint32_t address);
+
+  size_t write(uint8_t) override
+  {
+    return 0;
+  }
+  String toString() const;
+
+private:
+  union
+  {
+    uint8_t bytes[4];
+    uint32_t dword;
+  } _address;
+};
+
+class HardwareSerial : public Stream
+{
+public:
+  void begin(unsigned long baud);
+  int available(void) override;
+  int read(void) override;
+  int peek(void) override;
+  size_t write(uint8_t) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  void flush(void) override;
+  using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+#include "Esp.h"
+
+#endif
@@ -0,0 +1,44 @@
+/*
+  ESPRandom.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include <ESPRandom.h>
+
+#define UUID_SIZE 16
+
+/**
+ * @brief Fills the buffer with a random version 4 UUID
+ */
+void ESPRandom::uuid(uint8_t *buffer)
+{
+  for (int i = 0; i < UUID_SIZE; i += 4)
+  {
+    uint32_t value = esp_random();
+    memcpy(buffer + i, &value, sizeof(value));
+  }
+  buffer[6] = 0x40 | (buffer[6] & 0x0f);
+  buffer[8] = 0x80 | (buffer[8] & 0x3f);
+}
+
+std::vector<uint8_t> ESPRandom::uuid(void)
+{
+  std::vector<uint8_t> buffer(UUID_SIZE);
+  ESPRandom::uuid(buffer.data());
+  return buffer;
+}
+
+String ESPRandom::uuidToString(const uint8_t *buffer)
+{
+  char text[37];
+  snprintf(text, sizeof(text),
+           "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+           buffer[0], buffer[1], buffer[2], buffer[3], buffer[4], buffer[5], buffer[6], buffer[7],
+           buffer[8], buffer[9], buffer[10], buffer[11], buffer[12], buffer[13], buffer[14], buffer[15]);
+  return String(text);
+}
+
+String ESPRandom::uuidToString(const std::vector<uint8_t> &buffer)
+{
+  return ESPRandom::uuidToString(buffer.data());
+}
@@ -0,0 +1,25 @@
+/*
+  ESPRandom.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef ESPRandom_h
+#define ESPRandom_h
+
+#include <Arduino.h>
+#include <vector>
+
+/**
+ * @brief Host build stand-in for the ESPRandom library, on top of esp_random()
+ */
+class ESPRandom
+{
+public:
+  static std::vector<uint8_t> uuid(void);
+  static void uuid(uint8_t *buffer);
+  static String uuidToString(const uint8_t *buffer);
+  static String uuidToString(const std::vector<uint8_t> &buffer);
+};
+
+#endif
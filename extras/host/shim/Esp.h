@@ -0,0 +1,37 @@
+/*
+  Esp.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef Esp_h
+#define Esp_h
+
+#include <stdint.h>
+
+// Heap the host build pretends to have, what a WiFi connected ESP32 has free
+#ifndef ESP_HOST_HEAP_SIZE
+#define ESP_HOST_HEAP_SIZE 200000
+#endif
+
+/**
+ * @brief Host build stand-in for the ESP class
+ * The heap figures come from HeapModel: what the process allocated since
+ * the first call, OpenSSL left out, placed in a heap of the nominal size.
+ * getMaxAllocHeap() is the largest free block of that heap.
+ */
+class EspClass
+{
+public:
+  uint32_t getHeapSize(void);
+  uint32_t getFreeHeap(void);
+  uint32_t getMinFreeHeap(void);
+  uint32_t getMaxAllocHeap(void);
+  uint8_t getCpuFreqMHz(void);
+  uint64_t getEfuseMac(void);
+  void restart(void);
+};
+
+extern EspClass ESP;
+
+#endif
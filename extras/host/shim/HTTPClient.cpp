@@ -0,0 +1,931 @@
+/*
+  HTTPClient.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include <HTTPClient.h>
+#include <StreamString.h>
+#include <base64.h>
+
+HTTPClient::HTTPClient()
+    : _client(NULL),
+      _port(0),
+      _connectTimeout(-1),
+      _reuse(true),
+      _tcpTimeout(HTTPCLIENT_DEFAULT_TCP_TIMEOUT),
+      _useHTTP10(false),
+      _secure(false),
+      _uri(),
+      _protocol(),
+      _headers(),
+      _userAgent("ESP32HTTPClient"),
+      _base64Authorization(),
+      _currentHeaders(NULL),
+      _headerKeysCount(0),
+      _returnCode(0),
+      _size(-1),
+      _canReuse(false),
+      _transferEncoding(HTTPC_TE_IDENTITY)
+{
+}
+
+HTTPClient::~HTTPClient()
+{
+  if (this->_client != NULL)
+    this->_client->stop();
+  delete[] this->_currentHeaders;
+}
+
+void HTTPClient::clear()
+{
+  this->_returnCode = 0;
+  this->_size = -1;
+  this->_headers = "";
+}
+
+bool HTTPClient::begin(WiFiClient &client, String url)
+{
+  this->_client = &client;
+  int index = url.indexOf(':');
+  if (index < 0)
+    return false;
+  String protocol = url.substring(0, index);
+  if (protocol != "http" && protocol != "https")
+    return false;
+  this->_port = protocol == "https" ? 443 : 80;
+  this->_secure = protocol == "https";
+  return this->beginInternal(url, protocol.c_str());
+}
+
+bool HTTPClient::begin(WiFiClient &client, String host, uint16_t port, String uri, bool https)
+{
+  this->_client = &client;
+  this->clear();
+  this->_host = host;
+  this->_port = port;
+  this->_uri = uri;
+  this->_protocol = https ? "https" : "http";
+  this->_secure = https;
+  return true;
+}
+
+bool HTTPClient::beginInternal(String url, const char *expectedProtocol)
+{
+  this->clear();
+  int index = url.indexOf(':');
+  this->_protocol = url.substring(0, index);
+  url.remove(0, (index + 3)); // remove http:// or https://
+  if (this->_protocol != expectedProtocol)
+    return false;
+  index = url.indexOf('/');
+  String host = url.substring(0, index);
+  url.remove(0, index); // remove host part
+  index = host.indexOf('@');
+  if (index >= 0)
+  {
+    // auth info
+    String auth = host.substring(0, index);
+    host.remove(0, index + 1); // remove auth part including @
+    this->_base64Authorization = base64::encode(auth);
+  }
+  index = host.indexOf(':');
+  if (index >= 0)
+  {
+    this->_host = host.substring(0, index); // hostname
+    host.remove(0, (index + 1));            // remove hostname + :
+    this->_port = host.toInt();             // get port
+  }
+  else
+  {
+    this->_host = host;
+  }
+  this->_uri = url;
+  return true;
+}
+
+void HTTPClient::end(void)
+{
+  this->disconnect(false);
+  this->clear();
+}
+
+void HTTPClient::disconnect(bool preserveClient)
+{
+  if (this->connected())
+  {
+    while (this->_client->available() > 0)
+    {
+      this->_client->read();
+    }
+    if (this->_reuse && this->_canReuse)
+    {
+      log_d("tcp keep open for reuse");
+    }
+    else
+    {
+      log_d("tcp stop");
+      this->_client->stop();
+      if (!preserveClient)
+      {
+        this->_client = NULL;
+      }
+    }
+  }
+  else
+  {
+    log_d("tcp is closed");
+  }
+}
+
+bool HTTPClient::connected()
+{
+  if (this->_client != NULL)
+  {
+    return this->_client->available() > 0 || this->_client->connected();
+  }
+  return false;
+}
+
+void HTTPClient::setReuse(bool reuse)
+{
+  this->_reuse = reuse;
+}
+
+void HTTPClient::setUserAgent(const String &userAgent)
+{
+  this->_userAgent = userAgent;
+}
+
+void HTTPClient::setAuthorization(const char *user, const char *password)
+{
+  if (user != NULL && password != NULL)
+  {
+    String auth = user;
+    auth += ":";
+    auth += password;
+    this->_base64Authorization = base64::encode(auth);
+  }
+}
+
+void HTTPClient::setAuthorization(const char *auth)
+{
+  if (auth != NULL)
+  {
+    this->_base64Authorization = auth;
+  }
+}
+
+void HTTPClient::setConnectTimeout(int32_t connectTimeout)
+{
+  this->_connectTimeout = connectTimeout;
+}
+
+void HTTPClient::setTimeout(uint16_t timeout)
+{
+  this->_tcpTimeout = timeout;
+  if (this->connected())
+  {
+    this->_client->setTimeout((timeout + 500) / 1000);
+  }
+}
+
+void HTTPClient::useHTTP10(bool useHTTP10)
+{
+  this->_useHTTP10 = useHTTP10;
+}
+
+int HTTPClient::GET()
+{
+  return this->sendRequest("GET");
+}
+
+int HTTPClient::POST(uint8_t *payload, size_t size)
+{
+  return this->sendRequest("POST", payload, size);
+}
+
+int HTTPClient::POST(String payload)
+{
+  return this->POST((uint8_t *)payload.c_str(), payload.length());
+}
+
+int HTTPClient::PUT(uint8_t *payload, size_t size)
+{
+  return this->sendRequest("PUT", payload, size);
+}
+
+int HTTPClient::PUT(String payload)
+{
+  return this->PUT((uint8_t *)payload.c_str(), payload.length());
+}
+
+int HTTPClient::PATCH(uint8_t *payload, size_t size)
+{
+  return this->sendRequest("PATCH", payload, size);
+}
+
+int HTTPClient::PATCH(String payload)
+{
+  return this->PATCH((uint8_t *)payload.c_str(), payload.length());
+}
+
+int HTTPClient::sendRequest(const char *type, String payload)
+{
+  return this->sendRequest(type, (uint8_t *)payload.c_str(), payload.length());
+}
+
+int HTTPClient::sendRequest(const char *type, uint8_t *payload, size_t size)
+{
+  // connect to server
+  if (!this->connect())
+  {
+    return this->returnError(HTTPC_ERROR_CONNECTION_REFUSED);
+  }
+
+  if (payload && size > 0)
+  {
+    this->addHeader("Content-Length", String(size));
+  }
+
+  // send Header
+  if (!this->sendHeader(type))
+  {
+    return this->returnError(HTTPC_ERROR_SEND_HEADER_FAILED);
+  }
+
+  // send Payload if needed
+  if (payload && size > 0)
+  {
+    if (this->_client->write(&payload[0], size) != size)
+    {
+      return this->returnError(HTTPC_ERROR_SEND_PAYLOAD_FAILED);
+    }
+  }
+
+  // handle Server Response (Header)
+  return this->returnError(this->handleHeaderResponse());
+}
+
+int HTTPClient::sendRequest(const char *type, Stream *stream, size_t size)
+{
+  if (!stream)
+  {
+    return this->returnError(HTTPC_ERROR_NO_STREAM);
+  }
+
+  // connect to server
+  if (!this->connect())
+  {
+    return this->returnError(HTTPC_ERROR_CONNECTION_REFUSED);
+  }
+
+  if (size > 0)
+  {
+    this->addHeader("Content-Length", String(size));
+  }
+
+  // send Header
+  if (!this->sendHeader(type))
+  {
+    return this->returnError(HTTPC_ERROR_SEND_HEADER_FAILED);
+  }
+
+  int buff_size = HTTP_TCP_BUFFER_SIZE;
+  int len = size;
+  int bytesWritten = 0;
+  if (len == 0)
+  {
+    len = -1;
+  }
+
+  // if possible create smaller buffer then HTTP_TCP_BUFFER_SIZE
+  if ((len > 0) && (len < HTTP_TCP_BUFFER_SIZE))
+  {
+    buff_size = len;
+  }
+
+  // create buffer for read
+  uint8_t *buff = (uint8_t *)malloc(buff_size);
+  if (buff == NULL)
+  {
+    log_d("too less ram! need %d", buff_size);
+    return this->returnError(HTTPC_ERROR_TOO_LESS_RAM);
+  }
+
+  // read all data from stream and send it to server
+  while (this->connected() && (stream->available() > -1) && (len > 0 || len == -1))
+  {
+    // get available data size
+    int sizeAvailable = stream->available();
+    if (sizeAvailable)
+    {
+      int readBytes = sizeAvailable;
+      // read only the asked bytes
+      if (len > 0 && readBytes > len)
+      {
+        readBytes = len;
+      }
+      // not read more the buffer can handle
+      if (readBytes > buff_size)
+      {
+        readBytes = buff_size;
+      }
+      // read data
+      int bytesRead = stream->readBytes(buff, readBytes);
+      // write it to Stream
+      int bytesWrite = this->_client->write((const uint8_t *)buff, bytesRead);
+      bytesWritten += bytesWrite;
+      if (bytesWrite != bytesRead)
+      {
+        log_d("short write, asked for %d but got %d", bytesRead, bytesWrite);
+        free(buff);
+        return this->returnError(HTTPC_ERROR_SEND_PAYLOAD_FAILED);
+      }
+      // count bytes to read left
+      if (len > 0)
+      {
+        len -= readBytes;
+      }
+    }
+    else if (len == -1)
+    {
+      // an unsized stream ends when it has nothing left
+      break;
+    }
+    else
+    {
+      delay(1);
+    }
+  }
+  free(buff);
+
+  if (size && (int)size != bytesWritten)
+  {
+    log_d("Stream payload bytesWritten %d and size %d mismatch!", bytesWritten, size);
+    return this->returnError(HTTPC_ERROR_SEND_PAYLOAD_FAILED);
+  }
+
+  // handle Server Response (Header)
+  return this->returnError(this->handleHeaderResponse());
+}
+
+int HTTPClient::getSize(void)
+{
+  return this->_size;
+}
+
+WiFiClient &HTTPClient::getStream(void)
+{
+  return *this->_client;
+}
+
+WiFiClient *HTTPClient::getStreamPtr(void)
+{
+  if (this->connected())
+  {
+    return this->_client;
+  }
+  log_w("getStreamPtr: not connected");
+  return NULL;
+}
+
+int HTTPClient::writeToStream(Stream *stream)
+{
+  if (!stream)
+  {
+    return this->returnError(HTTPC_ERROR_NO_STREAM);
+  }
+
+  if (!this->connected())
+  {
+    return this->returnError(HTTPC_ERROR_NOT_CONNECTED);
+  }
+
+  // get length of document (is -1 when Server sends no Content-Length header)
+  int len = this->_size;
+  int ret = 0;
+
+  if (this->_transferEncoding == HTTPC_TE_IDENTITY)
+  {
+    ret = this->writeToStreamDataBlock(stream, len);
+
+    // have we an error?
+    if (ret < 0)
+    {
+      return this->returnError(ret);
+    }
+  }
+  else if (this->_transferEncoding == HTTPC_TE_CHUNKED)
+  {
+    int size = 0;
+    while (1)
+    {
+      if (!this->connected())
+      {
+        return this->returnError(HTTPC_ERROR_CONNECTION_LOST);
+      }
+      String chunkHeader = this->_client->readStringUntil('\n');
+
+      if (chunkHeader.length() <= 0)
+      {
+        return this->returnError(HTTPC_ERROR_READ_TIMEOUT);
+      }
+
+      chunkHeader.trim(); // remove \r
+
+      // read size of chunk
+      len = (uint32_t)strtol((const char *)chunkHeader.c_str(), NULL, 16);
+      size += len;
+      log_v(" read chunk len: %d", len);
+
+      // data left?
+      if (len > 0)
+      {
+        int r = this->writeToStreamDataBlock(stream, len);
+        if (r < 0)
+        {
+          // error in writeToStreamDataBlock
+          return this->returnError(r);
+        }
+        ret += r;
+      }
+      else
+      {
+        // if no length Header use global chunk size
+        if (this->_size <= 0)
+        {
+          this->_size = size;
+        }
+
+        // check if we have write all data out
+        if (ret != this->_size)
+        {
+          return this->returnError(HTTPC_ERROR_STREAM_WRITE);
+        }
+        break;
+      }
+
+      // read trailing \r\n at the end of the chunk
+      char buf[2];
+      auto trailing_seq_len = this->_client->readBytes((uint8_t *)buf, 2);
+      if (trailing_seq_len != 2 || buf[0] != '\r' || buf[1] != '\n')
+      {
+        return this->returnError(HTTPC_ERROR_READ_TIMEOUT);
+      }
+
+      delay(0);
+    }
+  }
+  else
+  {
+    return this->returnError(HTTPC_ERROR_ENCODING);
+  }
+
+  this->end();
+  return ret;
+}
+
+String HTTPClient::getString(void)
+{
+  StreamString sstring;
+
+  if (this->_size > 0)
+  {
+    // try to reserve needed memmory
+    if (!sstring.reserve((this->_size + 1)))
+    {
+      log_d("not enough memory to reserve a string! need: %d", (this->_size + 1));
+      return "";
+    }
+  }
+
+  this->writeToStream(&sstring);
+  return sstring;
+}
+
+String HTTPClient::errorToString(int error)
+{
+  switch (error)
+  {
+  case HTTPC_ERROR_CONNECTION_REFUSED:
+    return F("connection refused");
+  case HTTPC_ERROR_SEND_HEADER_FAILED:
+    return F("send header failed");
+  case HTTPC_ERROR_SEND_PAYLOAD_FAILED:
+    return F("send payload failed");
+  case HTTPC_ERROR_NOT_CONNECTED:
+    return F("not connected");
+  case HTTPC_ERROR_CONNECTION_LOST:
+    return F("connection lost");
+  case HTTPC_ERROR_NO_STREAM:
+    return F("no stream");
+  case HTTPC_ERROR_NO_HTTP_SERVER:
+    return F("no HTTP server");
+  case HTTPC_ERROR_TOO_LESS_RAM:
+    return F("too less ram");
+  case HTTPC_ERROR_ENCODING:
+    return F("Transfer-Encoding not supported");
+  case HTTPC_ERROR_STREAM_WRITE:
+    return F("Stream write error");
+  case HTTPC_ERROR_READ_TIMEOUT:
+    return F("read Timeout");
+  default:
+    return String();
+  }
+}
+
+void HTTPClient::addHeader(const String &name, const String &value, bool first, bool replace)
+{
+  // not allow set of Header handled by code
+  if (!name.equalsIgnoreCase(F("Connection")) &&
+      !name.equalsIgnoreCase(F("User-Agent")) &&
+      !name.equalsIgnoreCase(F("Host")) &&
+      !(name.equalsIgnoreCase(F("Authorization")) && this->_base64Authorization.length()))
+  {
+    String headerLine = name;
+    headerLine += ": ";
+
+    if (replace)
+    {
+      int headerStart = this->_headers.indexOf(headerLine);
+      if (headerStart != -1)
+      {
+        int headerEnd = this->_headers.indexOf('\n', headerStart);
+        this->_headers = this->_headers.substring(0, headerStart) + this->_headers.substring(headerEnd + 1);
+      }
+    }
+
+    headerLine += value;
+    headerLine += "\r\n";
+    if (first)
+    {
+      this->_headers = headerLine + this->_headers;
+    }
+    else
+    {
+      this->_headers += headerLine;
+    }
+  }
+}
+
+void HTTPClient::collectHeaders(const char *headerKeys[], const size_t headerKeysCount)
+{
+  this->_headerKeysCount = headerKeysCount;
+  delete[] this->_currentHeaders;
+  this->_currentHeaders = new RequestArgument[headerKeysCount];
+  for (size_t i = 0; i < headerKeysCount; i++)
+  {
+    this->_currentHeaders[i].key = headerKeys[i];
+  }
+}
+
+String HTTPClient::header(const char *name)
+{
+  for (size_t i = 0; i < this->_headerKeysCount; ++i)
+  {
+    if (this->_currentHeaders[i].key == name)
+    {
+      return this->_currentHeaders[i].value;
+    }
+  }
+  return String();
+}
+
+String HTTPClient::header(size_t i)
+{
+  if (i < this->_headerKeysCount)
+  {
+    return this->_currentHeaders[i].value;
+  }
+  return String();
+}
+
+String HTTPClient::headerName(size_t i)
+{
+  if (i < this->_headerKeysCount)
+  {
+    return this->_currentHeaders[i].key;
+  }
+  return String();
+}
+
+int HTTPClient::headers()
+{
+  return this->_headerKeysCount;
+}
+
+bool HTTPClient::hasHeader(const char *name)
+{
+  for (size_t i = 0; i < this->_headerKeysCount; ++i)
+  {
+    if ((this->_currentHeaders[i].key == name) && (this->_currentHeaders[i].value.length() > 0))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool HTTPClient::connect(void)
+{
+  if (this->connected())
+  {
+    if (this->_reuse)
+    {
+      log_d("already connected, try reuse!");
+    }
+    while (this->_client->available() > 0)
+    {
+      this->_client->read();
+    }
+    return true;
+  }
+
+  if (this->_client == NULL)
+  {
+    log_d("HTTPClient::begin was not called or returned error");
+    return false;
+  }
+
+  if (!this->_client->connect(this->_host.c_str(), this->_port, this->_connectTimeout))
+  {
+    log_d("failed connect to %s:%u", this->_host.c_str(), this->_port);
+    return false;
+  }
+
+  // set Timeout for WiFiClient and for Stream::readBytesUntil() and Stream::readStringUntil()
+  this->_client->setTimeout((this->_tcpTimeout + 500) / 1000);
+
+  log_d(" connected to %s:%u", this->_host.c_str(), this->_port);
+
+  return this->connected();
+}
+
+bool HTTPClient::sendHeader(const char *type)
+{
+  if (!this->connected())
+  {
+    return false;
+  }
+
+  String header = String(type) + " " + (this->_uri.length() ? this->_uri : F("/")) + F(" HTTP/1.");
+
+  if (this->_useHTTP10)
+  {
+    header += "0";
+  }
+  else
+  {
+    header += "1";
+  }
+
+  header += String(F("\r\nHost: ")) + this->_host;
+  if (this->_port != 80 && this->_port != 443)
+  {
+    header += ':';
+    header += String(this->_port);
+  }
+  header += String(F("\r\nUser-Agent: ")) + this->_userAgent +
+            F("\r\nConnection: ");
+
+  if (this->_reuse)
+  {
+    header += F("keep-alive");
+  }
+  else
+  {
+    header += F("close");
+  }
+  header += "\r\n";
+
+  if (!this->_useHTTP10)
+  {
+    header += F("Accept-Encoding: identity;q=1,chunked;q=0.1,*;q=0\r\n");
+  }
+
+  if (this->_base64Authorization.length())
+  {
+    this->_base64Authorization.replace("\n", "");
+    header += F("Authorization: Basic ");
+    header += this->_base64Authorization;
+    header += "\r\n";
+  }
+
+  header += this->_headers + "\r\n";
+
+  return (this->_client->write((const uint8_t *)header.c_str(), header.length()) == header.length());
+}
+
+int HTTPClient::handleHeaderResponse()
+{
+  if (!this->connected())
+  {
+    return HTTPC_ERROR_NOT_CONNECTED;
+  }
+
+  this->_canReuse = this->_reuse;
+
+  String transferEncoding;
+
+  this->_transferEncoding = HTTPC_TE_IDENTITY;
+  unsigned long lastDataTime = millis();
+
+  while (this->connected())
+  {
+    size_t len = this->_client->available();
+    if (len > 0)
+    {
+      String headerLine = this->_client->readStringUntil('\n');
+      headerLine.trim(); // remove \r
+
+      lastDataTime = millis();
+
+      log_v("RX: '%s'", headerLine.c_str());
+
+      if (headerLine.startsWith("HTTP/1."))
+      {
+        if (this->_canReuse)
+        {
+          this->_canReuse = (headerLine[sizeof "HTTP/1." - 1] != '0');
+        }
+        this->_returnCode = headerLine.substring(9, headerLine.indexOf(' ', 9)).toInt();
+      }
+      else if (headerLine.indexOf(':'))
+      {
+        String headerName = headerLine.substring(0, headerLine.indexOf(':'));
+        String headerValue = headerLine.substring(headerLine.indexOf(':') + 1);
+        headerValue.trim();
+
+        if (headerName.equalsIgnoreCase("Content-Length"))
+        {
+          this->_size = headerValue.toInt();
+        }
+
+        if (this->_canReuse && headerName.equalsIgnoreCase("Connection"))
+        {
+          if (headerValue.indexOf("close") >= 0 && headerValue.indexOf("keep-alive") < 0)
+          {
+            this->_canReuse = false;
+          }
+        }
+
+        if (headerName.equalsIgnoreCase("Transfer-Encoding"))
+        {
+          transferEncoding = headerValue;
+        }
+
+        for (size_t i = 0; i < this->_headerKeysCount; i++)
+        {
+          if (this->_currentHeaders[i].key.equalsIgnoreCase(headerName))
+          {
+            this->_currentHeaders[i].value = headerValue;
+            break;
+          }
+        }
+      }
+
+      if (headerLine == "")
+      {
+        log_d("code: %d", this->_returnCode);
+
+        if (this->_size > 0)
+        {
+          log_d("size: %d", this->_size);
+        }
+
+        if (transferEncoding.length() > 0)
+        {
+          log_d("Transfer-Encoding: %s", transferEncoding.c_str());
+          if (transferEncoding.equalsIgnoreCase("chunked"))
+          {
+            this->_transferEncoding = HTTPC_TE_CHUNKED;
+          }
+          else
+          {
+            return HTTPC_ERROR_ENCODING;
+          }
+        }
+        else
+        {
+          this->_transferEncoding = HTTPC_TE_IDENTITY;
+        }
+
+        if (this->_returnCode)
+        {
+          return this->_returnCode;
+        }
+        else
+        {
+          log_d("Remote host is not an HTTP Server!");
+          return HTTPC_ERROR_NO_HTTP_SERVER;
+        }
+      }
+    }
+    else
+    {
+      uint32_t elapsed = millis() - lastDataTime;
+      if (elapsed > this->_tcpTimeout)
+      {
+        return HTTPC_ERROR_READ_TIMEOUT;
+      }
+      // The core sleeps 10 ms here, waiting on the socket keeps host timings tight
+      this->_client->waitAvailable(this->_tcpTimeout - elapsed);
+    }
+  }
+
+  return HTTPC_ERROR_CONNECTION_LOST;
+}
+
+int HTTPClient::writeToStreamDataBlock(Stream *stream, int size)
+{
+  int buff_size = HTTP_TCP_BUFFER_SIZE;
+  int len = size;
+  int bytesWritten = 0;
+
+  // if possible create smaller buffer then HTTP_TCP_BUFFER_SIZE
+  if ((len > 0) && (len < HTTP_TCP_BUFFER_SIZE))
+  {
+    buff_size = len;
+  }
+
+  // create buffer for read
+  uint8_t *buff = (uint8_t *)malloc(buff_size);
+  if (buff == NULL)
+  {
+    log_w("too less ram! need %d", HTTP_TCP_BUFFER_SIZE);
+    return HTTPC_ERROR_TOO_LESS_RAM;
+  }
+
+  // read all data from server
+  while (this->connected() && (len > 0 || len == -1))
+  {
+    // get available data size
+    size_t sizeAvailable = this->_client->available();
+
+    if (sizeAvailable)
+    {
+      int readBytes = sizeAvailable;
+
+      // read only the asked bytes
+      if (len > 0 && readBytes > len)
+      {
+        readBytes = len;
+      }
+
+      // not read more the buffer can handle
+      if (readBytes > buff_size)
+      {
+        readBytes = buff_size;
+      }
+
+      // read data
+      int bytesRead = this->_client->readBytes(buff, readBytes);
+
+      // write it to Stream
+      int bytesWrite = stream->write(buff, bytesRead);
+      bytesWritten += bytesWrite;
+
+      // are all Bytes a writen to stream ?
+      if (bytesWrite != bytesRead)
+      {
+        log_w("short write asked for %d but got %d", bytesRead, bytesWrite);
+        free(buff);
+        return HTTPC_ERROR_STREAM_WRITE;
+      }
+
+      // count bytes to read left
+      if (len > 0)
+      {
+        len -= readBytes;
+      }
+    }
+    else
+    {
+      this->_client->waitAvailable(1);
+    }
+  }
+
+  free(buff);
+
+  if ((size > 0) && (size != bytesWritten))
+  {
+    log_d("bytesWritten %d and size %d mismatch!", bytesWritten, size);
+    return HTTPC_ERROR_STREAM_WRITE;
+  }
+
+  return bytesWritten;
+}
+
+int HTTPClient::returnError(int error)
+{
+  if (error < 0)
+  {
+    log_w("error(%d): %s", error, errorToString(error).c_str());
+    if (this->connected())
+    {
+      log_d("tcp stop");
+      this->_client->stop();
+    }
+  }
+  return error;
+}
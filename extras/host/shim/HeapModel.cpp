@@ -0,0 +1,343 @@
+/*
+  HeapModel.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "HeapModel.h"
+#include <atomic>
+#include <errno.h>
+#include <malloc.h>
+#include <mutex>
+#include <openssl/crypto.h>
+#include <stdint.h>
+#include <string.h>
+
+// Block layout of multi_heap: a 4 byte header, 4 byte alignment, and a free
+// block needs room for the header and the next free pointer
+#define HEAP_MODEL_HEADER 4
+#define HEAP_MODEL_ALIGNMENT 4
+#define HEAP_MODEL_MIN_BLOCK 8
+// Far more blocks than fit the nominal heap, the table is never crowded
+#define HEAP_MODEL_SLOTS 65536
+#define HEAP_MODEL_RANGES 32768
+#define HEAP_MODEL_OUTSIDE UINT32_MAX
+
+/**
+ * @brief A live allocation, offset HEAP_MODEL_OUTSIDE when it did not fit
+ */
+struct ModelBlock
+{
+  const void *ptr;
+  uint32_t offset;
+  uint32_t size;
+};
+
+struct FreeRange
+{
+  uint32_t offset;
+  uint32_t size;
+};
+
+// Nothing in here may allocate, it runs inside malloc and free
+static std::mutex modelLock;
+static std::atomic<bool> modelRunning(false);
+static ModelBlock blocks[HEAP_MODEL_SLOTS];
+static size_t blockCount = 0;
+static FreeRange ranges[HEAP_MODEL_RANGES];
+static size_t rangeCount = 0;
+static size_t freeBytes = 0;
+static size_t outsideBytes = 0;
+static size_t allocations = 0;
+static thread_local bool inTls = false;
+
+static size_t slotOf(const void *ptr)
+{
+  return (((uintptr_t)ptr >> 4) * 0x9E3779B1u) & (HEAP_MODEL_SLOTS - 1);
+}
+
+static ModelBlock *findBlock(const void *ptr)
+{
+  for (size_t i = slotOf(ptr);; i = (i + 1) & (HEAP_MODEL_SLOTS - 1))
+  {
+    if (blocks[i].ptr == ptr)
+      return &blocks[i];
+    if (blocks[i].ptr == NULL)
+      return NULL;
+  }
+}
+
+static void insertBlock(const void *ptr, uint32_t offset, uint32_t size)
+{
+  if (blockCount >= HEAP_MODEL_SLOTS / 2)
+    return;
+  size_t i = slotOf(ptr);
+  while (blocks[i].ptr != NULL)
+    i = (i + 1) & (HEAP_MODEL_SLOTS - 1);
+  blocks[i] = {ptr, offset, size};
+  blockCount++;
+}
+
+/**
+ * @brief Empties a slot, moving later entries of the probe sequence back
+ */
+static void removeBlock(ModelBlock *block)
+{
+  size_t i = block - blocks;
+  size_t j = i;
+  for (;;)
+  {
+    blocks[i].ptr = NULL;
+    for (;;)
+    {
+      j = (j + 1) & (HEAP_MODEL_SLOTS - 1);
+      if (blocks[j].ptr == NULL)
+      {
+        blockCount--;
+        return;
+      }
+      size_t k = slotOf(blocks[j].ptr);
+      bool stays = i <= j ? (i < k && k <= j) : (i < k || k <= j);
+      if (!stays)
+        break;
+    }
+    blocks[i] = blocks[j];
+    i = j;
+  }
+}
+
+static void place(const void *ptr, size_t size)
+{
+  size_t needed = (size + HEAP_MODEL_ALIGNMENT - 1) & ~(size_t)(HEAP_MODEL_ALIGNMENT - 1);
+  needed = needed + HEAP_MODEL_HEADER < HEAP_MODEL_MIN_BLOCK ? HEAP_MODEL_MIN_BLOCK : needed + HEAP_MODEL_HEADER;
+  allocations++;
+  size_t best = rangeCount;
+  for (size_t i = 0; i < rangeCount; i++)
+  {
+    if (ranges[i].size >= needed && (best == rangeCount || ranges[i].size < ranges[best].size))
+    {
+      best = i;
+      if (ranges[i].size == needed)
+        break;
+    }
+  }
+  if (best == rangeCount)
+  {
+    outsideBytes += needed;
+    insertBlock(ptr, HEAP_MODEL_OUTSIDE, needed);
+    return;
+  }
+  uint32_t offset = ranges[best].offset;
+  if (ranges[best].size - needed < HEAP_MODEL_MIN_BLOCK)
+  {
+    // The rest could not hold a block, it goes with this one
+    needed = ranges[best].size;
+    memmove(&ranges[best], &ranges[best + 1], (rangeCount - best - 1) * sizeof(FreeRange));
+    rangeCount--;
+  }
+  else
+  {
+    ranges[best].offset += needed;
+    ranges[best].size -= needed;
+  }
+  freeBytes -= needed;
+  insertBlock(ptr, offset, needed);
+}
+
+static void release(const void *ptr)
+{
+  // realloc(NULL, size) releases nothing, NULL also marks empty slots
+  ModelBlock *block = ptr != NULL ? findBlock(ptr) : NULL;
+  if (block == NULL)
+    return;
+  uint32_t offset = block->offset;
+  uint32_t size = block->size;
+  removeBlock(block);
+  if (offset == HEAP_MODEL_OUTSIDE)
+  {
+    outsideBytes -= size;
+    return;
+  }
+  freeBytes += size;
+  size_t lower = 0;
+  size_t upper = rangeCount;
+  while (lower < upper)
+  {
+    size_t middle = (lower + upper) / 2;
+    if (ranges[middle].offset < offset)
+      lower = middle + 1;
+    else
+      upper = middle;
+  }
+  bool joinsPrevious = lower > 0 && ranges[lower - 1].offset + ranges[lower - 1].size == offset;
+  bool joinsNext = lower < rangeCount && offset + size == ranges[lower].offset;
+  if (joinsPrevious && joinsNext)
+  {
+    ranges[lower - 1].size += size + ranges[lower].size;
+    memmove(&ranges[lower], &ranges[lower + 1], (rangeCount - lower - 1) * sizeof(FreeRange));
+    rangeCount--;
+  }
+  else if (joinsPrevious)
+  {
+    ranges[lower - 1].size += size;
+  }
+  else if (joinsNext)
+  {
+    ranges[lower].offset = offset;
+    ranges[lower].size += size;
+  }
+  else if (rangeCount < HEAP_MODEL_RANGES)
+  {
+    memmove(&ranges[lower + 1], &ranges[lower], (rangeCount - lower) * sizeof(FreeRange));
+    ranges[lower] = {offset, size};
+    rangeCount++;
+  }
+}
+
+static bool isModelled(void)
+{
+  return modelRunning.load(std::memory_order_relaxed) && !inTls;
+}
+
+bool HeapModel::begin(size_t size)
+{
+  std::lock_guard<std::mutex> lock(modelLock);
+  if (modelRunning)
+    return false;
+  ranges[0] = {0, (uint32_t)size};
+  rangeCount = 1;
+  freeBytes = size;
+  modelRunning = true;
+  return true;
+}
+
+size_t HeapModel::getFree(void)
+{
+  std::lock_guard<std::mutex> lock(modelLock);
+  return freeBytes > outsideBytes ? freeBytes - outsideBytes : 0;
+}
+
+size_t HeapModel::getLargestFree(void)
+{
+  std::lock_guard<std::mutex> lock(modelLock);
+  size_t largest = 0;
+  for (size_t i = 0; i < rangeCount; i++)
+  {
+    if (ranges[i].size > largest)
+      largest = ranges[i].size;
+  }
+  return largest > HEAP_MODEL_HEADER ? largest - HEAP_MODEL_HEADER : 0;
+}
+
+size_t HeapModel::getBlocks(void)
+{
+  std::lock_guard<std::mutex> lock(modelLock);
+  return blockCount;
+}
+
+size_t HeapModel::getAllocations(void)
+{
+  std::lock_guard<std::mutex> lock(modelLock);
+  return allocations;
+}
+
+#ifndef __SANITIZE_ADDRESS__
+extern "C"
+{
+  void *__libc_malloc(size_t size);
+  void *__libc_calloc(size_t count, size_t size);
+  void *__libc_realloc(void *ptr, size_t size);
+  void *__libc_memalign(size_t alignment, size_t size);
+  void __libc_free(void *ptr);
+
+  void *malloc(size_t size)
+  {
+    void *ptr = __libc_malloc(size);
+    if (ptr != NULL && isModelled())
+    {
+      std::lock_guard<std::mutex> lock(modelLock);
+      place(ptr, size);
+    }
+    return ptr;
+  }
+
+  void *calloc(size_t count, size_t size)
+  {
+    void *ptr = __libc_calloc(count, size);
+    if (ptr != NULL && isModelled())
+    {
+      std::lock_guard<std::mutex> lock(modelLock);
+      place(ptr, count * size);
+    }
+    return ptr;
+  }
+
+  void *realloc(void *ptr, size_t size)
+  {
+    void *resized = __libc_realloc(ptr, size);
+    if ((resized != NULL || size == 0) && isModelled())
+    {
+      std::lock_guard<std::mutex> lock(modelLock);
+      release(ptr);
+      if (resized != NULL)
+        place(resized, size);
+    }
+    return resized;
+  }
+
+  void *memalign(size_t alignment, size_t size)
+  {
+    void *ptr = __libc_memalign(alignment, size);
+    if (ptr != NULL && isModelled())
+    {
+      std::lock_guard<std::mutex> lock(modelLock);
+      place(ptr, size);
+    }
+    return ptr;
+  }
+
+  void *aligned_alloc(size_t alignment, size_t size)
+  {
+    return memalign(alignment, size);
+  }
+
+  int posix_memalign(void **ptr, size_t alignment, size_t size)
+  {
+    *ptr = memalign(alignment, size);
+    return *ptr != NULL ? 0 : ENOMEM;
+  }
+
+  void free(void *ptr)
+  {
+    if (ptr != NULL && modelRunning.load(std::memory_order_relaxed))
+    {
+      std::lock_guard<std::mutex> lock(modelLock);
+      release(ptr);
+    }
+    __libc_free(ptr);
+  }
+}
+#endif
+
+// OpenSSL allocates through these, its blocks are not placed in the model
+static void *tlsMalloc(size_t size, const char *file, int line)
+{
+  inTls = true;
+  void *ptr = malloc(size);
+  inTls = false;
+  return ptr;
+}
+
+static void *tlsRealloc(void *ptr, size_t size, const char *file, int line)
+{
+  inTls = true;
+  void *resized = realloc(ptr, size);
+  inTls = false;
+  return resized;
+}
+
+static void tlsFree(void *ptr, const char *file, int line)
+{
+  free(ptr);
+}
+
+static const bool tlsHandlersSet = CRYPTO_set_mem_functions(tlsMalloc, tlsRealloc, tlsFree) == 1;
@@ -0,0 +1,54 @@
+/*
+  HeapModel.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef HeapModel_h
+#define HeapModel_h
+
+#include <stddef.h>
+
+/**
+ * @brief Where the ESP32 would place the allocations of the sketch
+ * The shim's malloc hands out host memory as usual and also places every
+ * allocation made after begin() in a model of the board's heap: one region
+ * of the nominal size, a 4 byte header per block and best fit, like
+ * multi_heap of ESP-IDF 3. OpenSSL's allocations are left out, TLS runs in
+ * mbedTLS on the ESP32. The largest free block of the model shows the
+ * fragmentation the same allocations would cause on the board.
+ * Sanitizer builds keep their own malloc, the model stays empty there.
+ */
+class HeapModel
+{
+public:
+  /**
+   * @brief Starts placing allocations, the ones before are not counted
+   *
+   * @param size Nominal heap size in bytes
+   * @return bool false when it was already started
+   */
+  static bool begin(size_t size);
+
+  /**
+   * @brief Free bytes, headers and allocations that did not fit deducted
+   */
+  static size_t getFree(void);
+
+  /**
+   * @brief Largest block that could be allocated
+   */
+  static size_t getLargestFree(void);
+
+  /**
+   * @brief Number of live blocks
+   */
+  static size_t getBlocks(void);
+
+  /**
+   * @brief Allocations placed since begin(), a realloc counts as one
+   */
+  static size_t getAllocations(void);
+};
+
+#endif
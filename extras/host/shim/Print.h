@@ -0,0 +1,13 @@
+/*
+  Print.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef Print_h
+#define Print_h
+
+// ArduinoJson includes the core headers one by one, Print lives in Arduino.h
+#include <Arduino.h>
+
+#endif
@@ -0,0 +1,13 @@
+/*
+  Stream.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef Stream_h
+#define Stream_h
+
+// ArduinoJson includes the core headers one by one, Stream lives in Arduino.h
+#include <Arduino.h>
+
+#endif
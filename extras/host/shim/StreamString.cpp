@@ -0,0 +1,57 @@
+/*
+  StreamString.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include <StreamString.h>
+
+size_t StreamString::write(const uint8_t *data, size_t size)
+{
+  if (size && data)
+  {
+    const unsigned int newlen = this->length() + size;
+    if (this->reserve(newlen + 1))
+    {
+      memcpy((void *)(this->_buffer + this->length()), (const void *)data, size);
+      this->_length = newlen;
+      this->_buffer[newlen] = 0x00; // add null for string end
+      return size;
+    }
+  }
+  return 0;
+}
+
+size_t StreamString::write(uint8_t data)
+{
+  return this->concat((char)data);
+}
+
+int StreamString::available()
+{
+  return this->length();
+}
+
+int StreamString::read()
+{
+  if (this->length())
+  {
+    char c = this->charAt(0);
+    this->remove(0, 1);
+    return c;
+  }
+  return -1;
+}
+
+int StreamString::peek()
+{
+  if (this->length())
+  {
+    char c = this->charAt(0);
+    return c;
+  }
+  return -1;
+}
+
+void StreamString::flush()
+{
+}
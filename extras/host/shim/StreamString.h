@@ -0,0 +1,27 @@
+/*
+  StreamString.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef StreamString_h
+#define StreamString_h
+
+#include <Arduino.h>
+
+/**
+ * @brief Host build stand-in for the core's StreamString, a String written to as a Stream
+ */
+class StreamString : public Stream, public String
+{
+public:
+  size_t write(const uint8_t *buffer, size_t size) override;
+  size_t write(uint8_t data) override;
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  void flush() override;
+};
+
+#endif
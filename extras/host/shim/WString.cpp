@@ -0,0 +1,710 @@
+/*
+  WString.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include <Arduino.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static void formatUnsigned(unsigned long long value, unsigned char base, char *text)
+{
+  char digits[66];
+  int count = 0;
+  if (base < 2 || base > 36)
+    base = 10;
+  do
+  {
+    int digit = value % base;
+    digits[count++] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+    value /= base;
+  } while (value > 0);
+  while (count > 0)
+    *text++ = digits[--count];
+  *text = '\0';
+}
+
+static void formatSigned(long long value, unsigned char base, char *text)
+{
+  if (value < 0 && base == 10)
+  {
+    *text++ = '-';
+    formatUnsigned(-(unsigned long long)value, base, text);
+  }
+  else
+    formatUnsigned((unsigned long long)value, base, text);
+}
+
+String::String(const char *cstr)
+{
+  this->init();
+  if (cstr != NULL)
+    this->copy(cstr, strlen(cstr));
+}
+
+String::String(const String &value)
+{
+  this->init();
+  *this = value;
+}
+
+String::String(String &&rval)
+{
+  this->init();
+  this->move(rval);
+}
+
+String::String(char c)
+{
+  this->init();
+  char text[2] = {c, '\0'};
+  *this = text;
+}
+
+String::String(unsigned char value, unsigned char base)
+{
+  this->init();
+  char text[66];
+  formatUnsigned(value, base, text);
+  *this = text;
+}
+
+String::String(int value, unsigned char base)
+{
+  this->init();
+  char text[67];
+  formatSigned(value, base, text);
+  *this = text;
+}
+
+String::String(unsigned int value, unsigned char base)
+{
+  this->init();
+  char text[66];
+  formatUnsigned(value, base, text);
+  *this = text;
+}
+
+String::String(long value, unsigned char base)
+{
+  this->init();
+  char text[67];
+  formatSigned(value, base, text);
+  *this = text;
+}
+
+String::String(unsigned long value, unsigned char base)
+{
+  this->init();
+  char text[66];
+  formatUnsigned(value, base, text);
+  *this = text;
+}
+
+String::String(long long value, unsigned char base)
+{
+  this->init();
+  char text[67];
+  formatSigned(value, base, text);
+  *this = text;
+}
+
+String::String(unsigned long long value, unsigned char base)
+{
+  this->init();
+  char text[66];
+  formatUnsigned(value, base, text);
+  *this = text;
+}
+
+String::String(float value, unsigned char decimalPlaces)
+{
+  this->init();
+  char text[33];
+  *this = dtostrf(value, decimalPlaces + 2, decimalPlaces, text);
+}
+
+String::String(double value, unsigned char decimalPlaces)
+{
+  this->init();
+  char text[33];
+  *this = dtostrf(value, decimalPlaces + 2, decimalPlaces, text);
+}
+
+String::~String(void)
+{
+  free(this->_buffer);
+}
+
+void String::init(void)
+{
+  this->_buffer = NULL;
+  this->_capacity = 0;
+  this->_length = 0;
+}
+
+void String::invalidate(void)
+{
+  free(this->_buffer);
+  this->init();
+}
+
+unsigned char String::reserve(unsigned int size)
+{
+  if (this->_buffer != NULL && this->_capacity >= size)
+    return 1;
+  if (this->changeBuffer(size))
+  {
+    if (this->_length == 0)
+      this->_buffer[0] = '\0';
+    return 1;
+  }
+  return 0;
+}
+
+unsigned char String::changeBuffer(unsigned int maxStrLen)
+{
+  char *buffer = (char *)realloc(this->_buffer, maxStrLen + 1);
+  if (buffer == NULL)
+    return 0;
+  this->_buffer = buffer;
+  this->_capacity = maxStrLen;
+  return 1;
+}
+
+String &String::copy(const char *cstr, unsigned int length)
+{
+  if (!this->reserve(length))
+  {
+    this->invalidate();
+    return *this;
+  }
+  this->_length = length;
+  memmove(this->_buffer, cstr, length);
+  this->_buffer[length] = '\0';
+  return *this;
+}
+
+void String::move(String &rhs)
+{
+  if (this == &rhs)
+    return;
+  free(this->_buffer);
+  this->_buffer = rhs._buffer;
+  this->_capacity = rhs._capacity;
+  this->_length = rhs._length;
+  rhs.init();
+}
+
+String &String::operator=(const String &rhs)
+{
+  if (this == &rhs)
+    return *this;
+  if (rhs._buffer != NULL)
+    this->copy(rhs._buffer, rhs._length);
+  else
+    this->invalidate();
+  return *this;
+}
+
+String &String::operator=(String &&rval)
+{
+  this->move(rval);
+  return *this;
+}
+
+String &String::operator=(StringSumHelper &&rval)
+{
+  this->move(rval);
+  return *this;
+}
+
+String &String::operator=(const char *cstr)
+{
+  if (cstr != NULL)
+    this->copy(cstr, strlen(cstr));
+  else
+    this->invalidate();
+  return *this;
+}
+
+unsigned char String::concat(const String &s)
+{
+  // Concatenating a string to itself needs a copy of the source first
+  if (&s == this)
+  {
+    unsigned int length = this->_length;
+    if (length == 0)
+      return 1;
+    if (!this->reserve(length * 2))
+      return 0;
+    memcpy(this->_buffer + length, this->_buffer, length);
+    this->_length = length * 2;
+    this->_buffer[this->_length] = '\0';
+    return 1;
+  }
+  return this->concat(s.c_str(), s._length);
+}
+
+unsigned char String::concat(const char *cstr, unsigned int length)
+{
+  unsigned int newLength = this->_length + length;
+  if (cstr == NULL)
+    return 0;
+  if (length == 0)
+    return 1;
+  if (!this->reserve(newLength))
+    return 0;
+  memcpy(this->_buffer + this->_length, cstr, length);
+  this->_length = newLength;
+  this->_buffer[newLength] = '\0';
+  return 1;
+}
+
+unsigned char String::concat(const char *cstr)
+{
+  if (cstr == NULL)
+    return 0;
+  return this->concat(cstr, strlen(cstr));
+}
+
+unsigned char String::concat(char c)
+{
+  return this->concat(&c, 1);
+}
+
+unsigned char String::concat(unsigned char num)
+{
+  char text[4];
+  formatUnsigned(num, 10, text);
+  return this->concat(text);
+}
+
+unsigned char String::concat(int num)
+{
+  char text[12];
+  formatSigned(num, 10, text);
+  return this->concat(text);
+}
+
+unsigned char String::concat(unsigned int num)
+{
+  char text[11];
+  formatUnsigned(num, 10, text);
+  return this->concat(text);
+}
+
+unsigned char String::concat(long num)
+{
+  char text[21];
+  formatSigned(num, 10, text);
+  return this->concat(text);
+}
+
+unsigned char String::concat(unsigned long num)
+{
+  char text[21];
+  formatUnsigned(num, 10, text);
+  return this->concat(text);
+}
+
+unsigned char String::concat(long long num)
+{
+  char text[21];
+  formatSigned(num, 10, text);
+  return this->concat(text);
+}
+
+unsigned char String::concat(unsigned long long num)
+{
+  char text[21];
+  formatUnsigned(num, 10, text);
+  return this->concat(text);
+}
+
+unsigned char String::concat(float num)
+{
+  char text[33];
+  return this->concat(dtostrf(num, 4, 2, text));
+}
+
+unsigned char String::concat(double num)
+{
+  char text[33];
+  return this->concat(dtostrf(num, 4, 2, text));
+}
+
+StringSumHelper &operator+(const StringSumHelper &lhs, const String &rhs)
+{
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  if (!a.concat(rhs.c_str(), rhs.length()))
+    a.invalidate();
+  return a;
+}
+
+StringSumHelper &operator+(const StringSumHelper &lhs, const char *cstr)
+{
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  if (cstr == NULL || !a.concat(cstr, strlen(cstr)))
+    a.invalidate();
+  return a;
+}
+
+StringSumHelper &operator+(const StringSumHelper &lhs, char c)
+{
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  if (!a.concat(c))
+    a.invalidate();
+  return a;
+}
+
+StringSumHelper &operator+(const StringSumHelper &lhs, unsigned char num)
+{
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  if (!a.concat(num))
+    a.invalidate();
+  return a;
+}
+
+StringSumHelper &operator+(const StringSumHelper &lhs, int num)
+{
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  if (!a.concat(num))
+    a.invalidate();
+  return a;
+}
+
+StringSumHelper &operator+(const StringSumHelper &lhs, unsigned int num)
+{
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  if (!a.concat(num))
+    a.invalidate();
+  return a;
+}
+
+StringSumHelper &operator+(const StringSumHelper &lhs, long num)
+{
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  if (!a.concat(num))
+    a.invalidate();
+  return a;
+}
+
+StringSumHelper &operator+(const StringSumHelper &lhs, unsigned long num)
+{
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  if (!a.concat(num))
+    a.invalidate();
+  return a;
+}
+
+StringSumHelper &operator+(const StringSumHelper &lhs, float num)
+{
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  if (!a.concat(num))
+    a.invalidate();
+  return a;
+}
+
+StringSumHelper &operator+(const StringSumHelper &lhs, double num)
+{
+  StringSumHelper &a = const_cast<StringSumHelper &>(lhs);
+  if (!a.concat(num))
+    a.invalidate();
+  return a;
+}
+
+int String::compareTo(const String &s) const
+{
+  if (this->_buffer == NULL || s._buffer == NULL)
+  {
+    if (s._buffer != NULL && s._length > 0)
+      return 0 - *(unsigned char *)s._buffer;
+    if (this->_buffer != NULL && this->_length > 0)
+      return *(unsigned char *)this->_buffer;
+    return 0;
+  }
+  return strcmp(this->_buffer, s._buffer);
+}
+
+unsigned char String::equals(const String &s2) const
+{
+  return this->length() == s2.length() && this->compareTo(s2) == 0;
+}
+
+unsigned char String::equals(const char *cstr) const
+{
+  if (this->length() == 0)
+    return cstr == NULL || *cstr == 0;
+  if (cstr == NULL)
+    return this->_buffer[0] == 0;
+  return strcmp(this->_buffer, cstr) == 0;
+}
+
+unsigned char String::equalsIgnoreCase(const String &s2) const
+{
+  if (this == &s2)
+    return 1;
+  if (this->length() != s2.length())
+    return 0;
+  if (this->length() == 0)
+    return 1;
+  const char *p1 = this->_buffer;
+  const char *p2 = s2._buffer;
+  while (*p1)
+  {
+    if (tolower(*p1++) != tolower(*p2++))
+      return 0;
+  }
+  return 1;
+}
+
+unsigned char String::startsWith(const String &s2) const
+{
+  if (this->length() < s2.length())
+    return 0;
+  return this->startsWith(s2, 0);
+}
+
+unsigned char String::startsWith(const String &s2, unsigned int offset) const
+{
+  if (offset > this->length() - s2.length() || this->_buffer == NULL || s2._buffer == NULL)
+    return 0;
+  return strncmp(&this->_buffer[offset], s2._buffer, s2.length()) == 0;
+}
+
+unsigned char String::endsWith(const String &s2) const
+{
+  if (this->length() < s2.length() || this->_buffer == NULL || s2._buffer == NULL)
+    return 0;
+  return strcmp(&this->_buffer[this->length() - s2.length()], s2._buffer) == 0;
+}
+
+char String::charAt(unsigned int index) const
+{
+  return (*this)[index];
+}
+
+void String::setCharAt(unsigned int index, char c)
+{
+  if (index < this->length())
+    this->_buffer[index] = c;
+}
+
+char &String::operator[](unsigned int index)
+{
+  static char dummy_writable_char;
+  if (index >= this->length() || this->_buffer == NULL)
+  {
+    dummy_writable_char = 0;
+    return dummy_writable_char;
+  }
+  return this->_buffer[index];
+}
+
+char String::operator[](unsigned int index) const
+{
+  if (index >= this->length() || this->_buffer == NULL)
+    return 0;
+  return this->_buffer[index];
+}
+
+void String::getBytes(unsigned char *buf, unsigned int bufsize, unsigned int index) const
+{
+  if (bufsize == 0 || buf == NULL)
+    return;
+  if (index >= this->length())
+  {
+    buf[0] = 0;
+    return;
+  }
+  unsigned int n = bufsize - 1;
+  if (n > this->length() - index)
+    n = this->length() - index;
+  strncpy((char *)buf, this->_buffer + index, n);
+  buf[n] = 0;
+}
+
+int String::indexOf(char c) const
+{
+  return this->indexOf(c, 0);
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const
+{
+  if (fromIndex >= this->length())
+    return -1;
+  const char *temp = strchr(this->_buffer + fromIndex, ch);
+  if (temp == NULL)
+    return -1;
+  return temp - this->_buffer;
+}
+
+int String::indexOf(const String &s2) const
+{
+  return this->indexOf(s2, 0);
+}
+
+int String::indexOf(const String &s2, unsigned int fromIndex) const
+{
+  if (fromIndex >= this->length())
+    return -1;
+  const char *found = strstr(this->_buffer + fromIndex, s2.c_str());
+  if (found == NULL)
+    return -1;
+  return found - this->_buffer;
+}
+
+int String::lastIndexOf(char theChar) const
+{
+  return this->lastIndexOf(theChar, this->length() - 1);
+}
+
+int String::lastIndexOf(char ch, unsigned int fromIndex) const
+{
+  if (fromIndex >= this->length())
+    return -1;
+  for (int i = fromIndex; i >= 0; i--)
+    if (this->_buffer[i] == ch)
+      return i;
+  return -1;
+}
+
+int String::lastIndexOf(const String &s2) const
+{
+  return this->lastIndexOf(s2, this->length() - s2.length());
+}
+
+int String::lastIndexOf(const String &s2, unsigned int fromIndex) const
+{
+  if (s2.length() == 0 || s2.length() - 1 > fromIndex || fromIndex >= this->length())
+    return -1;
+  int found = -1;
+  for (const char *p = this->_buffer; p <= this->_buffer + fromIndex; p++)
+  {
+    p = strstr(p, s2._buffer);
+    if (p == NULL)
+      break;
+    if ((unsigned int)(p - this->_buffer) <= fromIndex)
+      found = p - this->_buffer;
+  }
+  return found;
+}
+
+String String::substring(unsigned int left, unsigned int right) const
+{
+  if (left > right)
+  {
+    unsigned int temp = right;
+    right = left;
+    left = temp;
+  }
+  String out;
+  if (left >= this->length())
+    return out;
+  if (right > this->length())
+    right = this->length();
+  out.copy(this->_buffer + left, right - left);
+  return out;
+}
+
+void String::replace(char find, char replace)
+{
+  if (this->_buffer == NULL)
+    return;
+  for (char *p = this->_buffer; *p; p++)
+    if (*p == find)
+      *p = replace;
+}
+
+void String::replace(const String &find, const String &replace)
+{
+  if (this->length() == 0 || find.length() == 0)
+    return;
+  String out;
+  int from = 0;
+  int index;
+  while ((index = this->indexOf(find, from)) >= 0)
+  {
+    out.concat(this->_buffer + from, index - from);
+    out.concat(replace);
+    from = index + find.length();
+  }
+  if (from == 0)
+    return;
+  out.concat(this->_buffer + from, this->length() - from);
+  this->move(out);
+}
+
+void String::remove(unsigned int index)
+{
+  this->remove(index, (unsigned int)-1);
+}
+
+void String::remove(unsigned int index, unsigned int count)
+{
+  if (index >= this->length())
+    return;
+  if (count <= 0)
+    return;
+  if (count > this->length() - index)
+    count = this->length() - index;
+  char *writeTo = this->_buffer + index;
+  this->_length = this->_length - count;
+  memmove(writeTo, this->_buffer + index + count, this->_length - index);
+  this->_buffer[this->_length] = 0;
+}
+
+void String::toLowerCase(void)
+{
+  if (this->_buffer == NULL)
+    return;
+  for (char *p = this->_buffer; *p; p++)
+    *p = tolower(*p);
+}
+
+void String::toUpperCase(void)
+{
+  if (this->_buffer == NULL)
+    return;
+  for (char *p = this->_buffer; *p; p++)
+    *p = toupper(*p);
+}
+
+void String::trim(void)
+{
+  if (this->_buffer == NULL || this->_length == 0)
+    return;
+  char *begin = this->_buffer;
+  while (isspace(*begin))
+    begin++;
+  char *end = this->_buffer + this->_length - 1;
+  while (isspace(*end) && end >= begin)
+    end--;
+  this->_length = end + 1 - begin;
+  if (begin > this->_buffer)
+    memmove(this->_buffer, begin, this->_length);
+  this->_buffer[this->_length] = 0;
+}
+
+long String::toInt(void) const
+{
+  if (this->_buffer != NULL)
+    return atol(this->_buffer);
+  return 0;
+}
+
+float String::toFloat(void) const
+{
+  if (this->_buffer != NULL)
+    return atof(this->_buffer);
+  return 0;
+}
+
+double String::toDouble(void) const
+{
+  if (this->_buffer != NULL)
+    return atof(this->_buffer);
+  return 0;
+}
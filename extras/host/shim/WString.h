@@ -0,0 +1,249 @@
+/*
+  WString.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef WString_h
+#define WString_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+class StringSumHelper;
+
+/**
+ * @brief Host build stand-in for the arduino-esp32 String
+ * Allocates like the ESP32 core does: one heap block of exactly the
+ * needed size, grown with realloc(), no small string optimization. Even
+ * an empty String made from "" holds a one byte block.
+ */
+class String
+{
+public:
+  String(const char *cstr = "");
+  String(const String &str);
+  String(String &&rval);
+  explicit String(char c);
+  explicit String(unsigned char value, unsigned char base = 10);
+  explicit String(int value, unsigned char base = 10);
+  explicit String(unsigned int value, unsigned char base = 10);
+  explicit String(long value, unsigned char base = 10);
+  explicit String(unsigned long value, unsigned char base = 10);
+  explicit String(long long value, unsigned char base = 10);
+  explicit String(unsigned long long value, unsigned char base = 10);
+  explicit String(float value, unsigned char decimalPlaces = 2);
+  explicit String(double value, unsigned char decimalPlaces = 2);
+  ~String(void);
+
+  unsigned char reserve(unsigned int size);
+  unsigned int length(void) const
+  {
+    return this->_buffer != NULL ? this->_length : 0;
+  }
+  bool isEmpty(void) const
+  {
+    return this->length() == 0;
+  }
+
+  String &operator=(const String &rhs);
+  String &operator=(const char *cstr);
+  String &operator=(String &&rval);
+  String &operator=(StringSumHelper &&rval);
+
+  unsigned char concat(const String &str);
+  unsigned char concat(const char *cstr);
+  unsigned char concat(const char *cstr, unsigned int length);
+  unsigned char concat(char c);
+  unsigned char concat(unsigned char num);
+  unsigned char concat(int num);
+  unsigned char concat(unsigned int num);
+  unsigned char concat(long num);
+  unsigned char concat(unsigned long num);
+  unsigned char concat(long long num);
+  unsigned char concat(unsigned long long num);
+  unsigned char concat(float num);
+  unsigned char concat(double num);
+
+  template <typename T>
+  String &operator+=(const T &rhs)
+  {
+    this->concat(rhs);
+    return *this;
+  }
+
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, const String &rhs);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, const char *cstr);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, char c);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, unsigned char num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, int num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, unsigned int num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, long num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, unsigned long num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, float num);
+  friend StringSumHelper &operator+(const StringSumHelper &lhs, double num);
+
+  typedef void (String::*StringIfHelperType)() const;
+  void StringIfHelper() const
+  {
+  }
+  operator StringIfHelperType() const
+  {
+    return this->_buffer != NULL ? &String::StringIfHelper : 0;
+  }
+
+  int compareTo(const String &s) const;
+  unsigned char equals(const String &s) const;
+  unsigned char equals(const char *cstr) const;
+  unsigned char operator==(const String &rhs) const
+  {
+    return this->equals(rhs);
+  }
+  unsigned char operator==(const char *cstr) const
+  {
+    return this->equals(cstr);
+  }
+  unsigned char operator!=(const String &rhs) const
+  {
+    return !this->equals(rhs);
+  }
+  unsigned char operator!=(const char *cstr) const
+  {
+    return !this->equals(cstr);
+  }
+  unsigned char operator<(const String &rhs) const
+  {
+    return this->compareTo(rhs) < 0;
+  }
+  unsigned char operator>(const String &rhs) const
+  {
+    return this->compareTo(rhs) > 0;
+  }
+  unsigned char operator<=(const String &rhs) const
+  {
+    return this->compareTo(rhs) <= 0;
+  }
+  unsigned char operator>=(const String &rhs) const
+  {
+    return this->compareTo(rhs) >= 0;
+  }
+  unsigned char equalsIgnoreCase(const String &s) const;
+  unsigned char startsWith(const String &prefix) const;
+  unsigned char startsWith(const String &prefix, unsigned int offset) const;
+  unsigned char endsWith(const String &suffix) const;
+
+  char charAt(unsigned int index) const;
+  void setCharAt(unsigned int index, char c);
+  char operator[](unsigned int index) const;
+  char &operator[](unsigned int index);
+  void getBytes(unsigned char *buf, unsigned int bufsize, unsigned int index = 0) const;
+  void toCharArray(char *buf, unsigned int bufsize, unsigned int index = 0) const
+  {
+    this->getBytes((unsigned char *)buf, bufsize, index);
+  }
+  const char *c_str() const
+  {
+    return this->_buffer != NULL ? this->_buffer : "";
+  }
+  char *begin()
+  {
+    return this->_buffer;
+  }
+  char *end()
+  {
+    return this->_buffer + this->length();
+  }
+  const char *begin() const
+  {
+    return this->c_str();
+  }
+  const char *end() const
+  {
+    return this->c_str() + this->length();
+  }
+
+  int indexOf(char ch) const;
+  int indexOf(char ch, unsigned int fromIndex) const;
+  int indexOf(const String &str) const;
+  int indexOf(const String &str, unsigned int fromIndex) const;
+  int lastIndexOf(char ch) const;
+  int lastIndexOf(char ch, unsigned int fromIndex) const;
+  int lastIndexOf(const String &str) const;
+  int lastIndexOf(const String &str, unsigned int fromIndex) const;
+  String substring(unsigned int beginIndex) const
+  {
+    return this->substring(beginIndex, this->length());
+  }
+  String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+  void replace(char find, char replace);
+  void replace(const String &find, const String &replace);
+  void remove(unsigned int index);
+  void remove(unsigned int index, unsigned int count);
+  void toLowerCase(void);
+  void toUpperCase(void);
+  void trim(void);
+
+  long toInt(void) const;
+  float toFloat(void) const;
+  double toDouble(void) const;
+
+protected:
+  char *_buffer;
+  unsigned int _capacity;
+  unsigned int _length;
+
+  void init(void);
+  void invalidate(void);
+  unsigned char changeBuffer(unsigned int maxStrLen);
+  String &copy(const char *cstr, unsigned int length);
+  void move(String &rhs);
+};
+
+class StringSumHelper : public String
+{
+public:
+  StringSumHelper(const String &s)
+      : String(s)
+  {
+  }
+  StringSumHelper(const char *p)
+      : String(p)
+  {
+  }
+  StringSumHelper(char c)
+      : String(c)
+  {
+  }
+  StringSumHelper(unsigned char num)
+      : String(num)
+  {
+  }
+  StringSumHelper(int num)
+      : String(num)
+  {
+  }
+  StringSumHelper(unsigned int num)
+      : String(num)
+  {
+  }
+  StringSumHelper(long num)
+      : String(num)
+  {
+  }
+  StringSumHelper(unsigned long num)
+      : String(num)
+  {
+  }
+  StringSumHelper(float num)
+      : String(num)
+  {
+  }
+  StringSumHelper(double num)
+      : String(num)
+  {
+  }
+};
+
+#endif
@@ -0,0 +1,316 @@
+/*
+  WiFi.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include <WiFi.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+WiFiClass WiFi;
+
+wl_status_t WiFiClass::begin(const char *ssid, const char *passphrase)
+{
+  return WL_CONNECTED;
+}
+
+wl_status_t WiFiClass::status(void)
+{
+  return WL_CONNECTED;
+}
+
+int WiFiClass::hostByName(const char *aHostname, IPAddress &aResult)
+{
+  struct addrinfo hints;
+  struct addrinfo *result = NULL;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  if (aHostname == NULL || getaddrinfo(aHostname, NULL, &hints, &result) != 0 || result == NULL)
+  {
+    aResult = (uint32_t)0;
+    return 0;
+  }
+  aResult = (uint32_t)((struct sockaddr_in *)result->ai_addr)->sin_addr.s_addr;
+  freeaddrinfo(result);
+  return 1;
+}
+
+IPAddress WiFiClass::localIP(void)
+{
+  return IPAddress(127, 0, 0, 1);
+}
+
+WiFiClient::WiFiClient(void)
+    : _fd(-1),
+      _connected(false),
+      _rxPosition(0),
+      _rxLength(0)
+{
+}
+
+WiFiClient::WiFiClient(const WiFiClient &other)
+    : WiFiClient()
+{
+  this->_timeout = other._timeout;
+}
+
+WiFiClient::~WiFiClient(void)
+{
+  this->closeSocket();
+}
+
+/**
+ * @brief Takes over the settings, a connection is never shared between two clients
+ */
+WiFiClient &WiFiClient::operator=(const WiFiClient &other)
+{
+  if (this != &other)
+  {
+    this->stop();
+    this->_timeout = other._timeout;
+  }
+  return *this;
+}
+
+/**
+ * @brief Opens a non-blocking TCP connection, waiting up to timeout ms for it
+ */
+boolean WiFiClient::openSocket(IPAddress ip, uint16_t port, int32_t timeout)
+{
+  // A peer closing the connection must not kill the process on write
+  signal(SIGPIPE, SIG_IGN);
+  this->closeSocket();
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0)
+  {
+    log_e("socket: %d", errno);
+    return false;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  int enabled = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = (uint32_t)ip;
+  address.sin_port = htons(port);
+  this->_fd = fd;
+  if (::connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0 && errno != EINPROGRESS)
+  {
+    log_e("connect on fd %d, errno: %d, \"%s\"", fd, errno, strerror(errno));
+    this->closeSocket();
+    return false;
+  }
+  int error = 0;
+  socklen_t length = sizeof(error);
+  if (!this->waitFor(POLLOUT, timeout < 0 ? WIFI_CLIENT_DEFAULT_CONNECT_TIMEOUT : timeout) ||
+      getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) != 0 || error != 0)
+  {
+    log_e("connect on fd %d, errno: %d, \"%s\"", fd, error, strerror(error));
+    this->closeSocket();
+    return false;
+  }
+  this->_connected = true;
+  return true;
+}
+
+boolean WiFiClient::waitFor(short events, uint32_t timeout)
+{
+  struct pollfd descriptor = {this->_fd, events, 0};
+  unsigned long start = millis();
+  while (true)
+  {
+    uint32_t elapsed = millis() - start;
+    int ready = poll(&descriptor, 1, elapsed < timeout ? timeout - elapsed : 0);
+    if (ready > 0)
+      return true;
+    if (ready == 0 || errno != EINTR)
+      return false;
+  }
+}
+
+void WiFiClient::closeSocket(void)
+{
+  if (this->_fd >= 0)
+    close(this->_fd);
+  this->_fd = -1;
+  this->_connected = false;
+  this->_rxPosition = 0;
+  this->_rxLength = 0;
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port)
+{
+  return this->connect(ip, port, -1);
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port, int32_t timeout)
+{
+  return this->openSocket(ip, port, timeout);
+}
+
+int WiFiClient::connect(const char *host, uint16_t port)
+{
+  return this->connect(host, port, -1);
+}
+
+int WiFiClient::connect(const char *host, uint16_t port, int32_t timeout)
+{
+  IPAddress ip;
+  if (!WiFi.hostByName(host, ip))
+    return 0;
+  return this->connect(ip, port, timeout);
+}
+
+int WiFiClient::setTimeout(uint32_t seconds)
+{
+  Stream::setTimeout(seconds * 1000);
+  return 0;
+}
+
+boolean WiFiClient::waitAvailable(uint32_t timeout)
+{
+  if (this->available() > 0)
+    return true;
+  if (this->_fd < 0 || !this->_connected)
+    return false;
+  this->waitFor(POLLIN, timeout);
+  return this->available() > 0;
+}
+
+/**
+ * @brief Reads what has arrived without waiting
+ *
+ * @return int Bytes read, 0 when nothing arrived, -1 when the connection was closed
+ */
+int WiFiClient::receive(uint8_t *buf, size_t size)
+{
+  ssize_t count = recv(this->_fd, buf, size, MSG_DONTWAIT);
+  if (count > 0)
+    return count;
+  if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+    return 0;
+  return -1;
+}
+
+/**
+ * @brief Writes what the socket takes without waiting
+ *
+ * @return int Bytes written, 0 when the socket is full, -1 on error
+ */
+int WiFiClient::send(const uint8_t *buf, size_t size)
+{
+  ssize_t count = ::send(this->_fd, buf, size, MSG_DONTWAIT | MSG_NOSIGNAL);
+  if (count >= 0)
+    return count;
+  if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+    return 0;
+  return -1;
+}
+
+/**
+ * @brief Moves arrived data into the receive buffer when it is empty
+ *
+ * @return boolean true when there is buffered data
+ */
+boolean WiFiClient::fill(void)
+{
+  if (this->_rxPosition < this->_rxLength)
+    return true;
+  if (this->_fd < 0 || !this->_connected)
+    return false;
+  int count = this->receive(this->_rx, sizeof(this->_rx));
+  if (count < 0)
+  {
+    this->_connected = false;
+    return false;
+  }
+  this->_rxPosition = 0;
+  this->_rxLength = count;
+  return count > 0;
+}
+
+size_t WiFiClient::write(uint8_t data)
+{
+  return this->write(&data, 1);
+}
+
+size_t WiFiClient::write(const uint8_t *buf, size_t size)
+{
+  if (this->_fd < 0 || !this->_connected)
+    return 0;
+  size_t written = 0;
+  unsigned long start = millis();
+  while (written < size)
+  {
+    int count = this->send(buf + written, size - written);
+    if (count < 0)
+    {
+      log_e("fail on fd %d, errno: %d, \"%s\"", this->_fd, errno, strerror(errno));
+      this->stop();
+      break;
+    }
+    written += count;
+    if (count == 0)
+    {
+      uint32_t elapsed = millis() - start;
+      if (elapsed >= this->_timeout || !this->waitFor(POLLOUT, this->_timeout - elapsed))
+        break;
+    }
+  }
+  return written;
+}
+
+int WiFiClient::available(void)
+{
+  this->fill();
+  return this->_rxLength - this->_rxPosition;
+}
+
+int WiFiClient::read(void)
+{
+  if (!this->fill())
+    return -1;
+  return this->_rx[this->_rxPosition++];
+}
+
+int WiFiClient::read(uint8_t *buf, size_t size)
+{
+  if (!this->fill())
+    return -1;
+  size_t count = min(size, this->_rxLength - this->_rxPosition);
+  memcpy(buf, this->_rx + this->_rxPosition, count);
+  this->_rxPosition += count;
+  return count;
+}
+
+int WiFiClient::peek(void)
+{
+  if (!this->fill())
+    return -1;
+  return this->_rx[this->_rxPosition];
+}
+
+void WiFiClient::flush(void)
+{
+}
+
+void WiFiClient::stop(void)
+{
+  this->closeSocket();
+}
+
+uint8_t WiFiClient::connected(void)
+{
+  this->fill();
+  return this->_connected;
+}
@@ -0,0 +1,39 @@
+/*
+  WiFi.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef WiFi_h
+#define WiFi_h
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+
+typedef enum
+{
+  WL_NO_SHIELD = 255,
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+/**
+ * @brief Host build stand-in for the WiFi class, the host network is always up
+ */
+class WiFiClass
+{
+public:
+  wl_status_t begin(const char *ssid, const char *passphrase = NULL);
+  wl_status_t status(void);
+  int hostByName(const char *aHostname, IPAddress &aResult);
+  IPAddress localIP(void);
+};
+
+extern WiFiClass WiFi;
+
+#endif
@@ -0,0 +1,79 @@
+/*
+  WiFiClient.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef WiFiClient_h
+#define WiFiClient_h
+
+#include <Arduino.h>
+
+#define WIFI_CLIENT_RX_BUFFER_SIZE 1436
+#define WIFI_CLIENT_DEFAULT_CONNECT_TIMEOUT 5000
+
+/**
+ * @brief Host build stand-in for the arduino-esp32 WiFiClient over a POSIX socket
+ * Reads never block: available() and read() only return what has arrived,
+ * like lwIP does on the board. Writes wait up to the stream timeout.
+ */
+class WiFiClient : public Stream
+{
+public:
+  WiFiClient(void);
+  WiFiClient(const WiFiClient &other);
+  virtual ~WiFiClient(void);
+  WiFiClient &operator=(const WiFiClient &other);
+
+  virtual int connect(IPAddress ip, uint16_t port);
+  virtual int connect(IPAddress ip, uint16_t port, int32_t timeout);
+  virtual int connect(const char *host, uint16_t port);
+  virtual int connect(const char *host, uint16_t port, int32_t timeout);
+
+  size_t write(uint8_t data) override;
+  size_t write(const uint8_t *buf, size_t size) override;
+  using Print::write;
+  int available(void) override;
+  int read(void) override;
+  virtual int read(uint8_t *buf, size_t size);
+  int peek(void) override;
+  void flush(void) override;
+  virtual void stop(void);
+  virtual uint8_t connected(void);
+
+  operator bool()
+  {
+    return this->connected();
+  }
+
+  int fd(void) const
+  {
+    return this->_fd;
+  }
+
+  /**
+   * @brief Sets the read and write timeout in seconds, as the core does
+   */
+  int setTimeout(uint32_t seconds);
+
+  /**
+   * @brief Host only, waits up to timeout ms for data instead of sleeping
+   */
+  boolean waitAvailable(uint32_t timeout);
+
+protected:
+  boolean openSocket(IPAddress ip, uint16_t port, int32_t timeout);
+  boolean waitFor(short events, uint32_t timeout);
+  void closeSocket(void);
+  virtual int receive(uint8_t *buf, size_t size);
+  virtual int send(const uint8_t *buf, size_t size);
+  boolean fill(void);
+
+  int _fd;
+  boolean _connected;
+  uint8_t _rx[WIFI_CLIENT_RX_BUFFER_SIZE];
+  size_t _rxPosition;
+  size_t _rxLength;
+};
+
+#endif
@@ -0,0 +1,257 @@
+/*
+  WiFiClientSecure.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include <WiFiClientSecure.h>
+#include <WiFi.h>
+#include <errno.h>
+#include <poll.h>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+
+#define SSL_HANDSHAKE_TIMEOUT 120
+
+WiFiClientSecure::WiFiClientSecure(void)
+    : _CA_cert(NULL),
+      _handshakeTimeout(SSL_HANDSHAKE_TIMEOUT * 1000),
+      _context(NULL),
+      _ssl(NULL),
+      _lastError(0)
+{
+}
+
+WiFiClientSecure::WiFiClientSecure(const WiFiClientSecure &other)
+    : WiFiClientSecure()
+{
+  *this = other;
+}
+
+WiFiClientSecure::~WiFiClientSecure(void)
+{
+  this->stop();
+}
+
+WiFiClientSecure &WiFiClientSecure::operator=(const WiFiClientSecure &other)
+{
+  if (this != &other)
+  {
+    WiFiClient::operator=(other);
+    this->_CA_cert = other._CA_cert;
+    this->_handshakeTimeout = other._handshakeTimeout;
+  }
+  return *this;
+}
+
+void WiFiClientSecure::setCACert(const char *rootCA)
+{
+  this->_CA_cert = rootCA;
+}
+
+void WiFiClientSecure::setHandshakeTimeout(unsigned long handshake_timeout)
+{
+  this->_handshakeTimeout = handshake_timeout * 1000;
+}
+
+int WiFiClientSecure::connect(IPAddress ip, uint16_t port)
+{
+  return this->connect(ip, port, NULL, this->_CA_cert, NULL, NULL);
+}
+
+int WiFiClientSecure::connect(IPAddress ip, uint16_t port, int32_t timeout)
+{
+  if (!this->openSocket(ip, port, timeout))
+    return 0;
+  return this->handshake(NULL, this->_CA_cert);
+}
+
+int WiFiClientSecure::connect(const char *host, uint16_t port)
+{
+  return this->connect(host, port, this->_CA_cert, NULL, NULL);
+}
+
+int WiFiClientSecure::connect(const char *host, uint16_t port, int32_t timeout)
+{
+  IPAddress ip;
+  if (!WiFi.hostByName(host, ip) || !this->openSocket(ip, port, timeout))
+    return 0;
+  return this->handshake(host, this->_CA_cert);
+}
+
+int WiFiClientSecure::connect(IPAddress ip, uint16_t port, const char *host, const char *rootCABuff, const char *cli_cert, const char *cli_key)
+{
+  // The core waits for the connect as long as the stream timeout
+  if (!this->openSocket(ip, port, (int32_t)this->getTimeout()))
+    return 0;
+  return this->handshake(host, rootCABuff);
+}
+
+int WiFiClientSecure::connect(const char *host, uint16_t port, const char *rootCABuff, const char *cli_cert, const char *cli_key)
+{
+  IPAddress ip;
+  if (!WiFi.hostByName(host, ip))
+    return 0;
+  return this->connect(ip, port, host, rootCABuff, cli_cert, cli_key);
+}
+
+/**
+ * @brief Loads the PEM certificates into the context's trust store
+ */
+static boolean loadCACert(SSL_CTX *context, const char *rootCA)
+{
+  BIO *bio = BIO_new_mem_buf(rootCA, -1);
+  if (bio == NULL)
+    return false;
+  X509_STORE *store = SSL_CTX_get_cert_store(context);
+  int loaded = 0;
+  X509 *cert;
+  while ((cert = PEM_read_bio_X509(bio, NULL, NULL, NULL)) != NULL)
+  {
+    if (X509_STORE_add_cert(store, cert) == 1)
+      loaded++;
+    X509_free(cert);
+  }
+  ERR_clear_error();
+  BIO_free(bio);
+  return loaded > 0;
+}
+
+/**
+ * @brief Runs the TLS handshake on the open socket
+ * The CA certificate turns on verification of the chain and, when a
+ * host name is given, of the name the server certificate is issued for.
+ */
+boolean WiFiClientSecure::handshake(const char *host, const char *rootCA)
+{
+  // A reconnect without stop() still holds the previous session
+  this->freeSession();
+  this->_context = SSL_CTX_new(TLS_client_method());
+  if (this->_context == NULL)
+  {
+    this->stop();
+    return false;
+  }
+  SSL_CTX_set_mode(this->_context, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER | SSL_MODE_ENABLE_PARTIAL_WRITE);
+  if (rootCA != NULL)
+  {
+    if (!loadCACert(this->_context, rootCA))
+    {
+      log_e("Could not parse the CA certificate");
+      this->stop();
+      return false;
+    }
+    SSL_CTX_set_verify(this->_context, SSL_VERIFY_PEER, NULL);
+  }
+  else
+  {
+    log_i("WARNING: Use certificates for a more secure communication!");
+    SSL_CTX_set_verify(this->_context, SSL_VERIFY_NONE, NULL);
+  }
+  this->_ssl = SSL_new(this->_context);
+  if (this->_ssl == NULL)
+  {
+    this->stop();
+    return false;
+  }
+  SSL_set_fd(this->_ssl, this->_fd);
+  if (host != NULL && host[0] != '\0')
+  {
+    SSL_set_tlsext_host_name(this->_ssl, host);
+    if (rootCA != NULL)
+      SSL_set1_host(this->_ssl, host);
+  }
+  unsigned long start = millis();
+  while (true)
+  {
+    int result = SSL_connect(this->_ssl);
+    if (result == 1)
+      break;
+    int error = SSL_get_error(this->_ssl, result);
+    uint32_t elapsed = millis() - start;
+    if ((error != SSL_ERROR_WANT_READ && error != SSL_ERROR_WANT_WRITE) ||
+        elapsed >= this->_handshakeTimeout ||
+        !this->waitFor(error == SSL_ERROR_WANT_READ ? POLLIN : POLLOUT, this->_handshakeTimeout - elapsed))
+    {
+      this->_lastError = ERR_peek_last_error();
+      char message[128];
+      ERR_error_string_n(this->_lastError, message, sizeof(message));
+      log_e("(%d) SSL handshake failed: %s", error, message);
+      ERR_clear_error();
+      this->stop();
+      return false;
+    }
+  }
+  return true;
+}
+
+int WiFiClientSecure::receive(uint8_t *buf, size_t size)
+{
+  if (this->_ssl == NULL)
+    return -1;
+  int count = SSL_read(this->_ssl, buf, size);
+  if (count > 0)
+    return count;
+  int error = SSL_get_error(this->_ssl, count);
+  if (error == SSL_ERROR_WANT_READ || error == SSL_ERROR_WANT_WRITE)
+    return 0;
+  ERR_clear_error();
+  return -1;
+}
+
+int WiFiClientSecure::send(const uint8_t *buf, size_t size)
+{
+  if (this->_ssl == NULL)
+    return -1;
+  int count = SSL_write(this->_ssl, buf, size);
+  if (count > 0)
+    return count;
+  int error = SSL_get_error(this->_ssl, count);
+  if (error == SSL_ERROR_WANT_READ || error == SSL_ERROR_WANT_WRITE)
+    return 0;
+  ERR_clear_error();
+  return -1;
+}
+
+int WiFiClientSecure::available(void)
+{
+  if (this->_ssl == NULL)
+    return 0;
+  return WiFiClient::available();
+}
+
+uint8_t WiFiClientSecure::connected(void)
+{
+  if (this->_ssl == NULL)
+    return false;
+  return WiFiClient::connected();
+}
+
+void WiFiClientSecure::stop(void)
+{
+  this->freeSession();
+  WiFiClient::stop();
+}
+
+void WiFiClientSecure::freeSession(void)
+{
+  if (this->_ssl != NULL)
+  {
+    SSL_free(this->_ssl);
+    this->_ssl = NULL;
+  }
+  if (this->_context != NULL)
+  {
+    SSL_CTX_free(this->_context);
+    this->_context = NULL;
+  }
+}
+
+int WiFiClientSecure::lastError(char *buf, const size_t size)
+{
+  if (this->_lastError == 0)
+    return 0;
+  ERR_error_string_n(this->_lastError, buf, size);
+  return this->_lastError;
+}
@@ -0,0 +1,59 @@
+/*
+  WiFiClientSecure.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef WiFiClientSecure_h
+#define WiFiClientSecure_h
+
+#include <WiFiClient.h>
+
+typedef struct ssl_st SSL;
+typedef struct ssl_ctx_st SSL_CTX;
+
+/**
+ * @brief Host build stand-in for the arduino-esp32 WiFiClientSecure over OpenSSL
+ * Like the board, a client without a CA certificate connects without
+ * verifying the server, one with a CA checks the chain and the host name.
+ * Every connection does a full handshake, the board keeps no TLS sessions.
+ */
+class WiFiClientSecure : public WiFiClient
+{
+public:
+  WiFiClientSecure(void);
+  WiFiClientSecure(const WiFiClientSecure &other);
+  ~WiFiClientSecure(void);
+  WiFiClientSecure &operator=(const WiFiClientSecure &other);
+
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(IPAddress ip, uint16_t port, int32_t timeout) override;
+  int connect(const char *host, uint16_t port) override;
+  int connect(const char *host, uint16_t port, int32_t timeout) override;
+  int connect(IPAddress ip, uint16_t port, const char *host, const char *rootCABuff, const char *cli_cert, const char *cli_key);
+  int connect(const char *host, uint16_t port, const char *rootCABuff, const char *cli_cert, const char *cli_key);
+
+  int available(void) override;
+  void stop(void) override;
+  uint8_t connected(void) override;
+
+  void setCACert(const char *rootCA);
+  void setHandshakeTimeout(unsigned long handshake_timeout);
+  int lastError(char *buf, const size_t size);
+
+protected:
+  int receive(uint8_t *buf, size_t size) override;
+  int send(const uint8_t *buf, size_t size) override;
+
+private:
+  boolean handshake(const char *host, const char *rootCA);
+  void freeSession(void);
+
+  const char *_CA_cert;
+  unsigned long _handshakeTimeout;
+  SSL_CTX *_context;
+  SSL *_ssl;
+  unsigned long _lastError;
+};
+
+#endif
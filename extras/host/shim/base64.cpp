@@ -0,0 +1,24 @@
+/*
+  base64.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include <base64.h>
+#include <openssl/evp.h>
+
+String base64::encode(const uint8_t *data, size_t length)
+{
+  size_t size = 4 * ((length + 2) / 3) + 1;
+  char *buffer = (char *)malloc(size);
+  if (buffer == NULL)
+    return String("-FAIL-");
+  EVP_EncodeBlock((unsigned char *)buffer, data, length);
+  String base64 = String(buffer);
+  free(buffer);
+  return base64;
+}
+
+String base64::encode(const String &text)
+{
+  return base64::encode((const uint8_t *)text.c_str(), text.length());
+}
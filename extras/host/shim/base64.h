@@ -0,0 +1,22 @@
+/*
+  base64.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef base64_h
+#define base64_h
+
+#include <Arduino.h>
+
+/**
+ * @brief Host build stand-in for the core's base64 encoder
+ */
+class base64
+{
+public:
+  static String encode(const uint8_t *data, size_t length);
+  static String encode(const String &text);
+};
+
+#endif
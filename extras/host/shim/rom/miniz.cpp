@@ -0,0 +1,82 @@
+/*
+  miniz.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "miniz.h"
+#include <string.h>
+
+#define TINFL_STATE_START 0
+#define TINFL_STATE_INFLATING 1
+#define TINFL_STATE_DONE 2
+#define TINFL_STATE_FAILED 3
+
+/**
+ * @brief Hands out memory from the arena inside the decompressor
+ */
+static voidpf arenaAlloc(voidpf opaque, uInt items, uInt size)
+{
+  tinfl_decompressor *r = (tinfl_decompressor *)opaque;
+  size_t bytes = ((size_t)items * size + 15) & ~(size_t)15;
+  if (r->m_arenaUsed + bytes > sizeof(r->m_arena))
+    return Z_NULL;
+  voidpf block = r->m_arena + r->m_arenaUsed;
+  r->m_arenaUsed += bytes;
+  return block;
+}
+
+static void arenaFree(voidpf opaque, voidpf address)
+{
+}
+
+tinfl_status tinfl_decompress(tinfl_decompressor *r, const mz_uint8 *pIn_buf_next, size_t *pIn_buf_size, mz_uint8 *pOut_buf_start, mz_uint8 *pOut_buf_next, size_t *pOut_buf_size, const mz_uint32 decomp_flags)
+{
+  if (r == NULL || pIn_buf_size == NULL || pOut_buf_size == NULL || pOut_buf_next < pOut_buf_start)
+    return TINFL_STATUS_BAD_PARAM;
+  if (r->m_state == TINFL_STATE_START)
+  {
+    memset(&r->m_stream, 0, sizeof(r->m_stream));
+    r->m_arenaUsed = 0;
+    r->m_stream.zalloc = arenaAlloc;
+    r->m_stream.zfree = arenaFree;
+    r->m_stream.opaque = r;
+    int windowBits = (decomp_flags & TINFL_FLAG_PARSE_ZLIB_HEADER) ? MAX_WBITS : -MAX_WBITS;
+    if (inflateInit2(&r->m_stream, windowBits) != Z_OK)
+    {
+      r->m_state = TINFL_STATE_FAILED;
+      *pIn_buf_size = *pOut_buf_size = 0;
+      return TINFL_STATUS_FAILED;
+    }
+    r->m_state = TINFL_STATE_INFLATING;
+  }
+  if (r->m_state != TINFL_STATE_INFLATING)
+  {
+    *pIn_buf_size = *pOut_buf_size = 0;
+    return r->m_state == TINFL_STATE_DONE ? TINFL_STATUS_DONE : TINFL_STATUS_FAILED;
+  }
+  r->m_stream.next_in = (Bytef *)pIn_buf_next;
+  r->m_stream.avail_in = *pIn_buf_size;
+  r->m_stream.next_out = pOut_buf_next;
+  r->m_stream.avail_out = *pOut_buf_size;
+  int result = inflate(&r->m_stream, Z_NO_FLUSH);
+  *pIn_buf_size -= r->m_stream.avail_in;
+  *pOut_buf_size -= r->m_stream.avail_out;
+  if (result == Z_STREAM_END)
+  {
+    r->m_state = TINFL_STATE_DONE;
+    return TINFL_STATUS_DONE;
+  }
+  if (result != Z_OK && result != Z_BUF_ERROR)
+  {
+    r->m_state = TINFL_STATE_FAILED;
+    return result == Z_DATA_ERROR && r->m_stream.msg != NULL && strstr(r->m_stream.msg, "check") != NULL
+               ? TINFL_STATUS_ADLER32_MISMATCH
+               : TINFL_STATUS_FAILED;
+  }
+  if (r->m_stream.avail_out == 0)
+    return TINFL_STATUS_HAS_MORE_OUTPUT;
+  if (decomp_flags & TINFL_FLAG_HAS_MORE_INPUT)
+    return TINFL_STATUS_NEEDS_MORE_INPUT;
+  r->m_state = TINFL_STATE_FAILED;
+  return TINFL_STATUS_FAILED;
+}
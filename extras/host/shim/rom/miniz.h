@@ -0,0 +1,66 @@
+/*
+  miniz.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef miniz_h
+#define miniz_h
+
+/*
+ * Host build stand-in for the tinfl decompressor in the ESP32 ROM, on top
+ * of zlib. The statuses and flags match the ROM, zlib keeps its own copy
+ * of the dictionary, so the output buffer does not need to wrap.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zlib.h>
+
+typedef unsigned char mz_uint8;
+typedef unsigned int mz_uint32;
+
+#define TINFL_LZ_DICT_SIZE 32768
+
+enum
+{
+  TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
+  TINFL_FLAG_HAS_MORE_INPUT = 2,
+  TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4,
+  TINFL_FLAG_COMPUTE_ADLER32 = 8
+};
+
+typedef enum
+{
+  TINFL_STATUS_BAD_PARAM = -3,
+  TINFL_STATUS_ADLER32_MISMATCH = -2,
+  TINFL_STATUS_FAILED = -1,
+  TINFL_STATUS_DONE = 0,
+  TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+  TINFL_STATUS_HAS_MORE_OUTPUT = 2
+} tinfl_status;
+
+// zlib's inflate state and its 32 KB window
+#define TINFL_HOST_ARENA_SIZE (48 * 1024)
+
+/**
+ * @brief The decompressor owns all of zlib's memory, freeing the struct
+ * releases it, like freeing a ROM tinfl_decompressor does
+ */
+typedef struct tinfl_decompressor_tag
+{
+  mz_uint32 m_state;
+  z_stream m_stream;
+  size_t m_arenaUsed;
+  alignas(16) mz_uint8 m_arena[TINFL_HOST_ARENA_SIZE];
+} tinfl_decompressor;
+
+#define tinfl_init(r)   \
+  do                    \
+  {                     \
+    (r)->m_state = 0;   \
+  } while (0)
+
+tinfl_status tinfl_decompress(tinfl_decompressor *r, const mz_uint8 *pIn_buf_next, size_t *pIn_buf_size, mz_uint8 *pOut_buf_start, mz_uint8 *pOut_buf_next, size_t *pOut_buf_size, const mz_uint32 decomp_flags);
+
+#endif
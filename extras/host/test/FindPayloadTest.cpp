@@ -0,0 +1,143 @@
+/*
+  FindPayloadTest.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "FMDataClient.h"
+#include <gtest/gtest.h>
+
+// Find payloads used to be sized with JSON_ARRAY_SIZE(5) for the sort and
+// 200 bytes per criterion, a sixth sort field or a long query was silently
+// dropped. The payload is compared with text written out by hand, not with
+// the output of the serializer it is built with.
+
+class FindPayloadTest : public ::testing::Test
+{
+protected:
+  FindPayloadTest(void)
+      : host("localhost"),
+        cert(""),
+        port(443),
+        credentials("database", "user", "password"),
+        client(credentials, host, cert, port)
+  {
+  }
+
+  const char *host;
+  const char *cert;
+  const int port;
+  UserCredentials credentials;
+  FMDataClient client;
+};
+
+TEST_F(FindPayloadTest, KeepsTwentySortFields)
+{
+  RecordFindCriteria all("id", "*");
+  vector<RecordFindCriteria *> records{&all};
+  FindCriteria find(records);
+  vector<FindCriteria *> finds{&find};
+
+  vector<RecordSortCriteria> fields;
+  fields.reserve(20);
+  String expected = "{\"query\":[{\"id\":\"*\"}],\"sort\":[";
+  for (int i = 0; i < 20; i++)
+  {
+    SortOrder order = i % 2 == 0 ? SortOrder::ascend : SortOrder::descend;
+    fields.push_back(RecordSortCriteria(String("sortField") + i, order));
+    if (i > 0)
+      expected += ",";
+    expected += String("{\"fieldName\":\"sortField") + i + "\",\"sortOrder\":\"" +
+                (order == SortOrder::ascend ? "ascend" : "descend") + "\"}";
+  }
+  expected += "],\"limit\":\"100\"}";
+  vector<RecordSortCriteria *> sortRecords;
+  for (auto &field : fields)
+    sortRecords.push_back(&field);
+  SortCriteria sort(sortRecords);
+
+  EXPECT_STREQ(expected.c_str(), client.generateFindPayload(finds, 100, 0, &sort).c_str());
+}
+
+TEST_F(FindPayloadTest, KeepsFiftyFindRequests)
+{
+  vector<RecordFindCriteria> records;
+  records.reserve(50);
+  for (int i = 0; i < 50; i++)
+    records.push_back(RecordFindCriteria(String("field") + i, String("==value ") + i));
+  vector<FindCriteria> requests;
+  requests.reserve(50);
+  String expected = "{\"query\":[";
+  for (int i = 0; i < 50; i++)
+  {
+    boolean omit = i % 10 == 9;
+    requests.push_back(FindCriteria(vector<RecordFindCriteria *>{&records[i]}, omit));
+    if (i > 0)
+      expected += ",";
+    expected += String("{\"field") + i + "\":\"==value " + i + "\"" + (omit ? ",\"omit\":\"true\"" : "") + "}";
+  }
+  expected += "],\"limit\":\"50\",\"offset\":\"101\"}";
+  vector<FindCriteria *> finds;
+  for (auto &request : requests)
+    finds.push_back(&request);
+
+  EXPECT_STREQ(expected.c_str(), client.generateFindPayload(finds, 50, 101).c_str());
+}
+
+TEST_F(FindPayloadTest, KeepsFiftyFieldsOfOneFindRequest)
+{
+  vector<RecordFindCriteria> records;
+  records.reserve(50);
+  String expected = "{\"query\":[{";
+  for (int i = 0; i < 50; i++)
+  {
+    records.push_back(RecordFindCriteria(String("field") + i, String(">") + i * 1000));
+    if (i > 0)
+      expected += ",";
+    expected += String("\"field") + i + "\":\">" + i * 1000 + "\"";
+  }
+  expected += "}],\"limit\":\"100\"}";
+  vector<RecordFindCriteria *> fields;
+  for (auto &record : records)
+    fields.push_back(&record);
+  FindCriteria find(fields);
+  vector<FindCriteria *> finds{&find};
+
+  EXPECT_STREQ(expected.c_str(), client.generateFindPayload(finds).c_str());
+}
+
+TEST_F(FindPayloadTest, KeepsScriptsNextToTwentySortFieldsAndFiftyRequests)
+{
+  vector<RecordFindCriteria> records;
+  records.reserve(50);
+  for (int i = 0; i < 50; i++)
+    records.push_back(RecordFindCriteria("status", String("==") + i));
+  vector<FindCriteria> requests;
+  requests.reserve(50);
+  for (auto &record : records)
+    requests.push_back(FindCriteria(vector<RecordFindCriteria *>{&record}));
+  vector<FindCriteria *> finds;
+  for (auto &request : requests)
+    finds.push_back(&request);
+  vector<RecordSortCriteria> fields;
+  fields.reserve(20);
+  for (int i = 0; i < 20; i++)
+    fields.push_back(RecordSortCriteria(String("sortField") + i));
+  vector<RecordSortCriteria *> sortRecords;
+  for (auto &field : fields)
+    sortRecords.push_back(&field);
+  SortCriteria sort(sortRecords);
+  ScriptParameters scripts("after", "1", "before", "2", "presort", "3");
+
+  String payload = client.generateFindPayload(finds, 10, 0, &sort, &scripts);
+  DynamicJsonDocument doc(16384);
+  ASSERT_FALSE(deserializeJson(doc, payload));
+  JsonArray query = doc["query"];
+  JsonArray sortArray = doc["sort"];
+  ASSERT_EQ(50u, query.size());
+  ASSERT_EQ(20u, sortArray.size());
+  EXPECT_STREQ("==49", query[49]["status"].as<const char *>());
+  EXPECT_STREQ("sortField19", sortArray[19]["fieldName"].as<const char *>());
+  EXPECT_STREQ("after", doc["script"].as<const char *>());
+  EXPECT_STREQ("presort", doc["script.presort"].as<const char *>());
+  EXPECT_STREQ("10", doc["limit"].as<const char *>());
+}
@@ -0,0 +1,92 @@
+/*
+  JsonCapacityTest.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "FMDataClient.h"
+#include "JsonCapacity.h"
+#include <gtest/gtest.h>
+
+TEST(JsonCapacityTest, SortCapacityIsExact)
+{
+  vector<RecordSortCriteria> fields;
+  fields.reserve(20);
+  for (int i = 0; i < 20; i++)
+    fields.push_back(RecordSortCriteria(String("sortField") + i, SortOrder::descend));
+  vector<RecordSortCriteria *> records;
+  for (auto &field : fields)
+    records.push_back(&field);
+  SortCriteria sort(records);
+
+  DynamicJsonDocument doc(sort.getJSONCapacity());
+  sort.toJSON(doc.to<JsonArray>());
+  EXPECT_EQ(20u, doc.as<JsonArray>().size());
+  EXPECT_EQ(sort.getJSONCapacity(), doc.memoryUsage());
+}
+
+TEST(JsonCapacityTest, FindCapacityIsExact)
+{
+  vector<RecordFindCriteria> criteria;
+  criteria.reserve(50);
+  for (int i = 0; i < 50; i++)
+    criteria.push_back(RecordFindCriteria(String("field") + i, "==1"));
+  vector<RecordFindCriteria *> records;
+  for (auto &criterion : criteria)
+    records.push_back(&criterion);
+  FindCriteria find(records, true);
+
+  DynamicJsonDocument doc(find.getJSONCapacity());
+  find.toJSON(doc.to<JsonObject>());
+  EXPECT_EQ(51u, doc.as<JsonObject>().size());
+  EXPECT_EQ(find.getJSONCapacity(), doc.memoryUsage());
+}
+
+TEST(JsonCapacityTest, GrowsUntilTheResponseFits)
+{
+  String response = "{\"response\":{\"data\":[";
+  for (int i = 0; i < 50; i++)
+  {
+    if (i > 0)
+      response += ",";
+    response += String("{\"fieldData\":{\"id\":") + i + ",\"name\":\"record " + i + "\"},\"recordId\":\"" + i + "\"}";
+  }
+  response += "]}}";
+
+  AdaptiveCapacity capacity(64);
+  size_t records = 0;
+  DeserializationError error = capacity.deserialize(response, [&records](JsonDocument &doc) {
+    records = doc["response"]["data"].as<JsonArray>().size();
+  });
+  EXPECT_FALSE(error);
+  EXPECT_EQ(50u, records);
+  EXPECT_GT(capacity.get(), 64u);
+}
+
+TEST(JsonCapacityTest, StopsAtTheMaximum)
+{
+  String response = "[";
+  for (int i = 0; i < 100; i++)
+    response += i > 0 ? ",1" : "1";
+  response += "]";
+
+  AdaptiveCapacity capacity(64, 256);
+  boolean called = false;
+  DeserializationError error = capacity.deserialize(response, [&called](JsonDocument &doc) {
+    called = true;
+  });
+  EXPECT_EQ(DeserializationError::NoMemory, error);
+  EXPECT_FALSE(called);
+  EXPECT_EQ(256u, capacity.get());
+}
+
+TEST(JsonCapacityTest, LearnsWithHeadroomAndShrinksSlowly)
+{
+  AdaptiveCapacity capacity(1024);
+  capacity.learn(2000);
+  EXPECT_EQ(2528u, capacity.get());
+  capacity.learn(2000);
+  EXPECT_EQ(2528u, capacity.get());
+  capacity.learn(100);
+  EXPECT_GT(capacity.get(), 1024u);
+  EXPECT_LT(capacity.get(), 2528u);
+}
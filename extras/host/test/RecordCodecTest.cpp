@@ -0,0 +1,70 @@
+/*
+  RecordCodecTest.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "RecordCodec.h"
+#include <gtest/gtest.h>
+
+// Records queued by RecordPipeline are encoded and written out as payload
+// only when they are sent, that payload has to be the one generatePayload()
+// writes for the same fields, byte for byte.
+
+class RecordCodecTest : public ::testing::Test
+{
+protected:
+  RecordCodecTest(void)
+  {
+    codec.addName("name");
+    codec.addName("counter");
+    codec.addName("temperature");
+  }
+
+  /**
+   * @brief Encodes the fields and compares the payload with generatePayload()
+   */
+  void expectSamePayload(const vector<RecordField> &fields)
+  {
+    vector<uint8_t> encoded;
+    ASSERT_GT(codec.encode(fields.data(), fields.size(), encoded), 0u);
+    String expected = FMDataClient::generatePayload(fields.data(), fields.size());
+    char payload[1024];
+    size_t length = codec.toPayload(encoded.data(), encoded.size(), payload, sizeof(payload));
+    ASSERT_EQ(expected.length(), length);
+    EXPECT_EQ(0, memcmp(expected.c_str(), payload, length + 1));
+    EXPECT_EQ(length, codec.measurePayload(encoded.data(), encoded.size()));
+  }
+
+  RecordCodec codec;
+};
+
+TEST_F(RecordCodecTest, WritesTextFieldsLikeGeneratePayload)
+{
+  expectSamePayload({RecordField("name", "Sensor 1"),
+                     RecordField("unregistered", "kept by name"),
+                     RecordField("empty", "")});
+}
+
+TEST_F(RecordCodecTest, WritesIntegerNumbersLikeGeneratePayload)
+{
+  expectSamePayload({RecordField("counter", 42),
+                     RecordField("temperature", -17),
+                     RecordField("zero", 0),
+                     RecordField("large", "2147483647", FieldTypes::Number)});
+}
+
+TEST_F(RecordCodecTest, WritesOtherNumbersLikeGeneratePayload)
+{
+  expectSamePayload({RecordField("temperature", 21.5f),
+                     RecordField("counter", "007", FieldTypes::Number),
+                     RecordField("exponent", "1e3", FieldTypes::Number),
+                     RecordField("overflow", "4294967296", FieldTypes::Number),
+                     RecordField("text", "12abc", FieldTypes::Number)});
+}
+
+TEST_F(RecordCodecTest, WritesEscapedValuesLikeGeneratePayload)
+{
+  expectSamePayload({RecordField("name", "say \"hi\"\\ \x01\b\f\n\t"),
+                     RecordField("quote\"d", "\xC3\xBC/\r"),
+                     RecordField("date", "10/19/2020", FieldTypes::Date)});
+}
@@ -0,0 +1,791 @@
+#!/usr/bin/env python3
+"""
+fms_mock.py - Filemaker DATA API library
+Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+
+Local stand-in for the FileMaker Data API v1, for load and regression tests
+of FMDataClient without a FileMaker Server. Only the standard library is
+used.
+
+Implemented: log in and out (/sessions), create, edit, delete and get
+records (/records), finds (/_find), container upload and the streaming url
+of the uploaded data (redirect with session cookie, byte ranges), globals.
+Responses have the shapes of FileMaker Server 19, errors included: 952 for
+an unknown or expired token, 401 when a find matches nothing, 101 for a
+missing record, 212 for a failed log in.
+
+Network conditions are set on the command line and changed at run time
+through the admin endpoints, which need no token:
+
+  GET  /_mock/config   current settings
+  POST /_mock/config   {"latency_ms": 50, "bandwidth": 20000, ...}
+  GET  /_mock/stats    requests, errors and bytes per operation
+  POST /_mock/reset    drops all records, sessions and statistics,
+                       {"statistics_only": true} keeps records and sessions
+
+Settings:
+  latency_ms  delay before every response
+  jitter_ms   random extra delay, 0 to jitter_ms
+  bandwidth   bytes per second in each direction, 0 for unlimited
+  error_rate  share of requests answered 503 without touching the data
+  down        close every connection right after accepting it
+  down_ms     be down for this long from now on, then come back; unlike
+              down the outage ends without reaching the admin endpoints
+  chunked     send find and record responses chunked
+  cut_bytes   container downloads stop after this many bytes of a response
+              and close the connection, 0 sends them whole
+  token_ttl   seconds a session token stays valid without use
+"""
+
+import argparse
+import base64
+import gzip
+import hashlib
+import json
+import os
+import random
+import re
+import socket
+import ssl
+import sys
+import threading
+import time
+import urllib.parse
+import zlib
+from datetime import datetime
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+API = "/fmi/data/v1/databases/"
+TIMESTAMP_FORMAT = "%m/%d/%Y %H:%M:%S"
+SEGMENT_SIZE = 1460
+
+ERRORS = {
+    "0": "OK",
+    "101": "Record is missing",
+    "212": "Invalid user account and/or password; please try again",
+    "401": "No records match the request",
+    "952": "Invalid FileMaker Data API token (*)",
+    "960": "Parameter is invalid",
+}
+
+
+class Settings:
+    """Network conditions, shared by all connections"""
+
+    FIELDS = {
+        "latency_ms": float,
+        "jitter_ms": float,
+        "bandwidth": int,
+        "error_rate": float,
+        "down": bool,
+        "down_ms": float,
+        "chunked": bool,
+        "cut_bytes": int,
+        "token_ttl": float,
+    }
+
+    def __init__(self, args):
+        self.lock = threading.Lock()
+        self.values = {name: kind(getattr(args, name)) for name, kind in self.FIELDS.items()}
+        self.down_until = time.monotonic() + self.values["down_ms"] / 1000
+
+    def get(self, name):
+        with self.lock:
+            return self.values[name]
+
+    def update(self, changes):
+        with self.lock:
+            for name, value in changes.items():
+                if name not in self.FIELDS:
+                    raise KeyError(name)
+                self.values[name] = self.FIELDS[name](value)
+                if name == "down_ms":
+                    self.down_until = time.monotonic() + self.values[name] / 1000
+            return dict(self.values)
+
+    def is_down(self):
+        with self.lock:
+            return self.values["down"] or time.monotonic() < self.down_until
+
+    def snapshot(self):
+        with self.lock:
+            return dict(self.values)
+
+
+class Statistics:
+    """Request counters per operation"""
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.active = 0
+        self.in_flight = 0
+        self.reset()
+
+    def reset(self):
+        # Open connections and requests in flight are still counted when
+        # they end, only the totals and maximums start over
+        with self.lock:
+            self.operations = {}
+            self.connections = 0
+            self.max_active = self.active
+            self.max_in_flight = self.in_flight
+
+    def connection(self, delta):
+        with self.lock:
+            if delta > 0:
+                self.connections += 1
+            self.active += delta
+            self.max_active = max(self.max_active, self.active)
+
+    def begin(self):
+        with self.lock:
+            self.in_flight += 1
+            self.max_in_flight = max(self.max_in_flight, self.in_flight)
+
+    def end(self, operation, status, code, received, sent):
+        with self.lock:
+            self.in_flight -= 1
+            entry = self.operations.setdefault(
+                operation, {"requests": 0, "errors": 0, "received": 0, "sent": 0, "codes": {}})
+            entry["requests"] += 1
+            if status >= 400:
+                entry["errors"] += 1
+            entry["received"] += received
+            entry["sent"] += sent
+            key = "%d/%s" % (status, code)
+            entry["codes"][key] = entry["codes"].get(key, 0) + 1
+
+    def snapshot(self):
+        with self.lock:
+            return {
+                "connections": self.connections,
+                "active": self.active,
+                "max_active": self.max_active,
+                "max_in_flight": self.max_in_flight,
+                "operations": json.loads(json.dumps(self.operations)),
+            }
+
+
+class FileMakerError(Exception):
+    def __init__(self, status, code):
+        Exception.__init__(self, code)
+        self.status = status
+        self.code = code
+
+
+def now():
+    return datetime.now().strftime(TIMESTAMP_FORMAT)
+
+
+def comparable(value):
+    """Numbers compare as numbers and timestamps as timestamps, like FileMaker does"""
+    if isinstance(value, (int, float)):
+        return (0, value)
+    text = str(value).strip()
+    try:
+        return (0, float(text))
+    except ValueError:
+        pass
+    try:
+        return (1, datetime.strptime(text, TIMESTAMP_FORMAT))
+    except ValueError:
+        return (2, text.lower())
+
+
+def matches(value, criterion):
+    """Find request operators: ==, =, >=, <=, >, <, ... ranges and word prefixes"""
+    criterion = str(criterion).strip()
+    text = "" if value is None else str(value)
+    if criterion == "*":
+        return text != ""
+    if criterion == "=":
+        return text == ""
+    if criterion.startswith("=="):
+        return text == criterion[2:]
+    for operator in (">=", "<=", ">", "<"):
+        if criterion.startswith(operator):
+            if text == "":
+                return False
+            left, right = comparable(text), comparable(criterion[len(operator):])
+            if left[0] != right[0]:
+                return False
+            return {">=": left >= right, "<=": left <= right, ">": left > right, "<": left < right}[operator]
+    if "..." in criterion:
+        low, high = criterion.split("...", 1)
+        left = comparable(text)
+        return comparable(low) <= left <= comparable(high)
+    if criterion.startswith("="):
+        return text.lower() == criterion[1:].lower()
+    # Plain text matches records with a word starting with it
+    words = re.split(r"\W+", text.lower())
+    return any(word.startswith(criterion.lower()) for word in words if word) or text.lower().startswith(criterion.lower())
+
+
+class Store:
+    """Records per database and layout, sessions and globals"""
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.reset()
+
+    def reset(self):
+        with self.lock:
+            self.layouts = {}
+            self.next_id = {}
+            self.tokens = {}
+            self.globals = {}
+            self.containers = {}
+
+    def login(self):
+        token = hashlib.sha1(os.urandom(16)).hexdigest()[:41]
+        with self.lock:
+            self.tokens[token] = time.monotonic()
+        return token
+
+    def logout(self, token):
+        with self.lock:
+            return self.tokens.pop(token, None) is not None
+
+    def check_token(self, token, ttl):
+        with self.lock:
+            used = self.tokens.get(token)
+            if used is None or time.monotonic() - used > ttl:
+                self.tokens.pop(token, None)
+                raise FileMakerError(401, "952")
+            self.tokens[token] = time.monotonic()
+
+    def records(self, database, layout):
+        return self.layouts.setdefault((database, layout), {})
+
+    def create(self, database, layout, field_data):
+        with self.lock:
+            key = (database, layout)
+            record_id = self.next_id.get(key, 1)
+            self.next_id[key] = record_id + 1
+            stamp = now()
+            fields = dict(field_data)
+            fields.setdefault("CreationTimestamp", stamp)
+            fields["ModificationTimestamp"] = stamp
+            fields["RecordID"] = record_id
+            self.records(database, layout)[str(record_id)] = {
+                "fieldData": fields, "portalData": {}, "recordId": str(record_id), "modId": "0"}
+            return str(record_id)
+
+    def edit(self, database, layout, record_id, field_data):
+        with self.lock:
+            record = self.records(database, layout).get(record_id)
+            if record is None:
+                raise FileMakerError(500, "101")
+            record["fieldData"].update(field_data)
+            record["fieldData"]["ModificationTimestamp"] = now()
+            record["modId"] = str(int(record["modId"]) + 1)
+            return record["modId"]
+
+    def delete(self, database, layout, record_id):
+        with self.lock:
+            if self.records(database, layout).pop(record_id, None) is None:
+                raise FileMakerError(500, "101")
+
+    def get(self, database, layout, record_id):
+        with self.lock:
+            record = self.records(database, layout).get(record_id)
+            if record is None:
+                raise FileMakerError(500, "101")
+            return json.loads(json.dumps(record))
+
+    def find(self, database, layout, query, sort):
+        with self.lock:
+            records = list(self.records(database, layout).values())
+            total = len(records)
+            found = []
+            for record in records:
+                keep = False
+                for request in query:
+                    omit = str(request.get("omit", "false")).lower() == "true"
+                    criteria = {name: value for name, value in request.items() if name != "omit"}
+                    if all(matches(record["fieldData"].get(name), value) for name, value in criteria.items()):
+                        keep = not omit
+                if keep:
+                    found.append(record)
+            found = json.loads(json.dumps(found))
+        for rule in reversed(sort or []):
+            name = rule.get("fieldName")
+            descend = str(rule.get("sortOrder", "ascend")).lower() == "descend"
+            found.sort(key=lambda record: comparable(record["fieldData"].get(name, "")), reverse=descend)
+        return total, found
+
+    def all(self, database, layout):
+        with self.lock:
+            return json.loads(json.dumps(list(self.records(database, layout).values())))
+
+    def put_container(self, database, layout, record_id, field, repetition, name, data, base_url):
+        with self.lock:
+            record = self.records(database, layout).get(record_id)
+            if record is None:
+                raise FileMakerError(500, "101")
+            key = hashlib.sha1(("%s/%s/%s/%s/%s" % (database, layout, record_id, field, repetition)).encode()).hexdigest()
+            self.containers[key] = data
+            extension = os.path.splitext(name)[1] or ".bin"
+            url = "%s/Streaming_SSL/MainDB/%s%s?RCType=EmbeddedRCFileProcessor" % (base_url, key, extension)
+            record["fieldData"][field] = url
+            record["modId"] = str(int(record["modId"]) + 1)
+            return record["modId"]
+
+    def container(self, key):
+        with self.lock:
+            return self.containers.get(key)
+
+    def set_globals(self, database, fields):
+        with self.lock:
+            self.globals.setdefault(database, {}).update(fields)
+
+
+def message(code="0"):
+    return {"messages": [{"code": code, "message": ERRORS.get(code, "Error")}]}
+
+
+def data_info(database, layout, total, found, returned):
+    return {
+        "database": database,
+        "layout": layout,
+        "table": layout,
+        "totalRecordCount": total,
+        "foundCount": found,
+        "returnedCount": returned,
+    }
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    server_version = "FileMaker/19.0 mock"
+
+    def setup(self):
+        settings = self.server.settings
+        if settings.is_down():
+            self.request.close()
+            raise ConnectionAbortedError("host is down")
+        # Headers and body go out in separate writes, Nagle would hold the
+        # body back for the delayed ACK of a keep-alive client
+        self.request.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        if self.server.tls is not None:
+            self.request.settimeout(10)
+            self.request = self.server.tls.wrap_socket(self.request, server_side=True)
+        self.request.settimeout(None)
+        BaseHTTPRequestHandler.setup(self)
+        self.server.statistics.connection(1)
+
+    def finish(self):
+        try:
+            BaseHTTPRequestHandler.finish(self)
+        finally:
+            self.server.statistics.connection(-1)
+
+    def log_message(self, format, *args):
+        if self.server.verbose:
+            BaseHTTPRequestHandler.log_message(self, format, *args)
+
+    def do_GET(self):
+        self.handle_request("GET")
+
+    def do_POST(self):
+        self.handle_request("POST")
+
+    def do_PATCH(self):
+        self.handle_request("PATCH")
+
+    def do_PUT(self):
+        self.handle_request("PUT")
+
+    def do_DELETE(self):
+        self.handle_request("DELETE")
+
+    def throttle(self, size, start):
+        bandwidth = self.server.settings.get("bandwidth")
+        if bandwidth > 0:
+            delay = start + size / float(bandwidth) - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+
+    def read_body(self):
+        length = int(self.headers.get("Content-Length") or 0)
+        body = bytearray()
+        start = time.monotonic()
+        while len(body) < length:
+            chunk = self.rfile.read(min(SEGMENT_SIZE, length - len(body)))
+            if not chunk:
+                break
+            body += chunk
+            self.throttle(len(body), start)
+        return bytes(body)
+
+    def write_throttled(self, data):
+        start = time.monotonic()
+        for position in range(0, len(data), SEGMENT_SIZE):
+            self.wfile.write(data[position:position + SEGMENT_SIZE])
+            self.throttle(position + SEGMENT_SIZE, start)
+
+    def accepts(self, encoding):
+        for value in self.headers.get_all("Accept-Encoding") or []:
+            if encoding in [part.split(";")[0].strip() for part in value.split(",")]:
+                return True
+        return False
+
+    def respond(self, status, body=b"", headers=None, chunked=False):
+        if isinstance(body, (dict, list)):
+            # \u escapes are not decoded by ArduinoJson 6.14, send utf-8
+            body = json.dumps(body, ensure_ascii=False, separators=(",", ":")).encode("utf-8")
+            headers = dict(headers or {})
+            headers.setdefault("Content-Type", "application/json; charset=utf-8")
+            if self.accepts("gzip"):
+                body = gzip.compress(body)
+                headers["Content-Encoding"] = "gzip"
+            elif self.accepts("deflate"):
+                body = zlib.compress(body)
+                headers["Content-Encoding"] = "deflate"
+        self.send_response(status)
+        for name, value in (headers or {}).items():
+            self.send_header(name, value)
+        if chunked:
+            self.send_header("Transfer-Encoding", "chunked")
+        else:
+            self.send_header("Content-Length", str(len(body)))
+        self.send_header("Connection", "close" if self.close_connection else "keep-alive")
+        self.end_headers()
+        if self.command == "HEAD":
+            return len(body)
+        if chunked:
+            data = bytearray()
+            for position in range(0, len(body), 1024):
+                piece = body[position:position + 1024]
+                data += b"%x\r\n" % len(piece) + piece + b"\r\n"
+            data += b"0\r\n\r\n"
+            self.write_throttled(bytes(data))
+        elif 0 < self.body_limit < len(body):
+            # The announced length is not sent, the client sees an interrupted transfer
+            self.write_throttled(body[:self.body_limit])
+            self.close_connection = True
+            return self.body_limit
+        else:
+            self.write_throttled(body)
+        return len(body)
+
+    def token(self):
+        auth = self.headers.get("Authorization", "")
+        if not auth.startswith("Bearer "):
+            raise FileMakerError(401, "952")
+        token = auth[len("Bearer "):].strip()
+        self.server.store.check_token(token, self.server.settings.get("token_ttl"))
+        return token
+
+    def json_body(self, body):
+        try:
+            return json.loads(body.decode("utf-8")) if body else {}
+        except ValueError:
+            raise FileMakerError(400, "960")
+
+    def base_url(self):
+        host = self.headers.get("Host") or "%s:%d" % self.server.server_address[:2]
+        return "%s://%s" % ("https" if self.server.tls is not None else "http", host)
+
+    def handle_request(self, method):
+        settings = self.server.settings
+        statistics = self.server.statistics
+        statistics.begin()
+        url = urllib.parse.urlsplit(self.path)
+        operation = "unknown"
+        status = 500
+        code = "-"
+        received = sent = 0
+        self.body_limit = 0
+        try:
+            body = self.read_body()
+            received = len(body)
+            operation, handler, groups = self.route(method, url.path)
+            if not operation.startswith("admin"):
+                delay = settings.get("latency_ms") + random.uniform(0, settings.get("jitter_ms"))
+                if delay > 0:
+                    time.sleep(delay / 1000.0)
+                if random.random() < settings.get("error_rate"):
+                    raise FileMakerError(503, "-1")
+            status, response, headers, chunked = handler(body, url, *groups)
+            code = response["messages"][0]["code"] if isinstance(response, dict) and "messages" in response else "-"
+            sent = self.respond(status, response, headers, chunked)
+        except FileMakerError as error:
+            status, code = error.status, error.code
+            response = message(code)
+            response["response"] = {}
+            if status == 503:
+                response = {"messages": [{"code": "-1", "message": "Service Unavailable"}], "response": {}}
+            sent = self.respond(status, response)
+        except (ConnectionError, socket.timeout, ssl.SSLError):
+            self.close_connection = True
+        finally:
+            statistics.end(operation, status, code, received, sent)
+
+    def route(self, method, path):
+        if path.startswith("/_mock/"):
+            name = path[len("/_mock/"):]
+            if name == "config":
+                return "admin", self.admin_config, ()
+            if name == "stats":
+                return "admin", self.admin_stats, ()
+            if name == "reset":
+                return "admin", self.admin_reset, ()
+        if path.startswith("/Streaming_SSL/MainDB/") and method == "GET":
+            return "downloadContainer", self.download_container, (path[len("/Streaming_SSL/MainDB/"):],)
+        if not path.startswith(API):
+            raise FileMakerError(404, "-")
+        parts = [urllib.parse.unquote(part) for part in path[len(API):].split("/")]
+        database = parts[0]
+        rest = parts[1:]
+        if rest == ["sessions"] and method == "POST":
+            return "logIn", self.log_in, (database,)
+        if len(rest) == 2 and rest[0] == "sessions" and method == "DELETE":
+            return "logOut", self.log_out, (database, rest[1])
+        if rest == ["globals"] and method == "PATCH":
+            return "setGlobals", self.set_globals, (database,)
+        if len(rest) >= 3 and rest[0] == "layouts":
+            layout = rest[1]
+            if rest[2:] == ["records"]:
+                if method == "POST":
+                    return "createRecord", self.create_record, (database, layout)
+                if method == "GET":
+                    return "getRecords", self.get_records, (database, layout)
+            if rest[2:] == ["_find"] and method == "POST":
+                return "performFind", self.perform_find, (database, layout)
+            if len(rest) == 4 and rest[2] == "records":
+                record_id = rest[3]
+                if method == "PATCH":
+                    return "editRecord", self.edit_record, (database, layout, record_id)
+                if method == "DELETE":
+                    return "deleteRecord", self.delete_record, (database, layout, record_id)
+                if method == "GET":
+                    return "getRecord", self.get_record, (database, layout, record_id)
+            if len(rest) == 7 and rest[2] == "records" and rest[4] == "containers" and method == "POST":
+                return "uploadContainer", self.upload_container, (database, layout, rest[3], rest[5], rest[6])
+        raise FileMakerError(404, "-")
+
+    def admin_config(self, body, url):
+        if self.command == "POST":
+            try:
+                values = self.server.settings.update(self.json_body(body))
+            except (KeyError, ValueError):
+                raise FileMakerError(400, "960")
+        else:
+            values = self.server.settings.snapshot()
+        return 200, values, None, False
+
+    def admin_stats(self, body, url):
+        return 200, self.server.statistics.snapshot(), None, False
+
+    def admin_reset(self, body, url):
+        if not self.json_body(body).get("statistics_only"):
+            self.server.store.reset()
+        self.server.statistics.reset()
+        return 200, {}, None, False
+
+    def log_in(self, body, url, database):
+        expected = "Basic " + base64.b64encode(
+            ("%s:%s" % (self.server.user, self.server.password)).encode()).decode()
+        if self.headers.get("Authorization", "") != expected:
+            raise FileMakerError(401, "212")
+        token = self.server.store.login()
+        response = message()
+        response["response"] = {"token": token}
+        return 200, response, {"X-FM-Data-Access-Token": token}, False
+
+    def log_out(self, body, url, database, token):
+        if not self.server.store.logout(token):
+            raise FileMakerError(401, "952")
+        response = message()
+        response["response"] = {}
+        return 200, response, None, False
+
+    def set_globals(self, body, url, database):
+        self.token()
+        fields = self.json_body(body).get("globalFields")
+        if not isinstance(fields, dict):
+            raise FileMakerError(400, "960")
+        self.server.store.set_globals(database, fields)
+        response = message()
+        response["response"] = {}
+        return 200, response, None, False
+
+    def create_record(self, body, url, database, layout):
+        self.token()
+        request = self.json_body(body)
+        record_id = self.server.store.create(database, layout, request.get("fieldData", {}))
+        response = message()
+        response["response"] = {"recordId": record_id, "modId": "0"}
+        return 200, response, None, False
+
+    def edit_record(self, body, url, database, layout, record_id):
+        self.token()
+        request = self.json_body(body)
+        mod_id = self.server.store.edit(database, layout, record_id, request.get("fieldData", {}))
+        response = message()
+        response["response"] = {"modId": mod_id}
+        return 200, response, None, False
+
+    def delete_record(self, body, url, database, layout, record_id):
+        self.token()
+        self.server.store.delete(database, layout, record_id)
+        response = message()
+        response["response"] = {}
+        return 200, response, None, False
+
+    def get_record(self, body, url, database, layout, record_id):
+        self.token()
+        record = self.server.store.get(database, layout, record_id)
+        response = message()
+        response["response"] = {"dataInfo": data_info(database, layout, 1, 1, 1), "data": [record]}
+        return 200, response, None, self.server.settings.get("chunked")
+
+    def get_records(self, body, url, database, layout):
+        self.token()
+        query = urllib.parse.parse_qs(url.query)
+        offset = max(int(query.get("_offset", ["1"])[0]), 1)
+        limit = int(query.get("_limit", ["100"])[0])
+        sort = json.loads(query["_sort"][0]) if "_sort" in query else []
+        records = self.server.store.all(database, layout)
+        total, found = self.server.store.find(database, layout, [{}], sort) if sort else (len(records), records)
+        if not found:
+            raise FileMakerError(500, "401")
+        page = found[offset - 1:offset - 1 + limit]
+        response = message()
+        response["response"] = {"dataInfo": data_info(database, layout, total, len(found), len(page)), "data": page}
+        return 200, response, None, self.server.settings.get("chunked")
+
+    def perform_find(self, body, url, database, layout):
+        self.token()
+        request = self.json_body(body)
+        query = request.get("query")
+        if not isinstance(query, list) or not query:
+            raise FileMakerError(400, "960")
+        offset = max(int(request.get("offset", 1)), 1)
+        limit = int(request.get("limit", 100))
+        total, found = self.server.store.find(database, layout, query, request.get("sort"))
+        if not found:
+            raise FileMakerError(500, "401")
+        page = found[offset - 1:offset - 1 + limit]
+        response = message()
+        response["response"] = {"dataInfo": data_info(database, layout, total, len(found), len(page)), "data": page}
+        return 200, response, None, self.server.settings.get("chunked")
+
+    def upload_container(self, body, url, database, layout, record_id, field, repetition):
+        self.token()
+        content_type = self.headers.get("Content-Type", "")
+        match = re.search(r"boundary=([^;]+)", content_type)
+        if match is None:
+            raise FileMakerError(400, "960")
+        boundary = b"--" + match.group(1).strip().strip('"').encode()
+        name = None
+        data = None
+        for part in body.split(boundary)[1:]:
+            if part.startswith(b"--"):
+                break
+            head, _, content = part.partition(b"\r\n\r\n")
+            if b'name="upload"' in head:
+                found = re.search(rb'filename="([^"]*)"', head)
+                name = found.group(1).decode("utf-8", "replace") if found else "upload.bin"
+                data = content[:-2] if content.endswith(b"\r\n") else content
+        if data is None:
+            raise FileMakerError(400, "960")
+        mod_id = self.server.store.put_container(database, layout, record_id, field, repetition, name, data, self.base_url())
+        response = message()
+        response["response"] = {"modId": mod_id}
+        return 200, response, None, False
+
+    def download_container(self, body, url, name):
+        key = os.path.splitext(name)[0]
+        data = self.server.store.container(key)
+        if data is None:
+            return 404, b"", None, False
+        # Like FileMaker Server, the first request only sets the session cookie
+        if "X-FMS-Session-Key=" not in (self.headers.get("Cookie") or ""):
+            cookie = "X-FMS-Session-Key=%s; HttpOnly" % hashlib.sha1(os.urandom(8)).hexdigest()
+            location = url.path + ("?" + url.query if url.query else "")
+            return 302, b"", {"Set-Cookie": cookie, "Location": location}, False
+        headers = {"Content-Type": "application/octet-stream", "Accept-Ranges": "bytes"}
+        self.body_limit = self.server.settings.get("cut_bytes")
+        match = re.match(r"bytes=(\d+)-(\d*)$", self.headers.get("Range") or "")
+        if match is None:
+            return 200, data, headers, False
+        first = int(match.group(1))
+        last = int(match.group(2)) if match.group(2) else len(data) - 1
+        if first >= len(data):
+            headers["Content-Range"] = "bytes */%d" % len(data)
+            return 416, b"", headers, False
+        last = min(last, len(data) - 1)
+        headers["Content-Range"] = "bytes %d-%d/%d" % (first, last, len(data))
+        return 206, data[first:last + 1], headers, False
+
+
+class MockServer(ThreadingHTTPServer):
+    daemon_threads = True
+    request_queue_size = 64
+
+    def __init__(self, args):
+        ThreadingHTTPServer.__init__(self, (args.host, args.port), Handler)
+        self.settings = Settings(args)
+        self.statistics = Statistics()
+        self.store = Store()
+        self.user = args.user
+        self.password = args.password
+        self.verbose = args.verbose
+        self.tls = None
+        if not args.plain:
+            self.tls = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+            self.tls.load_cert_chain(args.cert, args.key)
+
+    def handle_error(self, request, client_address):
+        error = sys.exc_info()[1]
+        if isinstance(error, (ConnectionError, ssl.SSLError, socket.timeout, OSError)):
+            return
+        ThreadingHTTPServer.handle_error(self, request, client_address)
+
+
+def parse_arguments(argv=None):
+    parser = argparse.ArgumentParser(description="FileMaker Data API stand-in")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=8443, help="0 picks a free port")
+    parser.add_argument("--port-file", help="write the port to this file once listening")
+    parser.add_argument("--cert", default=os.path.join(HERE, "localhost.crt"))
+    parser.add_argument("--key", default=os.path.join(HERE, "localhost.key"))
+    parser.add_argument("--plain", action="store_true", help="http instead of https")
+    parser.add_argument("--user", default="admin")
+    parser.add_argument("--password", default="admin")
+    parser.add_argument("--latency-ms", dest="latency_ms", type=float, default=0)
+    parser.add_argument("--jitter-ms", dest="jitter_ms", type=float, default=0)
+    parser.add_argument("--bandwidth", type=int, default=0, help="bytes per second, 0 for unlimited")
+    parser.add_argument("--error-rate", dest="error_rate", type=float, default=0)
+    parser.add_argument("--down", action="store_true")
+    parser.add_argument("--down-ms", dest="down_ms", type=float, default=0)
+    parser.add_argument("--chunked", action="store_true")
+    parser.add_argument("--cut-bytes", dest="cut_bytes", type=int, default=0,
+                        help="interrupt container downloads after this many bytes")
+    parser.add_argument("--token-ttl", dest="token_ttl", type=float, default=900)
+    parser.add_argument("--verbose", action="store_true")
+    return parser.parse_args(argv)
+
+
+def main(argv=None):
+    args = parse_arguments(argv)
+    server = MockServer(args)
+    port = server.server_address[1]
+    if args.port_file:
+        with open(args.port_file + ".tmp", "w") as output:
+            output.write(str(port))
+        os.replace(args.port_file + ".tmp", args.port_file)
+    print("FileMaker Data API mock listening on %s:%d" % (args.host, port), flush=True)
+    try:
+        server.serve_forever(poll_interval=0.1)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        server.server_close()
+
+
+if __name__ == "__main__":
+    main()
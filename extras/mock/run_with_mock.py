@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+"""
+run_with_mock.py - Filemaker DATA API library
+Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+
+Starts one or more mock servers on free ports, runs a command against them
+and stops them again. {port0}, {port1}, ... and {ca} in the command are
+replaced by the ports of the mocks and the path of their certificate.
+
+  run_with_mock.py "--mock=--latency-ms 20" --mock= -- load_test --port {port0}
+"""
+
+import argparse
+import os
+import shlex
+import subprocess
+import sys
+import tempfile
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+def start_mock(arguments, directory, index):
+    port_file = os.path.join(directory, "port%d" % index)
+    process = subprocess.Popen(
+        [sys.executable, os.path.join(HERE, "fms_mock.py"), "--port", "0", "--port-file", port_file]
+        + shlex.split(arguments),
+        stdout=subprocess.DEVNULL)
+    deadline = time.monotonic() + 10
+    while not os.path.exists(port_file):
+        if process.poll() is not None or time.monotonic() > deadline:
+            process.kill()
+            raise RuntimeError("mock %d did not start" % index)
+        time.sleep(0.05)
+    with open(port_file) as source:
+        return process, int(source.read())
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Run a command against mock FileMaker servers")
+    parser.add_argument("--mock", action="append", default=None,
+                        help="arguments of one mock server, repeat for more servers")
+    parser.add_argument("command", nargs=argparse.REMAINDER)
+    args = parser.parse_args()
+    command = args.command[1:] if args.command[:1] == ["--"] else args.command
+    if not command:
+        parser.error("no command")
+    mocks = args.mock if args.mock is not None else [""]
+    processes = []
+    with tempfile.TemporaryDirectory() as directory:
+        try:
+            values = {"ca": os.path.join(HERE, "localhost.crt")}
+            for index, arguments in enumerate(mocks):
+                process, port = start_mock(arguments, directory, index)
+                processes.append(process)
+                values["port%d" % index] = port
+            command = [part.format(**values) for part in command]
+            return subprocess.call(command)
+        finally:
+            for process in processes:
+                process.terminate()
+            for process in processes:
+                try:
+                    process.wait(5)
+                except subprocess.TimeoutExpired:
+                    process.kill()
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,123 @@
+/*
+  BatchController.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "BatchController.h"
+
+BatchController::BatchController(void)
+    : _batchSize(BATCH_MIN_SIZE),
+      _minBatch(BATCH_MIN_SIZE),
+      _maxBatch(BATCH_MAX_SIZE),
+      _interval(BATCH_MIN_INTERVAL),
+      _minInterval(BATCH_MIN_INTERVAL),
+      _maxInterval(BATCH_MAX_INTERVAL),
+      _latencyTarget(BATCH_LATENCY_TARGET),
+      _roundTrip(0),
+      _throughput(0),
+      _requestBytes(0),
+      _errorRate(0)
+{
+}
+
+void BatchController::setBatchBounds(uint16_t minimum, uint16_t maximum)
+{
+  this->_minBatch = max(minimum, (uint16_t)1);
+  this->_maxBatch = max(maximum, this->_minBatch);
+  this->_batchSize = constrain(this->_batchSize, this->_minBatch, this->_maxBatch);
+  this->updateInterval();
+}
+
+void BatchController::setIntervalBounds(uint32_t minimum, uint32_t maximum)
+{
+  this->_minInterval = minimum;
+  this->_maxInterval = max(maximum, minimum);
+  this->updateInterval();
+}
+
+void BatchController::setLatencyTarget(uint32_t milliseconds)
+{
+  this->_latencyTarget = milliseconds;
+  this->updateInterval();
+}
+
+/**
+ * @brief Smooths a value, the first sample is taken as is
+ */
+static uint32_t smooth(uint32_t average, uint32_t sample)
+{
+  if (average == 0)
+    return sample;
+  return average + (((int32_t)sample - (int32_t)average) >> BATCH_SMOOTHING_SHIFT);
+}
+
+void BatchController::record(uint16_t requests, uint16_t errors, uint32_t duration, size_t bytes)
+{
+  if (requests == 0)
+    return;
+  this->_roundTrip = smooth(this->_roundTrip, max(duration / requests, (uint32_t)1));
+  this->_requestBytes = smooth(this->_requestBytes, max((uint32_t)(bytes / requests), (uint32_t)1));
+  if (duration > 0)
+    this->_throughput = smooth(this->_throughput, bytes * 1000 / duration);
+  float weight = 1.0f / (1 << BATCH_SMOOTHING_SHIFT);
+  this->_errorRate += ((float)errors / requests - this->_errorRate) * weight;
+  if (this->_errorRate > BATCH_ERROR_RATE_LIMIT || duration > this->_latencyTarget)
+  {
+    this->_batchSize = max((uint16_t)(this->_batchSize / 2), this->_minBatch);
+  }
+  else if (errors == 0 && requests >= this->_batchSize && this->_batchSize < this->_maxBatch &&
+           this->estimateSending(this->_batchSize + 1) <= this->_latencyTarget)
+  {
+    // Only grow when the batch was full, a partial batch says nothing about a larger one
+    this->_batchSize++;
+  }
+  this->updateInterval();
+  log_d("Batch %u, interval %u ms, rtt %u ms, %u B/s, errors %.2f",
+        this->_batchSize, this->_interval, this->_roundTrip, this->_throughput, this->_errorRate);
+}
+
+/**
+ * @brief Expected milliseconds to send a batch, from the smoothed bytes per
+ * request and throughput, or the round trip time before any bytes were sent
+ *
+ * @param batchSize Requests in the batch
+ * @return uint32_t
+ */
+uint32_t BatchController::estimateSending(uint16_t batchSize) const
+{
+  if (this->_throughput == 0)
+    return this->_roundTrip * batchSize;
+  return (uint64_t)this->_requestBytes * batchSize * 1000 / this->_throughput;
+}
+
+void BatchController::updateInterval(void)
+{
+  uint32_t sending = this->estimateSending(this->_batchSize);
+  uint32_t interval = sending < this->_latencyTarget ? this->_latencyTarget - sending : 0;
+  this->_interval = constrain(interval, this->_minInterval, this->_maxInterval);
+}
+
+uint16_t BatchController::getBatchSize(void) const
+{
+  return this->_batchSize;
+}
+
+uint32_t BatchController::getFlushInterval(void) const
+{
+  return this->_interval;
+}
+
+uint32_t BatchController::getRoundTrip(void) const
+{
+  return this->_roundTrip;
+}
+
+uint32_t BatchController::getThroughput(void) const
+{
+  return this->_throughput;
+}
+
+float BatchController::getErrorRate(void) const
+{
+  return this->_errorRate;
+}
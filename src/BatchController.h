@@ -0,0 +1,123 @@
+/*
+  BatchController.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef BatchController_h
+#define BatchController_h
+
+#include <Arduino.h>
+
+#define BATCH_MIN_SIZE 1
+#define BATCH_MAX_SIZE 16
+#define BATCH_MIN_INTERVAL 50
+#define BATCH_MAX_INTERVAL 5000
+#define BATCH_LATENCY_TARGET 2000
+// Weight of a new sample in the smoothed values, 1/8
+#define BATCH_SMOOTHING_SHIFT 3
+// Smoothed share of failed requests above which the batch is halved
+#define BATCH_ERROR_RATE_LIMIT 0.05f
+
+/**
+ * @brief Tunes batch size and flush interval from the observed round trips
+ * AIMD: the batch grows by one after a batch that finished without errors,
+ * when a batch one larger is expected to be sent within the latency target.
+ * It is halved after a slow batch and after every batch while the smoothed
+ * error rate is above BATCH_ERROR_RATE_LIMIT, a single failure only stops
+ * it from growing. The time to send a batch is its payload bytes divided by
+ * the smoothed throughput, so larger records make smaller batches. The flush
+ * interval is what is left of the latency target after sending a batch, so
+ * a record is delivered within the target on a good link and batches get
+ * small and frequent on a marginal one.
+ */
+class BatchController
+{
+public:
+  BatchController(void);
+
+  /**
+   * @brief Sets the bounds of the batch size
+   *
+   * @param minimum At least 1
+   * @param maximum
+   */
+  void setBatchBounds(uint16_t minimum, uint16_t maximum);
+
+  /**
+   * @brief Sets the bounds of the flush interval
+   *
+   * @param minimum Milliseconds
+   * @param maximum Milliseconds
+   */
+  void setIntervalBounds(uint32_t minimum, uint32_t maximum);
+
+  /**
+   * @brief Sets the time from queuing a record to its delivery to aim for
+   *
+   * @param milliseconds
+   */
+  void setLatencyTarget(uint32_t milliseconds);
+
+  /**
+   * @brief Adapts to a sent batch
+   *
+   * @param requests Requests in the batch
+   * @param errors Failed requests
+   * @param duration Milliseconds to send the batch
+   * @param bytes Payload bytes sent
+   */
+  void record(uint16_t requests, uint16_t errors, uint32_t duration, size_t bytes);
+
+  /**
+   * @brief Number of records to collect before sending
+   *
+   * @return uint16_t
+   */
+  uint16_t getBatchSize(void) const;
+
+  /**
+   * @brief Milliseconds to wait for a batch to fill before sending what there is
+   *
+   * @return uint32_t
+   */
+  uint32_t getFlushInterval(void) const;
+
+  /**
+   * @brief Smoothed round trip time per request
+   *
+   * @return uint32_t Milliseconds
+   */
+  uint32_t getRoundTrip(void) const;
+
+  /**
+   * @brief Smoothed payload throughput
+   *
+   * @return uint32_t Bytes per second
+   */
+  uint32_t getThroughput(void) const;
+
+  /**
+   * @brief Smoothed share of failed requests
+   *
+   * @return float 0 to 1
+   */
+  float getErrorRate(void) const;
+
+private:
+  uint32_t estimateSending(uint16_t batchSize) const;
+  void updateInterval(void);
+  uint16_t _batchSize;
+  uint16_t _minBatch;
+  uint16_t _maxBatch;
+  uint32_t _interval;
+  uint32_t _minInterval;
+  uint32_t _maxInterval;
+  uint32_t _latencyTarget;
+  uint32_t _roundTrip;
+  uint32_t _throughput;
+  uint32_t _requestBytes;
+  float _errorRate;
+};
+
+#endif
@@ -0,0 +1,38 @@
+/*
+  CancellationToken.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "CancellationToken.h"
+
+CancellationToken::CancellationToken(uint32_t timeout)
+    : _cancelled(false)
+{
+  this->setTimeout(timeout);
+}
+
+void CancellationToken::setTimeout(uint32_t timeout)
+{
+  this->_start = millis();
+  this->_timeout = timeout;
+}
+
+void CancellationToken::cancel(void)
+{
+  this->_cancelled = true;
+}
+
+boolean CancellationToken::isCancelled(void) const
+{
+  return this->getRemaining() == 0;
+}
+
+uint32_t CancellationToken::getRemaining(void) const
+{
+  if (this->_cancelled)
+    return 0;
+  if (this->_timeout == 0)
+    return UINT32_MAX;
+  unsigned long elapsed = millis() - this->_start;
+  return elapsed >= this->_timeout ? 0 : this->_timeout - elapsed;
+}
@@ -0,0 +1,62 @@
+/*
+  CancellationToken.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef CancellationToken_h
+#define CancellationToken_h
+
+#include <Arduino.h>
+#include <atomic>
+
+/** Http code reported for a request that was cancelled or ran past its deadline */
+#define HTTP_ERROR_CANCELLED -101
+
+/**
+ * @brief Deadline and cancellation flag of one or more requests
+ * The deadline spans everything the client does for a call: waiting for
+ * the rate limiter, connecting, the TLS handshake, sending, receiving and
+ * the delays between retries. cancel() may be called from another task,
+ * the request stops at its next check and closes the connection.
+ */
+class CancellationToken
+{
+public:
+  /**
+   * @brief Construct a new Cancellation Token object
+   *
+   * @param timeout Milliseconds from now until the deadline, 0 for none
+   */
+  CancellationToken(uint32_t timeout = 0);
+
+  /**
+   * @brief Sets the deadline
+   *
+   * @param timeout Milliseconds from now, 0 for none
+   */
+  void setTimeout(uint32_t timeout);
+
+  void cancel(void);
+
+  /**
+   * @brief Whether the token was cancelled or its deadline passed
+   *
+   * @return boolean
+   */
+  boolean isCancelled(void) const;
+
+  /**
+   * @brief Time left until the deadline
+   *
+   * @return uint32_t Milliseconds, 0 when cancelled, UINT32_MAX without deadline
+   */
+  uint32_t getRemaining(void) const;
+
+private:
+  std::atomic<bool> _cancelled;
+  unsigned long _start;
+  uint32_t _timeout;
+};
+
+#endif
@@ -0,0 +1,145 @@
+/*
+  DnsCache.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "DnsCache.h"
+
+DnsCache::Entry::Entry(void)
+    : updated(0),
+      ttl(0),
+      resolved(false),
+      pinned(false)
+{
+}
+
+DnsCache::DnsCache(uint32_t ttl, uint32_t negativeTtl)
+    : _ttl(ttl),
+      _negativeTtl(negativeTtl),
+      _hits(0),
+      _misses(0)
+{
+}
+
+DnsCache::Entry *DnsCache::find(const char *host)
+{
+  for (Entry &entry : this->_entries)
+  {
+    if (entry.host == host)
+      return &entry;
+  }
+  return NULL;
+}
+
+/**
+ * @brief Entry of a host, replacing the oldest unpinned entry when the host is new
+ */
+DnsCache::Entry &DnsCache::store(const char *host)
+{
+  Entry *entry = this->find(host);
+  if (entry != NULL)
+    return *entry;
+  unsigned long now = millis();
+  for (Entry &candidate : this->_entries)
+  {
+    if (candidate.host.length() == 0)
+    {
+      entry = &candidate;
+      break;
+    }
+    if (!candidate.pinned && (entry == NULL || now - candidate.updated > now - entry->updated))
+      entry = &candidate;
+  }
+  if (entry == NULL)
+  {
+    // Every entry is pinned, the last one makes room
+    entry = &this->_entries[DNS_CACHE_SIZE - 1];
+  }
+  *entry = Entry();
+  entry->host = host;
+  return *entry;
+}
+
+boolean DnsCache::resolve(const char *host, IPAddress &address)
+{
+  if (host == NULL || *host == '\0')
+    return false;
+  if (address.fromString(host))
+    return true;
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    Entry *entry = this->find(host);
+    if (entry != NULL && (entry->pinned || millis() - entry->updated < entry->ttl))
+    {
+      this->_hits++;
+      address = entry->address;
+      return entry->resolved;
+    }
+    this->_misses++;
+  }
+  // The lookup is slow, other hosts stay available meanwhile
+  IPAddress resolved;
+  boolean found = WiFi.hostByName(host, resolved) == 1 && (uint32_t)resolved != 0;
+  if (!found)
+    log_e("Could not resolve: %s", host);
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  Entry &entry = this->store(host);
+  if (entry.pinned)
+  {
+    address = entry.address;
+    return true;
+  }
+  entry.address = resolved;
+  entry.resolved = found;
+  entry.updated = millis();
+  entry.ttl = found ? this->_ttl : this->_negativeTtl;
+  address = resolved;
+  return found;
+}
+
+void DnsCache::pin(const char *host, const IPAddress &address)
+{
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  Entry &entry = this->store(host);
+  entry.address = address;
+  entry.resolved = true;
+  entry.pinned = true;
+  entry.updated = millis();
+}
+
+void DnsCache::unpin(const char *host)
+{
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  Entry *entry = this->find(host);
+  if (entry != NULL)
+    *entry = Entry();
+}
+
+void DnsCache::invalidate(const char *host)
+{
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  Entry *entry = this->find(host);
+  if (entry != NULL && !entry->pinned)
+    *entry = Entry();
+}
+
+void DnsCache::clear(void)
+{
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  for (Entry &entry : this->_entries)
+  {
+    entry = Entry();
+  }
+  this->_hits = 0;
+  this->_misses = 0;
+}
+
+uint32_t DnsCache::getHits(void) const
+{
+  return this->_hits;
+}
+
+uint32_t DnsCache::getMisses(void) const
+{
+  return this->_misses;
+}
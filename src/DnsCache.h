@@ -0,0 +1,99 @@
+/*
+  DnsCache.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef DnsCache_h
+#define DnsCache_h
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <mutex>
+#include "InlineString.h"
+
+#define DNS_CACHE_SIZE 4
+/** lwIP does not report record TTLs, resolved addresses are kept this long */
+#define DNS_CACHE_TTL 300000
+/** Failed lookups are not repeated for this long */
+#define DNS_CACHE_NEGATIVE_TTL 10000
+/** Host names up to this length minus one are kept without a heap block */
+#ifndef DNS_CACHE_HOST_CAPACITY
+#define DNS_CACHE_HOST_CAPACITY 64
+#endif
+
+/**
+ * @brief Host name to address cache with expiry, negative caching and pinning
+ * An address that can not be connected to is dropped, so a host that moved
+ * is resolved again on the next request. Pinned addresses never expire and
+ * are never looked up. Share one cache between the clients of a host, it is
+ * safe to use from several tasks.
+ */
+class DnsCache
+{
+public:
+  /**
+   * @brief Construct a new Dns Cache object
+   *
+   * @param ttl Milliseconds a resolved address is used
+   * @param negativeTtl Milliseconds a failed lookup is remembered
+   */
+  DnsCache(uint32_t ttl = DNS_CACHE_TTL, uint32_t negativeTtl = DNS_CACHE_NEGATIVE_TTL);
+
+  /**
+   * @brief Address of a host, from the cache or looked up
+   *
+   * @param host Host name or address
+   * @param address Destination
+   * @return boolean false when the lookup failed, now or within the negative ttl
+   */
+  boolean resolve(const char *host, IPAddress &address);
+
+  /**
+   * @brief Uses a fixed address for a host, no lookups are made for it
+   * The certificate is still checked against the host name.
+   *
+   * @param host Host name
+   * @param address Address to connect to
+   */
+  void pin(const char *host, const IPAddress &address);
+
+  void unpin(const char *host);
+
+  /**
+   * @brief Forgets the address of a host, pinned addresses are kept
+   *
+   * @param host Host name
+   */
+  void invalidate(const char *host);
+
+  void clear(void);
+
+  /** Lookups answered from the cache, including negative answers */
+  uint32_t getHits(void) const;
+  /** Lookups sent to the resolver */
+  uint32_t getMisses(void) const;
+
+private:
+  class Entry
+  {
+  public:
+    Entry(void);
+    InlineString<DNS_CACHE_HOST_CAPACITY> host;
+    IPAddress address;
+    unsigned long updated;
+    uint32_t ttl;
+    boolean resolved;
+    boolean pinned;
+  };
+  Entry *find(const char *host);
+  Entry &store(const char *host);
+  uint32_t _ttl;
+  uint32_t _negativeTtl;
+  uint32_t _hits;
+  uint32_t _misses;
+  Entry _entries[DNS_CACHE_SIZE];
+  std::mutex _mutex;
+};
+
+#endif
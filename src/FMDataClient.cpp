@@ -9,13 +9,13 @@ DatabaseCredentials::DatabaseCredentials(String database)
 {
   if (database == EMPTY_STRING)
     throw ERROR_MSG_EMPTY_DATABASE_NAME;
-  this->database = database;
+  this->database = std::move(database);
 }
 
 DatabaseCredentials::DatabaseCredentials(
     String database,
     const vector<DatabaseCredentials *> &externalDatabasesCredentials)
-    : DatabaseCredentials(database)
+    : DatabaseCredentials(std::move(database))
 {
   this->externalDatabasesCredentials = externalDatabasesCredentials;
 }
@@ -29,17 +29,20 @@ String DatabaseCredentials::getExternalDatabasesCredentialsPayload(void) const
     int size = externalDatabasesCredentials.size();
     const size_t capacity = JSON_ARRAY_SIZE(size) +
                             JSON_OBJECT_SIZE(1) +
-                            size * JSON_OBJECT_SIZE(4);
+                            size * JSON_OBJECT_SIZE(3);
     DynamicJsonDocument doc(capacity);
     JsonArray fmDataSource = doc.createNestedArray(PARAMETER_FM_DATA_SOURCE);
     for (DatabaseCredentials *c : externalDatabasesCredentials)
     {
       log_d("External Database: %s", c->database.c_str());
-      fmDataSource.add(c->toJSON());
+      c->toJSON(fmDataSource.createNestedObject());
     }
+    result.reserve(measureJson(doc));
     serializeJson(doc, result);
   }
+#if FMDATA_LOG_PAYLOADS
   log_d("External Databases Credentials: %s", result.c_str());
+#endif
   return result;
 }
 
@@ -56,14 +59,14 @@ String UserCredentials::getAuthorizationHeaderValue(void) const
 UserCredentials::UserCredentials(
     String database,
     String userName,
-    String password) : DatabaseCredentials(database)
+    String password) : DatabaseCredentials(std::move(database))
 {
   if (userName == EMPTY_STRING)
     throw ERROR_MSG_EMPTY_USER_NAME;
   if (password == EMPTY_STRING)
     throw ERROR_MSG_EMPTY_PASSWORD;
-  this->userName = userName;
-  this->password = password;
+  this->userName = std::move(userName);
+  this->password = std::move(password);
 }
 
 UserCredentials::UserCredentials(
@@ -72,37 +75,33 @@ UserCredentials::UserCredentials(
     String password,
     const vector<DatabaseCredentials *> &externalDatabasesCredentials)
     : DatabaseCredentials(
-          database,
+          std::move(database),
           externalDatabasesCredentials)
 {
   if (userName == EMPTY_STRING)
     throw ERROR_MSG_EMPTY_USER_NAME;
   if (password == EMPTY_STRING)
     throw ERROR_MSG_EMPTY_PASSWORD;
-  this->userName = userName;
-  this->password = password;
+  this->userName = std::move(userName);
+  this->password = std::move(password);
 }
 
-JsonObject UserCredentials::toJSON(void)
+void UserCredentials::toJSON(JsonObject dst) const
 {
-  const size_t CAPACITY = JSON_OBJECT_SIZE(4);
-  StaticJsonDocument<CAPACITY> doc;
-  JsonObject obj = doc.to<JsonObject>();
-  obj[PARAMETER_DATABASE] = this->database;
-  obj[PARAMETER_USER_NAME] = this->userName;
-  obj[PARAMETER_PASSWORD] = this->password;
-  return obj;
+  dst[PARAMETER_DATABASE] = this->database.c_str();
+  dst[PARAMETER_USER_NAME] = this->userName.c_str();
+  dst[PARAMETER_PASSWORD] = this->password.c_str();
 }
 
 OAuthUserCredentials::OAuthUserCredentials(String database, String oAuthRequestId, String oAuthId)
-    : DatabaseCredentials(database)
+    : DatabaseCredentials(std::move(database))
 {
   if (oAuthRequestId == EMPTY_STRING)
     throw ERROR_MSG_EMPTY_OAUTH_REQUEST_ID;
   if (oAuthId == EMPTY_STRING)
     throw ERROR_MSG_EMPTY_OAUTH_ID;
-  this->oAuthId = oAuthId;
-  this->oAuthRequestId = oAuthRequestId;
+  this->oAuthId = std::move(oAuthId);
+  this->oAuthRequestId = std::move(oAuthRequestId);
 }
 
 OAuthUserCredentials::OAuthUserCredentials(
@@ -111,15 +110,15 @@ OAuthUserCredentials::OAuthUserCredentials(
     String oAuthId,
     const vector<DatabaseCredentials *> &externalDatabasesCredentials)
     : DatabaseCredentials(
-          database,
+          std::move(database),
           externalDatabasesCredentials)
 {
   if (oAuthRequestId == EMPTY_STRING)
     throw ERROR_MSG_EMPTY_OAUTH_REQUEST_ID;
   if (oAuthId == EMPTY_STRING)
     throw ERROR_MSG_EMPTY_OAUTH_ID;
-  this->oAuthId = oAuthId;
-  this->oAuthRequestId = oAuthRequestId;
+  this->oAuthId = std::move(oAuthId);
+  this->oAuthRequestId = std::move(oAuthRequestId);
 }
 
 CredentialsType OAuthUserCredentials::getType(void) const
@@ -132,32 +131,28 @@ CredentialsType UserCredentials::getType(void) const
   return CredentialsType::UserCredentialsType;
 }
 
-JsonObject OAuthUserCredentials::toJSON(void)
+void OAuthUserCredentials::toJSON(JsonObject dst) const
 {
-  const size_t CAPACITY = JSON_OBJECT_SIZE(4);
-  StaticJsonDocument<CAPACITY> doc;
-  JsonObject obj = doc.to<JsonObject>();
-  obj[PARAMETER_DATABASE] = database;
-  obj[PARAMETER_OAUTH_REQUEST_ID] = this->oAuthRequestId;
-  obj[PARAMETER_OAUTH_IDENTIFIER] = this->oAuthId;
-  return obj;
+  dst[PARAMETER_DATABASE] = this->database.c_str();
+  dst[PARAMETER_OAUTH_REQUEST_ID] = this->oAuthRequestId.c_str();
+  dst[PARAMETER_OAUTH_IDENTIFIER] = this->oAuthId.c_str();
 }
 
-RecordField::RecordField(String fieldName, String fieldValue, FieldTypes fieldType)
+RecordField::RecordField(FieldName fieldName, RecordFieldValue fieldValue, FieldTypes fieldType)
+    : fieldName(std::move(fieldName)),
+      fieldValue(std::move(fieldValue)),
+      fieldType(fieldType)
 {
-  this->fieldName = fieldName;
-  this->fieldType = fieldType;
-  this->fieldValue = fieldValue;
 }
 
-RecordField::RecordField(String fieldName, float fieldValue)
+RecordField::RecordField(FieldName fieldName, float fieldValue)
+    : fieldName(std::move(fieldName)),
+      fieldValue(fieldValue),
+      fieldType(FieldTypes::Number)
 {
-  this->fieldName = fieldName;
-  this->fieldType = FieldTypes::Number;
-  this->fieldValue = String(fieldValue);
 }
 
-size_t RecordField::getSize()
+size_t RecordField::getSize(void) const
 {
   return this->fieldValue.length() + this->fieldName.length() + 1;
 }
@@ -172,62 +167,84 @@ size_t RecordField::getSize()
  * @param preSortScriptName Presort script name
  * @param preSortScriptParameter Presort script parameter
  */
-ScriptParameters::ScriptParameters(String name, String parameter,
-                                   String preRequestScriptName, String preRequestScriptParameter,
-                                   String preSortScriptName, String preSortScriptParameter)
+ScriptParameters::ScriptParameters(const String &name, const String &parameter,
+                                   const String &preRequestScriptName, const String &preRequestScriptParameter,
+                                   const String &preSortScriptName, const String &preSortScriptParameter)
+    : _name(name),
+      _parameter(parameter),
+      _preRequestScriptName(preRequestScriptName),
+      _preRequestScriptParameter(preRequestScriptParameter),
+      _preSortScriptName(preSortScriptName),
+      _preSortScriptParameter(preSortScriptParameter)
 {
-  this->_name = name;
   log_d("                      Script: %s", this->_name.c_str());
-  this->_parameter = parameter;
+#if FMDATA_LOG_PAYLOADS
   log_d("            Script Parameter: %s", this->_parameter.c_str());
-  this->_preRequestScriptName = preRequestScriptName;
+#endif
   log_d("          Pre Request Script: %s", this->_preRequestScriptName.c_str());
-  this->_preRequestScriptParameter = preRequestScriptParameter;
+#if FMDATA_LOG_PAYLOADS
   log_d("Pre Request Script Parameter: %s", this->_preRequestScriptParameter.c_str());
-  this->_preSortScriptName = preSortScriptName;
+#endif
   log_d("             Pre Sort Script: %s", this->_preSortScriptName.c_str());
-  this->_preSortScriptParameter = preSortScriptParameter;
+#if FMDATA_LOG_PAYLOADS
   log_d("   Pre Sort Script Parameter: %s", this->_preSortScriptParameter.c_str());
+#endif
 }
 
 /**
  * @brief Generates de script parameters for POST and PATCH requests
  * 
- * @return JsonDocument 
+ * @return DynamicJsonDocument 
  */
-JsonDocument ScriptParameters::toJSONDocument(void) const
+DynamicJsonDocument ScriptParameters::toJSONDocument(void) const
 {
+  DynamicJsonDocument doc(this->getJSONCapacity());
+  this->toJSON(doc.to<JsonObject>());
+#if FMDATA_LOG_PAYLOADS
   String result(EMPTY_STRING);
-  const size_t capacity = JSON_OBJECT_SIZE(6) + 160 + this->_name.length() + this->_parameter.length() + this->_preRequestScriptName.length() + this->_preRequestScriptParameter.length() + this->_preSortScriptName.length() + this->_preSortScriptParameter.length();
-  DynamicJsonDocument doc(capacity);
+  serializeJson(doc, result);
+  log_d("Json: %s", result.c_str());
+#endif
+  return doc;
+}
+
+void ScriptParameters::toJSON(JsonObject dst) const
+{
   if (!this->_name.isEmpty())
   {
-    doc[PARAMETER_SCRIPT_NAME] = this->_name;
+    dst[PARAMETER_SCRIPT_NAME] = this->_name.c_str();
   }
   if (!this->_parameter.isEmpty())
   {
-    doc[PARAMETER_SCRIPT_PARAMETER] = this->_parameter;
+    dst[PARAMETER_SCRIPT_PARAMETER] = this->_parameter.c_str();
   }
-
   if (!this->_preRequestScriptName.isEmpty())
   {
-    doc[PARAMETER_SCRIPT_PRE_REQUEST_NAME] = this->_preRequestScriptName;
+    dst[PARAMETER_SCRIPT_PRE_REQUEST_NAME] = this->_preRequestScriptName.c_str();
   }
   if (!this->_preRequestScriptParameter.isEmpty())
   {
-    doc[PARAMETER_SCRIPT_PRE_REQUEST_PARAMETER] = this->_preRequestScriptParameter;
+    dst[PARAMETER_SCRIPT_PRE_REQUEST_PARAMETER] = this->_preRequestScriptParameter.c_str();
   }
   if (!this->_preSortScriptName.isEmpty())
   {
-    doc[PARAMETER_SCRIPT_PRE_SORT_NAME] = this->_preSortScriptName;
+    dst[PARAMETER_SCRIPT_PRE_SORT_NAME] = this->_preSortScriptName.c_str();
   }
   if (!this->_preSortScriptParameter.isEmpty())
   {
-    doc[PARAMETER_SCRIPT_PRE_SORT_PARAMETER] = this->_preSortScriptParameter;
+    dst[PARAMETER_SCRIPT_PRE_SORT_PARAMETER] = this->_preSortScriptParameter.c_str();
   }
-  serializeJson(doc, result);
-  log_d("Json: %s", result.c_str());
-  return doc;
+}
+
+size_t ScriptParameters::getJSONCapacity(void) const
+{
+  size_t count = !this->_name.isEmpty() +
+                 !this->_parameter.isEmpty() +
+                 !this->_preRequestScriptName.isEmpty() +
+                 !this->_preRequestScriptParameter.isEmpty() +
+                 !this->_preSortScriptName.isEmpty() +
+                 !this->_preSortScriptParameter.isEmpty();
+  return JSON_OBJECT_SIZE(count);
 }
 
 /**
@@ -264,11 +281,11 @@ String ScriptParameters::toQueryString(void) const
   return result;
 }
 
-RecordField::RecordField(String fieldName, int fieldValue)
+RecordField::RecordField(FieldName fieldName, int fieldValue)
+    : fieldName(std::move(fieldName)),
+      fieldValue(fieldValue),
+      fieldType(FieldTypes::Number)
 {
-  this->fieldName = fieldName;
-  this->fieldType = FieldTypes::Number;
-  this->fieldValue = String(fieldValue);
 }
 String OAuthUserCredentials::getAuthorizationHeaderValue(void) const
 {
@@ -283,11 +300,11 @@ String DatabaseCredentials::getLogInUrl(void) const
   return String(buff);
 }
 
-String DatabaseCredentials::getLogOutUrl(const String &token) const
+String DatabaseCredentials::getLogOutUrl(const char *token) const
 {
-  size_t length = sizeof(URL_SESSION_DELETE) + this->database.length() + token.length();
+  size_t length = sizeof(URL_SESSION_DELETE) + this->database.length() + strlen(token);
   char buff[length];
-  snprintf(buff, length, URL_SESSION_DELETE, this->database.c_str(), token.c_str());
+  snprintf(buff, length, URL_SESSION_DELETE, this->database.c_str(), token);
   return String(buff);
 }
 /**
@@ -302,50 +319,39 @@ String FMDataClient::logOutDatabaseSession(void)
     log_d(ERROR_MSG_EMPTY_TOKEN);
     return EMPTY_STRING;
   }
-  if (!this->_https.begin(
-          this->_client,
-          this->_host,
-          this->_port,
-          this->_credentials->getLogOutUrl(this->_token),
-          true))
+  if (!this->beginRequest(RequestOperation::LogOutOperation, this->_credentials->getLogOutUrl(this->_token.c_str())))
   {
-    log_e("Could not connect to: %s", this->_host.c_str());
     return EMPTY_STRING;
   }
-  this->_https.setAuthorization(EMPTY_STRING);
-  this->_https.setUserAgent(HEADER_AGENT_VALUE);
-  this->_https.setReuse(false);
   this->_https.addHeader(HEADER_CONTENT_TYPE, MIME_TYPE_APPLICATION_JSON);
   int httpCode = this->_https.sendRequest(HTTP_METHOD_DELETE, String(EMPTY_STRING));
-  const String &response = this->_https.getString();
-  this->_https.end();
+  this->markPhase(RequestPhase::WaitPhase);
+  if (!this->checkDeadline(httpCode, 0))
+  {
+    return EMPTY_STRING;
+  }
+  String response;
+  this->readResponseString(response);
+  this->endRequest(httpCode);
   if (httpCode == HTTP_CODE_OK)
   {
     log_d("Successfull request - Status: %d", httpCode);
-    const size_t capacity = // JSON Memory Size
-        JSON_ARRAY_SIZE(1) + JSON_OBJECT_SIZE(0) + 2 * JSON_OBJECT_SIZE(2) + 116;
-    DynamicJsonDocument doc(capacity);
-    DeserializationError error = deserializeJson(doc, response);
-    if (error)
+    ResponseStatus status;
+    BufferStream body((const uint8_t *)response.c_str(), response.length());
+    if (!ResponseScanner(body).scan(status))
     {
-      log_e("ArduinoJson error - %s", error.c_str());
+      log_e("Invalid response");
+      FMDATA_TRACE_EVENT(TraceEventType::ParseErrorTraceEvent, this->_operation, httpCode, 0, 0, -1, 0);
       return EMPTY_STRING;
     }
-    else
+    if (status.code != FileMakerError::NoFileMakerError)
     {
-      JsonArray messages = doc[PARAMETER_MESSAGES].as<JsonArray>();
-      for (JsonObject msg : messages)
-      {
-        if (msg[PARAMETER_CODE].as<int>() != 0)
-        {
-          log_e("Filemaker error: %d - %s",
-                msg[PARAMETER_CODE].as<int>(),
-                msg[PARAMETER_MESSAGE].as<const char *>());
-          return EMPTY_STRING;
-        }
-      }
-      return response;
+      log_e("Filemaker error: %d - %s", status.code, status.message.c_str());
+      FMDATA_TRACE_EVENT(TraceEventType::FileMakerErrorTraceEvent, this->_operation, httpCode,
+                         status.code, 0, response.length(), 0);
+      return EMPTY_STRING;
     }
+    return response;
   }
   else
   {
@@ -365,11 +371,11 @@ String FMDataClient::getListOfOAuthProviders(void)
     this->_client.stop();
     this->_https.begin(
         this->_client,
-        this->_host,
+        this->_host.c_str(),
         this->_port,
         URL_OAUTH_PROVIDERS);
     this->_https.setUserAgent(HEADER_AGENT_VALUE);
-    this->_https.addHeader(HEADER_HOST, this->_host);
+    this->_https.addHeader(HEADER_HOST, this->_host.c_str());
     this->_https.addHeader(HEADER_CONNECTION, HEADER_CONNECTION_CLOSE);
     int httpCode = this->_https.GET();
     if (httpCode == HTTP_CODE_OK)
@@ -415,7 +421,7 @@ String FMDataClient::getListOfOAuthProviders(void)
  * @param oauthType 
  * @return String 
  */
-String FMDataClient::getOAuthRequestId(String trackingId, String oauthProvider, String address, int oauthType)
+String FMDataClient::getOAuthRequestId(const String &trackingId, const String &oauthProvider, const String &address, int oauthType)
 {
   throw ERROR_MSG_NOT_IMPLEMENTED;
 }
@@ -430,71 +436,143 @@ String FMDataClient::getOAuthRequestId(String trackingId, String oauthProvider,
    * @param scripts Scripts to be executed
    * @return String Json with result or empty string when it fails
    */
-String FMDataClient::createRecord(String token, String database, String layout, vector<RecordField> fields, ScriptParameters *scripts)
+String FMDataClient::createRecord(const String &token, const String &database, const String &layout, const vector<RecordField> &fields, const ScriptParameters *scripts)
+{
+  return this->createRecord(token, database, layout, fields.data(), fields.size(), scripts);
+}
+
+/**
+   * @brief Create a record
+   * @see https://fmhelp.filemaker.com/docs/17/en/dataapi/#work-with-records_create-record
+   * @param token The Authentication Token
+   * @param database Database Name
+   * @param layout Layout Name
+   * @param fields Array of fields with values
+   * @param fieldCount Number of fields in the array
+   * @param scripts Scripts to be executed
+   * @return String Json with result or empty string when it fails
+   */
+String FMDataClient::createRecord(const String &token, const String &database, const String &layout, const RecordField *fields, size_t fieldCount, const ScriptParameters *scripts)
 {
+  return this->sendCreateRecord(token.c_str(), database, layout, fields, fieldCount, scripts);
+}
 
+String FMDataClient::sendCreateRecord(const char *token, const String &database, const String &layout, const RecordField *fields, size_t fieldCount, const ScriptParameters *scripts)
+{
   String url(stringf(URL_RECORD_NEW, database.c_str(), layout.c_str()));
   log_d("Url: %s", url.c_str());
-  String payload = generatePayload(fields, scripts);
+  String payload = generatePayload(fields, fieldCount, scripts);
+#if FMDATA_LOG_PAYLOADS
   log_d("Payload: %s", payload.c_str());
-  String auth = generateAuth(token.c_str());
-  log_d("Authorization: %s", auth.c_str());
+#endif
+  String auth = generateAuth(token);
 
-  if (!this->_https.begin(
-          this->_client,
-          this->_host,
-          443,
-          url, true))
+  String response;
+  ResponseStatus status;
+  this->retryRequest(RequestOperation::CreateRecordOperation, status, [&](ResponseStatus &attempt) {
+    if (!this->beginRequest(RequestOperation::CreateRecordOperation, url))
+    {
+      attempt.httpCode = HTTPC_ERROR_CONNECTION_REFUSED;
+      return false;
+    }
+    this->_https.addHeader(HEADER_AUTHORIZATION, auth.c_str());
+    this->_https.addHeader(HEADER_ACCEPT, HEADER_ACCEPT_VALUE_ALL);
+    this->_https.addHeader(HEADER_CACHE_CONTROL, HEADER_CACHE_CONTROL_VALUE_NO_CACHE);
+    this->_https.addHeader(HEADER_CONTENT_TYPE, MIME_TYPE_APPLICATION_JSON);
+    attempt.httpCode = this->_https.POST(payload);
+    return this->readStringResponse(attempt, payload.length(), response);
+  });
+  return response;
+}
+/**
+   * @brief Create a Record object
+   * @see https://fmhelp.filemaker.com/docs/17/en/dataapi/#work-with-records_create-record
+   * @param database Database Name
+   * @param layout Layout Name
+   * @param fields List of fields with values
+   * @param scripts Scripts to be executed
+   * @return String Json with result or empty string when it fails
+   */
+String FMDataClient::createRecord(const String &database, const String &layout, const vector<RecordField> &fields, const ScriptParameters *scripts)
+{
+  return this->createRecord(database, layout, fields.data(), fields.size(), scripts);
+}
+
+/**
+   * @brief Create a Record object
+   * @see https://fmhelp.filemaker.com/docs/17/en/dataapi/#work-with-records_create-record
+   * @param database Database Name
+   * @param layout Layout Name
+   * @param fields Array of fields with values
+   * @param fieldCount Number of fields in the array
+   * @param scripts Scripts to be executed
+   * @return String Json with result or empty string when it fails
+   */
+String FMDataClient::createRecord(const String &database, const String &layout, const RecordField *fields, size_t fieldCount, const ScriptParameters *scripts)
+{
+  if (this->_token == EMPTY_STRING)
   {
-    log_e("Could not connect to: %s", this->_host.c_str());
+    log_e("Error token is empty");
     return EMPTY_STRING;
   }
-  this->_https.setAuthorization(EMPTY_STRING);
-  this->_https.setUserAgent(HEADER_AGENT_VALUE);
-  this->_https.setReuse(false);
-  this->_https.addHeader(HEADER_AUTHORIZATION, auth.c_str());
-  this->_https.addHeader(HEADER_ACCEPT, HEADER_ACCEPT_VALUE_ALL);
-  this->_https.addHeader(HEADER_CACHE_CONTROL, HEADER_CACHE_CONTROL_VALUE_NO_CACHE);
-  this->_https.addHeader(HEADER_CONTENT_TYPE, MIME_TYPE_APPLICATION_JSON);
-  int httpCode = this->_https.POST(payload);
-  const String &response = this->_https.getString();
-  log_d("Response: %s", response.c_str());
-  this->_https.end();
-  if (httpCode == HTTP_CODE_OK)
-  {
-    log_d("Successfull request - Status: %d", httpCode);
-    return response;
-  }
   else
   {
-    log_e("Http error: %d - %s", httpCode, this->_https.errorToString(httpCode));
+    return this->sendCreateRecord(this->_token.c_str(), database, layout, fields, fieldCount, scripts);
   }
-  return EMPTY_STRING;
 }
+
 /**
-   * @brief Create a Record object
+   * @brief Create a record, reading only the status of the response
    * @see https://fmhelp.filemaker.com/docs/17/en/dataapi/#work-with-records_create-record
+   * @param token The Authentication Token
    * @param database Database Name
    * @param layout Layout Name
-   * @param fields List of fields with values
+   * @param fields Array of fields with values
+   * @param fieldCount Number of fields in the array
+   * @param status Filemaker code, message, recordId and modId
    * @param scripts Scripts to be executed
-   * @return String Json with result or empty string when it fails
+   * @return boolean true when the record was created
    */
-String FMDataClient::createRecord(String database, String layout, vector<RecordField> fields, ScriptParameters *scripts)
+boolean FMDataClient::createRecord(const String &token, const String &database, const String &layout, const RecordField *fields, size_t fieldCount, ResponseStatus &status, const ScriptParameters *scripts)
+{
+  return this->sendCreateRecord(token.c_str(), database, layout, fields, fieldCount, status, scripts);
+}
+
+boolean FMDataClient::sendCreateRecord(const char *token, const String &database, const String &layout, const RecordField *fields, size_t fieldCount, ResponseStatus &status, const ScriptParameters *scripts)
+{
+  String url(stringf(URL_RECORD_NEW, database.c_str(), layout.c_str()));
+  String payload = generatePayload(fields, fieldCount, scripts);
+  return this->sendRecordRequest(RequestOperation::CreateRecordOperation, HTTP_METHOD_POST, token, url,
+                                 (const uint8_t *)payload.c_str(), payload.length(), status);
+}
+
+boolean FMDataClient::createRecord(const String &database, const String &layout, const RecordField *fields, size_t fieldCount, ResponseStatus &status, const ScriptParameters *scripts)
 {
   if (this->_token == EMPTY_STRING)
   {
     log_e("Error token is empty");
-    return EMPTY_STRING;
+    return false;
   }
-  else
+  return this->sendCreateRecord(this->_token.c_str(), database, layout, fields, fieldCount, status, scripts);
+}
+
+boolean FMDataClient::createRecord(const String &database, const String &layout, const uint8_t *payload, size_t length, ResponseStatus &status)
+{
+  if (this->_token == EMPTY_STRING)
   {
-    return this->createRecord(this->_token, database, layout, fields, scripts);
+    log_e("Error token is empty");
+    return false;
   }
+  String url(stringf(URL_RECORD_NEW, database.c_str(), layout.c_str()));
+  return this->sendRecordRequest(RequestOperation::CreateRecordOperation, HTTP_METHOD_POST, this->_token.c_str(), url,
+                                 payload, length, status);
 }
 String FMDataClient::generateAuth(const char *token)
 {
-  String result = String(PARAMETER_BEARER) + String(token);
+  String result;
+  result.reserve(strlen(PARAMETER_BEARER) + strlen(token));
+  result += PARAMETER_BEARER;
+  result += token;
   return result;
 }
 
@@ -508,58 +586,113 @@ String FMDataClient::generateAuth(const char *token)
  * @param fields 
  * @return String 
  */
-String FMDataClient::editRecord(String token, String database, String layout, String recordId, vector<RecordField> fields)
+String FMDataClient::editRecord(const String &token, const String &database, const String &layout, const String &recordId, const vector<RecordField> &fields)
+{
+  return this->editRecord(token, database, layout, recordId, fields.data(), fields.size());
+}
+
+/**
+ * @brief 
+ * 
+ * @param token 
+ * @param database 
+ * @param layout 
+ * @param recordId 
+ * @param fields 
+ * @param fieldCount 
+ * @return String 
+ */
+String FMDataClient::editRecord(const String &token, const String &database, const String &layout, const String &recordId, const RecordField *fields, size_t fieldCount)
+{
+  return this->sendEditRecord(token.c_str(), database, layout, recordId, fields, fieldCount);
+}
+
+String FMDataClient::sendEditRecord(const char *token, const String &database, const String &layout, const String &recordId, const RecordField *fields, size_t fieldCount)
 {
   String url(stringf(URL_RECORD, database.c_str(), layout.c_str(), recordId.c_str()));
   log_d("Url: %s", url.c_str());
-  String payload = generatePayload(fields);
+  String payload = generatePayload(fields, fieldCount);
+#if FMDATA_LOG_PAYLOADS
   log_d("Payload: %s", payload.c_str());
-  String auth = generateAuth(token.c_str());
-  log_d("Authorization: %s", auth.c_str());
+#endif
+  String auth = generateAuth(token);
 
-  if (!this->_https.begin(
-          this->_client,
-          this->_host,
-          443,
-          url, true))
+  String response;
+  ResponseStatus status;
+  this->retryRequest(RequestOperation::EditRecordOperation, status, [&](ResponseStatus &attempt) {
+    if (!this->beginRequest(RequestOperation::EditRecordOperation, url))
+    {
+      attempt.httpCode = HTTPC_ERROR_CONNECTION_REFUSED;
+      return false;
+    }
+    this->_https.addHeader(HEADER_AUTHORIZATION, auth.c_str());
+    this->_https.addHeader(HEADER_ACCEPT, HEADER_ACCEPT_VALUE_ALL);
+    this->_https.addHeader(HEADER_CACHE_CONTROL, HEADER_CACHE_CONTROL_VALUE_NO_CACHE);
+    this->_https.addHeader(HEADER_CONTENT_TYPE, MIME_TYPE_APPLICATION_JSON);
+    attempt.httpCode = this->_https.PATCH(payload);
+    return this->readStringResponse(attempt, payload.length(), response);
+  });
+  return response;
+}
+
+String FMDataClient::editRecord(const String &database, const String &layout, const String &recordId, const vector<RecordField> &fields)
+{
+  if (this->_token == EMPTY_STRING)
   {
-    log_e("Could not connect to: %s", this->_host.c_str());
+    log_e("Error token is empty");
     return EMPTY_STRING;
   }
-  this->_https.setAuthorization(EMPTY_STRING);
-  this->_https.setUserAgent(HEADER_AGENT_VALUE);
-  this->_https.setReuse(false);
-  this->_https.addHeader(HEADER_AUTHORIZATION, auth.c_str());
-  this->_https.addHeader(HEADER_ACCEPT, HEADER_ACCEPT_VALUE_ALL);
-  this->_https.addHeader(HEADER_CACHE_CONTROL, HEADER_CACHE_CONTROL_VALUE_NO_CACHE);
-  this->_https.addHeader(HEADER_CONTENT_TYPE, MIME_TYPE_APPLICATION_JSON);
-  int httpCode = this->_https.PATCH(payload);
-  const String &response = this->_https.getString();
-  log_d("Response: %s", response.c_str());
-  this->_https.end();
-  if (httpCode == HTTP_CODE_OK)
-  {
-    log_d("Successfull request - Status: %d", httpCode);
-    return response;
-  }
   else
   {
-    log_e("Http error: %d - %s", httpCode, this->_https.errorToString(httpCode));
+    return this->sendEditRecord(this->_token.c_str(), database, layout, recordId, fields.data(), fields.size());
   }
-  return EMPTY_STRING;
 }
 
-String FMDataClient::editRecord(String database, String layout, String recordId, vector<RecordField> fields)
+/**
+ * @brief Edit a record, reading only the status of the response
+ * 
+ * @param token 
+ * @param database 
+ * @param layout 
+ * @param recordId 
+ * @param fields 
+ * @param fieldCount 
+ * @param status Filemaker code, message and modId
+ * @return boolean true when the record was changed
+ */
+boolean FMDataClient::editRecord(const String &token, const String &database, const String &layout, const String &recordId, const RecordField *fields, size_t fieldCount, ResponseStatus &status)
+{
+  return this->sendEditRecord(token.c_str(), database, layout, recordId, fields, fieldCount, status);
+}
+
+boolean FMDataClient::sendEditRecord(const char *token, const String &database, const String &layout, const String &recordId, const RecordField *fields, size_t fieldCount, ResponseStatus &status)
+{
+  String url(stringf(URL_RECORD, database.c_str(), layout.c_str(), recordId.c_str()));
+  String payload = generatePayload(fields, fieldCount);
+  return this->sendRecordRequest(RequestOperation::EditRecordOperation, HTTP_METHOD_PATCH, token, url,
+                                 (const uint8_t *)payload.c_str(), payload.length(), status);
+}
+
+boolean FMDataClient::editRecord(const String &database, const String &layout, const String &recordId, const RecordField *fields, size_t fieldCount, ResponseStatus &status)
 {
   if (this->_token == EMPTY_STRING)
   {
     log_e("Error token is empty");
-    return EMPTY_STRING;
+    return false;
   }
-  else
+  return this->sendEditRecord(this->_token.c_str(), database, layout, recordId, fields, fieldCount, status);
+}
+
+boolean FMDataClient::editRecord(const String &database, const String &layout, const String &recordId, const uint8_t *payload, size_t length, ResponseStatus &status)
+{
+  if (this->_token == EMPTY_STRING)
   {
-    return this->editRecord(this->_token, database, layout, recordId, fields);
+    log_e("Error token is empty");
+    return false;
   }
+  String url(stringf(URL_RECORD, database.c_str(), layout.c_str(), recordId.c_str()));
+  return this->sendRecordRequest(RequestOperation::EditRecordOperation, HTTP_METHOD_PATCH, this->_token.c_str(), url,
+                                 payload, length, status);
 }
 /**
    * @brief Delete a record
@@ -570,44 +703,16 @@ String FMDataClient::editRecord(String database, String layout, String recordId,
    * @param recordId 
    * @return boolean 
    */
-boolean FMDataClient::deleteRecord(String token, String database, String layout, String recordId)
+boolean FMDataClient::deleteRecord(const String &token, const String &database, const String &layout, const String &recordId)
 {
-  String url(stringf(URL_RECORD, database.c_str(), layout.c_str(), recordId.c_str()));
-  log_d("Url: %s", url.c_str());
-  String payload(EMPTY_STRING);
-  log_d("Payload: %s", payload.c_str());
-  String auth = generateAuth(token.c_str());
-  log_d("Authorization: %s", auth.c_str());
+  return this->sendDeleteRecord(token.c_str(), database, layout, recordId);
+}
 
-  if (!this->_https.begin(
-          this->_client,
-          this->_host,
-          443,
-          url, true))
-  {
-    log_e("Could not connect to: %s", this->_host.c_str());
-    return EMPTY_STRING;
-  }
-  this->_https.setAuthorization(EMPTY_STRING);
-  this->_https.setUserAgent(HEADER_AGENT_VALUE);
-  this->_https.setReuse(false);
-  this->_https.addHeader(HEADER_AUTHORIZATION, auth.c_str());
-  this->_https.addHeader(HEADER_ACCEPT, HEADER_ACCEPT_VALUE_ALL);
-  this->_https.addHeader(HEADER_CACHE_CONTROL, HEADER_CACHE_CONTROL_VALUE_NO_CACHE);
-  int httpCode = this->_https.sendRequest(HTTP_METHOD_DELETE, payload);
-  const String &response = this->_https.getString();
-  log_d("Response: %s", response.c_str());
-  this->_https.end();
-  if (httpCode == HTTP_CODE_OK)
-  {
-    log_d("Successfull request - Status: %d", httpCode);
-    return response;
-  }
-  else
-  {
-    log_e("Http error: %d - %s", httpCode, this->_https.errorToString(httpCode));
-  }
-  return EMPTY_STRING;
+boolean FMDataClient::sendDeleteRecord(const char *token, const String &database, const String &layout, const String &recordId)
+{
+  String url(stringf(URL_RECORD, database.c_str(), layout.c_str(), recordId.c_str()));
+  ResponseStatus status;
+  return this->sendRecordRequest(RequestOperation::DeleteRecordOperation, HTTP_METHOD_DELETE, token, url, NULL, 0, status);
 }
 /**
    * @brief Delete a record
@@ -617,16 +722,16 @@ boolean FMDataClient::deleteRecord(String token, String database, String layout,
    * @param recordId 
    * @return boolean 
    */
-boolean FMDataClient::deleteRecord(String database, String layout, String recordId)
+boolean FMDataClient::deleteRecord(const String &database, const String &layout, const String &recordId)
 {
   if (this->_token == EMPTY_STRING)
   {
     log_e("Error token is empty");
-    return EMPTY_STRING;
+    return false;
   }
   else
   {
-    return this->deleteRecord(this->_token, database, layout, recordId);
+    return this->sendDeleteRecord(this->_token.c_str(), database, layout, recordId);
   }
 }
 /**
@@ -640,7 +745,7 @@ boolean FMDataClient::deleteRecord(String database, String layout, String record
  * @param scripts
  * @return String 
  */
-String FMDataClient::getRecord(String token, String database, String layout, String recordId, PortalRecordRange *ranges, ScriptParameters *scripts)
+String FMDataClient::getRecord(const String &token, const String &database, const String &layout, const String &recordId, PortalRecordRange *ranges, const ScriptParameters *scripts)
 {
   throw ERROR_MSG_NOT_IMPLEMENTED;
 }
@@ -659,60 +764,57 @@ String FMDataClient::logInToDatabaseSession(void)
   if (this->_credentials->getType() == CredentialsType::UserCredentialsType)
   {
     log_d("Starting a new session");
-    if (!this->_https.begin(
-            this->_client,
-            this->_host,
-            this->_port,
-            this->_credentials->getLogInUrl(),
-            true))
+    if (!this->beginRequest(RequestOperation::LogInOperation, this->_credentials->getLogInUrl()))
     {
-      log_e("Could not connect to: %s", this->_host.c_str());
       return EMPTY_STRING;
     }
+    // The payload holds the external data source credentials and the
+    // response the session token, neither of them is logged
     String payload(this->_credentials->getExternalDatabasesCredentialsPayload());
-    log_d("Payload: %s", payload.c_str());
     size_t size = payload.length();
     log_d("Payload length: %d", size);
     String auth = this->_credentials->getAuthorizationHeaderValue();
-    log_d("Database Credentials: %s", auth.c_str());
-    this->_https.setUserAgent(HEADER_AGENT_VALUE);
-    this->_https.setReuse(false);
     this->_https.setAuthorization(auth.c_str());
     this->_https.addHeader(HEADER_CONTENT_TYPE, MIME_TYPE_APPLICATION_JSON);
     this->_https.addHeader(HEADER_CONTENT_LENGTH, String(size));
     int httpCode = this->_https.POST(payload);
-    const String &response = this->_https.getString();
-    log_d("Response: %s", response.c_str());
-    this->_https.end();
+    this->markPhase(RequestPhase::WaitPhase);
+    if (!this->checkDeadline(httpCode, size))
+    {
+      return EMPTY_STRING;
+    }
+    String response;
+    this->readResponseString(response);
+    this->endRequest(httpCode, size);
     if (httpCode == HTTP_CODE_OK)
     {
       log_d("Successfull request - Status: %d", httpCode);
-      const size_t capacity = // JSON Memory Size
-          JSON_ARRAY_SIZE(1) + JSON_OBJECT_SIZE(1) + 2 * JSON_OBJECT_SIZE(2) + 191;
-      DynamicJsonDocument doc(capacity);
-      DeserializationError error = deserializeJson(doc, response);
+      int code = 0;
+      DeserializationError error = this->_logInCapacity.deserialize(response, [&](JsonDocument &doc) {
+        for (JsonObject msg : doc[PARAMETER_MESSAGES].as<JsonArray>())
+        {
+          if (msg[PARAMETER_CODE].as<int>() != 0)
+          {
+            code = msg[PARAMETER_CODE].as<int>();
+            log_e("Filemaker error: %d - %s", code, msg[PARAMETER_MESSAGE].as<const char *>());
+            return;
+          }
+        }
+        this->_token = doc[PARAMETER_RESPONSE][PARAMETER_TOKEN].as<const char *>();
+      });
       if (error)
       {
         log_e("ArduinoJson error - %s", error.c_str());
+        FMDATA_TRACE_EVENT(TraceEventType::ParseErrorTraceEvent, this->_operation, httpCode, 0, 0, -1, 0);
         return EMPTY_STRING;
       }
-      else
+      if (code != 0)
       {
-        JsonArray messages = doc[PARAMETER_MESSAGES].as<JsonArray>();
-        for (JsonObject msg : messages)
-        {
-          if (msg[PARAMETER_CODE].as<int>() != 0)
-          {
-            log_e("Filemaker error: %d - %s",
-                  msg[PARAMETER_CODE].as<int>(),
-                  msg[PARAMETER_MESSAGE].as<const char *>());
-            return EMPTY_STRING;
-          }
-        }
-        this->_token = doc[PARAMETER_RESPONSE][PARAMETER_TOKEN].as<String>();
-        log_d("Token: %s", this->_token.c_str());
-        return response;
+        FMDATA_TRACE_EVENT(TraceEventType::FileMakerErrorTraceEvent, this->_operation, httpCode,
+                           code, 0, response.length(), 0);
+        return EMPTY_STRING;
       }
+      return response;
     }
     else
     {
@@ -741,12 +843,40 @@ FMDataClient::FMDataClient(
     const char *&host,
     const char *&cert,
     const int &port)
+    : FMDataClient(credentials, host, cert, port)
 {
   this->_client = client;
+  this->_client.setCACert(cert);
+}
+
+/**
+  * @brief Construct a new FMDataClient object with a Wifi Client of its own
+  * 
+  * @param credentials Database Credentials
+  * @param host Host address, ip address or domain name
+  * @param cert Root Certificate
+  * @param port Connection Port
+  */
+FMDataClient::FMDataClient(
+    const DatabaseCredentials &credentials,
+    const char *&host,
+    const char *&cert,
+    const int &port)
+    : _logInCapacity(JSON_CAPACITY_LOG_IN)
+{
   this->_credentials = &credentials;
   this->_host = host;
   this->_cert = cert;
   this->_port = port;
+  this->_compression = false;
+  this->_keepAlive = false;
+  this->_metrics = NULL;
+  this->_retryPolicy = NULL;
+  this->_rateLimiter = NULL;
+  this->_lastHttpCode = 0;
+  this->_rateLimited = false;
+  this->_cancellation = NULL;
+  this->_dnsCache = NULL;
   this->_client.setCACert(cert);
   uint8_t uuid[16];
   ESPRandom::uuid(uuid);
@@ -760,9 +890,10 @@ FMDataClient::FMDataClient(
    */
 FMDataClient::~FMDataClient(void)
 {
-  delete[] & _https;
-  delete[] & _client;
-  delete[] _credentials;
+  this->_https.end();
+  this->_client.stop();
+  delete this->_metrics;
+  delete this->_retryPolicy;
 }
 
 /**
@@ -774,13 +905,15 @@ FMDataClient::~FMDataClient(void)
  */
 void FMDataClient::mergeJson(JsonObject dst, JsonObject src)
 {
-  String finalJson(EMPTY_STRING);
   for (auto kvp : src)
   {
     dst[kvp.key()] = kvp.value();
   }
+#if FMDATA_LOG_PAYLOADS
+  String finalJson(EMPTY_STRING);
   serializeJson(dst, finalJson);
   log_d("Merged JSON: %s", finalJson.c_str());
+#endif
 }
 
 /**
@@ -792,7 +925,7 @@ void FMDataClient::mergeJson(JsonObject dst, JsonObject src)
  * @param range 
  * @return String 
  */
-String FMDataClient::getRecords(String token, String database, String layout, RecordRange range)
+String FMDataClient::getRecords(const String &token, const String &database, const String &layout, const RecordRange &range)
 {
   throw ERROR_MSG_NOT_IMPLEMENTED;
 }
@@ -807,7 +940,7 @@ String FMDataClient::getRecords(String token, String database, String layout, Re
  * @param range 
  * @return String 
  */
-String FMDataClient::getRecords(String token, String database, String layout, SortCriteria sortCriteria, RecordRange range)
+String FMDataClient::getRecords(const String &token, const String &database, const String &layout, const SortCriteria &sortCriteria, const RecordRange &range)
 {
   throw ERROR_MSG_NOT_IMPLEMENTED;
 }
@@ -826,20 +959,46 @@ String FMDataClient::getRecords(String token, String database, String layout, So
    * @param type Content type
    * @return String Json with result response or empty in case of error
    */
-String FMDataClient::uploadContainerData(String token, String database, String layout, String recordId, String fieldName, int repetition, String contents, String name, String type)
+String FMDataClient::uploadContainerData(const String &token, const String &database, const String &layout, const String &recordId, const String &fieldName, int repetition, const String &contents, const String &name, const String &type)
 {
-  /*
-POST /fmi/data/v1/databases/drm_iot/layouts/iot_tab2/records/1/containers/container/1 HTTP/1.1
-Host: drm.fmi.filemaker-cloud.com
-Authorization: Bearer e58...
-Content-Type: multipart/form-data; boundary=----WebKitFormBoundary7MA4YWxkTrZu0gW
+  BufferStream stream((const uint8_t *)contents.c_str(), contents.length());
+  return this->uploadContainerData(token, database, layout, recordId, fieldName, repetition, stream, contents.length(), name, type);
+}
 
-----WebKitFormBoundary7MA4YWxkTrZu0gW
+/**
+   * @brief Upload container data streamed from a Stream or File
+   * @see https://fmhelp.filemaker.com/docs/17/en/dataapi/#upload-container-data
+   * @param token Authentication Token
+   * @param database Database Name
+   * @param layout Layout Name
+   * @param recordId Record Identifier
+   * @param fieldName Field Name
+   * @param repetition Field Repetition index
+   * @param contents Stream
+   * @param length Number of bytes to read from contents
+   * @param name Name
+   * @param type Content type
+   * @return String Json with result response or empty in case of error
+   */
+String FMDataClient::uploadContainerData(const String &token, const String &database, const String &layout, const String &recordId, const String &fieldName, int repetition, Stream &contents, size_t length, const String &name, const String &type)
+{
+  return this->sendContainerData(token.c_str(), database, layout, recordId, fieldName, repetition, contents, length, name, type);
+}
+
+String FMDataClient::sendContainerData(const char *token, const String &database, const String &layout, const String &recordId, const String &fieldName, int repetition, Stream &contents, size_t length, const String &name, const String &type)
+{
+  /*
+POST /fmi/data/v1/databases/drm_iot/layouts/iot_tab2/records/1/containers/container/1 HTTP/1.1
+Host: drm.fmi.filemaker-cloud.com
+Authorization: Bearer e58...
+Content-Type: multipart/form-data; boundary=----WebKitFormBoundary7MA4YWxkTrZu0gW
+
+------WebKitFormBoundary7MA4YWxkTrZu0gW
 Content-Disposition: form-data; name="upload"; filename="test.txt"
 Content-Type: text/plain
 
 (data)
-----WebKitFormBoundary7MA4YWxkTrZu0gW
+------WebKitFormBoundary7MA4YWxkTrZu0gW--
 
 */
 
@@ -852,71 +1011,85 @@ Content-Type: text/plain
       String(repetition).c_str()));
   log_d("Url: %s", url.c_str());
 
-  String auth = generateAuth(this->_token.c_str());
-  log_d("Authorization: %s", auth.c_str());
+  String auth = generateAuth(token);
   String boundary = HTTP_BOUNDARY;
-  boundary.concat(this->_id);
+  boundary.concat(this->_id.c_str());
   log_d("Boundary: %s", boundary.c_str());
 
-  if (!this->_https.begin(
-          this->_client,
-          this->_host,
-          443,
-          url, true))
-  {
-    log_e("Could not connect to: %s", this->_host.c_str());
-    return EMPTY_STRING;
-  }
-  this->_https.setAuthorization(EMPTY_STRING);
-  this->_https.setUserAgent(HEADER_AGENT_VALUE);
-  this->_https.setReuse(false);
-  this->_https.addHeader(HEADER_AUTHORIZATION, auth.c_str());
-  this->_https.addHeader(HEADER_ACCEPT, HEADER_ACCEPT_VALUE_ALL);
-  this->_https.addHeader(HEADER_CACHE_CONTROL, HEADER_CACHE_CONTROL_VALUE_NO_CACHE);
   String multiPartType = String(MIME_TYPE_MULTIPART_FORM_DATA);
   multiPartType += boundary;
-  this->_https.addHeader(HEADER_CONTENT_TYPE, multiPartType);
-  StreamString payload;
-  payload.printf("%s\r\n", boundary.c_str());
-  payload.printf("%s: ", HEADER_CONTENT_DISPOSITION);
-  payload.printf(FORM_DATA_DISPOSITION, name.c_str());
-  payload.printf("\r\n");
-  payload.printf(HEADER_GENERIC, HEADER_CONTENT_TYPE, type.c_str());
-  payload.printf("\r\n");
-  payload.printf("\r\n");
-  payload.printf("%s\r\n", contents.c_str());
-  payload.printf("%s\r\n", boundary.c_str());
-  log_d("Payload: %s", payload.c_str());
-  int httpCode = this->_https.POST(payload.readString());
-  const String &response = this->_https.getString();
-  log_d("Response: %s", response.c_str());
-  this->_https.end();
-  if (httpCode == HTTP_CODE_OK)
+  String disposition(stringf(FORM_DATA_DISPOSITION, name.c_str()));
+  String response;
+  ResponseStatus status;
+  size_t contentsRead = 0;
+  this->retryRequest(RequestOperation::UploadContainerOperation, status, [&](ResponseStatus &attempt) {
+    if (contentsRead > 0)
+    {
+      // The stream can not be rewound, a retry would send truncated contents
+      log_e("Contents already read, the upload is not repeated");
+      attempt.httpCode = HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+      return false;
+    }
+    if (!this->beginRequest(RequestOperation::UploadContainerOperation, url))
+    {
+      attempt.httpCode = HTTPC_ERROR_CONNECTION_REFUSED;
+      return false;
+    }
+    this->_https.addHeader(HEADER_AUTHORIZATION, auth.c_str());
+    this->_https.addHeader(HEADER_ACCEPT, HEADER_ACCEPT_VALUE_ALL);
+    this->_https.addHeader(HEADER_CACHE_CONTROL, HEADER_CACHE_CONTROL_VALUE_NO_CACHE);
+    this->_https.addHeader(HEADER_CONTENT_TYPE, multiPartType);
+    MultipartStream payload(boundary, disposition, type, contents, length);
+    log_d("Payload length: %d", payload.size());
+    attempt.httpCode = this->_https.sendRequest(HTTP_METHOD_POST, &payload, payload.size());
+    contentsRead = payload.getContentsRead();
+    return this->readStringResponse(attempt, payload.size(), response);
+  });
+  return response;
+}
+
+/**
+   * @brief Upload container data
+   * @see https://fmhelp.filemaker.com/docs/17/en/dataapi/#upload-container-data
+   * @param database Database Name
+   * @param layout Layout Name
+   * @param recordId Record Identifier
+   * @param fieldName Field Name
+   * @param repetition Field Repetition index
+   * @param contents Contents
+   * @param name File name
+   * @param type File mime type
+   * @return String Json with result response or empty in case of error
+   */
+String FMDataClient::uploadContainerData(const String &database, const String &layout, const String &recordId, const String &fieldName, int repetition, const String &contents, const String &name, const String &type)
+{
+  if (this->_token == EMPTY_STRING)
   {
-    log_d("Successfull request - Status: %d", httpCode);
-    return response;
+    log_e("Error token is empty");
+    return EMPTY_STRING;
   }
   else
   {
-    log_e("Http error: %d - %s", httpCode, this->_https.errorToString(httpCode));
+    BufferStream stream((const uint8_t *)contents.c_str(), contents.length());
+    return this->sendContainerData(this->_token.c_str(), database, layout, recordId, fieldName, repetition, stream, contents.length(), name, type);
   }
-  return EMPTY_STRING;
 }
 
 /**
-   * @brief Upload container data
+   * @brief Upload container data streamed from a Stream or File
    * @see https://fmhelp.filemaker.com/docs/17/en/dataapi/#upload-container-data
    * @param database Database Name
    * @param layout Layout Name
    * @param recordId Record Identifier
    * @param fieldName Field Name
    * @param repetition Field Repetition index
-   * @param contents Contents
+   * @param contents Stream
+   * @param length Number of bytes to read from contents
    * @param name File name
    * @param type File mime type
    * @return String Json with result response or empty in case of error
    */
-String FMDataClient::uploadContainerData(String database, String layout, String recordId, String fieldName, int repetition, String contents, String name, String type)
+String FMDataClient::uploadContainerData(const String &database, const String &layout, const String &recordId, const String &fieldName, int repetition, Stream &contents, size_t length, const String &name, const String &type)
 {
   if (this->_token == EMPTY_STRING)
   {
@@ -925,35 +1098,295 @@ String FMDataClient::uploadContainerData(String database, String layout, String
   }
   else
   {
-    return this->uploadContainerData(this->_token, database, layout, recordId, fieldName, repetition, contents, name, type);
+    return this->sendContainerData(this->_token.c_str(), database, layout, recordId, fieldName, repetition, contents, length, name, type);
+  }
+}
+
+DownloadStatistics::DownloadStatistics(void)
+    : bytes(0),
+      totalSize(0),
+      requests(0),
+      duration(0),
+      startFreeHeap(0),
+      minFreeHeap(0)
+{
+}
+
+float DownloadStatistics::getThroughput(void) const
+{
+  if (this->duration == 0)
+    return 0;
+  return this->bytes * 1000.0f / this->duration;
+}
+
+uint32_t DownloadStatistics::getPeakHeapUsage(void) const
+{
+  return this->startFreeHeap > this->minFreeHeap ? this->startFreeHeap - this->minFreeHeap : 0;
+}
+
+/**
+ * @brief Resolves a redirect location against the url that was requested
+ * 
+ * @param url Requested url
+ * @param location Location header value, absolute or relative to the host
+ * @return String Absolute url
+ */
+static String resolveLocation(const String &url, const String &location)
+{
+  if (!location.startsWith("/"))
+    return location;
+  int scheme = url.indexOf("://");
+  int path = url.indexOf('/', scheme < 0 ? 0 : scheme + 3);
+  return (path < 0 ? url : url.substring(0, path)) + location;
+}
+
+/**
+ * @brief Host name and port of an https url
+ * 
+ * @param url Absolute url
+ * @param host Host name
+ * @param port Port, 443 when the url has none
+ * @return boolean false when the url has no host
+ */
+static boolean parseHost(const String &url, String &host, int &port)
+{
+  int scheme = url.indexOf("://");
+  int start = scheme < 0 ? 0 : scheme + 3;
+  int path = url.indexOf('/', start);
+  String authority = path < 0 ? url.substring(start) : url.substring(start, path);
+  int colon = authority.indexOf(':');
+  host = colon < 0 ? authority : authority.substring(0, colon);
+  port = colon < 0 ? 443 : authority.substring(colon + 1).toInt();
+  return !host.isEmpty() && port > 0;
+}
+
+/**
+   * @brief Download container data to a Stream or File
+   * @see https://fmhelp.filemaker.com/docs/17/en/dataapi/#work-with-records_get-record
+   * @param url Container URL as returned in the field data
+   * @param destination Stream the contents are written to
+   * @param offset Bytes already stored by a previous call, the download resumes from there
+   * @param statistics Optional transfer statistics
+   * @return boolean true when the container was completely downloaded
+   */
+boolean FMDataClient::downloadContainerData(const String &url, Stream &destination, size_t offset, DownloadStatistics *statistics)
+{
+  const char *headerKeys[] = {HEADER_SET_COOKIE, HEADER_LOCATION, HEADER_TRANSFER_ENCODING};
+  uint8_t buffer[CONTAINER_DOWNLOAD_BUFFER_SIZE];
+  DownloadStatistics stats;
+  boolean admitted = this->waitForRateLimit(RequestOperation::DownloadContainerOperation);
+  this->startTiming(RequestOperation::DownloadContainerOperation);
+  stats.startFreeHeap = ESP.getFreeHeap();
+  stats.minFreeHeap = stats.startFreeHeap;
+  unsigned long start = millis();
+  String location(url);
+  String cookie(EMPTY_STRING);
+  uint8_t redirects = 0;
+  uint8_t attempts = 0;
+  boolean complete = false;
+  boolean failed = !admitted;
+  boolean retry = false;
+
+  while (!complete && !failed && redirects <= CONTAINER_DOWNLOAD_MAX_REDIRECTS && attempts < CONTAINER_DOWNLOAD_MAX_ATTEMPTS)
+  {
+    if (this->isCancelled())
+    {
+      log_e("Download cancelled");
+      failed = true;
+      break;
+    }
+    if (attempts > 0 && retry)
+    {
+      // Back off before resuming, a server that dropped the transfer is likely busy
+      retry = false;
+      if (!this->pause(min((uint32_t)CONTAINER_DOWNLOAD_RETRY_DELAY << (attempts - 1), this->getRemaining())))
+      {
+        log_e("Download cancelled");
+        failed = true;
+        break;
+      }
+    }
+    size_t position = offset + stats.bytes;
+    stats.requests++;
+    log_d("Url: %s", location.c_str());
+    if ((this->_metrics != NULL || this->_dnsCache != NULL) && !this->_client.connected())
+    {
+      // Connect through the dns cache and time the phases, HTTPClient reuses the connection
+      String host;
+      int port;
+      if (!parseHost(location, host, port) || !this->connect(host.c_str(), port))
+      {
+        log_e("Could not connect to: %s", location.c_str());
+        attempts++;
+        retry = true;
+        continue;
+      }
+      this->markPhase(RequestPhase::ConnectPhase);
+    }
+    if (!this->_https.begin(this->_client, location))
+    {
+      log_e("Could not connect to: %s", location.c_str());
+      break;
+    }
+    this->_https.setUserAgent(HEADER_AGENT_VALUE);
+    this->_https.setReuse(false);
+    uint32_t timeout = min(this->getRemaining(), (uint32_t)HTTPCLIENT_DEFAULT_TCP_TIMEOUT);
+    this->_https.setConnectTimeout(timeout);
+    this->_https.setTimeout(timeout);
+    this->_https.collectHeaders(headerKeys, 3);
+    if (!cookie.isEmpty())
+    {
+      this->_https.addHeader(HEADER_COOKIE, cookie);
+    }
+    if (position > 0)
+    {
+      log_d("Resuming from byte: %u", position);
+      this->_https.addHeader(HEADER_RANGE, String(stringf(HEADER_RANGE_FROM, position)));
+    }
+    int httpCode = this->_https.GET();
+    if (httpCode == HTTP_CODE_MOVED_PERMANENTLY || httpCode == HTTP_CODE_FOUND ||
+        httpCode == HTTP_CODE_SEE_OTHER || httpCode == HTTP_CODE_TEMPORARY_REDIRECT)
+    {
+      // The streaming url sets the session cookie and redirects to the same url
+      String setCookie = this->_https.header(HEADER_SET_COOKIE);
+      if (!setCookie.isEmpty())
+      {
+        int end = setCookie.indexOf(';');
+        cookie = end < 0 ? setCookie : setCookie.substring(0, end);
+      }
+      location = resolveLocation(location, this->_https.header(HEADER_LOCATION));
+      this->_https.end();
+      redirects++;
+      continue;
+    }
+    if (httpCode == HTTP_CODE_RANGE_NOT_SATISFIABLE && position > 0)
+    {
+      log_d("Nothing left to download after byte: %u", position);
+      this->_https.end();
+      complete = true;
+      break;
+    }
+    if (httpCode != HTTP_CODE_OK && httpCode != HTTP_CODE_PARTIAL_CONTENT)
+    {
+      log_e("Http error: %d - %s", httpCode, this->_https.errorToString(httpCode));
+      this->_https.end();
+      // Only connection errors are worth another attempt
+      failed = httpCode > 0;
+      attempts++;
+      retry = true;
+      continue;
+    }
+
+    if (this->_https.header(HEADER_TRANSFER_ENCODING) == HEADER_TRANSFER_ENCODING_CHUNKED)
+    {
+      // Chunked bodies are decoded by the http client, they can not be resumed
+      int written = position == 0 ? this->_https.writeToStream(&destination) : HTTPC_ERROR_ENCODING;
+      this->_https.end();
+      if (written < 0)
+      {
+        log_e("Http error: %d - %s", written, this->_https.errorToString(written));
+        failed = true;
+        break;
+      }
+      stats.bytes += written;
+      stats.totalSize = written;
+      complete = true;
+      break;
+    }
+
+    int size = this->_https.getSize();
+    // A server ignoring the range sends the whole body again
+    size_t skip = httpCode == HTTP_CODE_OK ? position : 0;
+    if (size > 0)
+    {
+      stats.totalSize = httpCode == HTTP_CODE_OK ? size : position + size;
+    }
+    WiFiClient *stream = this->_https.getStreamPtr();
+    int remaining = size;
+    unsigned long lastData = millis();
+    boolean timedOut = false;
+    while (remaining != 0 && stream != NULL && (this->_https.connected() || stream->available() > 0))
+    {
+      if (this->isCancelled())
+      {
+        log_e("Download cancelled at byte: %u", offset + stats.bytes);
+        this->_client.stop();
+        failed = true;
+        break;
+      }
+      size_t available = stream->available();
+      if (available == 0)
+      {
+        if (millis() - lastData > CONTAINER_DOWNLOAD_TIMEOUT)
+        {
+          timedOut = true;
+          break;
+        }
+        delay(1);
+        continue;
+      }
+      size_t count = min(available, sizeof(buffer));
+      if (remaining > 0 && count > (size_t)remaining)
+        count = remaining;
+      count = stream->readBytes(buffer, count);
+      lastData = millis();
+      if (remaining > 0)
+        remaining -= count;
+      size_t skipped = min(skip, count);
+      skip -= skipped;
+      if (count > skipped && destination.write(buffer + skipped, count - skipped) != count - skipped)
+      {
+        log_e("Could not write to destination");
+        failed = true;
+        break;
+      }
+      stats.bytes += count - skipped;
+      uint32_t freeHeap = ESP.getFreeHeap();
+      if (freeHeap < stats.minFreeHeap)
+        stats.minFreeHeap = freeHeap;
+    }
+    this->_https.end();
+    complete = !failed && (remaining == 0 || (size < 0 && !timedOut));
+    if (!complete && !failed)
+    {
+      log_w("Transfer interrupted at byte: %u", offset + stats.bytes);
+      attempts++;
+      retry = true;
+    }
+  }
+
+  stats.duration = millis() - start;
+  this->finishTiming(complete ? HTTP_CODE_OK : this->isCancelled() ? HTTP_ERROR_CANCELLED : !admitted ? HTTP_ERROR_RATE_LIMITED : HTTPC_ERROR_CONNECTION_LOST);
+  log_d("Downloaded %u bytes in %lu ms, %.0f B/s, peak heap %u bytes",
+        stats.bytes, stats.duration, stats.getThroughput(), stats.getPeakHeapUsage());
+  if (statistics != NULL)
+  {
+    *statistics = stats;
   }
+  return complete;
 }
 
-RecordFindCriteria::RecordFindCriteria(String fieldName, String fieldValue)
+RecordFindCriteria::RecordFindCriteria(FieldName fieldName, String fieldValue)
+    : fieldName(std::move(fieldName)),
+      fieldValue(std::move(fieldValue))
 {
-  this->fieldName = fieldName;
-  this->fieldValue = fieldValue;
 }
 
-JsonObject RecordFindCriteria::toJSON(void)
+void RecordFindCriteria::toJSON(JsonObject dst) const
 {
-  DynamicJsonDocument doc(200);
-  doc[this->fieldName] = this->fieldValue;
-  return doc.as<JsonObject>();
+  dst[this->fieldName.c_str()] = this->fieldValue.c_str();
 }
 
-RecordSortCriteria::RecordSortCriteria(String fieldName, SortOrder order)
+RecordSortCriteria::RecordSortCriteria(FieldName fieldName, SortOrder order)
+    : order(order),
+      fieldName(std::move(fieldName))
 {
-  this->fieldName = fieldName;
-  this->order = order;
 }
 
-JsonObject RecordSortCriteria::toJSON(void)
+void RecordSortCriteria::toJSON(JsonObject dst) const
 {
-  DynamicJsonDocument doc(200);
-  doc[PARAMETER_FIELD_NAME] = this->fieldName;
-  doc[PARAMETER_SORT_ORDER] = this->order == SortOrder::ascend ? PARAMETER_SORT_ASCEND : PARAMETER_SORT_DESCEND;
-  return doc.as<JsonObject>();
+  dst[PARAMETER_FIELD_NAME] = this->fieldName.c_str();
+  dst[PARAMETER_SORT_ORDER] = this->order == SortOrder::ascend ? PARAMETER_SORT_ASCEND : PARAMETER_SORT_DESCEND;
 }
 
 SortCriteria::SortCriteria(const vector<RecordSortCriteria *> &records)
@@ -961,19 +1394,17 @@ SortCriteria::SortCriteria(const vector<RecordSortCriteria *> &records)
   this->records = records;
 }
 
-JsonObject SortCriteria::toJSON(void)
+void SortCriteria::toJSON(JsonArray dst) const
 {
-  const size_t capacity = JSON_ARRAY_SIZE(5) + JSON_OBJECT_SIZE(1) + 5 * JSON_OBJECT_SIZE(2);
-  DynamicJsonDocument doc(capacity);
-  JsonArray sort = doc.createNestedArray(PARAMETER_SORT);
   for (auto record : this->records)
   {
-    sort.add(record->toJSON());
+    record->toJSON(dst.createNestedObject());
   }
-  String result;
-  serializeJsonPretty(doc,result);
-  log_d("Sort Payload: %s", result.c_str());
-  return doc.as<JsonObject>();
+}
+
+size_t SortCriteria::getJSONCapacity(void) const
+{
+  return JSON_ARRAY_SIZE(this->records.size()) + this->records.size() * JSON_OBJECT_SIZE(2);
 }
 
 FindCriteria::FindCriteria(const vector<RecordFindCriteria *> &records, boolean omit)
@@ -981,22 +1412,22 @@ FindCriteria::FindCriteria(const vector<RecordFindCriteria *> &records, boolean
   this->records = records;
   this->omit = omit;
 }
-/**
- * @brief 
- */
-JsonObject FindCriteria::toJSON()
+
+void FindCriteria::toJSON(JsonObject dst) const
 {
-  StaticJsonDocument<200> doc;
-  for (auto record : records)
+  for (auto record : this->records)
   {
-    doc[record->fieldName] = record->fieldValue;
+    record->toJSON(dst);
   }
   if (this->omit)
   {
-    doc[PARAMETER_OMIT] = this->omit ? PARAMETER_OMIT_TRUE : PARAMETER_OMIT_FALSE;
+    dst[PARAMETER_OMIT] = PARAMETER_OMIT_TRUE;
   }
+}
 
-  return doc.as<JsonObject>();
+size_t FindCriteria::getJSONCapacity(void) const
+{
+  return JSON_OBJECT_SIZE(this->records.size() + (this->omit ? 1 : 0));
 }
 
 /**
@@ -1012,85 +1443,36 @@ JsonObject FindCriteria::toJSON()
  * @param scripts
  * @return String 
  */
-String FMDataClient::performFind(String token, String database, String layout, vector<FindCriteria *> findCriterias, int limit, int offset, SortCriteria *sortCriteria, ScriptParameters *scripts)
+String FMDataClient::performFind(const String &token, const String &database, const String &layout, const vector<FindCriteria *> &findCriterias, int limit, int offset, SortCriteria *sortCriteria, const ScriptParameters *scripts)
 {
-  String url(stringf(
-      URL_FIND,
-      database.c_str(),
-      layout.c_str()));
-  log_d("Url: %s", url.c_str());
-  String auth = generateAuth(this->_token.c_str());
-  log_d("Authorization: %s", auth.c_str());
+  return this->sendFind(token.c_str(), database, layout, findCriterias, limit, offset, sortCriteria, scripts);
+}
 
-  if (!this->_https.begin(
-          this->_client,
-          this->_host,
-          443,
-          url, true))
+String FMDataClient::performFind(const String &database, const String &layout, const vector<FindCriteria *> &findCriterias, int limit, int offset, SortCriteria *sortCriteria, const ScriptParameters *scripts)
+{
+  if (this->_token == EMPTY_STRING)
   {
-    log_e("Could not connect to: %s", this->_host.c_str());
+    log_e("Error token is empty");
     return EMPTY_STRING;
   }
-  this->_https.setAuthorization(EMPTY_STRING);
-  this->_https.setUserAgent(HEADER_AGENT_VALUE);
-  this->_https.setReuse(false);
-  this->_https.addHeader(HEADER_AUTHORIZATION, auth.c_str());
-  this->_https.addHeader(HEADER_ACCEPT, HEADER_ACCEPT_VALUE_ALL);
-  this->_https.addHeader(HEADER_CACHE_CONTROL, HEADER_CACHE_CONTROL_VALUE_NO_CACHE);
-  this->_https.addHeader(HEADER_CONTENT_TYPE, MIME_TYPE_APPLICATION_JSON);
-  String payload = this->generateFindPayload(findCriterias, limit, offset, sortCriteria, scripts);
-  int httpCode = this->_https.POST(payload);
-  const String &response = this->_https.getString();
-  log_d("Response: %s", response.c_str());
-  this->_https.end();
-  if (httpCode == HTTP_CODE_OK)
-  {
-    log_d("Successfull request - Status: %d", httpCode);
-    return response;
-  }
-  else
-  {
-    log_e("Http error: %d - %s", httpCode, this->_https.errorToString(httpCode));
-  }
-  return EMPTY_STRING;
+  return this->sendFind(this->_token.c_str(), database, layout, findCriterias, limit, offset, sortCriteria, scripts);
 }
-/**
-   * @brief Generates the find request payload, search criteria, sort criteria and script execution parameters
-   * @see performFind()
-   * @param findCriterias
-   * @param limit
-   * @param offset
-   * @param sortCriteria 
-   * @param scripts
-   * @return String 
-   */
-String FMDataClient::generateFindPayload(vector<FindCriteria *> findCriterias, int limit, int offset, SortCriteria *sortCriteria, ScriptParameters *scripts)
-{
-  const size_t capacity = 2 * JSON_ARRAY_SIZE(2) + JSON_ARRAY_SIZE(5) + JSON_OBJECT_SIZE(1) + 5 * JSON_OBJECT_SIZE(2) + JSON_OBJECT_SIZE(3) + JSON_OBJECT_SIZE(8);
-  DynamicJsonDocument doc(capacity);
-  JsonArray query = doc.createNestedArray("query");
-  for (auto findCriteria : findCriterias)
-  {
-    query.add(findCriteria->toJSON());
-  }
-  if (sortCriteria != NULL)
-  {
-    FMDataClient::mergeJson(doc.as<JsonObject>(), sortCriteria->toJSON());
-  }
-  if (scripts != NULL)
-  {
-    FMDataClient::mergeJson(doc.as<JsonObject>(), scripts->toJSONDocument().as<JsonObject>());
-  }
-  doc[PARAMETER_LIMIT] = String(limit);
-  if (offset > 0)
-  {
-    doc[PARAMETER_OFFSET] = String(offset);
-  }
 
-  String result = EMPTY_STRING;
-  serializeJson(doc, result);
-  log_d("Find payload: %s", result.c_str());
-  return result;
+String FMDataClient::sendFind(const char *token, const String &database, const String &layout, const vector<FindCriteria *> &findCriterias, int limit, int offset, SortCriteria *sortCriteria, const ScriptParameters *scripts)
+{
+  String payload = this->generateFindPayload(findCriterias, limit, offset, sortCriteria, scripts);
+  String response;
+  ResponseStatus status;
+  this->retryRequest(RequestOperation::FindOperation, status, [&](ResponseStatus &attempt) {
+    if (!this->beginFind(token, database, layout))
+    {
+      attempt.httpCode = HTTPC_ERROR_CONNECTION_REFUSED;
+      return false;
+    }
+    attempt.httpCode = this->_https.POST(payload);
+    return this->readStringResponse(attempt, payload.length(), response);
+  });
+  return response;
 }
 
 /**
@@ -1098,85 +1480,948 @@ String FMDataClient::generateFindPayload(vector<FindCriteria *> findCriterias, i
  * 
  * @param token 
  * @param database 
- * @param records 
- * @return String 
+ * @param layout 
+ * @param findCriterias
+ * @param response
+ * @param limit
+ * @param offset
+ * @param sortCriteria 
+ * @param scripts
+ * @return boolean 
  */
-String FMDataClient::setGlobalVariables(String token, String database, RecordField *records)
+boolean FMDataClient::performFind(const String &token, const String &database, const String &layout, const vector<FindCriteria *> &findCriterias, JsonDocument &response, int limit, int offset, SortCriteria *sortCriteria, const ScriptParameters *scripts)
 {
-  throw ERROR_MSG_NOT_IMPLEMENTED;
+  return this->sendFind(token.c_str(), database, layout, findCriterias, response, limit, offset, sortCriteria, scripts);
 }
 
-/**
- * @brief Get the Authentication Token
- * 
- * @return String 
- */
-String FMDataClient::getToken(void)
+boolean FMDataClient::performFind(const String &database, const String &layout, const vector<FindCriteria *> &findCriterias, JsonDocument &response, int limit, int offset, SortCriteria *sortCriteria, const ScriptParameters *scripts)
 {
-  return this->_token;
+  if (this->_token == EMPTY_STRING)
+  {
+    log_e("Error token is empty");
+    return false;
+  }
+  return this->sendFind(this->_token.c_str(), database, layout, findCriterias, response, limit, offset, sortCriteria, scripts);
 }
 
-/**
- * @brief Format a string
- * Format a string, max length 512
- * @param format format template
- * @param ... fill parameters
- * @return char* formated string
- */
-char *stringf(const char *format, ...)
+boolean FMDataClient::sendFind(const char *token, const String &database, const String &layout, const vector<FindCriteria *> &findCriterias, JsonDocument &response, int limit, int offset, SortCriteria *sortCriteria, const ScriptParameters *scripts)
 {
-  static char buffer[512] = "";
-
-  va_list argptr;
-  va_start(argptr, format);
-
-  vsprintf(buffer, format, argptr);
-
-  va_end(argptr);
+  String payload = this->generateFindPayload(findCriterias, limit, offset, sortCriteria, scripts);
+  ResponseStatus status;
+  return this->retryRequest(RequestOperation::FindOperation, status, [&](ResponseStatus &attempt) {
+    if (!this->beginFind(token, database, layout))
+    {
+      attempt.httpCode = HTTPC_ERROR_CONNECTION_REFUSED;
+      return false;
+    }
+    if (this->_compression)
+    {
+      this->_https.addHeader(HEADER_ACCEPT_ENCODING, HEADER_ACCEPT_ENCODING_VALUE);
+    }
+    attempt.httpCode = this->_https.POST(payload);
+    this->markPhase(RequestPhase::WaitPhase);
+    if (!this->checkDeadline(attempt.httpCode, payload.length()))
+    {
+      return false;
+    }
+    if (attempt.httpCode <= 0)
+    {
+      log_e("Http error: %d - %s", attempt.httpCode, this->_https.errorToString(attempt.httpCode));
+      this->endRequest(attempt.httpCode, payload.length());
+      return false;
+    }
+    // Filemaker errors come with a json body, parse it for the caller either way
+    DeserializationError error = this->deserializeResponse(response);
+    this->endRequest(attempt.httpCode, payload.length());
+    if (error)
+    {
+      log_e("ArduinoJson error - %s", error.c_str());
+      FMDATA_TRACE_EVENT(TraceEventType::ParseErrorTraceEvent, this->_operation, attempt.httpCode, 0, 0, -1, 0);
+      return false;
+    }
+    attempt.code = response[PARAMETER_MESSAGES][0][PARAMETER_CODE].as<String>().toInt();
+    if (attempt.httpCode != HTTP_CODE_OK)
+    {
+      log_e("Http error: %d - %s", attempt.httpCode, this->_https.errorToString(attempt.httpCode));
+      return false;
+    }
+    log_d("Successfull request - Status: %d", attempt.httpCode);
+    return true;
+  });
+}
+
+boolean FMDataClient::beginFind(const char *token, const String &database, const String &layout)
+{
+  String url(stringf(
+      URL_FIND,
+      database.c_str(),
+      layout.c_str()));
+  log_d("Url: %s", url.c_str());
+  String auth = generateAuth(token);
+
+  if (!this->beginRequest(RequestOperation::FindOperation, url))
+  {
+    return false;
+  }
+  this->_https.addHeader(HEADER_AUTHORIZATION, auth.c_str());
+  this->_https.addHeader(HEADER_ACCEPT, HEADER_ACCEPT_VALUE_ALL);
+  this->_https.addHeader(HEADER_CACHE_CONTROL, HEADER_CACHE_CONTROL_VALUE_NO_CACHE);
+  this->_https.addHeader(HEADER_CONTENT_TYPE, MIME_TYPE_APPLICATION_JSON);
+  return true;
+}
+
+DeserializationError FMDataClient::deserializeResponse(JsonDocument &doc)
+{
+  DeserializationError error = DeserializationError::IncompleteInput;
+  this->readResponseBody([&](Stream &body, int) {
+    error = deserializeJson(doc, body);
+  });
+  return error;
+}
+
+boolean FMDataClient::scanResponse(ResponseStatus &status)
+{
+  boolean scanned = false;
+  this->readResponseBody([&](Stream &body, int) {
+    scanned = ResponseScanner(body).scan(status);
+  });
+  return scanned;
+}
+
+boolean FMDataClient::readResponseBody(std::function<void(Stream &, int)> reader)
+{
+  WiFiClient *stream = this->_https.getStreamPtr();
+  if (stream == NULL)
+  {
+    return false;
+  }
+  int length = this->_https.getSize();
+  // Nothing is read past the deadline, whatever the body is handed to
+  DeadlineStream limited(*stream, this->_cancellation);
+  Stream *body = &limited;
+  ChunkedStream chunked(limited);
+  // The decoders wait on their source, their own timed reads do not wait again
+  chunked.setTimeout(0);
+  if (this->_https.header(HEADER_TRANSFER_ENCODING) == HEADER_TRANSFER_ENCODING_CHUNKED)
+  {
+    body = &chunked;
+    length = -1;
+  }
+  String encoding = this->_https.header(HEADER_CONTENT_ENCODING);
+  if (encoding == HEADER_CONTENT_ENCODING_GZIP || encoding == HEADER_CONTENT_ENCODING_DEFLATE)
+  {
+    log_d("Inflating %s response, %d bytes", encoding.c_str(), length);
+    InflateStream inflated(
+        *body,
+        encoding == HEADER_CONTENT_ENCODING_GZIP ? ContentEncoding::GzipEncoding : ContentEncoding::DeflateEncoding,
+        length);
+    inflated.setTimeout(0);
+    reader(inflated, -1);
+    return true;
+  }
+  reader(*body, length);
+  return true;
+}
+
+/**
+ * @brief Reads the whole response body into a String
+ * Unlike HTTPClient::getString() it stops at the deadline of the request.
+ *
+ * @param response Destination, what arrived before the deadline
+ * @return boolean false when the body is incomplete
+ */
+boolean FMDataClient::readResponseString(String &response)
+{
+  StreamString body;
+  boolean complete = false;
+  this->readResponseBody([&](Stream &stream, int length) {
+    if (length > 0 && !body.reserve(length + 1))
+    {
+      log_e("Not enough memory for a response of %d bytes", length);
+      return;
+    }
+    uint8_t buffer[FMDATA_READ_BUFFER_SIZE];
+    size_t total = 0;
+    for (;;)
+    {
+      size_t count = sizeof(buffer);
+      if (length >= 0)
+      {
+        count = min(count, (size_t)length - total);
+      }
+      else
+      {
+        // Only take what has arrived, the end of the body is not known
+        int available = stream.available();
+        count = available > 0 ? min(count, (size_t)available) : 1;
+      }
+      count = count > 0 ? stream.readBytes(buffer, count) : 0;
+      if (count == 0)
+      {
+        break;
+      }
+      body.write(buffer, count);
+      total += count;
+    }
+    complete = length >= 0 ? total == (size_t)length : !this->isCancelled();
+  });
+  response = body;
+  return complete;
+}
+
+boolean FMDataClient::sendRecordRequest(RequestOperation operation, const char *method, const char *token, const String &url, const uint8_t *payload, size_t length, ResponseStatus &status)
+{
+  return this->retryRequest(operation, status, [&](ResponseStatus &attempt) {
+    return this->sendRecordAttempt(operation, method, token, url, payload, length, attempt);
+  });
+}
+
+/**
+ * @brief Reads a whole response into a String, used by the String returning requests
+ *
+ * @param status Carries the http code of the request
+ * @param length Request body length
+ * @param response Destination, left empty on errors
+ * @return boolean true on HTTP_CODE_OK
+ */
+boolean FMDataClient::readStringResponse(ResponseStatus &status, size_t length, String &response)
+{
+  this->markPhase(RequestPhase::WaitPhase);
+  if (!this->checkDeadline(status.httpCode, length))
+  {
+    response = EMPTY_STRING;
+    return false;
+  }
+  String body;
+  if (status.httpCode > 0 && !this->readResponseString(body))
+  {
+    // The rest of the response would be read as the next one, drop the connection
+    log_e("Response incomplete");
+    status.httpCode = this->isCancelled() ? HTTP_ERROR_CANCELLED : HTTPC_ERROR_READ_TIMEOUT;
+    this->_client.stop();
+  }
+#if FMDATA_LOG_PAYLOADS
+  log_d("Response: %s", body.c_str());
+#endif
+  this->endRequest(status.httpCode, length);
+  if (status.httpCode == HTTP_CODE_OK)
+  {
+    log_d("Successfull request - Status: %d", status.httpCode);
+    response = body;
+    return true;
+  }
+  if (status.httpCode > 0)
+  {
+    // The Filemaker code decides whether the retry policy repeats the request
+    BufferStream stream((const uint8_t *)body.c_str(), body.length());
+    ResponseScanner(stream).scan(status);
+  }
+  log_e("Http error: %d - %s", status.httpCode, this->_https.errorToString(status.httpCode));
+  response = EMPTY_STRING;
+  return false;
+}
+
+/**
+ * @brief Runs a request until it succeeds or the retry policy gives up
+ * Without a retry policy the request runs once.
+ *
+ * @param operation Operation, decides which failures are retried
+ * @param status Status of the last attempt, HTTP_ERROR_CIRCUIT_OPEN when the breaker refused it
+ * @param attempt Sends the request once, fills the status and returns true on success
+ * @return boolean
+ */
+boolean FMDataClient::retryRequest(RequestOperation operation, ResponseStatus &status, std::function<boolean(ResponseStatus &)> attempt)
+{
+  if (this->_retryPolicy == NULL)
+  {
+    return this->runAttempt(status, attempt);
+  }
+  for (uint8_t number = 1;; number++)
+  {
+    status = ResponseStatus();
+    if (this->isCancelled())
+    {
+      status.httpCode = HTTP_ERROR_CANCELLED;
+      this->_lastHttpCode = HTTP_ERROR_CANCELLED;
+      return false;
+    }
+    if (!this->_retryPolicy->allow(operation))
+    {
+      log_e("Circuit breaker open, %s not sent", RequestMetrics::getOperationName(operation));
+      status.httpCode = HTTP_ERROR_CIRCUIT_OPEN;
+      this->_lastHttpCode = HTTP_ERROR_CIRCUIT_OPEN;
+      return false;
+    }
+    boolean ok = this->runAttempt(status, attempt);
+    if (status.httpCode == HTTP_ERROR_CANCELLED)
+    {
+      return false;
+    }
+    uint32_t wait = this->_retryPolicy->record(operation, status.httpCode, status.code, number);
+    if (ok || wait == 0)
+    {
+      return ok;
+    }
+    log_w("Retrying %s in %u ms", RequestMetrics::getOperationName(operation), wait);
+    this->pause(wait);
+  }
+}
+
+/**
+ * @brief Runs one attempt, a failure after the deadline is reported as HTTP_ERROR_CANCELLED,
+ * a request the rate limiter refused as HTTP_ERROR_RATE_LIMITED
+ */
+boolean FMDataClient::runAttempt(ResponseStatus &status, std::function<boolean(ResponseStatus &)> &attempt)
+{
+  this->_rateLimited = false;
+  boolean ok = attempt(status);
+  if (!ok && this->isCancelled())
+  {
+    status.httpCode = HTTP_ERROR_CANCELLED;
+    this->_lastHttpCode = HTTP_ERROR_CANCELLED;
+  }
+  else if (!ok && this->_rateLimited)
+  {
+    status.httpCode = HTTP_ERROR_RATE_LIMITED;
+  }
+  return ok;
+}
+
+boolean FMDataClient::sendRecordAttempt(RequestOperation operation, const char *method, const char *token, const String &url, const uint8_t *payload, size_t length, ResponseStatus &status)
+{
+  log_d("Url: %s", url.c_str());
+#if FMDATA_LOG_PAYLOADS
+  log_d("Payload: %.*s", (int)length, payload != NULL ? (const char *)payload : "");
+#endif
+  String auth = generateAuth(token);
+  if (!this->beginRequest(operation, url))
+  {
+    status.httpCode = HTTPC_ERROR_CONNECTION_REFUSED;
+    return false;
+  }
+  this->_https.addHeader(HEADER_AUTHORIZATION, auth.c_str());
+  this->_https.addHeader(HEADER_ACCEPT, HEADER_ACCEPT_VALUE_ALL);
+  this->_https.addHeader(HEADER_CACHE_CONTROL, HEADER_CACHE_CONTROL_VALUE_NO_CACHE);
+  if (length > 0)
+  {
+    this->_https.addHeader(HEADER_CONTENT_TYPE, MIME_TYPE_APPLICATION_JSON);
+  }
+  status.httpCode = this->_https.sendRequest(method, (uint8_t *)payload, length);
+  this->markPhase(RequestPhase::WaitPhase);
+  if (!this->checkDeadline(status.httpCode, length))
+  {
+    return false;
+  }
+  if (status.httpCode <= 0)
+  {
+    log_e("Http error: %d - %s", status.httpCode, this->_https.errorToString(status.httpCode));
+    this->endRequest(status.httpCode, length);
+    return false;
+  }
+  // Filemaker errors come with a json body, scan it either way
+  boolean scanned = this->scanResponse(status);
+  this->endRequest(status.httpCode, length);
+  if (!scanned)
+  {
+    log_e("Invalid response - Status: %d", status.httpCode);
+    FMDATA_TRACE_EVENT(TraceEventType::ParseErrorTraceEvent, this->_operation, status.httpCode, 0, 0, -1, 0);
+    return false;
+  }
+  if (status.code != FileMakerError::NoFileMakerError)
+  {
+    log_e("Filemaker error: %d - %s", status.code, status.message.c_str());
+    FMDATA_TRACE_EVENT(TraceEventType::FileMakerErrorTraceEvent, this->_operation, status.httpCode,
+                       status.code, 0, -1, 0);
+    return false;
+  }
+  if (status.httpCode != HTTP_CODE_OK)
+  {
+    log_e("Http error: %d - %s", status.httpCode, this->_https.errorToString(status.httpCode));
+    return false;
+  }
+  log_d("Successfull request - Status: %d, recordId: %s", status.httpCode, status.recordId.c_str());
+  return true;
+}
+
+/**
+   * @brief Generates the find request payload, search criteria, sort criteria and script execution parameters
+   * @see performFind()
+   * @param findCriterias
+   * @param limit
+   * @param offset
+   * @param sortCriteria 
+   * @param scripts
+   * @return String 
+   */
+String FMDataClient::generateFindPayload(const vector<FindCriteria *> &findCriterias, int limit, int offset, SortCriteria *sortCriteria, const ScriptParameters *scripts)
+{
+  String limitValue(limit);
+  String offsetValue(offset);
+  // Keys and criteria strings are linked, only the nodes are counted
+  size_t capacity = JSON_OBJECT_SIZE(4) + JSON_ARRAY_SIZE(findCriterias.size());
+  for (auto findCriteria : findCriterias)
+    capacity += findCriteria->getJSONCapacity();
+  if (sortCriteria != NULL)
+    capacity += sortCriteria->getJSONCapacity();
+  if (scripts != NULL)
+    capacity += scripts->getJSONCapacity();
+  DynamicJsonDocument doc(capacity);
+  JsonArray query = doc.createNestedArray(PARAMETER_QUERY);
+  for (auto findCriteria : findCriterias)
+  {
+    findCriteria->toJSON(query.createNestedObject());
+  }
+  if (sortCriteria != NULL)
+  {
+    sortCriteria->toJSON(doc.createNestedArray(PARAMETER_SORT));
+  }
+  if (scripts != NULL)
+  {
+    scripts->toJSON(doc.as<JsonObject>());
+  }
+  doc[PARAMETER_LIMIT] = limitValue.c_str();
+  if (offset > 0)
+  {
+    doc[PARAMETER_OFFSET] = offsetValue.c_str();
+  }
+
+  String result = EMPTY_STRING;
+  result.reserve(measureJson(doc));
+  serializeJson(doc, result);
+#if FMDATA_LOG_PAYLOADS
+  log_d("Find payload: %s", result.c_str());
+#endif
+  return result;
+}
+
+/**
+ * @brief 
+ * 
+ * @param token 
+ * @param database 
+ * @param records 
+ * @return String 
+ */
+String FMDataClient::setGlobalVariables(const String &token, const String &database, RecordField *records)
+{
+  throw ERROR_MSG_NOT_IMPLEMENTED;
+}
+
+/**
+ * @brief Get the Authentication Token
+ * 
+ * @return String 
+ */
+String FMDataClient::getToken(void) const
+{
+  return String(this->_token.c_str());
+}
+
+const char *FMDataClient::getTokenPtr(void) const
+{
+  return this->_token.c_str();
+}
+
+boolean FMDataClient::hasToken(void) const
+{
+  return !this->_token.isEmpty();
+}
+
+/**
+ * @brief Starts a request, connection, common headers and timing
+ * 
+ * @param operation Operation, used for the metrics
+ * @param url Url path
+ * @return boolean false when the connection failed
+ */
+boolean FMDataClient::beginRequest(RequestOperation operation, const String &url)
+{
+  // Waiting for a token is not part of the request timing
+  boolean admitted = this->waitForRateLimit(operation);
+  if (this->isCancelled())
+  {
+    log_e("Request cancelled before it was sent");
+    this->_operation = operation;
+    this->_lastHttpCode = HTTP_ERROR_CANCELLED;
+    return false;
+  }
+  if (!admitted)
+  {
+    this->_operation = operation;
+    this->_lastHttpCode = HTTP_ERROR_RATE_LIMITED;
+    this->_rateLimited = true;
+    return false;
+  }
+  this->startTiming(operation);
+  if ((this->_metrics != NULL || this->_dnsCache != NULL) && !this->_client.connected())
+  {
+    // Open the connection here to time DNS and connect separately,
+    // HTTPClient reuses an already connected client
+    if (!this->connect(this->_host.c_str(), this->_port))
+    {
+      log_e("Could not connect to: %s", this->_host.c_str());
+      FMDATA_TRACE_EVENT(TraceEventType::ConnectionErrorTraceEvent, operation, HTTPC_ERROR_CONNECTION_REFUSED, 0,
+                         0, -1, micros() - this->_requestStart);
+      this->finishTiming(HTTPC_ERROR_CONNECTION_REFUSED);
+      return false;
+    }
+    this->markPhase(RequestPhase::ConnectPhase);
+  }
+  if (!this->_https.begin(
+          this->_client,
+          this->_host.c_str(),
+          this->_port,
+          url, true))
+  {
+    log_e("Could not connect to: %s", this->_host.c_str());
+    FMDATA_TRACE_EVENT(TraceEventType::ConnectionErrorTraceEvent, operation, HTTPC_ERROR_CONNECTION_REFUSED, 0,
+                       0, -1, micros() - this->_requestStart);
+    this->finishTiming(HTTPC_ERROR_CONNECTION_REFUSED);
+    return false;
+  }
+  // Needed to decode the body, requests that need more headers collect their own
+  const char *headerKeys[] = {HEADER_CONTENT_ENCODING, HEADER_TRANSFER_ENCODING};
+  this->_https.collectHeaders(headerKeys, 2);
+  this->_https.setAuthorization(EMPTY_STRING);
+  this->_https.setUserAgent(HEADER_AGENT_VALUE);
+  this->_https.setReuse(this->_keepAlive);
+  // Connect and read timeouts never reach past the deadline
+  uint32_t timeout = min(this->getRemaining(), (uint32_t)HTTPCLIENT_DEFAULT_TCP_TIMEOUT);
+  this->_https.setConnectTimeout(timeout);
+  this->_https.setTimeout(timeout);
+  return true;
+}
+
+/**
+ * @brief Opens the connection, resolving the host through the dns cache when there is one
+ * The connect and the TLS handshake each wait no longer than the time left
+ * until the deadline, taken once the name is resolved.
+ * 
+ * @param host Host name, the certificate is checked against it
+ * @param port
+ * @return boolean false as well when the deadline passed
+ */
+boolean FMDataClient::connect(const char *host, int port)
+{
+  IPAddress address;
+  boolean resolved;
+  if (this->_dnsCache != NULL)
+  {
+    resolved = this->_dnsCache->resolve(host, address);
+  }
+  else
+  {
+    resolved = WiFi.hostByName(host, address) == 1;
+  }
+  this->markPhase(RequestPhase::DnsPhase);
+  if (this->isCancelled())
+  {
+    log_e("Request cancelled while resolving %s", host);
+    return false;
+  }
+  uint32_t timeout = min(this->getRemaining(), (uint32_t)HTTPCLIENT_DEFAULT_TCP_TIMEOUT);
+  // Both timeouts are given in whole seconds
+  this->_client.setHandshakeTimeout((timeout + 999) / 1000);
+  this->_client.setTimeout((timeout + 999) / 1000);
+  if (!resolved)
+  {
+    if (this->_dnsCache != NULL)
+    {
+      return false;
+    }
+    // Leave it to the client to resolve the name when the lookup failed
+    return this->_client.connect(host, port, (int32_t)timeout);
+  }
+  // Connect to the address, the certificate is still checked against the host name
+  const char *cert = this->_cert.length() > 0 ? this->_cert.c_str() : NULL;
+  if (this->_client.connect(address, port, host, cert, NULL, NULL))
+  {
+    return true;
+  }
+  if (this->_dnsCache != NULL)
+  {
+    this->_dnsCache->invalidate(host);
+  }
+  return false;
+}
+
+/**
+ * @brief Checks the deadline once the request was sent, before the response is read
+ * A cancelled request closes the connection, the rest of the response is not wanted.
+ * 
+ * @param httpCode Set to HTTP_ERROR_CANCELLED when the request was cancelled
+ * @param requestSize Request body size
+ * @return boolean false when the request was cancelled
+ */
+boolean FMDataClient::checkDeadline(int &httpCode, size_t requestSize)
+{
+  if (!this->isCancelled())
+  {
+    this->_https.setTimeout(min(this->getRemaining(), (uint32_t)HTTPCLIENT_DEFAULT_TCP_TIMEOUT));
+    return true;
+  }
+  log_e("Request cancelled");
+  httpCode = HTTP_ERROR_CANCELLED;
+  this->_client.stop();
+  this->endRequest(httpCode, requestSize);
+  return false;
+}
+
+boolean FMDataClient::isCancelled(void) const
+{
+  return this->_cancellation != NULL && this->_cancellation->isCancelled();
+}
+
+uint32_t FMDataClient::getRemaining(void) const
+{
+  return this->_cancellation != NULL ? this->_cancellation->getRemaining() : UINT32_MAX;
+}
+
+/**
+ * @brief Takes a token from the rate limiter, waiting for it when there is none
+ * The wait ends early when the request is cancelled or its deadline passes,
+ * the token is given back then.
+ * 
+ * @param operation Operation, selects the rate class
+ * @return boolean false when the limiter refused the request or it was cancelled while waiting
+ */
+boolean FMDataClient::waitForRateLimit(RequestOperation operation)
+{
+  if (this->_rateLimiter == NULL)
+  {
+    return true;
+  }
+  uint32_t wait = this->_rateLimiter->reserve(operation);
+  if (wait == RATE_LIMITER_REFUSED)
+  {
+    log_e("Rate limited, more than %d ms of requests waiting", RATE_LIMITER_MAX_WAIT);
+    return false;
+  }
+  if (wait > 0)
+  {
+    log_d("Rate limited, waiting %u ms", wait);
+    if (!this->pause(wait))
+    {
+      this->_rateLimiter->release(operation);
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Waits, returning early when the request is cancelled
+ * 
+ * @param milliseconds 
+ * @return boolean false when the request was cancelled
+ */
+boolean FMDataClient::pause(uint32_t milliseconds)
+{
+  unsigned long start = millis();
+  while (millis() - start < milliseconds)
+  {
+    if (this->isCancelled())
+      return false;
+    delay(min(milliseconds - (uint32_t)(millis() - start), (uint32_t)FMDATA_PAUSE_SLICE));
+  }
+  return !this->isCancelled();
+}
+
+void FMDataClient::endRequest(int httpCode, size_t requestSize)
+{
+  FMDATA_TRACE_EVENT(TraceEventType::RequestTraceEvent, this->_operation, httpCode, 0,
+                     requestSize, this->_https.getSize(), micros() - this->_requestStart);
+  if (this->_rateLimiter != NULL && (httpCode == HTTP_CODE_TOO_MANY_REQUESTS || httpCode == HTTP_CODE_SERVICE_UNAVAILABLE))
+  {
+    this->_rateLimiter->throttle(this->_operation);
+  }
+  this->_https.end();
+  this->finishTiming(httpCode);
+}
+
+void FMDataClient::startTiming(RequestOperation operation)
+{
+  this->_operation = operation;
+  if (this->_metrics == NULL && !FMDATA_TRACE_ENABLED)
+    return;
+  this->_timing = RequestTiming(operation);
+  this->_requestStart = micros();
+  this->_phaseStart = this->_requestStart;
+}
+
+void FMDataClient::markPhase(RequestPhase phase)
+{
+  if (this->_metrics == NULL)
+    return;
+  unsigned long now = micros();
+  this->_timing.phases[phase] = now - this->_phaseStart;
+  this->_phaseStart = now;
+}
+
+void FMDataClient::finishTiming(int httpCode)
+{
+  this->_lastHttpCode = httpCode;
+  if (this->_metrics == NULL)
+    return;
+  this->markPhase(RequestPhase::BodyPhase);
+  this->_timing.phases[RequestPhase::TotalPhase] = this->_phaseStart - this->_requestStart;
+  this->_timing.httpCode = httpCode;
+  this->_metrics->record(this->_timing);
+}
+
+/**
+ * @brief Enable per request phase timing
+ * 
+ * @param enabled 
+ */
+void FMDataClient::enableMetrics(boolean enabled)
+{
+  if (enabled && this->_metrics == NULL)
+  {
+    this->_metrics = new RequestMetrics();
+  }
+  else if (!enabled && this->_metrics != NULL)
+  {
+    delete this->_metrics;
+    this->_metrics = NULL;
+  }
+}
+
+const RequestMetrics *FMDataClient::getMetrics(void) const
+{
+  return this->_metrics;
+}
+
+/**
+ * @brief Enable retries with backoff and the circuit breaker
+ * 
+ * @param enabled 
+ */
+void FMDataClient::enableRetries(boolean enabled)
+{
+  if (enabled && this->_retryPolicy == NULL)
+  {
+    this->_retryPolicy = new RetryPolicy();
+  }
+  else if (!enabled && this->_retryPolicy != NULL)
+  {
+    delete this->_retryPolicy;
+    this->_retryPolicy = NULL;
+  }
+}
+
+RetryPolicy *FMDataClient::getRetryPolicy(void)
+{
+  return this->_retryPolicy;
+}
+
+/**
+ * @brief Sets the deadline and cancellation of the following requests
+ * 
+ * @param token Not owned by the client, NULL for none
+ */
+void FMDataClient::setCancellation(CancellationToken *token)
+{
+  this->_cancellation = token;
+}
+
+/**
+ * @brief Sets the dns cache shared by the clients of a host
+ * 
+ * @param cache Not owned by the client, NULL to resolve on every connection
+ */
+void FMDataClient::setDnsCache(DnsCache *cache)
+{
+  this->_dnsCache = cache;
+}
+
+int FMDataClient::getLastHttpCode(void) const
+{
+  return this->_lastHttpCode;
+}
+
+/**
+ * @brief Sets the rate limiter shared by the clients of a host
+ * 
+ * @param limiter Not owned by the client, NULL to send without limits
+ */
+void FMDataClient::setRateLimiter(RateLimiter *limiter)
+{
+  this->_rateLimiter = limiter;
+}
+
+RateLimiter *FMDataClient::getRateLimiter(void)
+{
+  return this->_rateLimiter;
+}
+
+/**
+ * @brief Stores the current metrics as a new record
+ * 
+ * @param database Database Name
+ * @param layout Layout Name
+ * @return String Json with result or empty string when it fails
+ */
+String FMDataClient::uploadMetrics(const String &database, const String &layout)
+{
+  if (this->_metrics == NULL)
+  {
+    log_e("Metrics are disabled");
+    return EMPTY_STRING;
+  }
+  vector<RecordField> fields;
+  for (uint8_t operation = 0; operation < RequestOperationCount; operation++)
+  {
+    RequestOperation op = (RequestOperation)operation;
+    if (this->_metrics->getCount(op) == 0)
+      continue;
+    String prefix(RequestMetrics::getOperationName(op));
+    prefix += "_";
+    fields.push_back(RecordField(prefix + "count", (int)this->_metrics->getCount(op)));
+    fields.push_back(RecordField(prefix + "errors", (int)this->_metrics->getErrors(op)));
+    for (uint8_t phase = 0; phase < RequestPhaseCount; phase++)
+    {
+      String name = prefix + RequestMetrics::getPhaseName((RequestPhase)phase);
+      fields.push_back(RecordField(name + "_p50", (int)this->_metrics->getPercentile(op, (RequestPhase)phase, 50)));
+      fields.push_back(RecordField(name + "_p99", (int)this->_metrics->getPercentile(op, (RequestPhase)phase, 99)));
+    }
+  }
+  return this->createRecord(database, layout, fields);
+}
+
+/**
+ * @brief Request gzip or deflate encoded responses
+ * 
+ * @param enabled 
+ */
+void FMDataClient::setResponseCompression(boolean enabled)
+{
+  this->_compression = enabled;
+}
 
-  return buffer;
+void FMDataClient::setToken(const String &token)
+{
+  this->_token = token;
+}
+
+void FMDataClient::setToken(const char *token)
+{
+  this->_token = token;
+}
+
+void FMDataClient::setKeepAlive(boolean enabled)
+{
+  this->_keepAlive = enabled;
+}
+
+/**
+ * @brief Format a string
+ * Formats on the caller's stack, so requests running on several tasks do
+ * not share a buffer. Text longer than STRINGF_BUFFER_SIZE is formatted
+ * again into the heap.
+ * @param format format template
+ * @param ... fill parameters
+ * @return String formated string
+ */
+String stringf(const char *format, ...)
+{
+  char buffer[STRINGF_BUFFER_SIZE];
+
+  va_list argptr;
+  va_start(argptr, format);
+  int length = vsnprintf(buffer, sizeof(buffer), format, argptr);
+  va_end(argptr);
+
+  if (length < 0)
+  {
+    return String(EMPTY_STRING);
+  }
+  if ((size_t)length < sizeof(buffer))
+  {
+    return String(buffer);
+  }
+  char *text = (char *)malloc(length + 1);
+  if (text == NULL)
+  {
+    log_e("No memory to format %d characters", length);
+    return String(EMPTY_STRING);
+  }
+  va_start(argptr, format);
+  vsnprintf(text, length + 1, format, argptr);
+  va_end(argptr);
+  String result(text);
+  free(text);
+  return result;
 }
 /**
  * @brief Generated the payload to create new record
+ * Field names and values are added as `const char *`, ArduinoJson stores
+ * them by reference instead of duplicating them into the document.
  * 
- * @param fields List of fields
+ * @param fields Array of fields
+ * @param fieldCount Number of fields in the array
  * @param scripts Scripts to be executed
  * @return String Filemaker response
  */
-String FMDataClient::generatePayload(vector<RecordField> fields, ScriptParameters *scripts)
+String FMDataClient::generatePayload(const RecordField *fields, size_t fieldCount, const ScriptParameters *scripts)
+{
+  String result;
+  DynamicJsonDocument doc(FMDataClient::getPayloadCapacity(fieldCount, scripts));
+  FMDataClient::writePayload(doc, fields, fieldCount, scripts);
+  // Serializing appends a character at a time, one block of the final size
+  size_t length = measureJson(doc);
+  log_d("Create Record payload size: %d", length);
+  result.reserve(length);
+  serializeJson(doc, result);
+  return result;
+}
+
+size_t FMDataClient::generatePayload(const RecordField *fields, size_t fieldCount, char *buffer, size_t size, const ScriptParameters *scripts)
+{
+  DynamicJsonDocument doc(FMDataClient::getPayloadCapacity(fieldCount, scripts));
+  FMDataClient::writePayload(doc, fields, fieldCount, scripts);
+  if (measureJson(doc) >= size)
+  {
+    log_e("Payload does not fit: %d bytes", measureJson(doc));
+    return 0;
+  }
+  return serializeJson(doc, buffer, size);
+}
+
+size_t FMDataClient::getPayloadCapacity(size_t fieldCount, const ScriptParameters *scripts)
+{
+  // Field names and values are linked, only the nodes are counted
+  size_t size = JSON_OBJECT_SIZE(1) + JSON_OBJECT_SIZE(fieldCount);
+  if (scripts != NULL)
+    size += scripts->getJSONCapacity();
+  return size;
+}
+
+void FMDataClient::writePayload(JsonDocument &doc, const RecordField *fields, size_t fieldCount, const ScriptParameters *scripts)
 {
-  String result = EMPTY_STRING;
-  size_t numChars = 0;
-  for (auto field : fields)
-    numChars += field.getSize();
-  size_t numFields = fields.size() + 1;
-  size_t size = JSON_OBJECT_SIZE(7) + JSON_OBJECT_SIZE(numFields) +
-                numFields * 16 + numChars + 160 + scripts->toJSONString().length();
-  DynamicJsonDocument doc(size);
   JsonObject fieldData = doc.createNestedObject(PARAMETER_FIELD_DATA);
-  for (auto field : fields)
+  for (size_t i = 0; i < fieldCount; i++)
   {
+    const RecordField &field = fields[i];
     log_d("Field Name: %s", field.fieldName.c_str());
+#if FMDATA_LOG_PAYLOADS
     log_d("Field Value: %s", field.fieldValue.c_str());
+#endif
     if (field.fieldType == FieldTypes::Number)
     {
       log_d("Field Value is Number");
-      fieldData[field.fieldName] = atoi(field.fieldValue.c_str());
+      fieldData[field.fieldName.c_str()] = atoi(field.fieldValue.c_str());
     }
     else
     {
       log_d("Field Value is Text");
-      fieldData[field.fieldName] = field.fieldValue;
+      fieldData[field.fieldName.c_str()] = field.fieldValue.c_str();
     }
   }
   if (scripts != NULL)
   {
-    JsonDocument js = scripts->toJSONDocument();
-    FMDataClient::mergeJson(doc.as<JsonObject>(), js.as<JsonObject>());
+    scripts->toJSON(doc.as<JsonObject>());
   }
-  log_d("Create Record payload size: %d", measureJson(doc));
-  serializeJson(doc, result);
-  return result;
 }
 
 /**
@@ -1186,7 +2431,7 @@ String FMDataClient::generatePayload(vector<RecordField> fields, ScriptParameter
    * @param method Http Method
    * @return String 
    */
-String ScriptParameters::formatParmaters(String method) const
+String ScriptParameters::formatParmaters(const String &method) const
 {
   if (method == HTTP_METHOD_GET || method == HTTP_METHOD_DELETE)
   {
@@ -1194,10 +2439,7 @@ String ScriptParameters::formatParmaters(String method) const
   }
   else if (method == HTTP_METHOD_PATCH || method == HTTP_METHOD_POST)
   {
-    String result;
-    JsonDocument jd = this->toJSONDocument();
-    serializeJson(jd, result);
-    return result;
+    return this->toJSONString();
   }
   else
   {
@@ -12,13 +12,51 @@
 #include <stdarg.h>
 #include <Arduino.h>
 #include <HTTPClient.h>
+#include <WiFi.h>
 #include <ArduinoJson.h>
 #include <base64.h>
 #include <ESPRandom.h>
 #include <StreamString.h>
+#include "MultipartStream.h"
+#include "ResponseStream.h"
+#include "RequestMetrics.h"
+#include "RetryPolicy.h"
+#include "RateLimiter.h"
+#include "CancellationToken.h"
+#include "DnsCache.h"
+#include "RequestTrace.h"
+#include "JsonCapacity.h"
+#include "ResponseScanner.h"
+#include "FieldName.h"
+#include "InlineString.h"
+#include <utility>
 
 #define EMPTY_STRING ""
 
+// Inline buffer sizes, longer text is stored on the heap
+#ifndef FIELD_VALUE_CAPACITY
+#define FIELD_VALUE_CAPACITY 24
+#endif
+#ifndef SCRIPT_PARAMETER_CAPACITY
+#define SCRIPT_PARAMETER_CAPACITY 32
+#endif
+#ifndef FMDATA_TOKEN_CAPACITY
+#define FMDATA_TOKEN_CAPACITY 64
+#endif
+#ifndef FMDATA_HOST_CAPACITY
+#define FMDATA_HOST_CAPACITY 64
+#endif
+#ifndef FMDATA_ID_CAPACITY
+#define FMDATA_ID_CAPACITY 40
+#endif
+
+// Json documents are only serialized for logging in debug builds
+#if defined(ARDUHAL_LOG_LEVEL) && ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_DEBUG
+#define FMDATA_LOG_PAYLOADS 1
+#else
+#define FMDATA_LOG_PAYLOADS 0
+#endif
+
 #define HEADER_X_FM_DATA_ACCESS_TOKEN "X-FM-Data-Access-Token"
 #define HEADER_X_FMS_REQUEST_ID "X-FMS-Request-ID"
 #define HEADER_CONTENT_TYPE "Content-Type"
@@ -32,12 +70,24 @@
 #define HEADER_HOST "Host"
 #define HEADER_ACCEPT "Accept"
 #define HEADER_ACCEPT_VALUE_ALL "*/*"
+#define HEADER_ACCEPT_ENCODING "Accept-Encoding"
+#define HEADER_ACCEPT_ENCODING_VALUE "gzip, deflate"
+#define HEADER_CONTENT_ENCODING "Content-Encoding"
+#define HEADER_CONTENT_ENCODING_GZIP "gzip"
+#define HEADER_CONTENT_ENCODING_DEFLATE "deflate"
 #define HEADER_CACHE_CONTROL "Cache-Control"
 #define HEADER_CACHE_CONTROL_VALUE_NO_CACHE "no-cache"
 #define HEADER_CONTENT_LENGTH "Content-Length"
 #define HEADER_CONTENT_LENGTH_EMPTY "0"
 #define HEADER_CONTENT_DISPOSITION "Content-Disposition"
 #define HEADER_GENERIC "%s: %s"
+#define HEADER_RANGE "Range"
+#define HEADER_RANGE_FROM "bytes=%u-"
+#define HEADER_COOKIE "Cookie"
+#define HEADER_SET_COOKIE "Set-Cookie"
+#define HEADER_LOCATION "Location"
+#define HEADER_TRANSFER_ENCODING "Transfer-Encoding"
+#define HEADER_TRANSFER_ENCODING_CHUNKED "chunked"
 
 #define FORM_DATA_DISPOSITION "form-data; name=\"upload\"; filename=\"%s\""
 
@@ -54,6 +104,7 @@
 #define MIME_TYPE_CSV "text/csv"
 
 #define URL_FULL "https://%s:%d%s"
+#define URL_HOST "https://%s:%d"
 #define URL_DATA_API_BASE_V1 "/fmi/data/v1/databases/"
 #define URL_SESSIONS "/fmi/data/v1/databases/%s/sessions"
 #define URL_OAUTH_PROVIDERS "/fmws/oauthproviderinfo"
@@ -113,11 +164,30 @@
 #define ERROR_MSG_EMPTY_TOKEN "Empty Token"
 #define ERROR_MSG_CONNECTION_FAILED "Connection Failed"
 
+#define CONTAINER_DOWNLOAD_BUFFER_SIZE 1024
+#define CONTAINER_DOWNLOAD_MAX_REDIRECTS 5
+#define CONTAINER_DOWNLOAD_MAX_ATTEMPTS 5
+#define CONTAINER_DOWNLOAD_TIMEOUT 5000
+// First wait before an interrupted download is resumed, doubled with every attempt
+#define CONTAINER_DOWNLOAD_RETRY_DELAY 250
+
+// Longest sleep between cancellation checks while waiting
+#define FMDATA_PAUSE_SLICE 10
+
+// Bytes copied at a time when a response is read into a String
+#define FMDATA_READ_BUFFER_SIZE 128
+
+// Initial estimate of the login response document, adapted to the responses received
+#define JSON_CAPACITY_LOG_IN (JSON_ARRAY_SIZE(1) + JSON_OBJECT_SIZE(1) + 2 * JSON_OBJECT_SIZE(2) + 191)
+
+// Stack buffer of stringf(), longer text is formatted into the heap
+#define STRINGF_BUFFER_SIZE 128
+
 // #define setf(format, ...) formatString(format, ##__VA_ARGS__)
 
 using namespace std;
 
-char *stringf(const char *format, ...);
+String stringf(const char *format, ...);
 
 /**
  * @brief Credentials Type
@@ -144,11 +214,17 @@ public:
   virtual CredentialsType getType(void) const = 0;
   virtual String getAuthorizationHeaderValue(void) const = 0;
   String getLogInUrl(void) const;
-  String getLogOutUrl(const String &token) const;
+  String getLogOutUrl(const char *token) const;
 
 protected:
   String database;
-  virtual JsonObject toJSON(void) = 0;
+  /**
+   * @brief Writes the credentials of an external database
+   * Strings are linked, not copied, a slot of JSON_OBJECT_SIZE(3) is enough.
+   *
+   * @param dst Destination object
+   */
+  virtual void toJSON(JsonObject dst) const = 0;
   vector<DatabaseCredentials *> externalDatabasesCredentials;
 };
 /**
@@ -168,7 +244,7 @@ public:
   CredentialsType getType(void) const;
 
 protected:
-  JsonObject toJSON(void);
+  void toJSON(JsonObject dst) const;
   String userName;
   String password;
 };
@@ -189,7 +265,7 @@ public:
   CredentialsType getType(void) const;
 
 protected:
-  JsonObject toJSON(void);
+  void toJSON(JsonObject dst) const;
   String oAuthRequestId;
   String oAuthId;
 };
@@ -235,19 +311,29 @@ enum FieldTypes
 class RecordSortCriteria
 {
 public:
-  RecordSortCriteria(String fieldName, SortOrder order = SortOrder::ascend);
+  RecordSortCriteria(FieldName fieldName, SortOrder order = SortOrder::ascend);
   SortOrder order;
-  String fieldName;
-  JsonObject toJSON(void);
+  FieldName fieldName;
+  /**
+   * @brief Writes the sort object, needs JSON_OBJECT_SIZE(2)
+   *
+   * @param dst Destination object
+   */
+  void toJSON(JsonObject dst) const;
 };
 
 class RecordFindCriteria
 {
 public:
-  RecordFindCriteria(String fieldName, String fieldValue = "*");
-  String fieldName;
+  RecordFindCriteria(FieldName fieldName, String fieldValue = "*");
+  FieldName fieldName;
   String fieldValue;
-  JsonObject toJSON(void);
+  /**
+   * @brief Adds the field to a find request, needs JSON_OBJECT_SIZE(1)
+   *
+   * @param dst Destination object
+   */
+  void toJSON(JsonObject dst) const;
 };
 
 class SortCriteria
@@ -255,7 +341,18 @@ class SortCriteria
 public:
   SortCriteria(const vector<RecordSortCriteria *> &records);
   vector<RecordSortCriteria *> records;
-  JsonObject toJSON(void);
+  /**
+   * @brief Writes the sort array
+   *
+   * @param dst Destination array
+   */
+  void toJSON(JsonArray dst) const;
+  /**
+   * @brief Exact memory needed by toJSON()
+   *
+   * @return size_t Bytes
+   */
+  size_t getJSONCapacity(void) const;
 };
 
 class FindCriteria
@@ -264,20 +361,72 @@ public:
   FindCriteria(const vector<RecordFindCriteria *> &records, boolean omit = false);
   vector<RecordFindCriteria *> records;
   boolean omit;
-  JsonObject toJSON(void);
+  /**
+   * @brief Writes the find request object
+   *
+   * @param dst Destination object
+   */
+  void toJSON(JsonObject dst) const;
+  /**
+   * @brief Exact memory needed by toJSON()
+   *
+   * @return size_t Bytes
+   */
+  size_t getJSONCapacity(void) const;
 };
 
+typedef InlineString<FIELD_VALUE_CAPACITY> RecordFieldValue;
+
+/**
+ * @brief A field name/value pair of a record
+ * The name is interned, fields with the same name share one copy, see
+ * FieldName. Values up to FIELD_VALUE_CAPACITY - 1 characters are kept
+ * inside the field, longer ones take a heap block.
+ */
 class RecordField
 {
 public:
-  RecordField(String fieldName, String fieldValue = "", FieldTypes fieldType = FieldTypes::Text);
-  RecordField(String fieldName, int fieldValue);
-  RecordField(String fieldName, float fieldValue);
-  String fieldName;
-  String fieldValue;
+  RecordField(FieldName fieldName, RecordFieldValue fieldValue = "", FieldTypes fieldType = FieldTypes::Text);
+  RecordField(FieldName fieldName, int fieldValue);
+  RecordField(FieldName fieldName, float fieldValue);
+  FieldName fieldName;
+  RecordFieldValue fieldValue;
   FieldTypes fieldType;
   JsonObject toJSON(void) const;
-  size_t getSize();
+  size_t getSize(void) const;
+};
+
+/**
+ * @brief Transfer statistics of a container download
+ */
+class DownloadStatistics
+{
+public:
+  DownloadStatistics(void);
+  /** Bytes written to the destination by this call */
+  size_t bytes;
+  /** Total size of the container, 0 when the server did not report it */
+  size_t totalSize;
+  /** Number of requests, including redirects and resumed transfers */
+  uint8_t requests;
+  /** Transfer duration in milliseconds */
+  unsigned long duration;
+  /** Free heap before the transfer started */
+  uint32_t startFreeHeap;
+  /** Lowest free heap observed during the transfer */
+  uint32_t minFreeHeap;
+  /**
+   * @brief Transfer throughput
+   *
+   * @return float Bytes per second
+   */
+  float getThroughput(void) const;
+  /**
+   * @brief Peak heap used by the transfer
+   *
+   * @return uint32_t Bytes
+   */
+  uint32_t getPeakHeapUsage(void) const;
 };
 
 /**
@@ -297,16 +446,31 @@ public:
    * @param preSortScriptName Presort script name
    * @param preSortScriptParameter Presort script parameter
    */
-  ScriptParameters(String name = "", String parameter = "",
-                   String preRequestScriptName = "", String preRequestScriptParameter = "",
-                   String preSortScriptName = "", String preSortScriptParameter = "");
+  ScriptParameters(const String &name = "", const String &parameter = "",
+                   const String &preRequestScriptName = "", const String &preRequestScriptParameter = "",
+                   const String &preSortScriptName = "", const String &preSortScriptParameter = "");
 
   /**
   * @brief Generates de script parameters for POST and PATCH requests
   * 
-  * @return JsonDocument 
+  * @return DynamicJsonDocument 
   */
-  JsonDocument toJSONDocument(void) const;
+  DynamicJsonDocument toJSONDocument(void) const;
+
+  /**
+   * @brief Adds the script parameters to a request object
+   * Strings are linked, not copied, this object must outlive the document.
+   *
+   * @param dst Destination object
+   */
+  void toJSON(JsonObject dst) const;
+
+  /**
+   * @brief Exact memory needed by toJSON()
+   *
+   * @return size_t Bytes
+   */
+  size_t getJSONCapacity(void) const;
 
   /**
    * @brief Generates de script parameters for POST and PATCH requests
@@ -328,15 +492,15 @@ public:
    * @param method Http Method
    * @return String The resulting string
    */
-  String formatParmaters(String method) const;
+  String formatParmaters(const String &method) const;
 
 private:
-  String _name;
-  String _parameter;
-  String _preRequestScriptName;
-  String _preRequestScriptParameter;
-  String _preSortScriptName;
-  String _preSortScriptParameter;
+  InlineString<SCRIPT_PARAMETER_CAPACITY> _name;
+  InlineString<SCRIPT_PARAMETER_CAPACITY> _parameter;
+  InlineString<SCRIPT_PARAMETER_CAPACITY> _preRequestScriptName;
+  InlineString<SCRIPT_PARAMETER_CAPACITY> _preRequestScriptParameter;
+  InlineString<SCRIPT_PARAMETER_CAPACITY> _preSortScriptName;
+  InlineString<SCRIPT_PARAMETER_CAPACITY> _preSortScriptParameter;
 };
 
 /**
@@ -361,6 +525,21 @@ public:
       const char *&host,
       const char *&cert,
       const int &port);
+  /**
+   * @brief Construct a new FMDataClient object with a Wifi Client of its own
+   * Use it for clients working in parallel, every client keeps its own TLS
+   * session and socket.
+   * 
+   * @param credentials Database Credentials
+   * @param host Host address, ip address or domain name
+   * @param cert Root Certificate
+   * @param port Connection Port
+   */
+  FMDataClient(
+      const DatabaseCredentials &credentials,
+      const char *&host,
+      const char *&cert,
+      const int &port);
   /**
    * @brief Destroy the FMDataClient object
    * 
@@ -402,7 +581,7 @@ public:
    * @param oauthType OAuth Type
    * @return String 
    */
-  String getOAuthRequestId(String trackingId, String oauthProvider, String address = "127.0.0.1", int oauthType = 2);
+  String getOAuthRequestId(const String &trackingId, const String &oauthProvider, const String &address = "127.0.0.1", int oauthType = 2);
 
   /**
    * @brief Log out of a database session
@@ -421,7 +600,19 @@ public:
    * @param scripts Scripts to be executed
    * @return String Json with result or empty string when it fails
    */
-  String createRecord(String token, String database, String layout, vector<RecordField> fields, ScriptParameters *scripts = NULL);
+  String createRecord(const String &token, const String &database, const String &layout, const vector<RecordField> &fields, const ScriptParameters *scripts = NULL);
+  /**
+   * @brief Create a record
+   * @see https://fmhelp.filemaker.com/docs/17/en/dataapi/#work-with-records_create-record
+   * @param token The Authentication Token
+   * @param database Database Name
+   * @param layout Layout Name
+   * @param fields Array of fields with values
+   * @param fieldCount Number of fields in the array
+   * @param scripts Scripts to be executed
+   * @return String Json with result or empty string when it fails
+   */
+  String createRecord(const String &token, const String &database, const String &layout, const RecordField *fields, size_t fieldCount, const ScriptParameters *scripts = NULL);
   /**
    * @brief Create a Record object
    * @see https://fmhelp.filemaker.com/docs/17/en/dataapi/#work-with-records_create-record
@@ -431,7 +622,59 @@ public:
    * @param scripts Scripts to be executed
    * @return String Json with result or empty string when it fails
    */
-  String createRecord(String database, String layout, vector<RecordField> fields, ScriptParameters *scripts = NULL);
+  String createRecord(const String &database, const String &layout, const vector<RecordField> &fields, const ScriptParameters *scripts = NULL);
+  /**
+   * @brief Create a Record object
+   * @see https://fmhelp.filemaker.com/docs/17/en/dataapi/#work-with-records_create-record
+   * @param database Database Name
+   * @param layout Layout Name
+   * @param fields Array of fields with values
+   * @param fieldCount Number of fields in the array
+   * @param scripts Scripts to be executed
+   * @return String Json with result or empty string when it fails
+   */
+  String createRecord(const String &database, const String &layout, const RecordField *fields, size_t fieldCount, const ScriptParameters *scripts = NULL);
+
+  /**
+   * @brief Create a record, reading only the status of the response
+   * The response is scanned for the Filemaker code and the new recordId
+   * instead of being buffered, use it for high rate writes.
+   * @see https://fmhelp.filemaker.com/docs/17/en/dataapi/#work-with-records_create-record
+   * @param token The Authentication Token
+   * @param database Database Name
+   * @param layout Layout Name
+   * @param fields Array of fields with values
+   * @param fieldCount Number of fields in the array
+   * @param status Filemaker code, message, recordId and modId
+   * @param scripts Scripts to be executed
+   * @return boolean true when the record was created
+   */
+  boolean createRecord(const String &token, const String &database, const String &layout, const RecordField *fields, size_t fieldCount, ResponseStatus &status, const ScriptParameters *scripts = NULL);
+
+  /**
+   * @brief Create a record with the session token, reading only the status of the response
+   * @see createRecord()
+   * @param database Database Name
+   * @param layout Layout Name
+   * @param fields Array of fields with values
+   * @param fieldCount Number of fields in the array
+   * @param status Filemaker code, message, recordId and modId
+   * @param scripts Scripts to be executed
+   * @return boolean true when the record was created
+   */
+  boolean createRecord(const String &database, const String &layout, const RecordField *fields, size_t fieldCount, ResponseStatus &status, const ScriptParameters *scripts = NULL);
+
+  /**
+   * @brief Create a record with the session token from a generated payload
+   * @see generatePayload()
+   * @param database Database Name
+   * @param layout Layout Name
+   * @param payload Json payload
+   * @param length Payload length
+   * @param status Filemaker code, message, recordId and modId
+   * @return boolean true when the record was created
+   */
+  boolean createRecord(const String &database, const String &layout, const uint8_t *payload, size_t length, ResponseStatus &status);
 
   /**
    * @brief Edit a record
@@ -443,7 +686,19 @@ public:
    * @param fields List of fields with values
    * @return String Json with result or empty string when it fails
    */
-  String editRecord(String token, String database, String layout, String recordId, vector<RecordField> fields);
+  String editRecord(const String &token, const String &database, const String &layout, const String &recordId, const vector<RecordField> &fields);
+  /**
+   * @brief Edit a record
+   * @see https://fmhelp.filemaker.com/docs/17/en/dataapi/#work-with-records_edit-record
+   * @param token The Authentication Token
+   * @param database Database Name
+   * @param layout Layout Name
+   * @param recordId  Record Identifier
+   * @param fields Array of fields with values
+   * @param fieldCount Number of fields in the array
+   * @return String Json with result or empty string when it fails
+   */
+  String editRecord(const String &token, const String &database, const String &layout, const String &recordId, const RecordField *fields, size_t fieldCount);
   /**
    * @brief Edit a record
    * @see https://fmhelp.filemaker.com/docs/17/en/dataapi/#work-with-records_edit-record
@@ -453,7 +708,47 @@ public:
    * @param fields List of fields with values
    * @return String Json with result or empty string when it fails
    */
-  String editRecord(String database, String layout, String recordId, vector<RecordField> fields);
+  String editRecord(const String &database, const String &layout, const String &recordId, const vector<RecordField> &fields);
+
+  /**
+   * @brief Edit a record, reading only the status of the response
+   * @see https://fmhelp.filemaker.com/docs/17/en/dataapi/#work-with-records_edit-record
+   * @param token The Authentication Token
+   * @param database Database Name
+   * @param layout Layout Name
+   * @param recordId Record Id
+   * @param fields Array of fields with values
+   * @param fieldCount Number of fields in the array
+   * @param status Filemaker code, message and modId
+   * @return boolean true when the record was changed
+   */
+  boolean editRecord(const String &token, const String &database, const String &layout, const String &recordId, const RecordField *fields, size_t fieldCount, ResponseStatus &status);
+
+  /**
+   * @brief Edit a record with the session token, reading only the status of the response
+   * @see editRecord()
+   * @param database Database Name
+   * @param layout Layout Name
+   * @param recordId Record Id
+   * @param fields Array of fields with values
+   * @param fieldCount Number of fields in the array
+   * @param status Filemaker code, message and modId
+   * @return boolean true when the record was changed
+   */
+  boolean editRecord(const String &database, const String &layout, const String &recordId, const RecordField *fields, size_t fieldCount, ResponseStatus &status);
+
+  /**
+   * @brief Edit a record with the session token from a generated payload
+   * @see generatePayload()
+   * @param database Database Name
+   * @param layout Layout Name
+   * @param recordId Record Id
+   * @param payload Json payload
+   * @param length Payload length
+   * @param status Filemaker code, message and modId
+   * @return boolean true when the record was changed
+   */
+  boolean editRecord(const String &database, const String &layout, const String &recordId, const uint8_t *payload, size_t length, ResponseStatus &status);
 
   /**
    * @brief Delete a record
@@ -464,7 +759,7 @@ public:
    * @param recordId 
    * @return boolean 
    */
-  boolean deleteRecord(String token, String database, String layout, String recordId);
+  boolean deleteRecord(const String &token, const String &database, const String &layout, const String &recordId);
   /**
    * @brief Delete a record
    * @see https://fmhelp.filemaker.com/docs/17/en/dataapi/#work-with-records_delete-record
@@ -473,7 +768,7 @@ public:
    * @param recordId 
    * @return boolean 
    */
-  boolean deleteRecord(String database, String layout, String recordId);
+  boolean deleteRecord(const String &database, const String &layout, const String &recordId);
 
   /**
    * @brief Get a single record
@@ -486,7 +781,7 @@ public:
    * @param scripts
    * @return String 
    */
-  String getRecord(String token, String database, String layout, String recordId, PortalRecordRange *ranges = NULL, ScriptParameters *scripts = NULL);
+  String getRecord(const String &token, const String &database, const String &layout, const String &recordId, PortalRecordRange *ranges = NULL, const ScriptParameters *scripts = NULL);
 
   /**
    * @brief Get a range of records
@@ -497,7 +792,7 @@ public:
    * @param range 
    * @return String 
    */
-  String getRecords(String token, String database, String layout, RecordRange range = RecordRange());
+  String getRecords(const String &token, const String &database, const String &layout, const RecordRange &range = RecordRange());
 
   /**
    * @brief Get a range of records
@@ -509,7 +804,7 @@ public:
    * @param range 
    * @return String 
    */
-  String getRecords(String token, String database, String layout, SortCriteria sortCriteria, RecordRange range = RecordRange());
+  String getRecords(const String &token, const String &database, const String &layout, const SortCriteria &sortCriteria, const RecordRange &range = RecordRange());
 
   /**
    * @brief Upload container data
@@ -525,7 +820,7 @@ public:
    * @param type Content type
    * @return String Json with result response or empty in case of error
    */
-  String uploadContainerData(String token, String database, String layout, String recordId, String fieldName, int repetition, String contents, String name, String type);
+  String uploadContainerData(const String &token, const String &database, const String &layout, const String &recordId, const String &fieldName, int repetition, const String &contents, const String &name, const String &type);
 
   /**
    * @brief Upload container data
@@ -540,7 +835,56 @@ public:
    * @param type Content type
    * @return String Json with result response or empty in case of error
    */
-  String uploadContainerData(String database, String layout, String recordId, String fieldName, int repetition, String contents, String name, String type);
+  String uploadContainerData(const String &database, const String &layout, const String &recordId, const String &fieldName, int repetition, const String &contents, const String &name, const String &type);
+
+  /**
+   * @brief Upload container data streamed from a Stream or File
+   * The multipart body is written to the socket in fixed size chunks,
+   * memory usage does not depend on the contents length.
+   * @see https://fmhelp.filemaker.com/docs/17/en/dataapi/#upload-container-data
+   * @param token Authentication Token
+   * @param database Database Name
+   * @param layout Layout Name
+   * @param recordId Record Identifier
+   * @param fieldName Field Name
+   * @param repetition Field Repetition index
+   * @param contents Stream
+   * @param length Number of bytes to read from contents
+   * @param name Name
+   * @param type Content type
+   * @return String Json with result response or empty in case of error
+   */
+  String uploadContainerData(const String &token, const String &database, const String &layout, const String &recordId, const String &fieldName, int repetition, Stream &contents, size_t length, const String &name, const String &type);
+
+  /**
+   * @brief Upload container data streamed from a Stream or File
+   * @see https://fmhelp.filemaker.com/docs/17/en/dataapi/#upload-container-data
+   * @param database Database Name
+   * @param layout Layout Name
+   * @param recordId Record Identifier
+   * @param fieldName Field Name
+   * @param repetition Field Repetition index
+   * @param contents Stream
+   * @param length Number of bytes to read from contents
+   * @param name Name
+   * @param type Content type
+   * @return String Json with result response or empty in case of error
+   */
+  String uploadContainerData(const String &database, const String &layout, const String &recordId, const String &fieldName, int repetition, Stream &contents, size_t length, const String &name, const String &type);
+
+  /**
+   * @brief Download container data to a Stream or File
+   * Follows the streaming URL redirect carrying the session cookie, copies the
+   * body in fixed size chunks and, when the connection drops, resumes with a
+   * Range request from the last byte written.
+   * @see https://fmhelp.filemaker.com/docs/17/en/dataapi/#work-with-records_get-record
+   * @param url Container URL as returned in the field data
+   * @param destination Stream the contents are written to
+   * @param offset Bytes already stored by a previous call, the download resumes from there
+   * @param statistics Optional transfer statistics
+   * @return boolean true when the container was completely downloaded
+   */
+  boolean downloadContainerData(const String &url, Stream &destination, size_t offset = 0, DownloadStatistics *statistics = NULL);
 
   /**
    * @brief Perform a find request
@@ -555,7 +899,55 @@ public:
    * @param scripts
    * @return String 
    */
-  String performFind(String token, String database, String layout, vector<FindCriteria *> findCriterias, int limit = 100, int offset = 0, SortCriteria *sortCriteria = NULL, ScriptParameters *scripts = NULL);
+  String performFind(const String &token, const String &database, const String &layout, const vector<FindCriteria *> &findCriterias, int limit = 100, int offset = 0, SortCriteria *sortCriteria = NULL, const ScriptParameters *scripts = NULL);
+
+  /**
+   * @brief Perform a find request, parsing the response straight into a document
+   * The body is deserialized while it is received, with response compression
+   * enabled it is inflated on the fly and never held as a String.
+   * @see https://fmhelp.filemaker.com/docs/17/en/dataapi/#perform-a-find-request
+   * @see setResponseCompression()
+   * @param token 
+   * @param database 
+   * @param layout 
+   * @param findCriterias
+   * @param response Document receiving the Filemaker response, also on Filemaker errors
+   * @param limit
+   * @param offset
+   * @param sortCriteria 
+   * @param scripts
+   * @return boolean true when the request succeeded and the response was parsed
+   */
+  boolean performFind(const String &token, const String &database, const String &layout, const vector<FindCriteria *> &findCriterias, JsonDocument &response, int limit = 100, int offset = 0, SortCriteria *sortCriteria = NULL, const ScriptParameters *scripts = NULL);
+
+  /**
+   * @brief Perform a find request with the session token
+   * @see performFind()
+   * @param database 
+   * @param layout 
+   * @param findCriterias
+   * @param limit
+   * @param offset
+   * @param sortCriteria 
+   * @param scripts
+   * @return String 
+   */
+  String performFind(const String &database, const String &layout, const vector<FindCriteria *> &findCriterias, int limit = 100, int offset = 0, SortCriteria *sortCriteria = NULL, const ScriptParameters *scripts = NULL);
+
+  /**
+   * @brief Perform a find request with the session token, parsing the response straight into a document
+   * @see performFind()
+   * @param database 
+   * @param layout 
+   * @param findCriterias
+   * @param response Document receiving the Filemaker response, also on Filemaker errors
+   * @param limit
+   * @param offset
+   * @param sortCriteria 
+   * @param scripts
+   * @return boolean true when the request succeeded and the response was parsed
+   */
+  boolean performFind(const String &database, const String &layout, const vector<FindCriteria *> &findCriterias, JsonDocument &response, int limit = 100, int offset = 0, SortCriteria *sortCriteria = NULL, const ScriptParameters *scripts = NULL);
 
   /**
    * @brief Generates the find request payload, search criteria, sort criteria and script execution parameters
@@ -567,7 +959,29 @@ public:
    * @param scripts
    * @return String 
    */
-  String generateFindPayload(vector<FindCriteria *> findCriterias, int limit = 100, int offset = 0, SortCriteria *sortCriteria = NULL, ScriptParameters *scripts = NULL);
+  String generateFindPayload(const vector<FindCriteria *> &findCriterias, int limit = 100, int offset = 0, SortCriteria *sortCriteria = NULL, const ScriptParameters *scripts = NULL);
+
+  /**
+   * @brief Generated the payload to create new record
+   * 
+   * @param fields Array of fields
+   * @param fieldCount Number of fields in the array
+   * @param scripts Scripts to be executed
+   * @return String Filemaker response
+   */
+  static String generatePayload(const RecordField *fields, size_t fieldCount, const ScriptParameters *scripts = NULL);
+
+  /**
+   * @brief Generates the payload to create or edit a record into a buffer
+   * 
+   * @param fields Array of fields
+   * @param fieldCount Number of fields in the array
+   * @param buffer Destination, NUL terminated
+   * @param size Size of the buffer
+   * @param scripts Scripts to be executed
+   * @return size_t Payload length, 0 when it does not fit
+   */
+  static size_t generatePayload(const RecordField *fields, size_t fieldCount, char *buffer, size_t size, const ScriptParameters *scripts = NULL);
 
   /**
    * @brief Set global field values
@@ -577,22 +991,164 @@ public:
    * @param records 
    * @return String 
    */
-  String setGlobalVariables(String token, String database, RecordField *records);
+  String setGlobalVariables(const String &token, const String &database, RecordField *records);
 
   /**
    * @brief Get the Authentication
    * 
-   * @return String 
+   * @return String Copy of the token, empty without a session
+   */
+  String getToken(void) const;
+
+  /**
+   * @brief Get the Authentication Token without copying it
+   * Points into the client, valid until the next log in, log out or setToken().
+   * 
+   * @return const char* Empty without a session
+   */
+  const char *getTokenPtr(void) const;
+
+  /**
+   * @brief True while a session token is set
+   *
+   * @return boolean
+   */
+  boolean hasToken(void) const;
+
+  /**
+   * @brief Set the Authentication Token
+   * Lets several clients share the session opened by one of them.
+   * 
+   * @param token 
+   */
+  void setToken(const String &token);
+  void setToken(const char *token);
+
+  /**
+   * @brief Keep the connection open between requests
+   * 
+   * @param enabled 
+   */
+  void setKeepAlive(boolean enabled);
+
+  /**
+   * @brief Request gzip or deflate encoded responses
+   * Only applies to requests parsing the response into a JsonDocument,
+   * String responses are always requested uncompressed.
+   * 
+   * @param enabled 
+   */
+  void setResponseCompression(boolean enabled);
+
+  /**
+   * @brief Enable per request phase timing
+   * While disabled no timing is taken and no memory is used, enabling
+   * allocates the histograms and starts measuring DNS and connect times
+   * by opening the connection before the request is sent.
+   * 
+   * @param enabled 
+   */
+  void enableMetrics(boolean enabled);
+
+  /**
+   * @brief Get the request metrics
+   * 
+   * @return const RequestMetrics* NULL while metrics are disabled
+   */
+  const RequestMetrics *getMetrics(void) const;
+
+  /**
+   * @brief Stores the current metrics as a new record
+   * Fields are named <operation>_<phase>_p50 and <operation>_<phase>_p99 in
+   * milliseconds plus <operation>_count and <operation>_errors, only
+   * operations with requests are included.
+   * 
+   * @param database Database Name
+   * @param layout Layout Name
+   * @return String Json with result or empty string when it fails
+   */
+  String uploadMetrics(const String &database, const String &layout);
+
+  /**
+   * @brief Enable retries with exponential backoff and the circuit breaker
+   * Applies to create, edit, delete, find and container uploads. Transient failures are
+   * retried when repeating the operation is safe, a create whose response
+   * was lost is not repeated. While the breaker is open requests fail
+   * without being sent, with HTTP_ERROR_CIRCUIT_OPEN as http code.
+   * 
+   * @param enabled 
+   */
+  void enableRetries(boolean enabled);
+
+  /**
+   * @brief Get the retry policy, to change its limits or read its counters
+   * 
+   * @return RetryPolicy* NULL while retries are disabled
+   */
+  RetryPolicy *getRetryPolicy(void);
+
+  /**
+   * @brief Sets the deadline and cancellation of the following requests
+   * Keep the token until the call returns and clear it afterwards. A
+   * cancelled request fails with HTTP_ERROR_CANCELLED as http code and
+   * closes the connection, requests not yet sent are not sent at all.
+   * 
+   * @param token Not owned by the client, NULL for none
+   */
+  void setCancellation(CancellationToken *token);
+
+  /**
+   * @brief Sets the dns cache, new connections go to the cached address
+   * The host name is still sent for SNI and the certificate is checked
+   * against it, pin an address in the cache to skip lookups altogether.
+   * The lookup time is reported as the dns phase of the request metrics.
+   * 
+   * @param cache Not owned by the client, share one between all clients; NULL to resolve on every connection
+   */
+  void setDnsCache(DnsCache *cache);
+
+  /**
+   * @brief Http code of the last request
+   * 
+   * @return int Http status code, a negative HTTPClient error, HTTP_ERROR_CIRCUIT_OPEN, HTTP_ERROR_CANCELLED or HTTP_ERROR_RATE_LIMITED
    */
-  String getToken(void);
+  int getLastHttpCode(void) const;
+
+  /**
+   * @brief Sets the rate limiter, requests wait for a token of their class before being sent
+   * The limiter is not owned by the client, share one between all clients
+   * of a host. A 429 or 503 response empties the bucket of the operation.
+   * A request that would wait more than RATE_LIMITER_MAX_WAIT fails without
+   * being sent, with HTTP_ERROR_RATE_LIMITED as http code.
+   * 
+   * @param limiter NULL to send without limits
+   */
+  void setRateLimiter(RateLimiter *limiter);
+
+  RateLimiter *getRateLimiter(void);
 
 private:
   String _cert;
   WiFiClientSecure _client;
   HTTPClient _https;
-  String _host;
+  InlineString<FMDATA_HOST_CAPACITY> _host;
   int _port;
-  String _id;
+  InlineString<FMDATA_ID_CAPACITY> _id;
+  boolean _compression;
+  boolean _keepAlive;
+  RequestMetrics *_metrics;
+  RetryPolicy *_retryPolicy;
+  RateLimiter *_rateLimiter;
+  int _lastHttpCode;
+  /** beginRequest() of the current attempt was refused by the rate limiter */
+  boolean _rateLimited;
+  CancellationToken *_cancellation;
+  DnsCache *_dnsCache;
+  RequestOperation _operation;
+  RequestTiming _timing;
+  unsigned long _requestStart;
+  unsigned long _phaseStart;
+  AdaptiveCapacity _logInCapacity;
   const DatabaseCredentials *_credentials;
   /**
    * @brief Authentication Token
@@ -602,16 +1158,7 @@ private:
    * specifies the token resets the session timeout counter to zero.)
    * @see https://fmhelp.filemaker.com/docs/17/en/dataapi/#connect-database
    */
-  String _token;
-
-  /**
-   * @brief Generated the payload to create new record
-   * 
-   * @param fields List of fields
-   * @param scripts Scripts to be executed
-   * @return String Filemaker response
-   */
-  static String generatePayload(vector<RecordField> fields, ScriptParameters *scripts = NULL);
+  InlineString<FMDATA_TOKEN_CAPACITY> _token;
 
   /**
    * @brief Generate Bearer token authorization
@@ -620,6 +1167,122 @@ private:
    * @return String 
   */
   static String generateAuth(const char *token);
+
+  /**
+   * @brief Starts a request, connection, common headers and timing
+   * 
+   * @param operation Operation, used for the metrics
+   * @param url Url path
+   * @return boolean false when the connection failed
+   */
+  boolean beginRequest(RequestOperation operation, const String &url);
+
+  /**
+   * @brief Ends the current request and records its timing
+   * 
+   * @param httpCode Http status code or HTTPClient error
+   * @param requestSize Request body size, for the trace
+   */
+  void endRequest(int httpCode, size_t requestSize = 0);
+
+  /**
+   * @brief Starts timing a request, no-op while metrics are disabled
+   * 
+   * @param operation 
+   */
+  void startTiming(RequestOperation operation);
+
+  /**
+   * @brief Ends a phase of the current request, the next phase starts now
+   * 
+   * @param phase 
+   */
+  void markPhase(RequestPhase phase);
+
+  /**
+   * @brief Ends the body phase and records the request
+   * 
+   * @param httpCode 
+   */
+  void finishTiming(int httpCode);
+
+  /**
+   * @brief Starts a find request, connection and headers
+   * 
+   * @param token Token
+   * @param database Database Name
+   * @param layout Layout Name
+   * @return boolean false when the connection failed
+   */
+  boolean beginFind(const char *token, const String &database, const String &layout);
+
+  /**
+   * @brief Deserializes the current response body, decoding chunked and compressed bodies
+   * 
+   * @param doc Destination document
+   * @return DeserializationError 
+   */
+  DeserializationError deserializeResponse(JsonDocument &doc);
+
+  /**
+   * @brief Scans the current response body for its status, decoding chunked and compressed bodies
+   * 
+   * @param status Destination
+   * @return boolean false when the body is not a valid Filemaker response
+   */
+  boolean scanResponse(ResponseStatus &status);
+
+  /**
+   * @brief Passes the current response body to a reader, decoding chunked and compressed bodies
+   * 
+   * @param reader Called with the body stream and its decoded length, -1 when it is not known
+   * @return boolean false when there is no body stream
+   */
+  boolean readResponseBody(std::function<void(Stream &, int)> reader);
+  boolean readResponseString(String &response);
+
+  /**
+   * @brief Request bodies shared by the overloads with a token and with the session token
+   * The session token is passed as the inline buffer, no String copy is made.
+   */
+  String sendCreateRecord(const char *token, const String &database, const String &layout, const RecordField *fields, size_t fieldCount, const ScriptParameters *scripts);
+  boolean sendCreateRecord(const char *token, const String &database, const String &layout, const RecordField *fields, size_t fieldCount, ResponseStatus &status, const ScriptParameters *scripts);
+  String sendEditRecord(const char *token, const String &database, const String &layout, const String &recordId, const RecordField *fields, size_t fieldCount);
+  boolean sendEditRecord(const char *token, const String &database, const String &layout, const String &recordId, const RecordField *fields, size_t fieldCount, ResponseStatus &status);
+  boolean sendDeleteRecord(const char *token, const String &database, const String &layout, const String &recordId);
+  String sendContainerData(const char *token, const String &database, const String &layout, const String &recordId, const String &fieldName, int repetition, Stream &contents, size_t length, const String &name, const String &type);
+  String sendFind(const char *token, const String &database, const String &layout, const vector<FindCriteria *> &findCriterias, int limit, int offset, SortCriteria *sortCriteria, const ScriptParameters *scripts);
+  boolean sendFind(const char *token, const String &database, const String &layout, const vector<FindCriteria *> &findCriterias, JsonDocument &response, int limit, int offset, SortCriteria *sortCriteria, const ScriptParameters *scripts);
+  /**
+   * @brief Sends a record request and scans the status of the response, retried as the retry policy allows
+   * 
+   * @param operation Timed operation
+   * @param method Http Method
+   * @param token Token
+   * @param url Request url
+   * @param payload Json body, NULL for none
+   * @param length Body length
+   * @param status Destination
+   * @return boolean true when Filemaker reported no error
+   */
+  boolean sendRecordRequest(RequestOperation operation, const char *method, const char *token, const String &url, const uint8_t *payload, size_t length, ResponseStatus &status);
+  /** A single attempt of sendRecordRequest() */
+  boolean sendRecordAttempt(RequestOperation operation, const char *method, const char *token, const String &url, const uint8_t *payload, size_t length, ResponseStatus &status);
+  boolean readStringResponse(ResponseStatus &status, size_t length, String &response);
+  boolean retryRequest(RequestOperation operation, ResponseStatus &status, std::function<boolean(ResponseStatus &)> attempt);
+  boolean runAttempt(ResponseStatus &status, std::function<boolean(ResponseStatus &)> &attempt);
+  boolean connect(const char *host, int port);
+  boolean checkDeadline(int &httpCode, size_t requestSize);
+  boolean isCancelled(void) const;
+  uint32_t getRemaining(void) const;
+  boolean pause(uint32_t milliseconds);
+  boolean waitForRateLimit(RequestOperation operation);
+
+  /**
+   * @brief Writes the create or edit payload into a document sized by getPayloadCapacity()
+   */
+  static void writePayload(JsonDocument &doc, const RecordField *fields, size_t fieldCount, const ScriptParameters *scripts);
+  static size_t getPayloadCapacity(size_t fieldCount, const ScriptParameters *scripts);
 };
 
 #endif
\ No newline at end of file
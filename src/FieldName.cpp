@@ -0,0 +1,135 @@
+/*
+  FieldName.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "FieldName.h"
+#include <mutex>
+#include <set>
+
+/**
+ * @brief Orders interned names by their text
+ */
+class NameOrder
+{
+public:
+  bool operator()(const char *a, const char *b) const
+  {
+    return strcmp(a, b) < 0;
+  }
+};
+
+/**
+ * @brief Interned names and the mutex guarding them
+ */
+class InternTable
+{
+public:
+  std::mutex mutex;
+  std::set<const char *, NameOrder> names;
+  size_t bytes = 0;
+};
+
+/**
+ * @brief The intern table, built on first use
+ * Global FieldName objects of other translation units intern their names
+ * during static initialization, possibly before a namespace scope table
+ * of this file was constructed.
+ */
+static InternTable &internTable(void)
+{
+  static InternTable table;
+  return table;
+}
+
+static const char *EMPTY_NAME = "";
+
+const char *FieldName::intern(const char *name)
+{
+  if (name == NULL || *name == '\0')
+    return EMPTY_NAME;
+  InternTable &table = internTable();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  auto existing = table.names.find(name);
+  if (existing != table.names.end())
+    return *existing;
+  size_t length = strlen(name) + 1;
+  char *copy = (char *)malloc(length);
+  if (copy == NULL)
+  {
+    log_e("No memory for field name: %s", name);
+    return EMPTY_NAME;
+  }
+  memcpy(copy, name, length);
+  table.names.insert(copy);
+  table.bytes += length;
+  return copy;
+}
+
+FieldName::FieldName(void)
+    : _name(EMPTY_NAME)
+{
+}
+
+FieldName::FieldName(const char *name)
+    : _name(FieldName::intern(name))
+{
+}
+
+FieldName::FieldName(const String &name)
+    : _name(FieldName::intern(name.c_str()))
+{
+}
+
+FieldName FieldName::fromStatic(const char *name)
+{
+  FieldName result;
+  if (name != NULL)
+    result._name = name;
+  return result;
+}
+
+const char *FieldName::c_str(void) const
+{
+  return this->_name;
+}
+
+size_t FieldName::length(void) const
+{
+  return strlen(this->_name);
+}
+
+boolean FieldName::operator==(const FieldName &other) const
+{
+  // Interned names are equal by pointer, static ones may hold the same text
+  return this->_name == other._name || strcmp(this->_name, other._name) == 0;
+}
+
+boolean FieldName::operator==(const char *other) const
+{
+  return other != NULL && strcmp(this->_name, other) == 0;
+}
+
+boolean FieldName::operator==(const String &other) const
+{
+  return strcmp(this->_name, other.c_str()) == 0;
+}
+
+boolean FieldName::operator!=(const FieldName &other) const
+{
+  return !(*this == other);
+}
+
+size_t FieldName::getInternedCount(void)
+{
+  InternTable &table = internTable();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  return table.names.size();
+}
+
+size_t FieldName::getInternedBytes(void)
+{
+  InternTable &table = internTable();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  return table.bytes;
+}
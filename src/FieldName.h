@@ -0,0 +1,53 @@
+/*
+  FieldName.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef FieldName_h
+#define FieldName_h
+
+#include <Arduino.h>
+
+/**
+ * @brief Interned field name, a pointer to a name stored once per process
+ * Names made from text are looked up in the intern table and copied into
+ * it the first time, every later field with the same name shares that
+ * copy. fromStatic() keeps a pointer to text that outlives every field,
+ * such as a string literal in flash, without copying it. Names are never
+ * freed, intern only the fixed set of names a device uses.
+ */
+class FieldName
+{
+public:
+  FieldName(void);
+  FieldName(const char *name);
+  FieldName(const String &name);
+
+  /**
+   * @brief A name kept by pointer, not copied
+   *
+   * @param name Text valid for the lifetime of the program
+   * @return FieldName
+   */
+  static FieldName fromStatic(const char *name);
+
+  const char *c_str(void) const;
+  size_t length(void) const;
+
+  boolean operator==(const FieldName &other) const;
+  boolean operator==(const char *other) const;
+  boolean operator==(const String &other) const;
+  boolean operator!=(const FieldName &other) const;
+
+  /** Number of names in the intern table */
+  static size_t getInternedCount(void);
+  /** Bytes of name text in the intern table */
+  static size_t getInternedBytes(void);
+
+private:
+  static const char *intern(const char *name);
+  const char *_name;
+};
+
+#endif
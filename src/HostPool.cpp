@@ -0,0 +1,231 @@
+/*
+  HostPool.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "HostPool.h"
+
+HostPool::HostPool(const DatabaseCredentials &credentials)
+    : _credentials(credentials),
+      _idleTime(HOST_POOL_IDLE_TIME)
+{
+  this->_hosts.reserve(HOST_POOL_MAX_HOSTS);
+}
+
+HostPool::~HostPool(void)
+{
+  for (Host &host : this->_hosts)
+  {
+    delete host.client;
+  }
+}
+
+boolean HostPool::addHost(const char *host, const char *cert, int port, boolean writable)
+{
+  if (this->_hosts.size() >= HOST_POOL_MAX_HOSTS)
+  {
+    log_e("Too many hosts");
+    return false;
+  }
+  Host entry;
+  entry.host = host;
+  entry.cert = cert;
+  entry.port = port;
+  entry.writable = writable;
+  // A client of its own per host, with the certificate of that host
+  entry.client = new FMDataClient(this->_credentials, entry.host, entry.cert, entry.port);
+  entry.latency = 0;
+  entry.failures = 0;
+  entry.downSince = 0;
+  entry.used = 0;
+  this->_hosts.push_back(entry);
+  return true;
+}
+
+boolean HostPool::begin(void)
+{
+  boolean connected = false;
+  for (Host &host : this->_hosts)
+  {
+    connected |= this->connect(host);
+  }
+  return connected;
+}
+
+/**
+ * @brief Opens the session of a host when it has none
+ */
+boolean HostPool::connect(Host &host)
+{
+  if (host.client->hasToken())
+    return true;
+  unsigned long start = millis();
+  boolean connected = host.client->logInToDatabaseSession() != EMPTY_STRING;
+  if (!connected)
+  {
+    log_e("Log in failed: %s", host.host);
+    // A host that refuses the log in is as useless as one that is down
+    host.failures = HOST_POOL_FAILURE_THRESHOLD - 1;
+  }
+  this->record(host, !connected, millis() - start);
+  return connected;
+}
+
+boolean HostPool::isAvailable(const Host &host) const
+{
+  return host.failures < HOST_POOL_FAILURE_THRESHOLD || millis() - host.downSince >= HOST_POOL_RETRY_TIME;
+}
+
+void HostPool::record(Host &host, boolean hostFailure, uint32_t duration)
+{
+  if (hostFailure)
+  {
+    if (host.failures < HOST_POOL_FAILURE_THRESHOLD)
+      host.failures++;
+    if (host.failures >= HOST_POOL_FAILURE_THRESHOLD)
+    {
+      log_w("Host out of rotation: %s", host.host);
+      // Also restarts the wait after a failed probe
+      host.downSince = millis();
+    }
+    return;
+  }
+  if (host.failures >= HOST_POOL_FAILURE_THRESHOLD)
+    log_d("Host back in rotation: %s", host.host);
+  host.failures = 0;
+  duration = max(duration, (uint32_t)1);
+  // After the idle time the history is stale, start over from this request
+  boolean idle = millis() - host.used >= this->_idleTime;
+  host.latency = host.latency == 0 || idle ? duration : host.latency + (((int32_t)duration - (int32_t)host.latency) >> HOST_POOL_SMOOTHING_SHIFT);
+  host.used = millis();
+}
+
+/**
+ * @brief Smoothed latency, halved for every idle time since the last request
+ */
+uint32_t HostPool::getLatency(const Host &host) const
+{
+  if (this->_idleTime == 0)
+    return 0;
+  unsigned long periods = (millis() - host.used) / this->_idleTime;
+  return periods >= 32 ? 0 : host.latency >> periods;
+}
+
+boolean HostPool::read(HostRequest request)
+{
+  uint32_t tried = 0;
+  for (;;)
+  {
+    Host *best = NULL;
+    for (uint8_t i = 0; i < this->_hosts.size(); i++)
+    {
+      Host &host = this->_hosts[i];
+      if ((tried & (1 << i)) == 0 && this->isAvailable(host) &&
+          (best == NULL || this->getLatency(host) < this->getLatency(*best)))
+        best = &host;
+    }
+    if (best == NULL)
+    {
+      log_e("No host available");
+      return false;
+    }
+    tried |= 1 << (best - this->_hosts.data());
+    if (!this->connect(*best))
+      continue;
+    unsigned long start = millis();
+    boolean ok = request(*best->client);
+    int httpCode = best->client->getLastHttpCode();
+    boolean hostFailure = !ok && RetryPolicy::isHostFailure(httpCode);
+    this->record(*best, hostFailure, millis() - start);
+    if (httpCode == HTTP_CODE_UNAUTHORIZED)
+      best->client->setToken(EMPTY_STRING);
+    if (!hostFailure)
+      return ok;
+    log_w("Read failed on %s, trying the next host", best->host);
+  }
+}
+
+boolean HostPool::write(RequestOperation operation, HostRequest request)
+{
+  for (Host &host : this->_hosts)
+  {
+    if (!host.writable || !this->isAvailable(host) || !this->connect(host))
+      continue;
+    unsigned long start = millis();
+    boolean ok = request(*host.client);
+    int httpCode = host.client->getLastHttpCode();
+    boolean hostFailure = !ok && RetryPolicy::isHostFailure(httpCode);
+    this->record(host, hostFailure, millis() - start);
+    if (httpCode == HTTP_CODE_UNAUTHORIZED)
+      host.client->setToken(EMPTY_STRING);
+    // Only move writes the failed host can not have applied
+    if (!hostFailure || !RetryPolicy::isRetryable(operation, httpCode, FileMakerError::UnknownFileMakerError))
+      return ok;
+    log_w("Write failed on %s, failing over", host.host);
+  }
+  log_e("No writable host available");
+  return false;
+}
+
+String HostPool::performFind(const String &database, const String &layout, const vector<FindCriteria *> &findCriterias, int limit, int offset, SortCriteria *sortCriteria, const ScriptParameters *scripts)
+{
+  String response;
+  this->read([&](FMDataClient &client) {
+    response = client.performFind(database, layout, findCriterias, limit, offset, sortCriteria, scripts);
+    return response != EMPTY_STRING;
+  });
+  return response;
+}
+
+boolean HostPool::performFind(const String &database, const String &layout, const vector<FindCriteria *> &findCriterias, JsonDocument &response, int limit, int offset, SortCriteria *sortCriteria, const ScriptParameters *scripts)
+{
+  return this->read([&](FMDataClient &client) {
+    return client.performFind(database, layout, findCriterias, response, limit, offset, sortCriteria, scripts);
+  });
+}
+
+boolean HostPool::createRecord(const String &database, const String &layout, const RecordField *fields, size_t fieldCount, ResponseStatus &status, const ScriptParameters *scripts)
+{
+  return this->write(RequestOperation::CreateRecordOperation, [&](FMDataClient &client) {
+    return client.createRecord(database, layout, fields, fieldCount, status, scripts);
+  });
+}
+
+boolean HostPool::editRecord(const String &database, const String &layout, const String &recordId, const RecordField *fields, size_t fieldCount, ResponseStatus &status)
+{
+  return this->write(RequestOperation::EditRecordOperation, [&](FMDataClient &client) {
+    return client.editRecord(database, layout, recordId, fields, fieldCount, status);
+  });
+}
+
+boolean HostPool::deleteRecord(const String &database, const String &layout, const String &recordId)
+{
+  return this->write(RequestOperation::DeleteRecordOperation, [&](FMDataClient &client) {
+    return client.deleteRecord(database, layout, recordId);
+  });
+}
+
+uint8_t HostPool::getHostCount(void) const
+{
+  return this->_hosts.size();
+}
+
+FMDataClient &HostPool::getClient(uint8_t index)
+{
+  return *this->_hosts[index].client;
+}
+
+void HostPool::setIdleTime(uint32_t milliseconds)
+{
+  this->_idleTime = milliseconds;
+}
+
+uint32_t HostPool::getLatency(uint8_t index) const
+{
+  return this->getLatency(this->_hosts[index]);
+}
+
+boolean HostPool::isHealthy(uint8_t index) const
+{
+  return this->_hosts[index].failures < HOST_POOL_FAILURE_THRESHOLD;
+}
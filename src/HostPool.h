@@ -0,0 +1,140 @@
+/*
+  HostPool.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef HostPool_h
+#define HostPool_h
+
+#include "FMDataClient.h"
+#include <functional>
+
+#define HOST_POOL_MAX_HOSTS 4
+/** Consecutive host failures that take a host out of rotation */
+#define HOST_POOL_FAILURE_THRESHOLD 3
+/** Milliseconds before a host out of rotation gets another request */
+#define HOST_POOL_RETRY_TIME 30000
+#define HOST_POOL_SMOOTHING_SHIFT 3
+/** Milliseconds without a request after which the latency of a host is halved */
+#define HOST_POOL_IDLE_TIME 10000
+
+/**
+ * @brief A primary host plus standbys or read replicas of the same database
+ * Every host has its own client and session. Reads go to the healthy host
+ * with the lowest smoothed latency, writes go to the first healthy writable
+ * host in the order the hosts were added. The latency of a host that gets
+ * no requests is halved every idle time, so a host that was slow once is
+ * tried again; the first request after the idle time replaces the smoothed
+ * latency with its own. A request that fails because of
+ * the host is repeated on the next one; a create is only moved when it was
+ * not sent, so a lost response never creates the record twice.
+ */
+class HostPool
+{
+public:
+  /**
+   * @brief Construct a new Host Pool object
+   *
+   * @param credentials Database Credentials, the same for every host
+   */
+  HostPool(const DatabaseCredentials &credentials);
+  ~HostPool(void);
+
+  /**
+   * @brief Adds a host, the first one added is the primary
+   *
+   * @param host Host address, kept by pointer
+   * @param cert Root Certificate, kept by pointer
+   * @param port Connection Port
+   * @param writable false for read only replicas
+   * @return boolean false when HOST_POOL_MAX_HOSTS hosts were added
+   */
+  boolean addHost(const char *host, const char *cert, int port, boolean writable = true);
+
+  /**
+   * @brief Logs in to every host, hosts that fail are taken out of rotation
+   *
+   * @return boolean true when at least one host has a session
+   */
+  boolean begin(void);
+
+  /**
+   * @brief Finds records on the fastest healthy host
+   *
+   * @return String Json with result or empty string when it fails on every host
+   */
+  String performFind(const String &database, const String &layout, const vector<FindCriteria *> &findCriterias, int limit = 100, int offset = 0, SortCriteria *sortCriteria = NULL, const ScriptParameters *scripts = NULL);
+
+  /**
+   * @brief Finds records on the fastest healthy host, into a document
+   *
+   * @return boolean
+   */
+  boolean performFind(const String &database, const String &layout, const vector<FindCriteria *> &findCriterias, JsonDocument &response, int limit = 100, int offset = 0, SortCriteria *sortCriteria = NULL, const ScriptParameters *scripts = NULL);
+
+  boolean createRecord(const String &database, const String &layout, const RecordField *fields, size_t fieldCount, ResponseStatus &status, const ScriptParameters *scripts = NULL);
+  boolean editRecord(const String &database, const String &layout, const String &recordId, const RecordField *fields, size_t fieldCount, ResponseStatus &status);
+  boolean deleteRecord(const String &database, const String &layout, const String &recordId);
+
+  uint8_t getHostCount(void) const;
+
+  /**
+   * @brief Sets the time without requests after which the latency of a host is halved
+   *
+   * @param milliseconds
+   */
+  void setIdleTime(uint32_t milliseconds);
+
+  /**
+   * @brief A host's client, to configure it before begin()
+   *
+   * @param index 0 to getHostCount() - 1
+   * @return FMDataClient&
+   */
+  FMDataClient &getClient(uint8_t index);
+
+  /**
+   * @brief Smoothed latency of a host, halved for every idle time without requests
+   *
+   * @param index 0 to getHostCount() - 1
+   * @return uint32_t Milliseconds, 0 before the first request
+   */
+  uint32_t getLatency(uint8_t index) const;
+
+  /**
+   * @brief Whether a host is in rotation
+   *
+   * @param index 0 to getHostCount() - 1
+   * @return boolean
+   */
+  boolean isHealthy(uint8_t index) const;
+
+private:
+  class Host
+  {
+  public:
+    const char *host;
+    const char *cert;
+    int port;
+    boolean writable;
+    FMDataClient *client;
+    uint32_t latency;
+    uint8_t failures;
+    unsigned long downSince;
+    /** millis() of the last successful request */
+    unsigned long used;
+  };
+  typedef std::function<boolean(FMDataClient &client)> HostRequest;
+  boolean isAvailable(const Host &host) const;
+  uint32_t getLatency(const Host &host) const;
+  boolean connect(Host &host);
+  void record(Host &host, boolean hostFailure, uint32_t duration);
+  boolean read(HostRequest request);
+  boolean write(RequestOperation operation, HostRequest request);
+  const DatabaseCredentials &_credentials;
+  vector<Host> _hosts;
+  uint32_t _idleTime;
+};
+
+#endif
@@ -0,0 +1,213 @@
+/*
+  InlineString.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef InlineString_h
+#define InlineString_h
+
+#include <Arduino.h>
+#include <utility>
+
+/**
+ * @brief String stored inside the object up to Capacity - 1 characters
+ * Identifiers and short values live in the object itself, so they do not
+ * take a heap block of their own. Longer text falls back to one heap
+ * block of exactly the needed size. Use toString() where an Arduino
+ * String is required, it makes a temporary copy.
+ *
+ * @tparam Capacity Inline buffer size, including the terminating zero
+ */
+template <size_t Capacity>
+class InlineString
+{
+public:
+  InlineString(void)
+      : _heap(NULL),
+        _length(0)
+  {
+    this->_buffer[0] = '\0';
+  }
+
+  InlineString(const char *text)
+      : InlineString()
+  {
+    this->assign(text, text != NULL ? strlen(text) : 0);
+  }
+
+  InlineString(const char *text, size_t length)
+      : InlineString()
+  {
+    this->assign(text, length);
+  }
+
+  InlineString(const String &text)
+      : InlineString()
+  {
+    this->assign(text.c_str(), text.length());
+  }
+
+  /**
+   * @brief Formats an integer like String(int) does
+   */
+  explicit InlineString(int value)
+      : InlineString()
+  {
+    char text[12];
+    itoa(value, text, 10);
+    this->assign(text, strlen(text));
+  }
+
+  /**
+   * @brief Formats a float with two decimals like String(float) does
+   */
+  explicit InlineString(float value)
+      : InlineString()
+  {
+    char text[33];
+    dtostrf(value, 4, 2, text);
+    this->assign(text, strlen(text));
+  }
+
+  InlineString(const InlineString &other)
+      : InlineString()
+  {
+    this->assign(other.c_str(), other._length);
+  }
+
+  InlineString(InlineString &&other)
+      : InlineString()
+  {
+    this->swap(other);
+  }
+
+  ~InlineString(void)
+  {
+    free(this->_heap);
+  }
+
+  InlineString &operator=(const InlineString &other)
+  {
+    if (this != &other)
+      this->assign(other.c_str(), other._length);
+    return *this;
+  }
+
+  InlineString &operator=(InlineString &&other)
+  {
+    this->swap(other);
+    return *this;
+  }
+
+  InlineString &operator=(const char *text)
+  {
+    this->assign(text, text != NULL ? strlen(text) : 0);
+    return *this;
+  }
+
+  InlineString &operator=(const String &text)
+  {
+    this->assign(text.c_str(), text.length());
+    return *this;
+  }
+
+  const char *c_str(void) const
+  {
+    return this->_heap != NULL ? this->_heap : this->_buffer;
+  }
+
+  size_t length(void) const
+  {
+    return this->_length;
+  }
+
+  boolean isEmpty(void) const
+  {
+    return this->_length == 0;
+  }
+
+  /**
+   * @brief True while the text fits the inline buffer
+   */
+  boolean isInline(void) const
+  {
+    return this->_heap == NULL;
+  }
+
+  String toString(void) const
+  {
+    return String(this->c_str());
+  }
+
+  /**
+   * @brief Compares like String does, an empty string equals NULL
+   */
+  boolean operator==(const char *other) const
+  {
+    if (other == NULL)
+      return this->_length == 0;
+    return strcmp(this->c_str(), other) == 0;
+  }
+
+  boolean operator==(const String &other) const
+  {
+    return this->_length == other.length() && memcmp(this->c_str(), other.c_str(), this->_length) == 0;
+  }
+
+  boolean operator!=(const char *other) const
+  {
+    return !(*this == other);
+  }
+
+  boolean operator!=(const String &other) const
+  {
+    return !(*this == other);
+  }
+
+private:
+  void assign(const char *text, size_t length)
+  {
+    char *heap = NULL;
+    if (length >= Capacity)
+    {
+      heap = (char *)malloc(length + 1);
+      if (heap == NULL)
+      {
+        log_e("No memory for %u characters", length);
+        length = 0;
+      }
+      else
+      {
+        memcpy(heap, text, length);
+        heap[length] = '\0';
+      }
+    }
+    if (heap == NULL)
+    {
+      // text may point into this object when it is assigned to itself
+      if (length > 0)
+        memmove(this->_buffer, text, length);
+      this->_buffer[length] = '\0';
+    }
+    free(this->_heap);
+    this->_heap = heap;
+    this->_length = length;
+  }
+
+  void swap(InlineString &other)
+  {
+    char buffer[Capacity];
+    memcpy(buffer, this->_buffer, Capacity);
+    memcpy(this->_buffer, other._buffer, Capacity);
+    memcpy(other._buffer, buffer, Capacity);
+    std::swap(this->_heap, other._heap);
+    std::swap(this->_length, other._length);
+  }
+
+  char _buffer[Capacity];
+  char *_heap;
+  size_t _length;
+};
+
+#endif
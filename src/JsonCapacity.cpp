@@ -0,0 +1,53 @@
+/*
+  JsonCapacity.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "JsonCapacity.h"
+
+AdaptiveCapacity::AdaptiveCapacity(size_t initial, size_t maximum)
+    : _capacity(initial),
+      _maximum(maximum)
+{
+}
+
+size_t AdaptiveCapacity::get(void) const
+{
+  return this->_capacity;
+}
+
+boolean AdaptiveCapacity::grow(void)
+{
+  if (this->_capacity >= this->_maximum)
+    return false;
+  this->_capacity = min(this->_capacity * 2, this->_maximum);
+  log_d("Json capacity grown to: %u", this->_capacity);
+  return true;
+}
+
+void AdaptiveCapacity::learn(size_t used)
+{
+  size_t target = used + used / 4;
+  target = (target + JSON_CAPACITY_ALIGNMENT - 1) & ~(size_t)(JSON_CAPACITY_ALIGNMENT - 1);
+  if (target > this->_capacity)
+    this->_capacity = min(target, this->_maximum);
+  else if (target < this->_capacity / 2)
+    this->_capacity -= (this->_capacity - target) / 4;
+}
+
+DeserializationError AdaptiveCapacity::deserialize(const String &input, std::function<void(JsonDocument &)> callback)
+{
+  for (;;)
+  {
+    DynamicJsonDocument doc(this->_capacity);
+    DeserializationError error = deserializeJson(doc, input);
+    if (error == DeserializationError::NoMemory && this->grow())
+      continue;
+    if (!error)
+    {
+      this->learn(doc.memoryUsage());
+      callback(doc);
+    }
+    return error;
+  }
+}
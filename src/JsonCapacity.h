@@ -0,0 +1,72 @@
+/*
+  JsonCapacity.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef JsonCapacity_h
+#define JsonCapacity_h
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <functional>
+
+#define JSON_CAPACITY_MAXIMUM 32768
+#define JSON_CAPACITY_ALIGNMENT 32
+
+/**
+ * @brief Capacity of the documents a kind of response is parsed into
+ * Response sizes can not be known before parsing, the capacity starts from
+ * an estimate, doubles and retries when a document runs out of memory and
+ * then follows the memory actually used, with 25% headroom, shrinking
+ * slowly when responses get smaller.
+ */
+class AdaptiveCapacity
+{
+public:
+  /**
+   * @brief Construct a new Adaptive Capacity object
+   *
+   * @param initial Initial estimate in bytes
+   * @param maximum Upper limit in bytes
+   */
+  AdaptiveCapacity(size_t initial, size_t maximum = JSON_CAPACITY_MAXIMUM);
+
+  /**
+   * @brief Current capacity
+   *
+   * @return size_t Bytes
+   */
+  size_t get(void) const;
+
+  /**
+   * @brief Doubles the capacity after a document ran out of memory
+   *
+   * @return boolean false when the maximum was already reached
+   */
+  boolean grow(void);
+
+  /**
+   * @brief Adapts the capacity to the memory used by a parsed document
+   *
+   * @param used JsonDocument::memoryUsage()
+   */
+  void learn(size_t used);
+
+  /**
+   * @brief Parses input into a document of the learned capacity
+   * Retries with a larger document instead of returning NoMemory, the document
+   * is only valid inside the callback.
+   *
+   * @param input Json text
+   * @param callback Called with the parsed document on success
+   * @return DeserializationError
+   */
+  DeserializationError deserialize(const String &input, std::function<void(JsonDocument &)> callback);
+
+private:
+  size_t _capacity;
+  size_t _maximum;
+};
+
+#endif
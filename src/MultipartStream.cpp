@@ -0,0 +1,183 @@
+/*
+  MultipartStream.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "MultipartStream.h"
+
+BufferStream::BufferStream(const uint8_t *buffer, size_t length)
+    : _buffer(buffer),
+      _length(length),
+      _position(0)
+{
+}
+
+int BufferStream::available(void)
+{
+  return this->_length - this->_position;
+}
+
+int BufferStream::read(void)
+{
+  if (this->_position >= this->_length)
+    return -1;
+  return this->_buffer[this->_position++];
+}
+
+int BufferStream::peek(void)
+{
+  if (this->_position >= this->_length)
+    return -1;
+  return this->_buffer[this->_position];
+}
+
+size_t BufferStream::readBytes(char *buffer, size_t length)
+{
+  size_t count = this->_length - this->_position;
+  if (count > length)
+    count = length;
+  memcpy(buffer, this->_buffer + this->_position, count);
+  this->_position += count;
+  return count;
+}
+
+size_t BufferStream::write(uint8_t data)
+{
+  return 0;
+}
+
+void BufferStream::flush(void)
+{
+}
+
+/**
+ * @brief Construct a new Multipart Stream object
+ *
+ * @param boundary Boundary, without the leading "--"
+ * @param disposition Content-Disposition header value of the part
+ * @param type Content type of the part
+ * @param contents Contents source
+ * @param length Number of bytes to read from contents
+ */
+MultipartStream::MultipartStream(const String &boundary, const String &disposition, const String &type, Stream &contents, size_t length)
+    : _contents(contents),
+      _length(length),
+      _position(0)
+{
+  this->_preamble.reserve(boundary.length() + disposition.length() + type.length() + 64);
+  this->_preamble += MULTIPART_DELIMITER;
+  this->_preamble += boundary;
+  this->_preamble += MULTIPART_CRLF "Content-Disposition: ";
+  this->_preamble += disposition;
+  this->_preamble += MULTIPART_CRLF "Content-Type: ";
+  this->_preamble += type;
+  this->_preamble += MULTIPART_CRLF MULTIPART_CRLF;
+  this->_epilogue.reserve(boundary.length() + 8);
+  this->_epilogue += MULTIPART_CRLF MULTIPART_DELIMITER;
+  this->_epilogue += boundary;
+  this->_epilogue += MULTIPART_DELIMITER MULTIPART_CRLF;
+}
+
+size_t MultipartStream::size(void) const
+{
+  return this->_preamble.length() + this->_length + this->_epilogue.length();
+}
+
+size_t MultipartStream::getContentsRead(void) const
+{
+  size_t preambleEnd = this->_preamble.length();
+  if (this->_position <= preambleEnd)
+    return 0;
+  return min(this->_position - preambleEnd, this->_length);
+}
+
+/**
+ * @brief Number of bytes that can be read without waiting on the contents stream
+ *
+ * @return int
+ */
+int MultipartStream::available(void)
+{
+  size_t preambleEnd = this->_preamble.length();
+  size_t contentsEnd = preambleEnd + this->_length;
+  size_t count = 0;
+  if (this->_position < preambleEnd)
+    count += preambleEnd - this->_position;
+  if (this->_position < contentsEnd)
+  {
+    size_t remaining = contentsEnd - max(this->_position, preambleEnd);
+    int ready = this->_contents.available();
+    if (ready < 0 || (size_t)ready < remaining)
+      return count + (ready > 0 ? ready : 0);
+    count += remaining;
+  }
+  return count + this->size() - max(this->_position, contentsEnd);
+}
+
+int MultipartStream::read(void)
+{
+  char c;
+  return this->readBytes(&c, 1) == 1 ? (uint8_t)c : -1;
+}
+
+int MultipartStream::peek(void)
+{
+  size_t preambleEnd = this->_preamble.length();
+  size_t contentsEnd = preambleEnd + this->_length;
+  if (this->_position < preambleEnd)
+    return (uint8_t)this->_preamble[this->_position];
+  if (this->_position < contentsEnd)
+    return this->_contents.peek();
+  if (this->_position < this->size())
+    return (uint8_t)this->_epilogue[this->_position - contentsEnd];
+  return -1;
+}
+
+/**
+ * @brief Copies the next bytes of the preamble, contents and epilogue
+ *
+ * @param buffer Destination
+ * @param length Maximum number of bytes to copy
+ * @return size_t Number of bytes copied
+ */
+size_t MultipartStream::readBytes(char *buffer, size_t length)
+{
+  size_t preambleEnd = this->_preamble.length();
+  size_t contentsEnd = preambleEnd + this->_length;
+  size_t total = 0;
+  while (total < length && this->_position < this->size())
+  {
+    size_t count;
+    if (this->_position < preambleEnd)
+    {
+      count = min(length - total, preambleEnd - this->_position);
+      memcpy(buffer + total, this->_preamble.c_str() + this->_position, count);
+    }
+    else if (this->_position < contentsEnd)
+    {
+      count = this->_contents.readBytes(buffer + total, min(length - total, contentsEnd - this->_position));
+      if (count == 0)
+      {
+        log_e("Contents ended %d bytes early", contentsEnd - this->_position);
+        break;
+      }
+    }
+    else
+    {
+      count = min(length - total, this->size() - this->_position);
+      memcpy(buffer + total, this->_epilogue.c_str() + this->_position - contentsEnd, count);
+    }
+    this->_position += count;
+    total += count;
+  }
+  return total;
+}
+
+size_t MultipartStream::write(uint8_t data)
+{
+  return 0;
+}
+
+void MultipartStream::flush(void)
+{
+}
@@ -0,0 +1,92 @@
+/*
+  MultipartStream.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef MultipartStream_h
+#define MultipartStream_h
+
+#include <Arduino.h>
+
+#define MULTIPART_DELIMITER "--"
+#define MULTIPART_CRLF "\r\n"
+
+/**
+ * @brief Read only stream over a memory buffer
+ * The buffer is not copied, it must outlive the stream.
+ */
+class BufferStream : public Stream
+{
+public:
+  /**
+   * @brief Construct a new Buffer Stream object
+   *
+   * @param buffer Data, may contain NUL bytes
+   * @param length Number of bytes in the buffer
+   */
+  BufferStream(const uint8_t *buffer, size_t length);
+  int available(void);
+  int read(void);
+  int peek(void);
+  size_t readBytes(char *buffer, size_t length);
+  size_t write(uint8_t data);
+  void flush(void);
+
+private:
+  const uint8_t *_buffer;
+  size_t _length;
+  size_t _position;
+};
+
+/**
+ * @brief A single part multipart/form-data body streamed from another stream
+ * Only the part headers and the closing boundary are kept in memory, the
+ * contents are pulled from the source stream as the HTTP client consumes them,
+ * so the memory used is independent of the contents size.
+ * @see https://tools.ietf.org/html/rfc7578
+ */
+class MultipartStream : public Stream
+{
+public:
+  /**
+   * @brief Construct a new Multipart Stream object
+   *
+   * @param boundary Boundary, without the leading "--"
+   * @param disposition Content-Disposition header value of the part
+   * @param type Content type of the part
+   * @param contents Contents source
+   * @param length Number of bytes to read from contents
+   */
+  MultipartStream(const String &boundary, const String &disposition, const String &type, Stream &contents, size_t length);
+
+  /**
+   * @brief Total number of bytes of the body, used as Content-Length
+   *
+   * @return size_t
+   */
+  size_t size(void) const;
+
+  /**
+   * @brief Number of bytes read from the contents stream so far
+   *
+   * @return size_t
+   */
+  size_t getContentsRead(void) const;
+
+  int available(void);
+  int read(void);
+  int peek(void);
+  size_t readBytes(char *buffer, size_t length);
+  size_t write(uint8_t data);
+  void flush(void);
+
+private:
+  String _preamble;
+  String _epilogue;
+  Stream &_contents;
+  size_t _length;
+  size_t _position;
+};
+
+#endif
@@ -0,0 +1,125 @@
+/*
+  RateLimiter.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "RateLimiter.h"
+
+RateLimiter::TokenBucket::TokenBucket(void)
+    : rate(0),
+      burst(1),
+      tokens(1),
+      updated(0)
+{
+}
+
+void RateLimiter::TokenBucket::refill(unsigned long now)
+{
+  this->tokens = min(this->burst, this->tokens + (now - this->updated) * this->rate / 1000);
+  this->updated = now;
+}
+
+RateLimiter::RateLimiter(void)
+{
+}
+
+void RateLimiter::setLimit(RateClass rateClass, float rate, float burst)
+{
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  TokenBucket &bucket = this->_buckets[rateClass];
+  bucket.rate = max(rate, 0.0f);
+  bucket.burst = max(burst, 1.0f);
+  bucket.tokens = bucket.burst;
+  bucket.updated = millis();
+}
+
+RateClass RateLimiter::getClass(RequestOperation operation)
+{
+  switch (operation)
+  {
+  case RequestOperation::LogInOperation:
+  case RequestOperation::LogOutOperation:
+    return RateClass::SessionRate;
+  case RequestOperation::FindOperation:
+  case RequestOperation::DownloadContainerOperation:
+    return RateClass::ReadRate;
+  default:
+    return RateClass::WriteRate;
+  }
+}
+
+uint32_t RateLimiter::reserve(RequestOperation operation)
+{
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  TokenBucket &bucket = this->_buckets[RateLimiter::getClass(operation)];
+  if (bucket.rate <= 0)
+    return 0;
+  bucket.refill(millis());
+  if (bucket.tokens >= 1)
+  {
+    bucket.tokens -= 1;
+    return 0;
+  }
+  // The token is taken from the future, later requests queue behind it
+  float wait = (1 - bucket.tokens) * 1000 / bucket.rate;
+  if (wait > RATE_LIMITER_MAX_WAIT)
+    return RATE_LIMITER_REFUSED;
+  bucket.tokens -= 1;
+  return max((uint32_t)wait, (uint32_t)1);
+}
+
+void RateLimiter::release(RequestOperation operation)
+{
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  TokenBucket &bucket = this->_buckets[RateLimiter::getClass(operation)];
+  if (bucket.rate <= 0)
+    return;
+  bucket.refill(millis());
+  bucket.tokens = min(bucket.burst, bucket.tokens + 1);
+}
+
+boolean RateLimiter::acquire(RequestOperation operation)
+{
+  uint32_t wait = this->reserve(operation);
+  if (wait == RATE_LIMITER_REFUSED)
+  {
+    log_e("Rate limited, more than %d ms of requests waiting", RATE_LIMITER_MAX_WAIT);
+    return false;
+  }
+  if (wait > 0)
+  {
+    log_d("Rate limited, waiting %u ms", wait);
+    delay(wait);
+  }
+  return true;
+}
+
+void RateLimiter::throttle(RequestOperation operation)
+{
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  TokenBucket &bucket = this->_buckets[RateLimiter::getClass(operation)];
+  if (bucket.rate <= 0)
+    return;
+  bucket.refill(millis());
+  bucket.tokens = min(bucket.tokens, 0.0f);
+}
+
+float RateLimiter::getFill(RateClass rateClass)
+{
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  TokenBucket &bucket = this->_buckets[rateClass];
+  if (bucket.rate <= 0)
+    return 1;
+  bucket.refill(millis());
+  return bucket.tokens / bucket.burst;
+}
+
+uint32_t RateLimiter::getWait(RateClass rateClass)
+{
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  TokenBucket &bucket = this->_buckets[rateClass];
+  if (bucket.rate <= 0)
+    return 0;
+  bucket.refill(millis());
+  return bucket.tokens >= 1 ? 0 : (uint32_t)((1 - bucket.tokens) * 1000 / bucket.rate);
+}
@@ -0,0 +1,123 @@
+/*
+  RateLimiter.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef RateLimiter_h
+#define RateLimiter_h
+
+#include <Arduino.h>
+#include <mutex>
+#include "RequestMetrics.h"
+
+/** Longest a request waits for its turn, in milliseconds */
+#define RATE_LIMITER_MAX_WAIT 60000
+/** reserve() result for a request that would wait longer than RATE_LIMITER_MAX_WAIT */
+#define RATE_LIMITER_REFUSED UINT32_MAX
+/** Http code reported for a request the rate limiter refused */
+#define HTTP_ERROR_RATE_LIMITED -102
+
+/**
+ * @brief Operation class, each class has its own bucket
+ */
+enum RateClass
+{
+  /** find, get records, container download */
+  ReadRate,
+  /** create, edit, delete, container upload */
+  WriteRate,
+  /** log in and log out */
+  SessionRate,
+  RateClassCount
+};
+
+/**
+ * @brief Token bucket rate limits per operation class
+ * A request takes a token from the bucket of its class, the bucket refills
+ * at the configured rate up to the burst size. When the bucket is empty the
+ * request waits for its token instead of failing, requests arriving
+ * together reserve consecutive tokens so they leave evenly spaced. A
+ * request that would wait longer than RATE_LIMITER_MAX_WAIT is refused
+ * without taking a token, so the backlog stays bounded.
+ * Share one limiter between all clients talking to the same host, it is
+ * safe to use from several tasks. Classes without a limit never wait.
+ */
+class RateLimiter
+{
+public:
+  RateLimiter(void);
+
+  /**
+   * @brief Sets the limit of a class
+   *
+   * @param rateClass
+   * @param rate Requests per second, 0 for no limit
+   * @param burst Requests that may be sent at once after an idle period
+   */
+  void setLimit(RateClass rateClass, float rate, float burst = 1);
+
+  /**
+   * @brief Reserves a token for a request
+   *
+   * @param operation
+   * @return uint32_t Milliseconds the request has to wait for its token, RATE_LIMITER_REFUSED when no token was taken
+   */
+  uint32_t reserve(RequestOperation operation);
+
+  /**
+   * @brief Gives back a reserved token of a request that was not sent
+   *
+   * @param operation
+   */
+  void release(RequestOperation operation);
+
+  /**
+   * @brief Reserves a token and waits for it
+   *
+   * @param operation
+   * @return boolean false when the request was refused
+   */
+  boolean acquire(RequestOperation operation);
+
+  /**
+   * @brief Empties the bucket of a class after the server said it is overloaded
+   *
+   * @param operation
+   */
+  void throttle(RequestOperation operation);
+
+  /**
+   * @brief Fill level of a class
+   *
+   * @param rateClass
+   * @return float 1 when full, 0 when empty, negative while requests wait for tokens
+   */
+  float getFill(RateClass rateClass);
+
+  /**
+   * @brief Time until a request of a class could be sent without waiting
+   *
+   * @param rateClass
+   * @return uint32_t Milliseconds
+   */
+  uint32_t getWait(RateClass rateClass);
+
+  static RateClass getClass(RequestOperation operation);
+
+private:
+  class TokenBucket
+  {
+  public:
+    TokenBucket(void);
+    void refill(unsigned long now);
+    float rate;
+    float burst;
+    float tokens;
+    unsigned long updated;
+  };
+  TokenBucket _buckets[RateClassCount];
+  std::mutex _mutex;
+};
+
+#endif
@@ -0,0 +1,380 @@
+/*
+  RecordCodec.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "RecordCodec.h"
+
+#define CODEC_INLINE_NAME 63
+#define CODEC_ID_MASK 0x3F
+#define CODEC_KIND_SHIFT 6
+
+/**
+ * @brief Kind of an encoded value, the top two bits of the field byte
+ */
+enum CodecKind
+{
+  TextKind,
+  IntegerKind,
+  NumberTextKind,
+  TypedTextKind
+};
+
+static void writeVarint(vector<uint8_t> &output, uint32_t value)
+{
+  while (value >= 0x80)
+  {
+    output.push_back((value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  output.push_back(value);
+}
+
+static boolean readVarint(const uint8_t *&data, const uint8_t *end, uint32_t &value)
+{
+  value = 0;
+  for (uint8_t shift = 0; shift < 35 && data < end; shift += 7)
+  {
+    uint8_t byte = *data++;
+    value |= (uint32_t)(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0)
+      return true;
+  }
+  return false;
+}
+
+static void writeText(vector<uint8_t> &output, const char *text, size_t length)
+{
+  writeVarint(output, length);
+  output.insert(output.end(), text, text + length);
+}
+
+static boolean readText(const uint8_t *&data, const uint8_t *end, const char *&text, uint32_t &length)
+{
+  if (!readVarint(data, end, length) || length > (uint32_t)(end - data))
+    return false;
+  text = (const char *)data;
+  data += length;
+  return true;
+}
+
+/**
+ * @brief Whether a number field holds an integer that survives a round trip
+ */
+static boolean toInteger(const char *value, size_t length, int32_t &integer)
+{
+  if (length == 0 || length > 11)
+    return false;
+  char *end;
+  long parsed = strtol(value, &end, 10);
+  if (*end != '\0' || parsed < INT32_MIN || parsed > INT32_MAX)
+    return false;
+  integer = parsed;
+  // Leading zeros or a plus sign would not come back
+  return String(integer) == value;
+}
+
+RecordCodec::RecordCodec(void)
+{
+}
+
+RecordCodec::RecordCodec(const vector<RecordField> &schema)
+{
+  for (const RecordField &field : schema)
+  {
+    this->addName(field.fieldName);
+  }
+}
+
+int RecordCodec::getId(const FieldName &fieldName) const
+{
+  for (size_t id = 0; id < this->_names.size(); id++)
+  {
+    if (this->_names[id] == fieldName)
+      return id;
+  }
+  return -1;
+}
+
+int RecordCodec::addName(const FieldName &fieldName)
+{
+  int id = this->getId(fieldName);
+  if (id >= 0)
+    return id;
+  if (this->_names.size() >= CODEC_MAX_NAMES)
+    return -1;
+  this->_names.push_back(fieldName);
+  return this->_names.size() - 1;
+}
+
+size_t RecordCodec::encode(const RecordField *fields, size_t fieldCount, vector<uint8_t> &output) const
+{
+  size_t start = output.size();
+  writeVarint(output, fieldCount);
+  for (size_t i = 0; i < fieldCount; i++)
+  {
+    const RecordField &field = fields[i];
+    int id = this->getId(field.fieldName);
+    int32_t integer;
+    CodecKind kind = CodecKind::TextKind;
+    if (field.fieldType == FieldTypes::Number)
+      kind = toInteger(field.fieldValue.c_str(), field.fieldValue.length(), integer) ? CodecKind::IntegerKind : CodecKind::NumberTextKind;
+    else if (field.fieldType != FieldTypes::Text)
+      kind = CodecKind::TypedTextKind;
+    output.push_back((kind << CODEC_KIND_SHIFT) | (id >= 0 ? id : CODEC_INLINE_NAME));
+    if (id < 0)
+      writeText(output, field.fieldName.c_str(), field.fieldName.length());
+    switch (kind)
+    {
+    case CodecKind::IntegerKind:
+      writeVarint(output, ((uint32_t)integer << 1) ^ (uint32_t)(integer >> 31));
+      break;
+    case CodecKind::TypedTextKind:
+      output.push_back(field.fieldType);
+      writeText(output, field.fieldValue.c_str(), field.fieldValue.length());
+      break;
+    default:
+      writeText(output, field.fieldValue.c_str(), field.fieldValue.length());
+      break;
+    }
+  }
+  return output.size() - start;
+}
+
+/**
+ * @brief Walks the fields of an encoded record
+ *
+ * @param visit Called with name, kind, type, text and integer of every field
+ * @return boolean false when the data is not a valid record
+ */
+template <typename Visitor>
+static boolean walk(const vector<FieldName> &names, const uint8_t *data, size_t length, Visitor visit)
+{
+  const uint8_t *end = data + length;
+  uint32_t count;
+  if (!readVarint(data, end, count))
+    return false;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    if (data >= end)
+      return false;
+    uint8_t header = *data++;
+    uint8_t id = header & CODEC_ID_MASK;
+    CodecKind kind = (CodecKind)(header >> CODEC_KIND_SHIFT);
+    const char *name;
+    uint32_t nameLength;
+    const FieldName *known = NULL;
+    if (id == CODEC_INLINE_NAME)
+    {
+      if (!readText(data, end, name, nameLength))
+        return false;
+    }
+    else if (id < names.size())
+    {
+      known = &names[id];
+      name = known->c_str();
+      nameLength = known->length();
+    }
+    else
+    {
+      return false;
+    }
+    FieldTypes type = kind == CodecKind::TextKind ? FieldTypes::Text : FieldTypes::Number;
+    const char *text = NULL;
+    uint32_t textLength = 0;
+    int32_t integer = 0;
+    if (kind == CodecKind::IntegerKind)
+    {
+      uint32_t zigzag;
+      if (!readVarint(data, end, zigzag))
+        return false;
+      integer = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+    }
+    else
+    {
+      if (kind == CodecKind::TypedTextKind)
+      {
+        if (data >= end)
+          return false;
+        type = (FieldTypes)*data++;
+      }
+      if (!readText(data, end, text, textLength))
+        return false;
+    }
+    if (!visit(known, name, nameLength, kind, type, text, textLength, integer))
+      return false;
+  }
+  return data == end;
+}
+
+static String toString(const char *text, uint32_t length)
+{
+  String value;
+  value.reserve(length);
+  for (uint32_t i = 0; i < length; i++)
+    value += text[i];
+  return value;
+}
+
+boolean RecordCodec::decode(const uint8_t *data, size_t length, vector<RecordField> &fields) const
+{
+  return walk(this->_names, data, length, [&fields](const FieldName *known, const char *name, uint32_t nameLength, CodecKind kind, FieldTypes type, const char *text, uint32_t textLength, int32_t integer) {
+    // Dictionary names are already interned, only inline names are looked up
+    FieldName fieldName = known != NULL ? *known : FieldName(toString(name, nameLength));
+    if (kind == CodecKind::IntegerKind)
+      fields.push_back(RecordField(fieldName, (int)integer));
+    else
+      fields.push_back(RecordField(fieldName, RecordFieldValue(text, textLength), type));
+    return true;
+  });
+}
+
+/**
+ * @brief Appends to a fixed buffer, remembering when it did not fit
+ * Without a buffer it only counts the characters.
+ */
+class PayloadWriter
+{
+public:
+  PayloadWriter(char *buffer, size_t size) : buffer(buffer), size(size), length(0) {}
+  char *buffer;
+  size_t size;
+  size_t length;
+  boolean put(char c)
+  {
+    if (this->buffer == NULL)
+    {
+      this->length++;
+      return true;
+    }
+    if (this->length + 1 >= this->size)
+      return false;
+    this->buffer[this->length++] = c;
+    return true;
+  }
+  boolean put(const char *text)
+  {
+    while (*text)
+    {
+      if (!this->put(*text++))
+        return false;
+    }
+    return true;
+  }
+  /**
+   * @brief Writes a JSON string escaped like ArduinoJson does, other control characters are kept
+   */
+  boolean quoted(const char *text, uint32_t length)
+  {
+    if (!this->put('"'))
+      return false;
+    for (uint32_t i = 0; i < length; i++)
+    {
+      char c = text[i];
+      boolean ok;
+      switch (c)
+      {
+      case '"':
+        ok = this->put("\\\"");
+        break;
+      case '\\':
+        ok = this->put("\\\\");
+        break;
+      case '\n':
+        ok = this->put("\\n");
+        break;
+      case '\r':
+        ok = this->put("\\r");
+        break;
+      case '\t':
+        ok = this->put("\\t");
+        break;
+      case '\b':
+        ok = this->put("\\b");
+        break;
+      case '\f':
+        ok = this->put("\\f");
+        break;
+      default:
+        ok = this->put(c);
+        break;
+      }
+      if (!ok)
+        return false;
+    }
+    return this->put('"');
+  }
+};
+
+/**
+ * @brief Writes the payload of an encoded record
+ *
+ * @param names Registered field names
+ * @param data Encoded record
+ * @param length Bytes
+ * @param writer Destination
+ * @return boolean false when it did not fit or the data is not valid
+ */
+static boolean writePayload(const vector<FieldName> &names, const uint8_t *data, size_t length, PayloadWriter &writer)
+{
+  boolean first = true;
+  if (!writer.put("{\"" PARAMETER_FIELD_DATA "\":{"))
+    return false;
+  boolean valid = walk(names, data, length, [&writer, &first](const FieldName *known, const char *name, uint32_t nameLength, CodecKind kind, FieldTypes type, const char *text, uint32_t textLength, int32_t integer) {
+    if (!first && !writer.put(','))
+      return false;
+    first = false;
+    if (!writer.quoted(name, nameLength) || !writer.put(':'))
+      return false;
+    if (type == FieldTypes::Number)
+    {
+      // Number fields are sent as integers, like generatePayload() does
+      if (kind != CodecKind::IntegerKind)
+        integer = atoi(toString(text, textLength).c_str());
+      return writer.put(String(integer).c_str());
+    }
+    return writer.quoted(text, textLength);
+  });
+  return valid && writer.put("}}");
+}
+
+size_t RecordCodec::toPayload(const uint8_t *data, size_t length, char *buffer, size_t size) const
+{
+  PayloadWriter writer(buffer, size);
+  if (buffer == NULL || !writePayload(this->_names, data, length, writer))
+    return 0;
+  buffer[writer.length] = '\0';
+  return writer.length;
+}
+
+size_t RecordCodec::measurePayload(const uint8_t *data, size_t length) const
+{
+  PayloadWriter writer(NULL, 0);
+  return writePayload(this->_names, data, length, writer) ? writer.length : 0;
+}
+
+boolean RecordCodec::merge(vector<uint8_t> &record, const vector<uint8_t> &update) const
+{
+  vector<RecordField> fields;
+  vector<RecordField> changes;
+  if (!this->decode(record.data(), record.size(), fields) || !this->decode(update.data(), update.size(), changes))
+    return false;
+  for (RecordField &change : changes)
+  {
+    boolean replaced = false;
+    for (RecordField &field : fields)
+    {
+      if (field.fieldName == change.fieldName)
+      {
+        field = std::move(change);
+        replaced = true;
+        break;
+      }
+    }
+    if (!replaced)
+      fields.push_back(std::move(change));
+  }
+  record.clear();
+  this->encode(fields.data(), fields.size(), record);
+  return true;
+}
@@ -0,0 +1,99 @@
+/*
+  RecordCodec.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef RecordCodec_h
+#define RecordCodec_h
+
+#include "FMDataClient.h"
+
+/** Field names with an id, further names are stored in every record */
+#define CODEC_MAX_NAMES 63
+
+/**
+ * @brief Compact binary encoding of record fields
+ * A record is a varint field count followed by the fields. A field starts
+ * with one byte, the top two bits give the kind of value and the low six
+ * bits the name id; id 63 means the name follows as text. Text is a varint
+ * length and the bytes, integer numbers are zigzag varints, other field
+ * types store the type in one byte before the text. Register the field
+ * names before encoding, the dictionary is not changed by encoding and
+ * one codec can be used by several tasks.
+ */
+class RecordCodec
+{
+public:
+  RecordCodec(void);
+
+  /**
+   * @brief Construct a new Record Codec object with the names of a field list
+   *
+   * @param schema Fields, only the names are used
+   */
+  RecordCodec(const vector<RecordField> &schema);
+
+  /**
+   * @brief Registers a field name
+   *
+   * @param fieldName
+   * @return int Id of the name, -1 when CODEC_MAX_NAMES names are registered
+   */
+  int addName(const FieldName &fieldName);
+
+  /**
+   * @brief Appends an encoded record
+   *
+   * @param fields Fields
+   * @param fieldCount Number of fields
+   * @param output Destination, appended to
+   * @return size_t Bytes appended
+   */
+  size_t encode(const RecordField *fields, size_t fieldCount, vector<uint8_t> &output) const;
+
+  /**
+   * @brief Decodes a record back into fields
+   *
+   * @param data Encoded record
+   * @param length Bytes
+   * @param fields Destination, appended to
+   * @return boolean false when the data is not a valid record
+   */
+  boolean decode(const uint8_t *data, size_t length, vector<RecordField> &fields) const;
+
+  /**
+   * @brief Writes the create or edit payload of an encoded record, as FMDataClient::generatePayload() would
+   *
+   * @param data Encoded record
+   * @param length Bytes
+   * @param buffer Destination
+   * @param size Buffer size
+   * @return size_t Payload length without the terminating zero, 0 when it does not fit or the data is not valid
+   */
+  size_t toPayload(const uint8_t *data, size_t length, char *buffer, size_t size) const;
+
+  /**
+   * @brief Length of the payload toPayload() writes, the buffer needs one more byte
+   *
+   * @param data Encoded record
+   * @param length Bytes
+   * @return size_t Payload length without the terminating zero, 0 when the data is not valid
+   */
+  size_t measurePayload(const uint8_t *data, size_t length) const;
+
+  /**
+   * @brief Merges fields into an encoded record, values of the update replace existing ones
+   *
+   * @param record Encoded record, replaced by the merged record
+   * @param update Encoded record
+   * @return boolean false when either is not a valid record
+   */
+  boolean merge(vector<uint8_t> &record, const vector<uint8_t> &update) const;
+
+private:
+  int getId(const FieldName &fieldName) const;
+  vector<FieldName> _names;
+};
+
+#endif
@@ -0,0 +1,468 @@
+/*
+  RecordPipeline.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "RecordPipeline.h"
+#include <chrono>
+
+#ifdef ESP_PLATFORM
+
+PipelineRequest::PipelineRequest(void)
+    : operation(RequestOperation::CreateRecordOperation),
+      size(0),
+      queued(0)
+{
+}
+
+PipelineBuffer::PipelineBuffer(void)
+    : operation(RequestOperation::CreateRecordOperation),
+      length(0),
+      data(NULL),
+      queued(0)
+{
+}
+
+PipelineStatistics::PipelineStatistics(void)
+    : depth(0),
+      bytesPending(0),
+      oldestAge(0),
+      drainRate(0),
+      dropped(0)
+{
+}
+
+RecordPipeline::RecordPipeline(FMDataClient &client, const String &database, const String &layout)
+    : _client(client),
+      _database(database),
+      _layout(layout),
+      _queueSize(PIPELINE_QUEUE_SIZE),
+      _policy(OverflowPolicy::DropNewestOverflow),
+      _bytes(0),
+      _dropped(0),
+      _drainRate(0),
+      _drained(0),
+      _drainStart(0),
+      _batching(false),
+      _producer(NULL),
+      _network(NULL),
+      _running(false),
+      _tasks(0),
+      _pending(0)
+{
+}
+
+RecordPipeline::~RecordPipeline(void)
+{
+  this->end();
+  for (uint8_t i = 0; i < PIPELINE_DEPTH; i++)
+  {
+    free(this->_buffers[i].data);
+  }
+}
+
+boolean RecordPipeline::begin(void)
+{
+  if (this->_running)
+    return true;
+  for (uint8_t i = 0; i < PIPELINE_DEPTH; i++)
+  {
+    if (this->_buffers[i].data == NULL)
+      this->_buffers[i].data = (char *)malloc(PIPELINE_BUFFER_SIZE);
+    if (this->_buffers[i].data == NULL)
+    {
+      log_e("Pipeline buffers: out of memory");
+      return false;
+    }
+  }
+  uint8_t index;
+  while (this->_free.pop(index))
+    ;
+  for (uint8_t i = 0; i < PIPELINE_DEPTH; i++)
+  {
+    this->_free.push(i);
+  }
+  if (this->_batching)
+    this->_client.setKeepAlive(true);
+  this->_drainStart = millis();
+  this->_running = true;
+  this->_tasks = 2;
+  if (xTaskCreatePinnedToCore(RecordPipeline::transmit, "fmdata-net", PIPELINE_TASK_STACK_SIZE, this,
+                              PIPELINE_TASK_PRIORITY, &this->_network, PIPELINE_NETWORK_CORE) != pdPASS)
+  {
+    this->_running = false;
+    this->_tasks = 0;
+    return false;
+  }
+  if (xTaskCreatePinnedToCore(RecordPipeline::produce, "fmdata-gen", PIPELINE_TASK_STACK_SIZE, this,
+                              PIPELINE_TASK_PRIORITY, &this->_producer, PIPELINE_PRODUCER_CORE) != pdPASS)
+  {
+    this->_tasks = 1;
+    this->end();
+    return false;
+  }
+  return true;
+}
+
+void RecordPipeline::end(void)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    this->_running = false;
+  }
+  this->_space.notify_all();
+  while (this->_tasks > 0)
+  {
+    this->wake(this->_producer);
+    this->wake(this->_network);
+    vTaskDelay(1);
+  }
+}
+
+boolean RecordPipeline::createRecord(vector<RecordField> fields)
+{
+  EnqueueResult result = this->enqueue(String(EMPTY_STRING), std::move(fields));
+  return result == EnqueueResult::QueuedResult || result == EnqueueResult::CoalescedResult ||
+         result == EnqueueResult::DroppedOldestResult;
+}
+
+boolean RecordPipeline::editRecord(String recordId, vector<RecordField> fields)
+{
+  EnqueueResult result = this->enqueue(std::move(recordId), std::move(fields));
+  return result == EnqueueResult::QueuedResult || result == EnqueueResult::CoalescedResult ||
+         result == EnqueueResult::DroppedOldestResult;
+}
+
+EnqueueResult RecordPipeline::enqueue(String recordId, vector<RecordField> fields, uint32_t timeout)
+{
+  PipelineRequest request;
+  request.operation = recordId.isEmpty() ? RequestOperation::CreateRecordOperation : RequestOperation::EditRecordOperation;
+  request.recordId = std::move(recordId);
+  request.size = this->_codec.encode(fields.data(), fields.size(), request.record);
+  fields.clear();
+  if (!this->fits(request.record))
+  {
+    log_w("Pipeline: the payload of the record does not fit into %d bytes", PIPELINE_BUFFER_SIZE);
+    return EnqueueResult::TooLargeResult;
+  }
+  request.queued = millis();
+  EnqueueResult result = EnqueueResult::QueuedResult;
+  {
+    std::unique_lock<std::mutex> lock(this->_mutex);
+    if (timeout > 0)
+    {
+      this->_space.wait_for(lock, std::chrono::milliseconds(timeout), [this] {
+        return this->_requests.size() < this->_queueSize || !this->_running;
+      });
+    }
+    if (!this->_running)
+      return EnqueueResult::StoppedResult;
+    if (this->_requests.size() >= this->_queueSize)
+    {
+      if (this->_policy == OverflowPolicy::CoalesceOverflow && this->coalesce(request))
+        return EnqueueResult::CoalescedResult;
+      if (this->_policy != OverflowPolicy::DropOldestOverflow)
+        return EnqueueResult::WouldBlockResult;
+      this->_bytes -= this->_requests.front().size;
+      this->_requests.pop_front();
+      this->_pending--;
+      this->_dropped++;
+      result = EnqueueResult::DroppedOldestResult;
+    }
+    this->_bytes += request.size;
+    this->_requests.push_back(std::move(request));
+    this->_pending++;
+  }
+  this->wake(this->_producer);
+  return result;
+}
+
+/**
+ * @brief Whether the payload of an encoded record fits into a pipeline buffer
+ *
+ * @param record Encoded record
+ * @return boolean false when it does not fit or is not valid
+ */
+boolean RecordPipeline::fits(const vector<uint8_t> &record) const
+{
+  size_t length = this->_codec.measurePayload(record.data(), record.size());
+  return length > 0 && length < PIPELINE_BUFFER_SIZE;
+}
+
+/**
+ * @brief Merges an edit into the newest queued edit of the same record,
+ * fields of the new edit replace queued values
+ *
+ * @param request New edit
+ * @return boolean false when there is no queued edit of the record or the merged payload would not fit
+ */
+boolean RecordPipeline::coalesce(PipelineRequest &request)
+{
+  if (request.operation != RequestOperation::EditRecordOperation)
+    return false;
+  for (auto queued = this->_requests.rbegin(); queued != this->_requests.rend(); queued++)
+  {
+    if (queued->operation != RequestOperation::EditRecordOperation || queued->recordId != request.recordId)
+      continue;
+    vector<uint8_t> merged(queued->record);
+    if (!this->_codec.merge(merged, request.record) || !this->fits(merged))
+      return false;
+    queued->record = std::move(merged);
+    this->_bytes -= queued->size;
+    queued->size = queued->record.size();
+    this->_bytes += queued->size;
+    return true;
+  }
+  return false;
+}
+
+void RecordPipeline::setQueueSize(size_t size)
+{
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_queueSize = max(size, (size_t)1);
+}
+
+void RecordPipeline::setOverflowPolicy(OverflowPolicy policy)
+{
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_policy = policy;
+}
+
+PipelineStatistics RecordPipeline::getStatistics(void)
+{
+  PipelineStatistics statistics;
+  unsigned long now = millis();
+  unsigned long oldest = now;
+  for (uint8_t i = 0; i < PIPELINE_DEPTH; i++)
+  {
+    unsigned long queued = this->_buffers[i].queued;
+    if (queued != 0 && now - queued > now - oldest)
+      oldest = queued;
+  }
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  if (!this->_requests.empty() && now - this->_requests.front().queued > now - oldest)
+    oldest = this->_requests.front().queued;
+  statistics.depth = this->_pending;
+  statistics.bytesPending = this->_bytes;
+  statistics.oldestAge = now - oldest;
+  statistics.drainRate = this->_drainRate;
+  statistics.dropped = this->_dropped;
+  return statistics;
+}
+
+void RecordPipeline::setBatching(boolean enabled)
+{
+  this->_batching = enabled;
+}
+
+RecordCodec &RecordPipeline::getCodec(void)
+{
+  return this->_codec;
+}
+
+BatchController &RecordPipeline::getBatchController(void)
+{
+  return this->_batch;
+}
+
+void RecordPipeline::onComplete(PipelineCallback callback)
+{
+  this->_callback = callback;
+}
+
+size_t RecordPipeline::getPending(void) const
+{
+  return this->_pending;
+}
+
+/**
+ * @brief Takes the oldest queued request
+ *
+ * @param request Destination
+ * @return int 1 with a request, 0 when the queue is empty, -1 when it is empty and the pipeline stopped
+ */
+int RecordPipeline::takeRequest(PipelineRequest &request)
+{
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  if (this->_requests.empty())
+    return this->_running ? 0 : -1;
+  request = std::move(this->_requests.front());
+  this->_requests.pop_front();
+  this->_space.notify_one();
+  return 1;
+}
+
+/**
+ * @brief Accounts a finished write, the drain rate is updated once per second
+ *
+ * @param length Bytes of the sent payload
+ */
+void RecordPipeline::finished(size_t length)
+{
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_bytes -= min(length, this->_bytes);
+  this->_pending--;
+  this->_drained++;
+  unsigned long elapsed = millis() - this->_drainStart;
+  if (elapsed >= 1000)
+  {
+    this->_drainRate = (this->_drainRate + this->_drained * 1000.0f / elapsed) / 2;
+    this->_drained = 0;
+    this->_drainStart += elapsed;
+  }
+}
+
+/**
+ * @brief Producer task, generates payloads into free buffers
+ * After end() the queued requests are still generated, so nothing is lost.
+ */
+void RecordPipeline::produce(void *parameter)
+{
+  RecordPipeline *pipeline = (RecordPipeline *)parameter;
+  PipelineRequest request;
+  uint8_t index;
+  int taken;
+  while ((taken = pipeline->takeRequest(request)) >= 0)
+  {
+    if (taken == 0)
+    {
+      ulTaskNotifyTake(pdTRUE, PIPELINE_IDLE_TICKS);
+      continue;
+    }
+    while (!pipeline->_free.pop(index))
+    {
+      ulTaskNotifyTake(pdTRUE, PIPELINE_IDLE_TICKS);
+    }
+    PipelineBuffer &buffer = pipeline->_buffers[index];
+    buffer.operation = request.operation;
+    buffer.recordId = std::move(request.recordId);
+    buffer.length = pipeline->_codec.toPayload(request.record.data(), request.record.size(),
+                                               buffer.data, PIPELINE_BUFFER_SIZE);
+    buffer.queued = request.queued;
+    request.record.clear();
+    {
+      std::lock_guard<std::mutex> lock(pipeline->_mutex);
+      pipeline->_bytes += buffer.length;
+      pipeline->_bytes -= min(request.size, pipeline->_bytes);
+    }
+    pipeline->_ready.push(index);
+    pipeline->wake(pipeline->_network);
+  }
+  pipeline->exit(pipeline->_producer);
+}
+
+/**
+ * @brief Network task, sends the generated payloads and returns the buffers
+ * With batching it waits until a batch is complete or its oldest write
+ * reached the flush interval.
+ */
+void RecordPipeline::transmit(void *parameter)
+{
+  RecordPipeline *pipeline = (RecordPipeline *)parameter;
+  uint8_t index;
+  for (;;)
+  {
+    size_t ready = pipeline->_ready.size();
+    if (ready == 0)
+    {
+      if (!pipeline->_running && pipeline->_pending == 0)
+        break;
+      ulTaskNotifyTake(pdTRUE, PIPELINE_IDLE_TICKS);
+      continue;
+    }
+    uint16_t batch = 1;
+    if (pipeline->_batching)
+    {
+      batch = min(pipeline->_batch.getBatchSize(), (uint16_t)PIPELINE_DEPTH);
+      pipeline->_ready.front(index);
+      unsigned long age = millis() - pipeline->_buffers[index].queued;
+      uint32_t interval = pipeline->_batch.getFlushInterval();
+      if (pipeline->_running && ready < batch && age < interval)
+      {
+        TickType_t wait = pdMS_TO_TICKS(interval - age);
+        ulTaskNotifyTake(pdTRUE, wait > 0 ? wait : 1);
+        continue;
+      }
+    }
+    unsigned long start = millis();
+    uint16_t sent = 0;
+    uint16_t errors = 0;
+    size_t bytes = 0;
+    while (sent < batch && pipeline->_ready.pop(index))
+    {
+      bytes += pipeline->_buffers[index].length;
+      if (!pipeline->send(index))
+        errors++;
+      sent++;
+    }
+    if (pipeline->_batching)
+      pipeline->_batch.record(sent, errors, millis() - start, bytes);
+  }
+  pipeline->exit(pipeline->_network);
+}
+
+/**
+ * @brief Sends a generated payload and returns its buffer
+ *
+ * @param index Buffer
+ * @return boolean false when the write failed
+ */
+boolean RecordPipeline::send(uint8_t index)
+{
+  PipelineBuffer &buffer = this->_buffers[index];
+  ResponseStatus status;
+  if (buffer.length == 0)
+  {
+    status.httpCode = HTTPC_ERROR_TOO_LESS_RAM;
+  }
+  else if (buffer.operation == RequestOperation::EditRecordOperation)
+  {
+    this->_client.editRecord(this->_database, this->_layout, buffer.recordId,
+                             (const uint8_t *)buffer.data, buffer.length, status);
+  }
+  else
+  {
+    this->_client.createRecord(this->_database, this->_layout,
+                               (const uint8_t *)buffer.data, buffer.length, status);
+  }
+  if (this->_callback)
+    this->_callback(buffer.operation, buffer.recordId, status);
+  buffer.recordId = EMPTY_STRING;
+  buffer.queued = 0;
+  this->finished(buffer.length);
+  this->_free.push(index);
+  this->wake(this->_producer);
+  return status.isOk();
+}
+
+/**
+ * @brief Notifies a task unless it already exited
+ *
+ * @param task _producer or _network
+ */
+void RecordPipeline::wake(TaskHandle_t &task)
+{
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  if (task != NULL)
+    xTaskNotifyGive(task);
+}
+
+/**
+ * @brief Ends the calling pipeline task
+ * The handle is cleared under the mutex first, so wake() never notifies
+ * a deleted task. The pipeline is not touched once _tasks dropped, end()
+ * may return and the pipeline be destroyed from then on.
+ *
+ * @param task Handle of the calling task
+ */
+void RecordPipeline::exit(TaskHandle_t &task)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    task = NULL;
+  }
+  this->_tasks--;
+  vTaskDelete(NULL);
+}
+
+#endif
@@ -0,0 +1,280 @@
+/*
+  RecordPipeline.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef RecordPipeline_h
+#define RecordPipeline_h
+
+#include "FMDataClient.h"
+#include "SpscQueue.h"
+#include "BatchController.h"
+#include "RecordCodec.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+// The pipeline pins its tasks to the two ESP32 cores
+#ifdef ESP_PLATFORM
+
+#define PIPELINE_DEPTH 8
+#define PIPELINE_QUEUE_SIZE 32
+#define PIPELINE_BUFFER_SIZE 1024
+#define PIPELINE_PRODUCER_CORE 1
+#define PIPELINE_NETWORK_CORE 0
+#define PIPELINE_TASK_STACK_SIZE 8192
+#define PIPELINE_TASK_PRIORITY 1
+#define PIPELINE_IDLE_TICKS pdMS_TO_TICKS(100)
+
+/**
+ * @brief A record write waiting for its payload
+ */
+class PipelineRequest
+{
+public:
+  PipelineRequest(void);
+  RequestOperation operation;
+  /** Record to edit, empty to create a record */
+  String recordId;
+  /** Fields encoded by the pipeline's RecordCodec */
+  vector<uint8_t> record;
+  /** Encoded size */
+  size_t size;
+  /** millis() when it was queued */
+  unsigned long queued;
+};
+
+/**
+ * @brief A generated payload waiting to be sent
+ */
+class PipelineBuffer
+{
+public:
+  PipelineBuffer(void);
+  RequestOperation operation;
+  String recordId;
+  /** Payload length, 0 when it did not fit */
+  size_t length;
+  char *data;
+  /** millis() when the request was queued, 0 while the buffer is free */
+  std::atomic<unsigned long> queued;
+};
+
+/**
+ * @brief What to do with a write when the queue is full
+ */
+enum OverflowPolicy
+{
+  /** Refuse the new write */
+  DropNewestOverflow,
+  /** Drop the oldest queued write to make room */
+  DropOldestOverflow,
+  /** Merge an edit into a queued edit of the same record, refuse other writes and merges that would not fit */
+  CoalesceOverflow
+};
+
+/**
+ * @brief Outcome of queuing a write
+ */
+enum EnqueueResult
+{
+  QueuedResult,
+  /** Merged into a queued edit of the same record */
+  CoalescedResult,
+  /** Queued after dropping the oldest queued write */
+  DroppedOldestResult,
+  /** The queue stayed full until the timeout */
+  WouldBlockResult,
+  /** The payload of the record would not fit into PIPELINE_BUFFER_SIZE */
+  TooLargeResult,
+  /** The pipeline is not running */
+  StoppedResult
+};
+
+/**
+ * @brief Backlog of a pipeline, for producers to adapt their rate
+ */
+class PipelineStatistics
+{
+public:
+  PipelineStatistics(void);
+  /** Writes queued or in flight */
+  size_t depth;
+  /** Encoded bytes queued plus payload bytes in flight */
+  size_t bytesPending;
+  /** Age of the oldest write queued or in flight in milliseconds */
+  unsigned long oldestAge;
+  /** Writes finished per second, smoothed */
+  float drainRate;
+  /** Writes dropped by the overflow policy */
+  uint32_t dropped;
+};
+
+/**
+ * @brief Called on the network task when a write finished
+ */
+typedef std::function<void(RequestOperation operation, const String &recordId, const ResponseStatus &status)> PipelineCallback;
+
+/**
+ * @brief Writes records with payload generation and network I/O on separate cores
+ * A producer task on PIPELINE_PRODUCER_CORE generates the payloads into
+ * PIPELINE_DEPTH preallocated buffers, a network task on PIPELINE_NETWORK_CORE
+ * sends them with the client, so payloads are generated while the previous
+ * request waits for the server. Buffers are handed over through lock free
+ * queues. Writes wait in a bounded queue that any task may add to, when it
+ * is full the overflow policy applies. With batching enabled the network
+ * task collects generated payloads and sends them back to back over the
+ * kept alive connection, batch size and flush interval follow the
+ * BatchController.
+ */
+class RecordPipeline
+{
+public:
+  /**
+   * @brief Construct a new Record Pipeline object
+   *
+   * @param client Logged in client, only used by the network task while running
+   * @param database Database Name
+   * @param layout Layout Name
+   */
+  RecordPipeline(FMDataClient &client, const String &database, const String &layout);
+  ~RecordPipeline(void);
+
+  /**
+   * @brief Allocates the buffers and starts the tasks
+   *
+   * @return boolean false when out of memory
+   */
+  boolean begin(void);
+
+  /**
+   * @brief Sends the queued writes and stops the tasks
+   */
+  void end(void);
+
+  /**
+   * @brief Queues a record creation
+   *
+   * @param fields Moved into the queue
+   * @return boolean false when the write was refused
+   */
+  boolean createRecord(vector<RecordField> fields);
+
+  /**
+   * @brief Queues a record edit
+   *
+   * @param recordId Record Id
+   * @param fields Moved into the queue
+   * @return boolean false when the write was refused
+   */
+  boolean editRecord(String recordId, vector<RecordField> fields);
+
+  /**
+   * @brief Queues a write, waiting for room when the queue is full
+   * A write whose payload does not fit into a pipeline buffer is refused,
+   * send it with the client instead.
+   *
+   * @param recordId Record to edit, empty to create a record
+   * @param fields Moved into the queue
+   * @param timeout Milliseconds to wait for room before the overflow policy applies, 0 not to wait
+   * @return EnqueueResult
+   */
+  EnqueueResult enqueue(String recordId, vector<RecordField> fields, uint32_t timeout = 0);
+
+  /**
+   * @brief Codec queued writes are stored with, register the field names before begin()
+   * Queued writes are kept in binary and only turned into json when their
+   * payload is generated, names not registered are stored in every write.
+   *
+   * @return RecordCodec&
+   */
+  RecordCodec &getCodec(void);
+
+  /**
+   * @brief Sets the number of writes waiting for a buffer
+   *
+   * @param size Queue size
+   */
+  void setQueueSize(size_t size);
+
+  void setOverflowPolicy(OverflowPolicy policy);
+
+  /**
+   * @brief Current backlog
+   *
+   * @return PipelineStatistics
+   */
+  PipelineStatistics getStatistics(void);
+
+  /**
+   * @brief Collect writes into batches sized by the batch controller
+   *
+   * @param enabled
+   */
+  void setBatching(boolean enabled);
+
+  /**
+   * @brief The batch controller, to set its bounds and latency target before begin()
+   * Batches are limited to PIPELINE_DEPTH writes.
+   *
+   * @return BatchController&
+   */
+  BatchController &getBatchController(void);
+
+  /**
+   * @brief Sets the function called with the result of each write
+   *
+   * @param callback
+   */
+  void onComplete(PipelineCallback callback);
+
+  /**
+   * @brief Number of writes queued or in flight
+   *
+   * @return size_t
+   */
+  size_t getPending(void) const;
+
+private:
+  static void produce(void *parameter);
+  static void transmit(void *parameter);
+  int takeRequest(PipelineRequest &request);
+  boolean fits(const vector<uint8_t> &record) const;
+  boolean coalesce(PipelineRequest &request);
+  void finished(size_t length);
+  boolean send(uint8_t index);
+  void wake(TaskHandle_t &task);
+  void exit(TaskHandle_t &task);
+  FMDataClient &_client;
+  String _database;
+  String _layout;
+  PipelineCallback _callback;
+  PipelineBuffer _buffers[PIPELINE_DEPTH];
+  std::deque<PipelineRequest> _requests;
+  size_t _queueSize;
+  OverflowPolicy _policy;
+  size_t _bytes;
+  uint32_t _dropped;
+  float _drainRate;
+  uint16_t _drained;
+  unsigned long _drainStart;
+  boolean _batching;
+  BatchController _batch;
+  RecordCodec _codec;
+  std::mutex _mutex;
+  std::condition_variable _space;
+  SpscQueue<uint8_t, PIPELINE_DEPTH + 1> _free;
+  SpscQueue<uint8_t, PIPELINE_DEPTH + 1> _ready;
+  /** Task handles, guarded by _mutex, NULL once the task exited */
+  TaskHandle_t _producer;
+  TaskHandle_t _network;
+  std::atomic<boolean> _running;
+  std::atomic<uint8_t> _tasks;
+  std::atomic<size_t> _pending;
+};
+
+#endif
+
+#endif
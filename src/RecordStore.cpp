@@ -0,0 +1,528 @@
+/*
+  RecordStore.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "RecordStore.h"
+#include <algorithm>
+#include <iterator>
+
+static const String NO_VALUE;
+
+const String &StoredRecord::getValue(const String &fieldName) const
+{
+  for (size_t field = 0; field < this->_values.size(); field++)
+  {
+    if ((*this->_names)[field] == fieldName)
+      return this->_values[field];
+  }
+  return NO_VALUE;
+}
+
+RecordStore::RecordStore(size_t maxRecords)
+    : _maxRecords(maxRecords),
+      _complete(false),
+      _hits(0),
+      _misses(0)
+{
+}
+
+int RecordStore::fieldOf(const String &fieldName) const
+{
+  for (size_t field = 0; field < this->_names.size(); field++)
+  {
+    if (this->_names[field] == fieldName)
+      return field;
+  }
+  return -1;
+}
+
+int RecordStore::addField(const String &fieldName)
+{
+  int field = this->fieldOf(fieldName);
+  if (field >= 0)
+    return field;
+  this->_names.push_back(fieldName);
+  return this->_names.size() - 1;
+}
+
+void RecordStore::addIndex(const String &fieldName)
+{
+  int field = this->addField(fieldName);
+  if (this->_indexes.count(field) > 0)
+    return;
+  FieldIndex &index = this->_indexes[field];
+  for (auto &entry : this->_records)
+  {
+    const StoredRecord &record = entry.second;
+    if ((size_t)field >= record._values.size())
+      continue;
+    const String &value = record._values[field];
+    index.text.insert(std::make_pair(foldCase(value), record.recordId));
+    double number;
+    if (toNumber(value, number))
+      index.numbers.insert(std::make_pair(number, record.recordId));
+  }
+}
+
+/**
+ * @brief Text index key of a value, letters compare without case as in FileMaker
+ *
+ * @param value
+ * @return String Lower case value
+ */
+String RecordStore::foldCase(const String &value)
+{
+  String folded(value);
+  folded.toLowerCase();
+  return folded;
+}
+
+/**
+ * @brief Whether a value only holds ASCII characters
+ * The case of other characters is not folded, criteria holding them go to the server.
+ */
+boolean RecordStore::isAscii(const String &value)
+{
+  for (size_t i = 0; i < value.length(); i++)
+  {
+    if ((uint8_t)value[i] >= 0x80)
+      return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Parses a whole value as a number
+ */
+boolean RecordStore::toNumber(const String &value, double &number)
+{
+  if (value.length() == 0)
+    return false;
+  char *end;
+  number = strtod(value.c_str(), &end);
+  return *end == '\0';
+}
+
+template <typename K>
+static void eraseEntry(std::multimap<K, uint32_t> &map, const K &key, uint32_t recordId)
+{
+  auto range = map.equal_range(key);
+  for (auto entry = range.first; entry != range.second; ++entry)
+  {
+    if (entry->second == recordId)
+    {
+      map.erase(entry);
+      return;
+    }
+  }
+}
+
+void RecordStore::indexRecord(const StoredRecord &record, boolean add)
+{
+  for (auto &entry : this->_indexes)
+  {
+    if ((size_t)entry.first >= record._values.size())
+      continue;
+    const String &value = record._values[entry.first];
+    double number;
+    boolean numeric = toNumber(value, number);
+    if (add)
+    {
+      entry.second.text.insert(std::make_pair(foldCase(value), record.recordId));
+      if (numeric)
+        entry.second.numbers.insert(std::make_pair(number, record.recordId));
+    }
+    else
+    {
+      eraseEntry(entry.second.text, foldCase(value), record.recordId);
+      if (numeric)
+        eraseEntry(entry.second.numbers, number, record.recordId);
+    }
+  }
+}
+
+boolean RecordStore::put(JsonObjectConst record)
+{
+  uint32_t recordId = record["recordId"].as<String>().toInt();
+  auto existing = this->_records.find(recordId);
+  if (existing != this->_records.end())
+  {
+    this->indexRecord(existing->second, false);
+  }
+  else if (this->_records.size() >= this->_maxRecords)
+  {
+    log_w("Record store full, record %u not kept", recordId);
+    this->_complete = false;
+    return false;
+  }
+  StoredRecord &stored = this->_records[recordId];
+  this->readRecord(record, stored);
+  this->indexRecord(stored, true);
+  return true;
+}
+
+/**
+ * @brief Copies recordId, modId and the field values of a record
+ */
+void RecordStore::readRecord(JsonObjectConst record, StoredRecord &stored)
+{
+  stored.recordId = record["recordId"].as<String>().toInt();
+  stored.modId = record["modId"].as<String>();
+  stored._names = &this->_names;
+  stored._values.clear();
+  for (JsonPairConst field : record["fieldData"].as<JsonObjectConst>())
+  {
+    size_t index = this->addField(field.key().c_str());
+    if (stored._values.size() <= index)
+      stored._values.resize(index + 1);
+    stored._values[index] = field.value().as<String>();
+  }
+}
+
+size_t RecordStore::cache(JsonObjectConst response)
+{
+  size_t count = 0;
+  for (JsonObjectConst record : response["response"]["data"].as<JsonArrayConst>())
+  {
+    if (this->put(record))
+      count++;
+  }
+  return count;
+}
+
+void RecordStore::remove(uint32_t recordId)
+{
+  auto existing = this->_records.find(recordId);
+  if (existing == this->_records.end())
+    return;
+  this->indexRecord(existing->second, false);
+  this->_records.erase(existing);
+}
+
+const StoredRecord *RecordStore::get(uint32_t recordId) const
+{
+  auto existing = this->_records.find(recordId);
+  return existing != this->_records.end() ? &existing->second : NULL;
+}
+
+template <typename K>
+static void collect(typename std::multimap<K, uint32_t>::const_iterator from, typename std::multimap<K, uint32_t>::const_iterator to, vector<uint32_t> &ids)
+{
+  for (; from != to; ++from)
+    ids.push_back(from->second);
+}
+
+/**
+ * @brief Record ids matching one field criterion, sorted
+ *
+ * @return boolean false when the criterion can not be answered locally
+ */
+boolean RecordStore::match(const RecordFindCriteria &criteria, vector<uint32_t> &ids) const
+{
+  int field = this->fieldOf(criteria.fieldName.c_str());
+  auto indexed = this->_indexes.find(field);
+  if (field < 0 || indexed == this->_indexes.end())
+    return false;
+  const FieldIndex &index = indexed->second;
+  if (!isAscii(criteria.fieldValue))
+    return false;
+  String value = foldCase(criteria.fieldValue);
+  ids.clear();
+  int dots = value.indexOf("...");
+  double low, high;
+  if (value.startsWith("=="))
+  {
+    auto range = index.text.equal_range(value.substring(2));
+    collect<String>(range.first, range.second, ids);
+  }
+  else if (dots > 0)
+  {
+    String from = value.substring(0, dots);
+    String to = value.substring(dots + 3);
+    if (toNumber(from, low) && toNumber(to, high))
+      collect<double>(index.numbers.lower_bound(low), index.numbers.upper_bound(high), ids);
+    else
+      collect<String>(index.text.lower_bound(from), index.text.upper_bound(to), ids);
+  }
+  else if (value.startsWith(">=") || value.startsWith("<="))
+  {
+    String bound = value.substring(2);
+    boolean greater = value[0] == '>';
+    if (toNumber(bound, low))
+      collect<double>(greater ? index.numbers.lower_bound(low) : index.numbers.begin(),
+                      greater ? index.numbers.end() : index.numbers.upper_bound(low), ids);
+    else
+      collect<String>(greater ? index.text.lower_bound(bound) : index.text.begin(),
+                      greater ? index.text.end() : index.text.upper_bound(bound), ids);
+  }
+  else if (value.startsWith(">") || value.startsWith("<"))
+  {
+    String bound = value.substring(1);
+    boolean greater = value[0] == '>';
+    if (toNumber(bound, low))
+      collect<double>(greater ? index.numbers.upper_bound(low) : index.numbers.begin(),
+                      greater ? index.numbers.end() : index.numbers.lower_bound(low), ids);
+    else
+      collect<String>(greater ? index.text.upper_bound(bound) : index.text.begin(),
+                      greater ? index.text.end() : index.text.lower_bound(bound), ids);
+  }
+  else if (value.length() > 1 && value.endsWith("*") && value.indexOf('*') == (int)value.length() - 1)
+  {
+    String prefix = value.substring(0, value.length() - 1);
+    for (auto entry = index.text.lower_bound(prefix); entry != index.text.end() && entry->first.startsWith(prefix); ++entry)
+      ids.push_back(entry->second);
+  }
+  else
+  {
+    return false;
+  }
+  std::sort(ids.begin(), ids.end());
+  return true;
+}
+
+/**
+ * @brief Record ids matching every criterion of a find request, sorted
+ */
+boolean RecordStore::matchRequest(const FindCriteria &findCriteria, vector<uint32_t> &ids) const
+{
+  vector<uint32_t> matched;
+  vector<uint32_t> both;
+  for (size_t i = 0; i < findCriteria.records.size(); i++)
+  {
+    if (!this->match(*findCriteria.records[i], i == 0 ? ids : matched))
+      return false;
+    if (i == 0)
+      continue;
+    both.clear();
+    std::set_intersection(ids.begin(), ids.end(), matched.begin(), matched.end(), std::back_inserter(both));
+    ids.swap(both);
+  }
+  return !findCriteria.records.empty();
+}
+
+boolean RecordStore::findLocal(const vector<FindCriteria *> &findCriterias, StoredRecordCallback callback) const
+{
+  vector<uint32_t> found;
+  vector<uint32_t> omitted;
+  vector<uint32_t> request;
+  vector<uint32_t> merged;
+  for (FindCriteria *findCriteria : findCriterias)
+  {
+    if (!this->matchRequest(*findCriteria, request))
+      return false;
+    vector<uint32_t> &target = findCriteria->omit ? omitted : found;
+    merged.clear();
+    std::set_union(target.begin(), target.end(), request.begin(), request.end(), std::back_inserter(merged));
+    target.swap(merged);
+  }
+  merged.clear();
+  std::set_difference(found.begin(), found.end(), omitted.begin(), omitted.end(), std::back_inserter(merged));
+  for (uint32_t recordId : merged)
+  {
+    callback(this->_records.at(recordId));
+  }
+  return !findCriterias.empty();
+}
+
+void RecordStore::setComplete(boolean complete)
+{
+  this->_complete = complete;
+}
+
+boolean RecordStore::isComplete(void) const
+{
+  return this->_complete;
+}
+
+boolean RecordStore::find(FMDataClient &client, const String &database, const String &layout, const vector<FindCriteria *> &findCriterias, StoredRecordCallback callback)
+{
+  // Records missing from a partial store would silently drop out of the result
+  if (this->_complete && this->findLocal(findCriterias, callback))
+  {
+    this->_hits++;
+    return true;
+  }
+  this->_misses++;
+  DynamicJsonDocument response(RECORD_STORE_DOCUMENT_CAPACITY);
+  if (!client.performFind(database, layout, findCriterias, response))
+  {
+    return false;
+  }
+  StoredRecord found;
+  for (JsonObjectConst record : response["response"]["data"].as<JsonArrayConst>())
+  {
+    // Records the full store does not keep are still reported
+    if (this->put(record))
+    {
+      callback(this->_records.at(record["recordId"].as<String>().toInt()));
+      continue;
+    }
+    this->readRecord(record, found);
+    callback(found);
+  }
+  return true;
+}
+
+size_t RecordStore::size(void) const
+{
+  return this->_records.size();
+}
+
+void RecordStore::clear(void)
+{
+  this->_complete = false;
+  this->_records.clear();
+  for (auto &entry : this->_indexes)
+  {
+    entry.second.text.clear();
+    entry.second.numbers.clear();
+  }
+}
+
+static boolean writeString(Print &output, const String &value)
+{
+  uint16_t length = value.length();
+  uint8_t header[2] = {(uint8_t)length, (uint8_t)(length >> 8)};
+  return output.write(header, 2) == 2 && output.write((const uint8_t *)value.c_str(), length) == length;
+}
+
+static boolean readString(Stream &input, String &value)
+{
+  uint8_t header[2];
+  if (input.readBytes(header, 2) != 2)
+    return false;
+  uint16_t length = header[0] | (header[1] << 8);
+  value = String();
+  if (!value.reserve(length))
+    return false;
+  char buffer[64];
+  while (length > 0)
+  {
+    size_t count = input.readBytes(buffer, min((size_t)length, sizeof(buffer)));
+    if (count == 0)
+      return false;
+    for (size_t i = 0; i < count; i++)
+      value += buffer[i];
+    length -= count;
+  }
+  return true;
+}
+
+static boolean writeNumber(Print &output, uint32_t value)
+{
+  uint8_t bytes[4] = {(uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24)};
+  return output.write(bytes, 4) == 4;
+}
+
+static boolean readNumber(Stream &input, uint32_t &value)
+{
+  uint8_t bytes[4];
+  if (input.readBytes(bytes, 4) != 4)
+    return false;
+  value = bytes[0] | (bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+  return true;
+}
+
+/**
+ * @brief Writes the records, strings are a 16 bit length followed by the bytes
+ * Layout: magic, complete flag, field count, field names, record count, then
+ * per record recordId, modId, value count and values. Numbers are little endian.
+ */
+boolean RecordStore::save(Print &output) const
+{
+  if (!writeString(output, RECORD_STORE_MAGIC) || !writeNumber(output, this->_complete ? 1 : 0) ||
+      !writeNumber(output, this->_names.size()))
+    return false;
+  for (const String &name : this->_names)
+  {
+    if (!writeString(output, name))
+      return false;
+  }
+  if (!writeNumber(output, this->_records.size()))
+    return false;
+  for (auto &entry : this->_records)
+  {
+    const StoredRecord &record = entry.second;
+    if (!writeNumber(output, record.recordId) || !writeString(output, record.modId) ||
+        !writeNumber(output, record._values.size()))
+      return false;
+    for (const String &value : record._values)
+    {
+      if (!writeString(output, value))
+        return false;
+    }
+  }
+  return true;
+}
+
+boolean RecordStore::load(Stream &input)
+{
+  this->clear();
+  String magic;
+  uint32_t complete;
+  uint32_t count;
+  if (!readString(input, magic) || magic != RECORD_STORE_MAGIC || !readNumber(input, complete) ||
+      !readNumber(input, count))
+  {
+    log_e("Not a saved record store");
+    return false;
+  }
+  // Fields indexed before loading keep their index, the saved ids are mapped
+  vector<int> fields;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    String name;
+    if (!readString(input, name))
+      return false;
+    fields.push_back(this->addField(name));
+  }
+  if (!readNumber(input, count))
+    return false;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    uint32_t recordId;
+    uint32_t values;
+    String modId;
+    if (!readNumber(input, recordId) || !readString(input, modId) || !readNumber(input, values) || values > fields.size())
+    {
+      this->clear();
+      return false;
+    }
+    StoredRecord record;
+    record.recordId = recordId;
+    record.modId = modId;
+    record._names = &this->_names;
+    for (uint32_t value = 0; value < values; value++)
+    {
+      String text;
+      if (!readString(input, text))
+      {
+        this->clear();
+        return false;
+      }
+      if (record._values.size() <= (size_t)fields[value])
+        record._values.resize(fields[value] + 1);
+      record._values[fields[value]] = text;
+    }
+    if (this->_records.size() >= this->_maxRecords)
+    {
+      complete = 0;
+      continue;
+    }
+    this->indexRecord(this->_records[recordId] = record, true);
+  }
+  // A store saved complete stays complete unless records were dropped
+  this->_complete = complete != 0;
+  return true;
+}
+
+uint32_t RecordStore::getHits(void) const
+{
+  return this->_hits;
+}
+
+uint32_t RecordStore::getMisses(void) const
+{
+  return this->_misses;
+}
@@ -0,0 +1,176 @@
+/*
+  RecordStore.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef RecordStore_h
+#define RecordStore_h
+
+#include "FMDataClient.h"
+#include <functional>
+#include <map>
+
+#define RECORD_STORE_MAX_RECORDS 1000
+/** Response document of a find made after a local miss */
+#define RECORD_STORE_DOCUMENT_CAPACITY 16384
+#define RECORD_STORE_MAGIC "FMRS2"
+
+/**
+ * @brief A record kept by the store
+ */
+class StoredRecord
+{
+public:
+  uint32_t recordId;
+  String modId;
+  /**
+   * @brief Value of a field
+   *
+   * @param fieldName
+   * @return const String& Empty when the record has no such field
+   */
+  const String &getValue(const String &fieldName) const;
+
+private:
+  friend class RecordStore;
+  const vector<String> *_names;
+  vector<String> _values;
+};
+
+typedef std::function<void(const StoredRecord &record)> StoredRecordCallback;
+
+/**
+ * @brief Local copy of records found on the server, searchable by indexed fields
+ * Finds on indexed fields are answered from memory when every criterion is
+ * one of: "==value", "prefix*", "low...high", ">value", ">=value", "<value"
+ * or "<=value". Ranges compare numerically when both sides are numbers and
+ * as text otherwise. Text compares without case like FileMaker does, criteria
+ * with characters beyond ASCII go to the server. Only a store declared complete, holding every record
+ * of the layout like one fed by RecordSync, answers finds locally. Other
+ * stores, criteria and fields without index go to the server, and the
+ * records found are kept.
+ * Requests of a find are or-ed, omit requests are removed from the result.
+ * save() and load() write the records and the complete flag to any Stream,
+ * a file on flash or a socket alike.
+ */
+class RecordStore
+{
+public:
+  /**
+   * @brief Construct a new Record Store object
+   *
+   * @param maxRecords Records kept, new records are ignored beyond that
+   */
+  RecordStore(size_t maxRecords = RECORD_STORE_MAX_RECORDS);
+
+  /**
+   * @brief Indexes a field, call before adding records
+   *
+   * @param fieldName
+   */
+  void addIndex(const String &fieldName);
+
+  /**
+   * @brief Adds or replaces a record
+   *
+   * @param record response.data[n] of a find, with recordId, modId and fieldData
+   * @return boolean false when the store is full
+   */
+  boolean put(JsonObjectConst record);
+
+  /**
+   * @brief Adds the records of a find response
+   *
+   * @param response Find response
+   * @return size_t Records added or replaced
+   */
+  size_t cache(JsonObjectConst response);
+
+  void remove(uint32_t recordId);
+
+  const StoredRecord *get(uint32_t recordId) const;
+
+  /**
+   * @brief Answers a find from the store only
+   *
+   * @param findCriterias Find requests
+   * @param callback Called for every record found, in recordId order
+   * @return boolean false when the find can not be answered locally
+   */
+  boolean findLocal(const vector<FindCriteria *> &findCriterias, StoredRecordCallback callback) const;
+
+  /**
+   * @brief Declares the store a complete mirror of the layout
+   * Set it once every record is in the store and kept current, by RecordSync
+   * for example. A store that is full or was cleared is not complete anymore.
+   *
+   * @param complete
+   */
+  void setComplete(boolean complete);
+
+  boolean isComplete(void) const;
+
+  /**
+   * @brief Answers a find from a complete store, or from the server otherwise
+   *
+   * @param client Client with an open session
+   * @param database Database Name
+   * @param layout Layout Name
+   * @param findCriterias Find requests
+   * @param callback Called for every record found
+   * @return boolean false when the server find failed
+   */
+  boolean find(FMDataClient &client, const String &database, const String &layout, const vector<FindCriteria *> &findCriterias, StoredRecordCallback callback);
+
+  size_t size(void) const;
+  void clear(void);
+
+  /**
+   * @brief Writes every record
+   *
+   * @param output
+   * @return boolean false when a write failed
+   */
+  boolean save(Print &output) const;
+
+  /**
+   * @brief Replaces the records with the ones written by save()
+   *
+   * @param input
+   * @return boolean false when the input is not a saved store, the store is empty then
+   * The store is complete when it was saved complete and every record fit.
+   */
+  boolean load(Stream &input);
+
+  /** Finds answered locally */
+  uint32_t getHits(void) const;
+  /** Finds sent to the server */
+  uint32_t getMisses(void) const;
+
+private:
+  class FieldIndex
+  {
+  public:
+    std::multimap<String, uint32_t> text;
+    std::multimap<double, uint32_t> numbers;
+  };
+  int fieldOf(const String &fieldName) const;
+  int addField(const String &fieldName);
+  void readRecord(JsonObjectConst record, StoredRecord &stored);
+  void indexRecord(const StoredRecord &record, boolean add);
+  boolean match(const RecordFindCriteria &criteria, vector<uint32_t> &ids) const;
+  boolean matchRequest(const FindCriteria &findCriteria, vector<uint32_t> &ids) const;
+  static String foldCase(const String &value);
+  static boolean isAscii(const String &value);
+  static boolean toNumber(const String &value, double &number);
+  size_t _maxRecords;
+  boolean _complete;
+  vector<String> _names;
+  std::map<int, FieldIndex> _indexes;
+  std::map<uint32_t, StoredRecord> _records;
+  uint32_t _hits;
+  uint32_t _misses;
+};
+
+#endif
@@ -0,0 +1,186 @@
+/*
+  RecordSync.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "RecordSync.h"
+#include <algorithm>
+
+SyncWatermark::SyncWatermark(String timestamp, String recordId, String modId)
+    : timestamp(std::move(timestamp)),
+      recordId(std::move(recordId)),
+      modId(std::move(modId))
+{
+}
+
+RecordSync::RecordSync(FMDataClient &client, const String &database, const String &layout, const String &timestampField)
+    : _client(client),
+      _database(database),
+      _layout(layout),
+      _sweepLayout(layout),
+      _timestampField(timestampField),
+      _pageSize(SYNC_PAGE_SIZE)
+{
+}
+
+/**
+ * @brief Finds one page sorted by a field
+ *
+ * @param layout Layout Name
+ * @param field Field searched and sorted by
+ * @param criteria Find criteria of the field
+ * @param offset First record, starting at 1
+ * @param response Destination
+ * @param empty Set when nothing matched
+ * @return boolean false when the request failed
+ */
+boolean RecordSync::findPage(const String &layout, const String &field, const String &criteria, int offset, JsonDocument &response, boolean &empty)
+{
+  RecordFindCriteria value(field, criteria);
+  vector<RecordFindCriteria *> fields(1, &value);
+  FindCriteria find(fields);
+  vector<FindCriteria *> finds(1, &find);
+  RecordSortCriteria order(field, SortOrder::ascend);
+  vector<RecordSortCriteria *> orders(1, &order);
+  SortCriteria sort(orders);
+  response.clear();
+  boolean found = this->_client.performFind(this->_database, layout, finds, response,
+                                            this->_pageSize, offset, &sort);
+  empty = !found && response["messages"][0]["code"].as<String>().toInt() == SYNC_NO_RECORDS_MATCH;
+  return found || empty;
+}
+
+boolean RecordSync::sync(SyncUpsertCallback onUpsert)
+{
+  DynamicJsonDocument response(SYNC_DOCUMENT_CAPACITY);
+  int offset = 1;
+  for (;;)
+  {
+    String from = this->_watermark.timestamp;
+    String criteria = from.length() > 0 ? String(">=") + from : String("*");
+    boolean empty;
+    if (!this->findPage(this->_layout, this->_timestampField, criteria, offset, response, empty))
+    {
+      log_e("Sync failed at: %s", this->_watermark.timestamp.c_str());
+      return false;
+    }
+    if (empty)
+      return true;
+    JsonArrayConst data = response["response"]["data"];
+    for (JsonObjectConst record : data)
+    {
+      String timestamp = record["fieldData"][this->_timestampField].as<String>();
+      String recordId = record["recordId"].as<String>();
+      String modId = record["modId"].as<String>();
+      String key = recordId + "/" + modId;
+      if (timestamp == this->_watermark.timestamp &&
+          std::find(this->_boundary.begin(), this->_boundary.end(), key) != this->_boundary.end())
+        continue;
+      onUpsert(record);
+      if (timestamp != this->_watermark.timestamp)
+        this->_boundary.clear();
+      this->_boundary.push_back(key);
+      this->_watermark = SyncWatermark(timestamp, recordId, modId);
+      this->remember(recordId.toInt());
+    }
+    if (data.size() < this->_pageSize)
+      return true;
+    // The same find pages on, a newer watermark skips the records already delivered with its timestamp
+    offset = this->_watermark.timestamp == from ? offset + this->_pageSize : this->_boundary.size() + 1;
+  }
+}
+
+boolean RecordSync::sweep(SyncDeleteCallback onDelete)
+{
+  if (this->_recordIdField.length() == 0)
+  {
+    log_e("Sweep needs a record id field");
+    return false;
+  }
+  DynamicJsonDocument response(SYNC_DOCUMENT_CAPACITY);
+  vector<uint32_t> present;
+  present.reserve(this->_known.size());
+  // Pages continue after the last id seen instead of at an offset, edits
+  // and deletes while sweeping do not move the records not read yet
+  uint32_t last = 0;
+  for (;;)
+  {
+    String criteria = last > 0 ? String(">") + String(last) : String("*");
+    boolean empty;
+    if (!this->findPage(this->_sweepLayout, this->_recordIdField, criteria, 1, response, empty))
+    {
+      log_e("Sweep failed after: %u", last);
+      return false;
+    }
+    if (empty)
+      break;
+    JsonArrayConst data = response["response"]["data"];
+    uint32_t previous = last;
+    for (JsonObjectConst record : data)
+    {
+      uint32_t recordId = record["recordId"].as<String>().toInt();
+      present.push_back(recordId);
+      last = max(last, (uint32_t)record["fieldData"][this->_recordIdField].as<String>().toInt());
+    }
+    if (data.size() < this->_pageSize)
+      break;
+    if (last == previous)
+    {
+      log_e("Record id field %s not on the sweep layout", this->_recordIdField.c_str());
+      return false;
+    }
+  }
+  std::sort(present.begin(), present.end());
+  vector<uint32_t> kept;
+  kept.reserve(present.size());
+  for (uint32_t recordId : this->_known)
+  {
+    if (std::binary_search(present.begin(), present.end(), recordId))
+      kept.push_back(recordId);
+    else
+      onDelete(recordId);
+  }
+  this->_known.swap(kept);
+  return true;
+}
+
+void RecordSync::remember(uint32_t recordId)
+{
+  auto position = std::lower_bound(this->_known.begin(), this->_known.end(), recordId);
+  if (position == this->_known.end() || *position != recordId)
+    this->_known.insert(position, recordId);
+}
+
+void RecordSync::setSweepLayout(const String &layout, const String &recordIdField)
+{
+  this->_sweepLayout = layout;
+  this->_recordIdField = recordIdField;
+}
+
+void RecordSync::setPageSize(uint16_t size)
+{
+  this->_pageSize = max(size, (uint16_t)1);
+}
+
+const SyncWatermark &RecordSync::getWatermark(void) const
+{
+  return this->_watermark;
+}
+
+void RecordSync::setWatermark(const SyncWatermark &watermark)
+{
+  this->_watermark = watermark;
+  this->_boundary.clear();
+  if (watermark.recordId.length() > 0)
+    this->_boundary.push_back(watermark.recordId + "/" + watermark.modId);
+}
+
+void RecordSync::addKnown(uint32_t recordId)
+{
+  this->remember(recordId);
+}
+
+size_t RecordSync::getKnownCount(void) const
+{
+  return this->_known.size();
+}
@@ -0,0 +1,143 @@
+/*
+  RecordSync.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef RecordSync_h
+#define RecordSync_h
+
+#include "FMDataClient.h"
+#include <functional>
+
+#define SYNC_PAGE_SIZE 50
+/** Response document of one page, enough for SYNC_PAGE_SIZE small records */
+#define SYNC_DOCUMENT_CAPACITY 16384
+/** Filemaker error code of a find without results */
+#define SYNC_NO_RECORDS_MATCH 401
+
+/**
+ * @brief A changed or new record, record is response.data[n] of the find
+ */
+typedef std::function<void(JsonObjectConst record)> SyncUpsertCallback;
+
+/**
+ * @brief A record that no longer exists on the server
+ */
+typedef std::function<void(uint32_t recordId)> SyncDeleteCallback;
+
+/**
+ * @brief Position of a sync, store it to resume after a restart
+ */
+class SyncWatermark
+{
+public:
+  SyncWatermark(String timestamp = "", String recordId = "", String modId = "");
+  /** Modification timestamp of the last record delivered, as Filemaker formats it */
+  String timestamp;
+  /** recordId of the last record delivered */
+  String recordId;
+  /** modId of the last record delivered */
+  String modId;
+};
+
+/**
+ * @brief Mirrors a layout by pulling only the records modified since the last sync
+ * Records are found by a modification timestamp field, sorted by it and
+ * paged from the watermark on. Once a page moves the watermark the next find
+ * starts at it, past the records already delivered with its timestamp, so
+ * records modified while paging are not skipped and every record is read
+ * about once. Records
+ * sharing the watermark's timestamp may be delivered again, upserts have to
+ * be idempotent. Deleted records are not found by timestamp, sweep()
+ * compares the record ids on the server with the ones delivered. It pages
+ * by a field holding the record id, which edits do not change, so a record
+ * modified during the sweep can not shift another one out of the pages.
+ */
+class RecordSync
+{
+public:
+  /**
+   * @brief Construct a new Record Sync object
+   *
+   * @param client Client with an open session
+   * @param database Database Name
+   * @param layout Layout Name
+   * @param timestampField Modification timestamp field, must be on the layout
+   */
+  RecordSync(FMDataClient &client, const String &database, const String &layout, const String &timestampField);
+
+  /**
+   * @brief Pulls the records modified since the watermark
+   *
+   * @param onUpsert Called for every changed or new record, oldest first
+   * @return boolean false when a request failed, the watermark keeps the records delivered
+   */
+  boolean sync(SyncUpsertCallback onUpsert);
+
+  /**
+   * @brief Finds records deleted on the server since they were delivered
+   * Reads every record id of the sweep layout, keep it down to the record id field.
+   * Needs setSweepLayout() with the record id field.
+   *
+   * @param onDelete Called for every record delivered that no longer exists
+   * @return boolean false when a request failed, nothing is reported then
+   */
+  boolean sweep(SyncDeleteCallback onDelete);
+
+  /**
+   * @brief Layout read by sweep()
+   *
+   * @param layout Layout Name, the sync layout may be used
+   * @param recordIdField Number field with Get(RecordID), stored calculation or auto-enter
+   */
+  void setSweepLayout(const String &layout, const String &recordIdField);
+
+  /**
+   * @brief Records per request
+   *
+   * @param size Records, adjust SYNC_DOCUMENT_CAPACITY to their size
+   */
+  void setPageSize(uint16_t size);
+
+  const SyncWatermark &getWatermark(void) const;
+
+  /**
+   * @brief Resumes from a stored watermark
+   *
+   * @param watermark
+   */
+  void setWatermark(const SyncWatermark &watermark);
+
+  /**
+   * @brief Adds a record to the ones sweep() checks, to restore them after a restart
+   *
+   * @param recordId
+   */
+  void addKnown(uint32_t recordId);
+
+  /**
+   * @brief Number of records sweep() checks
+   *
+   * @return size_t
+   */
+  size_t getKnownCount(void) const;
+
+private:
+  boolean findPage(const String &layout, const String &field, const String &criteria, int offset, JsonDocument &response, boolean &empty);
+  void remember(uint32_t recordId);
+  FMDataClient &_client;
+  String _database;
+  String _layout;
+  String _sweepLayout;
+  String _recordIdField;
+  String _timestampField;
+  uint16_t _pageSize;
+  SyncWatermark _watermark;
+  /** recordId/modId of the records delivered with the watermark's timestamp */
+  vector<String> _boundary;
+  /** Sorted record ids delivered */
+  vector<uint32_t> _known;
+};
+
+#endif
@@ -0,0 +1,124 @@
+/*
+  RequestMetrics.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "RequestMetrics.h"
+
+static const char *OPERATION_NAMES[RequestOperationCount] = {
+    "login",
+    "logout",
+    "create",
+    "edit",
+    "delete",
+    "find",
+    "upload",
+    "download"};
+
+static const char *PHASE_NAMES[RequestPhaseCount] = {
+    "dns",
+    "connect",
+    "wait",
+    "body",
+    "total"};
+
+RequestTiming::RequestTiming(RequestOperation operation)
+    : operation(operation),
+      httpCode(0)
+{
+  memset(this->phases, 0, sizeof(this->phases));
+}
+
+RequestMetrics::RequestMetrics(void)
+{
+  this->reset();
+}
+
+void RequestMetrics::reset(void)
+{
+  memset(this->_histogram, 0, sizeof(this->_histogram));
+  memset(this->_window, 0, sizeof(this->_window));
+  memset(this->_count, 0, sizeof(this->_count));
+  memset(this->_errors, 0, sizeof(this->_errors));
+  this->_last = RequestTiming();
+}
+
+/**
+ * @brief Histogram bucket of a duration, bucket n holds [2^(n-1), 2^n) ms
+ *
+ * @param micros Duration in microseconds
+ * @return uint8_t
+ */
+static uint8_t bucketOf(uint32_t micros)
+{
+  uint32_t millis = micros / 1000;
+  uint8_t bucket = 0;
+  while (millis > 0 && bucket < METRICS_HISTOGRAM_BUCKETS - 1)
+  {
+    millis >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+void RequestMetrics::record(const RequestTiming &timing)
+{
+  RequestOperation operation = timing.operation;
+  this->_last = timing;
+  this->_count[operation]++;
+  if (timing.httpCode != 200)
+    this->_errors[operation]++;
+  if (++this->_window[operation] > METRICS_WINDOW)
+  {
+    for (uint8_t phase = 0; phase < RequestPhaseCount; phase++)
+      for (uint8_t bucket = 0; bucket < METRICS_HISTOGRAM_BUCKETS; bucket++)
+        this->_histogram[operation][phase][bucket] >>= 1;
+    this->_window[operation] = METRICS_WINDOW / 2;
+  }
+  for (uint8_t phase = 0; phase < RequestPhaseCount; phase++)
+    this->_histogram[operation][phase][bucketOf(timing.phases[phase])]++;
+}
+
+uint32_t RequestMetrics::getCount(RequestOperation operation) const
+{
+  return this->_count[operation];
+}
+
+uint32_t RequestMetrics::getErrors(RequestOperation operation) const
+{
+  return this->_errors[operation];
+}
+
+uint32_t RequestMetrics::getPercentile(RequestOperation operation, RequestPhase phase, uint8_t percentile) const
+{
+  const uint16_t *buckets = this->_histogram[operation][phase];
+  uint32_t total = 0;
+  for (uint8_t bucket = 0; bucket < METRICS_HISTOGRAM_BUCKETS; bucket++)
+    total += buckets[bucket];
+  if (total == 0)
+    return 0;
+  uint32_t target = (total * percentile + 99) / 100;
+  uint32_t seen = 0;
+  for (uint8_t bucket = 0; bucket < METRICS_HISTOGRAM_BUCKETS; bucket++)
+  {
+    seen += buckets[bucket];
+    if (seen >= target && seen > 0)
+      return 1UL << bucket;
+  }
+  return 1UL << (METRICS_HISTOGRAM_BUCKETS - 1);
+}
+
+const RequestTiming &RequestMetrics::getLastTiming(void) const
+{
+  return this->_last;
+}
+
+const char *RequestMetrics::getOperationName(RequestOperation operation)
+{
+  return operation < RequestOperationCount ? OPERATION_NAMES[operation] : "";
+}
+
+const char *RequestMetrics::getPhaseName(RequestPhase phase)
+{
+  return phase < RequestPhaseCount ? PHASE_NAMES[phase] : "";
+}
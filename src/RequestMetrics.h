@@ -0,0 +1,125 @@
+/*
+  RequestMetrics.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef RequestMetrics_h
+#define RequestMetrics_h
+
+#include <Arduino.h>
+
+#define METRICS_HISTOGRAM_BUCKETS 16
+#define METRICS_WINDOW 256
+
+/**
+ * @brief Client operation, requests are timed per operation
+ */
+enum RequestOperation
+{
+  LogInOperation,
+  LogOutOperation,
+  CreateRecordOperation,
+  EditRecordOperation,
+  DeleteRecordOperation,
+  FindOperation,
+  UploadContainerOperation,
+  DownloadContainerOperation,
+  RequestOperationCount
+};
+
+/**
+ * @brief Phase of a request
+ * DNS and connect are only measured when the client opens the connection,
+ * the connect phase includes the TLS handshake. Wait is the time from
+ * sending the request until the response headers are received (time to
+ * first byte), body is the time spent reading the response body.
+ */
+enum RequestPhase
+{
+  DnsPhase,
+  ConnectPhase,
+  WaitPhase,
+  BodyPhase,
+  TotalPhase,
+  RequestPhaseCount
+};
+
+/**
+ * @brief Phase durations of a single request
+ */
+class RequestTiming
+{
+public:
+  RequestTiming(RequestOperation operation = RequestOperation::LogInOperation);
+  RequestOperation operation;
+  /** Http status code, or a negative HTTPClient error */
+  int httpCode;
+  /** Phase durations in microseconds */
+  uint32_t phases[RequestPhaseCount];
+};
+
+/**
+ * @brief Rolling latency histograms per operation and phase
+ * Buckets are powers of two milliseconds, when an operation reaches
+ * METRICS_WINDOW samples its buckets are halved, so old samples fade out.
+ */
+class RequestMetrics
+{
+public:
+  RequestMetrics(void);
+
+  /**
+   * @brief Adds a finished request
+   *
+   * @param timing Request timing
+   */
+  void record(const RequestTiming &timing);
+
+  /**
+   * @brief Number of requests of an operation since the last reset
+   *
+   * @param operation
+   * @return uint32_t
+   */
+  uint32_t getCount(RequestOperation operation) const;
+
+  /**
+   * @brief Number of failed requests of an operation since the last reset
+   *
+   * @param operation
+   * @return uint32_t
+   */
+  uint32_t getErrors(RequestOperation operation) const;
+
+  /**
+   * @brief Estimated percentile of a phase from the rolling histogram
+   *
+   * @param operation
+   * @param phase
+   * @param percentile 0 to 100
+   * @return uint32_t Upper bound of the bucket in milliseconds, 0 without samples
+   */
+  uint32_t getPercentile(RequestOperation operation, RequestPhase phase, uint8_t percentile) const;
+
+  /**
+   * @brief Timing of the last finished request
+   *
+   * @return const RequestTiming&
+   */
+  const RequestTiming &getLastTiming(void) const;
+
+  void reset(void);
+
+  static const char *getOperationName(RequestOperation operation);
+  static const char *getPhaseName(RequestPhase phase);
+
+private:
+  uint16_t _histogram[RequestOperationCount][RequestPhaseCount][METRICS_HISTOGRAM_BUCKETS];
+  uint16_t _window[RequestOperationCount];
+  uint32_t _count[RequestOperationCount];
+  uint32_t _errors[RequestOperationCount];
+  RequestTiming _last;
+};
+
+#endif
@@ -0,0 +1,299 @@
+/*
+  RequestScheduler.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "RequestScheduler.h"
+#ifndef ESP_PLATFORM
+#include <thread>
+#endif
+
+RequestScheduler::RequestScheduler(
+    const DatabaseCredentials &credentials,
+    const char *host,
+    const char *cert,
+    int port,
+    uint8_t connections)
+    : _host(host),
+      _cert(cert),
+      _port(port),
+      _reserved(0),
+      _queued(0),
+      _busy(0),
+      _running(0),
+      _accepting(false)
+{
+  connections = constrain(connections, 1, SCHEDULER_MAX_CONNECTIONS);
+  for (uint8_t i = 0; i < connections; i++)
+  {
+    // Every connection needs a TLS session of its own, a shared client would share one socket
+    FMDataClient *connection = new FMDataClient(credentials, this->_host, this->_cert, this->_port);
+    connection->setKeepAlive(true);
+    this->_connections.push_back(connection);
+  }
+}
+
+RequestScheduler::~RequestScheduler(void)
+{
+  this->end();
+  for (FMDataClient *connection : this->_connections)
+  {
+    delete connection;
+  }
+}
+
+boolean RequestScheduler::begin(void)
+{
+  if (this->_accepting)
+    return true;
+  FMDataClient *first = this->_connections.front();
+  if (!first->hasToken() && first->logInToDatabaseSession() == EMPTY_STRING)
+  {
+    log_e("Scheduler log in failed");
+    return false;
+  }
+  this->_accepting = true;
+  this->_workers.clear();
+  this->_workers.reserve(this->_connections.size());
+  for (uint8_t i = 0; i < this->_connections.size(); i++)
+  {
+    this->_connections[i]->setToken(first->getTokenPtr());
+    Worker worker;
+    worker.scheduler = this;
+    worker.client = this->_connections[i];
+    worker.lowest = i < this->_reserved ? RequestPriority::AlarmPriority : RequestPriority::BulkPriority;
+    this->_workers.push_back(worker);
+  }
+  for (Worker &worker : this->_workers)
+  {
+    if (!this->startWorker(worker))
+    {
+      log_e("Could not start a scheduler worker");
+      this->end();
+      return false;
+    }
+  }
+  log_d("Scheduler running with %u connections", this->_workers.size());
+  return true;
+}
+
+boolean RequestScheduler::startWorker(Worker &worker)
+{
+  std::lock_guard<std::mutex> lock(this->_mutex);
+#ifdef ESP_PLATFORM
+  if (xTaskCreate(RequestScheduler::run, SCHEDULER_TASK_NAME, SCHEDULER_TASK_STACK_SIZE,
+                  &worker, SCHEDULER_TASK_PRIORITY, NULL) != pdPASS)
+    return false;
+#else
+  std::thread(RequestScheduler::run, &worker).detach();
+#endif
+  this->_running++;
+  return true;
+}
+
+void RequestScheduler::run(void *parameter)
+{
+  Worker *worker = (Worker *)parameter;
+  worker->scheduler->work(*worker);
+#ifdef ESP_PLATFORM
+  vTaskDelete(NULL);
+#endif
+}
+
+void RequestScheduler::work(Worker &worker)
+{
+  RequestJob job;
+  CancellationToken *cancellation;
+  while (this->next(job, cancellation, worker.lowest))
+  {
+    worker.client->setCancellation(cancellation);
+    job(*worker.client);
+    worker.client->setCancellation(NULL);
+    job = nullptr;
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    this->_busy--;
+    if (this->_busy == 0 && this->_queued == 0)
+      this->_idle.notify_all();
+  }
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_running--;
+  this->_idle.notify_all();
+}
+
+RequestScheduler::JobQueue::JobQueue(void)
+    : size(0),
+      deadline(0),
+      dropped(0)
+{
+}
+
+void RequestScheduler::JobQueue::push(QueuedJob job, uint16_t source)
+{
+  std::deque<QueuedJob> &queue = this->_queues[source];
+  if (queue.empty())
+    this->_sources.push_back(source);
+  queue.push_back(std::move(job));
+  this->size++;
+}
+
+/**
+ * @brief Takes the next job, round robin over the sources, dropping stale jobs
+ *
+ * @param job Destination
+ * @return boolean false when no job is left
+ */
+boolean RequestScheduler::JobQueue::pop(QueuedJob &job)
+{
+  while (this->size > 0)
+  {
+    uint16_t source = this->_sources.front();
+    this->_sources.pop_front();
+    std::deque<QueuedJob> &queue = this->_queues[source];
+    job = std::move(queue.front());
+    queue.pop_front();
+    if (queue.empty())
+      this->_queues.erase(source);
+    else
+      this->_sources.push_back(source);
+    this->size--;
+    if (job.cancellation != NULL && job.cancellation->isCancelled())
+    {
+      this->dropped++;
+      log_w("Dropped a cancelled job");
+      continue;
+    }
+    if (this->deadline == 0 || millis() - job.queued <= this->deadline)
+      return true;
+    this->dropped++;
+    log_w("Dropped a job queued %lu ms ago", millis() - job.queued);
+  }
+  return false;
+}
+
+boolean RequestScheduler::hasJob(RequestPriority lowest) const
+{
+  for (uint8_t priority = 0; priority <= lowest; priority++)
+  {
+    if (this->_queues[priority].size > 0)
+      return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Takes the next job of the highest priority class with queued jobs
+ *
+ * @param job Destination
+ * @param cancellation Destination for the cancellation token of the job
+ * @param lowest Lowest priority class the worker runs
+ * @return boolean false when the scheduler stopped and the queue is empty
+ */
+boolean RequestScheduler::next(RequestJob &job, CancellationToken *&cancellation, RequestPriority lowest)
+{
+  std::unique_lock<std::mutex> lock(this->_mutex);
+  for (;;)
+  {
+    this->_available.wait(lock, [this, lowest] { return this->hasJob(lowest) || !this->_accepting; });
+    QueuedJob queued;
+    for (uint8_t priority = 0; priority <= lowest; priority++)
+    {
+      JobQueue &queue = this->_queues[priority];
+      size_t size = queue.size;
+      boolean found = queue.pop(queued);
+      this->_queued -= size - queue.size;
+      if (found)
+      {
+        job = std::move(queued.job);
+        cancellation = queued.cancellation;
+        this->_busy++;
+        return true;
+      }
+    }
+    if (this->_queued == 0)
+      this->_idle.notify_all();
+    if (!this->_accepting && !this->hasJob(lowest))
+      return false;
+  }
+}
+
+boolean RequestScheduler::submit(RequestJob job, uint16_t source, RequestPriority priority, CancellationToken *cancellation)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    if (!this->_accepting || priority >= RequestPriority::RequestPriorityCount)
+      return false;
+    QueuedJob queued;
+    queued.job = std::move(job);
+    queued.queued = millis();
+    queued.cancellation = cancellation;
+    this->_queues[priority].push(std::move(queued), source);
+    this->_queued++;
+  }
+  // Reserved workers only take alarms, wake all so one that may run it does
+  this->_available.notify_all();
+  return true;
+}
+
+void RequestScheduler::setDeadline(RequestPriority priority, uint32_t milliseconds)
+{
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_queues[priority].deadline = milliseconds;
+}
+
+void RequestScheduler::setReservedConnections(uint8_t count)
+{
+  this->_reserved = min(count, (uint8_t)(this->_connections.size() - 1));
+}
+
+void RequestScheduler::setRateLimiter(RateLimiter *limiter)
+{
+  for (FMDataClient *connection : this->_connections)
+  {
+    connection->setRateLimiter(limiter);
+  }
+}
+
+uint32_t RequestScheduler::getDropped(RequestPriority priority)
+{
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  return this->_queues[priority].dropped;
+}
+
+void RequestScheduler::wait(void)
+{
+  std::unique_lock<std::mutex> lock(this->_mutex);
+  this->_idle.wait(lock, [this] { return this->_queued == 0 && this->_busy == 0; });
+}
+
+void RequestScheduler::end(void)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    this->_accepting = false;
+  }
+  this->_available.notify_all();
+  std::unique_lock<std::mutex> lock(this->_mutex);
+  this->_idle.wait(lock, [this] { return this->_running == 0; });
+}
+
+size_t RequestScheduler::getQueueLength(void)
+{
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  return this->_queued;
+}
+
+size_t RequestScheduler::getQueueLength(RequestPriority priority)
+{
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  return this->_queues[priority].size;
+}
+
+uint8_t RequestScheduler::getConnectionCount(void) const
+{
+  return this->_connections.size();
+}
+
+FMDataClient &RequestScheduler::getConnection(uint8_t index)
+{
+  return *this->_connections[index];
+}
@@ -0,0 +1,211 @@
+/*
+  RequestScheduler.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef RequestScheduler_h
+#define RequestScheduler_h
+
+#include "FMDataClient.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+
+#define SCHEDULER_MAX_CONNECTIONS 8
+#define SCHEDULER_TASK_STACK_SIZE 8192
+#define SCHEDULER_TASK_PRIORITY 1
+#define SCHEDULER_TASK_NAME "fmdata"
+
+/**
+ * @brief A request, runs on whichever connection is idle
+ */
+typedef std::function<void(FMDataClient &client)> RequestJob;
+
+/**
+ * @brief Priority class of a queued request, lower values run first
+ */
+enum RequestPriority
+{
+  AlarmPriority,
+  NormalPriority,
+  BulkPriority,
+  RequestPriorityCount
+};
+
+/**
+ * @brief Runs queued requests over several connections to the same host
+ * Each connection is a FMDataClient with keep-alive enabled, served by its
+ * own worker, a FreeRTOS task on ESP32 or a thread elsewhere. All connections
+ * share the session opened by the first one. Jobs are queued per source and
+ * sources are served round robin, so a busy source can not starve the others.
+ * Queued jobs of a higher priority class always run before lower ones, jobs
+ * older than the deadline of their class are dropped, and connections can
+ * be reserved for alarms so they never wait behind an in-flight upload.
+ */
+class RequestScheduler
+{
+public:
+  /**
+   * @brief Construct a new Request Scheduler object
+   *
+   * @param credentials Database Credentials
+   * @param host Host address, ip address or domain name
+   * @param cert Root Certificate
+   * @param port Connection Port
+   * @param connections Number of parallel connections, up to SCHEDULER_MAX_CONNECTIONS
+   */
+  RequestScheduler(
+      const DatabaseCredentials &credentials,
+      const char *host,
+      const char *cert,
+      int port,
+      uint8_t connections = 2);
+
+  /**
+   * @brief Stops the workers and closes the connections
+   */
+  ~RequestScheduler(void);
+
+  /**
+   * @brief Logs in and starts one worker per connection
+   *
+   * @return boolean false when the log in or starting a worker failed
+   */
+  boolean begin(void);
+
+  /**
+   * @brief Stops accepting jobs, runs the queued ones and stops the workers
+   */
+  void end(void);
+
+  /**
+   * @brief Queues a job
+   *
+   * @param job Request to run
+   * @param source Jobs of the same source and priority run in order, sources take turns
+   * @param priority Priority class
+   * @param cancellation Optional, a cancelled job is dropped from the queue
+   * and the deadline applies to the requests of the running job; keep the
+   * token until the job ran or was dropped
+   * @return boolean false when the scheduler is not running
+   */
+  boolean submit(RequestJob job, uint16_t source = 0, RequestPriority priority = RequestPriority::NormalPriority, CancellationToken *cancellation = NULL);
+
+  /**
+   * @brief Drops jobs of a priority class that waited longer than the deadline
+   *
+   * @param priority Priority class
+   * @param milliseconds Maximum queue time, 0 to keep jobs until they run
+   */
+  void setDeadline(RequestPriority priority, uint32_t milliseconds);
+
+  /**
+   * @brief Reserves connections for AlarmPriority jobs, call before begin()
+   *
+   * @param count Connections that only run alarms, less than getConnectionCount()
+   */
+  void setReservedConnections(uint8_t count);
+
+  /**
+   * @brief Shares a rate limiter between all connections
+   *
+   * @param limiter Not owned by the scheduler, NULL to send without limits
+   */
+  void setRateLimiter(RateLimiter *limiter);
+
+  /**
+   * @brief Number of jobs of a priority class dropped after their deadline or cancelled
+   *
+   * @param priority Priority class
+   * @return uint32_t
+   */
+  uint32_t getDropped(RequestPriority priority);
+
+  /**
+   * @brief Blocks until the queue is empty and every connection is idle
+   */
+  void wait(void);
+
+  /**
+   * @brief Number of jobs waiting for a connection
+   *
+   * @return size_t
+   */
+  size_t getQueueLength(void);
+
+  /**
+   * @brief Number of jobs of a priority class waiting for a connection
+   *
+   * @param priority Priority class
+   * @return size_t
+   */
+  size_t getQueueLength(RequestPriority priority);
+
+  uint8_t getConnectionCount(void) const;
+
+  /**
+   * @brief A connection, to configure it before begin()
+   *
+   * @param index 0 to getConnectionCount() - 1
+   * @return FMDataClient&
+   */
+  FMDataClient &getConnection(uint8_t index);
+
+private:
+  class Worker
+  {
+  public:
+    RequestScheduler *scheduler;
+    FMDataClient *client;
+    /** Lowest priority class this worker runs */
+    RequestPriority lowest;
+  };
+  class QueuedJob
+  {
+  public:
+    RequestJob job;
+    unsigned long queued;
+    CancellationToken *cancellation;
+  };
+  /**
+   * @brief Jobs of one priority class, round robin over the sources
+   */
+  class JobQueue
+  {
+  public:
+    JobQueue(void);
+    void push(QueuedJob job, uint16_t source);
+    boolean pop(QueuedJob &job);
+    size_t size;
+    uint32_t deadline;
+    uint32_t dropped;
+
+  private:
+    std::map<uint16_t, std::deque<QueuedJob>> _queues;
+    std::deque<uint16_t> _sources;
+  };
+  static void run(void *parameter);
+  void work(Worker &worker);
+  boolean next(RequestJob &job, CancellationToken *&cancellation, RequestPriority lowest);
+  boolean hasJob(RequestPriority lowest) const;
+  boolean startWorker(Worker &worker);
+  const char *_host;
+  const char *_cert;
+  int _port;
+  uint8_t _reserved;
+  vector<FMDataClient *> _connections;
+  vector<Worker> _workers;
+  JobQueue _queues[RequestPriorityCount];
+  size_t _queued;
+  uint8_t _busy;
+  uint8_t _running;
+  boolean _accepting;
+  std::mutex _mutex;
+  std::condition_variable _available;
+  std::condition_variable _idle;
+};
+
+#endif
@@ -0,0 +1,100 @@
+/*
+  RequestTrace.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "RequestTrace.h"
+#include "RequestMetrics.h"
+
+#ifdef FMDATA_TRACE
+
+static const char *EVENT_TYPE_NAMES[] = {
+    "request",
+    "connect",
+    "filemaker",
+    "parse"};
+
+TraceEvent RequestTrace::_events[FMDATA_TRACE_SIZE];
+std::atomic<uint32_t> RequestTrace::_sequences[FMDATA_TRACE_SIZE];
+std::atomic<uint32_t> RequestTrace::_head(0);
+
+void RequestTrace::record(TraceEventType type, uint8_t operation, int16_t httpCode, uint16_t fileMakerCode,
+                          uint32_t requestSize, int32_t responseSize, uint32_t duration)
+{
+  uint32_t index = _head.fetch_add(1, std::memory_order_relaxed);
+  uint32_t slot = index & (FMDATA_TRACE_SIZE - 1);
+  // Odd sequence while the slot is being written
+  _sequences[slot].store(index * 2 + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  TraceEvent &event = _events[slot];
+  event.timestamp = millis();
+  event.duration = duration;
+  event.requestSize = requestSize;
+  event.responseSize = responseSize;
+  event.httpCode = httpCode;
+  event.fileMakerCode = fileMakerCode;
+  event.operation = operation;
+  event.type = type;
+  _sequences[slot].store(index * 2 + 2, std::memory_order_release);
+}
+
+/**
+ * @brief Copies the event with the given index if it is complete and not overwritten
+ *
+ * @param index Event index
+ * @param event Destination
+ * @return boolean
+ */
+boolean RequestTrace::readEvent(uint32_t index, TraceEvent &event)
+{
+  uint32_t slot = index & (FMDATA_TRACE_SIZE - 1);
+  uint32_t expected = index * 2 + 2;
+  if (_sequences[slot].load(std::memory_order_acquire) != expected)
+    return false;
+  memcpy(&event, &_events[slot], sizeof(TraceEvent));
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return _sequences[slot].load(std::memory_order_relaxed) == expected;
+}
+
+size_t RequestTrace::read(TraceEvent *events, size_t length)
+{
+  uint32_t head = _head.load(std::memory_order_acquire);
+  uint32_t index = head > FMDATA_TRACE_SIZE ? head - FMDATA_TRACE_SIZE : 0;
+  size_t count = 0;
+  for (; index < head && count < length; index++)
+  {
+    if (readEvent(index, events[count]))
+      count++;
+  }
+  return count;
+}
+
+void RequestTrace::dump(Print &output)
+{
+  uint32_t head = _head.load(std::memory_order_acquire);
+  uint32_t index = head > FMDATA_TRACE_SIZE ? head - FMDATA_TRACE_SIZE : 0;
+  TraceEvent event;
+  for (; index < head; index++)
+  {
+    if (!readEvent(index, event))
+      continue;
+    output.printf("%10u %-9s %-8s http=%d fm=%u req=%u res=%d %u us\n",
+                  event.timestamp,
+                  event.type < sizeof(EVENT_TYPE_NAMES) / sizeof(EVENT_TYPE_NAMES[0]) ? EVENT_TYPE_NAMES[event.type] : "",
+                  RequestMetrics::getOperationName((RequestOperation)event.operation),
+                  event.httpCode,
+                  event.fileMakerCode,
+                  event.requestSize,
+                  event.responseSize,
+                  event.duration);
+  }
+}
+
+void RequestTrace::clear(void)
+{
+  for (size_t slot = 0; slot < FMDATA_TRACE_SIZE; slot++)
+    _sequences[slot].store(0, std::memory_order_relaxed);
+  _head.store(0, std::memory_order_release);
+}
+
+#endif
@@ -0,0 +1,112 @@
+/*
+  RequestTrace.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef RequestTrace_h
+#define RequestTrace_h
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * Tracing is compiled in with -DFMDATA_TRACE, the number of events kept
+ * can be changed with -DFMDATA_TRACE_SIZE=n (power of two).
+ * Without FMDATA_TRACE the FMDATA_TRACE_EVENT() arguments are not even
+ * evaluated.
+ */
+#ifndef FMDATA_TRACE_SIZE
+#define FMDATA_TRACE_SIZE 64
+#endif
+
+#ifdef FMDATA_TRACE
+#define FMDATA_TRACE_ENABLED 1
+#define FMDATA_TRACE_EVENT(...) RequestTrace::record(__VA_ARGS__)
+#else
+#define FMDATA_TRACE_ENABLED 0
+#define FMDATA_TRACE_EVENT(...) \
+  do                            \
+  {                             \
+  } while (0)
+#endif
+
+/**
+ * @brief Kind of trace event
+ */
+enum TraceEventType
+{
+  /** A request finished, successfully or not */
+  RequestTraceEvent,
+  /** The connection could not be opened */
+  ConnectionErrorTraceEvent,
+  /** The response carried a Filemaker error code */
+  FileMakerErrorTraceEvent,
+  /** The response could not be parsed */
+  ParseErrorTraceEvent
+};
+
+/**
+ * @brief Fixed size binary trace event
+ */
+class TraceEvent
+{
+public:
+  /** millis() when the event was recorded */
+  uint32_t timestamp;
+  /** Request duration in microseconds */
+  uint32_t duration;
+  /** Request body size in bytes */
+  uint32_t requestSize;
+  /** Response body size in bytes, -1 when unknown */
+  int32_t responseSize;
+  /** Http status code or HTTPClient error */
+  int16_t httpCode;
+  /** Filemaker error code */
+  uint16_t fileMakerCode;
+  /** RequestOperation */
+  uint8_t operation;
+  /** TraceEventType */
+  uint8_t type;
+};
+
+/**
+ * @brief Lock free ring buffer of the last FMDATA_TRACE_SIZE trace events
+ * Writers claim a slot with an atomic increment and publish it with a
+ * sequence number, readers skip slots that are being written.
+ */
+class RequestTrace
+{
+public:
+  /**
+   * @brief Records an event, overwriting the oldest one when the buffer is full
+   */
+  static void record(TraceEventType type, uint8_t operation, int16_t httpCode, uint16_t fileMakerCode,
+                     uint32_t requestSize, int32_t responseSize, uint32_t duration);
+
+  /**
+   * @brief Copies the recorded events, oldest first
+   *
+   * @param events Destination
+   * @param length Maximum number of events to copy
+   * @return size_t Number of events copied
+   */
+  static size_t read(TraceEvent *events, size_t length);
+
+  /**
+   * @brief Prints the recorded events, one line per event
+   *
+   * @param output
+   */
+  static void dump(Print &output);
+
+  static void clear(void);
+
+private:
+  static boolean readEvent(uint32_t index, TraceEvent &event);
+  static TraceEvent _events[FMDATA_TRACE_SIZE];
+  static std::atomic<uint32_t> _sequences[FMDATA_TRACE_SIZE];
+  static std::atomic<uint32_t> _head;
+};
+
+#endif
@@ -0,0 +1,308 @@
+/*
+  ResponseScanner.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "ResponseScanner.h"
+
+ResponseStatus::ResponseStatus(void)
+    : httpCode(0),
+      code(FileMakerError::UnknownFileMakerError)
+{
+}
+
+FileMakerError ResponseStatus::getError(void) const
+{
+  return (FileMakerError)this->code;
+}
+
+boolean ResponseStatus::isOk(void) const
+{
+  return this->httpCode == 200 && this->code == FileMakerError::NoFileMakerError;
+}
+
+ResponseScanner::ResponseScanner(Stream &input)
+    : _input(input),
+      _position(0),
+      _length(0),
+      _pending(-1)
+{
+}
+
+/**
+ * @brief Next byte of the response, reads at most what is already available
+ * so it never blocks on a byte the server has not sent
+ *
+ * @return int Byte or -1 at the end of the input
+ */
+int ResponseScanner::read(void)
+{
+  if (this->_pending >= 0)
+  {
+    int c = this->_pending;
+    this->_pending = -1;
+    return c;
+  }
+  if (this->_position >= this->_length)
+  {
+    int available = this->_input.available();
+    size_t length = available > 0 ? min((size_t)available, (size_t)SCANNER_BUFFER_SIZE) : 1;
+    this->_length = this->_input.readBytes(this->_buffer, length);
+    this->_position = 0;
+    if (this->_length == 0)
+      return -1;
+  }
+  return (uint8_t)this->_buffer[this->_position++];
+}
+
+/**
+ * @brief Next byte that is not white space
+ */
+int ResponseScanner::next(void)
+{
+  int c;
+  do
+  {
+    c = this->read();
+  } while (c == ' ' || c == '\t' || c == '\r' || c == '\n');
+  return c;
+}
+
+/**
+ * @brief Reads the next key of an object, up to and including the colon
+ *
+ * @param key Destination
+ * @param first The opening brace was just read
+ * @return int 1 with a key, 0 at the end of the object, -1 on errors
+ */
+int ResponseScanner::nextKey(String &key, boolean first)
+{
+  int c = this->next();
+  if (c == '}')
+    return 0;
+  if (!first)
+  {
+    if (c != ',')
+      return -1;
+    c = this->next();
+  }
+  if (c != '"')
+    return -1;
+  key = "";
+  key.reserve(SCANNER_KEY_LENGTH);
+  if (!this->readString(&key, SCANNER_KEY_LENGTH) || this->next() != ':')
+    return -1;
+  return 1;
+}
+
+/**
+ * @brief Reads a string after its opening quote
+ *
+ * @param value Destination or NULL to discard
+ * @param limit Characters kept, the rest is discarded
+ * @return boolean false when the input ended
+ */
+boolean ResponseScanner::readString(String *value, size_t limit)
+{
+  for (;;)
+  {
+    int c = this->read();
+    if (c < 0)
+      return false;
+    if (c == '"')
+      return true;
+    if (c == '\\')
+    {
+      c = this->read();
+      switch (c)
+      {
+      case -1:
+        return false;
+      case 'n':
+        c = '\n';
+        break;
+      case 'r':
+        c = '\r';
+        break;
+      case 't':
+        c = '\t';
+        break;
+      case 'b':
+        c = '\b';
+        break;
+      case 'f':
+        c = '\f';
+        break;
+      case 'u':
+      {
+        char hex[5] = {0};
+        for (uint8_t i = 0; i < 4; i++)
+        {
+          int h = this->read();
+          if (h < 0)
+            return false;
+          hex[i] = h;
+        }
+        long code = strtol(hex, NULL, 16);
+        c = code < 0x80 ? code : '?';
+        break;
+      }
+      }
+    }
+    if (value != NULL && value->length() < limit)
+      *value += (char)c;
+  }
+}
+
+/**
+ * @brief Reads a value, strings and literals are kept, objects and arrays are skipped
+ *
+ * @param c First byte of the value
+ * @param value Destination or NULL to discard
+ * @return boolean false on errors
+ */
+boolean ResponseScanner::readScalar(int c, String *value)
+{
+  if (c == '"')
+    return this->readString(value, SCANNER_VALUE_LENGTH);
+  if (c == '{' || c == '[')
+    return this->skipValue(c);
+  while (c >= 0)
+  {
+    if (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\t' || c == '\r' || c == '\n')
+    {
+      this->_pending = c;
+      return true;
+    }
+    if (value != NULL && value->length() < SCANNER_VALUE_LENGTH)
+      *value += (char)c;
+    c = this->read();
+  }
+  return false;
+}
+
+/**
+ * @brief Discards a value
+ *
+ * @param c First byte of the value
+ * @return boolean false on errors
+ */
+boolean ResponseScanner::skipValue(int c)
+{
+  if (c != '{' && c != '[')
+    return this->readScalar(c, NULL);
+  uint16_t depth = 1;
+  while (depth > 0)
+  {
+    c = this->read();
+    if (c < 0)
+      return false;
+    if (c == '"')
+    {
+      if (!this->readString(NULL, 0))
+        return false;
+    }
+    else if (c == '{' || c == '[')
+      depth++;
+    else if (c == '}' || c == ']')
+      depth--;
+  }
+  return true;
+}
+
+/**
+ * @brief Keeps code and message of the first entry of the messages array
+ */
+boolean ResponseScanner::scanMessages(ResponseStatus &status)
+{
+  int c = this->next();
+  if (c != '[')
+    return this->skipValue(c);
+  c = this->next();
+  for (uint16_t index = 0; c != ']'; index++)
+  {
+    if (index == 0 && c == '{')
+    {
+      String key;
+      int result;
+      boolean first = true;
+      while ((result = this->nextKey(key, first)) > 0)
+      {
+        first = false;
+        boolean ok;
+        if (key == "code")
+        {
+          String code;
+          ok = this->readScalar(this->next(), &code);
+          status.code = code.toInt();
+        }
+        else if (key == "message")
+          ok = this->readScalar(this->next(), &status.message);
+        else
+          ok = this->skipValue(this->next());
+        if (!ok)
+          return false;
+      }
+      if (result < 0)
+        return false;
+    }
+    else if (!this->skipValue(c))
+      return false;
+    c = this->next();
+    if (c == ',')
+      c = this->next();
+    else if (c != ']')
+      return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Keeps recordId and modId of the response object
+ */
+boolean ResponseScanner::scanResponse(ResponseStatus &status)
+{
+  int c = this->next();
+  if (c != '{')
+    return this->skipValue(c);
+  String key;
+  int result;
+  boolean first = true;
+  while ((result = this->nextKey(key, first)) > 0)
+  {
+    first = false;
+    boolean ok;
+    if (key == "recordId")
+      ok = this->readScalar(this->next(), &status.recordId);
+    else if (key == "modId")
+      ok = this->readScalar(this->next(), &status.modId);
+    else
+      ok = this->skipValue(this->next());
+    if (!ok)
+      return false;
+  }
+  return result == 0;
+}
+
+boolean ResponseScanner::scan(ResponseStatus &status)
+{
+  if (this->next() != '{')
+    return false;
+  String key;
+  int result;
+  boolean first = true;
+  while ((result = this->nextKey(key, first)) > 0)
+  {
+    first = false;
+    boolean ok;
+    if (key == "messages")
+      ok = this->scanMessages(status);
+    else if (key == "response")
+      ok = this->scanResponse(status);
+    else
+      ok = this->skipValue(this->next());
+    if (!ok)
+      return false;
+  }
+  return result == 0;
+}
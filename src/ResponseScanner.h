@@ -0,0 +1,113 @@
+/*
+  ResponseScanner.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef ResponseScanner_h
+#define ResponseScanner_h
+
+#include <Arduino.h>
+
+#define SCANNER_BUFFER_SIZE 64
+#define SCANNER_KEY_LENGTH 16
+#define SCANNER_VALUE_LENGTH 128
+
+/**
+ * @brief Filemaker error codes reported in messages[0].code
+ * @see https://fmhelp.filemaker.com/help/18/fmp/en/#page/FMP_Help%2Ferror-codes.html
+ */
+enum FileMakerError
+{
+  /** The response could not be read */
+  UnknownFileMakerError = -1,
+  NoFileMakerError = 0,
+  UserCanceledError = 1,
+  MemoryError = 2,
+  FileMissingError = 100,
+  RecordMissingError = 101,
+  FieldMissingError = 102,
+  LayoutMissingError = 105,
+  RecordAccessDeniedError = 200,
+  FieldNotModifiableError = 201,
+  InvalidAccountError = 212,
+  RecordInUseError = 301,
+  NoRecordsMatchError = 401,
+  ValidationError = 500,
+  ValueNotUniqueError = 504,
+  ValueRequiredError = 509,
+  FileOpenError = 802,
+  InvalidTokenError = 952,
+  DataLimitError = 953,
+  ParameterMissingError = 958,
+  ParameterInvalidError = 960,
+  UrlFormatError = 1630,
+  ParameterValueError = 1708
+};
+
+/**
+ * @brief Status of a Filemaker response
+ */
+class ResponseStatus
+{
+public:
+  ResponseStatus(void);
+  /** Http status code, or a negative HTTPClient error */
+  int httpCode;
+  /** messages[0].code, -1 when the response could not be read */
+  int code;
+  /** messages[0].message */
+  String message;
+  /** response.recordId */
+  String recordId;
+  /** response.modId */
+  String modId;
+  /**
+   * @brief Code as a Filemaker error, codes not in the enum keep their value
+   *
+   * @return FileMakerError
+   */
+  FileMakerError getError(void) const;
+  /**
+   * @brief The request succeeded and Filemaker reported no error
+   *
+   * @return boolean
+   */
+  boolean isOk(void) const;
+};
+
+/**
+ * @brief Extracts the status of a Filemaker response from a stream
+ * Only messages[0] and the scalar members of response are kept, everything
+ * else is read and discarded, the body is never buffered.
+ */
+class ResponseScanner
+{
+public:
+  ResponseScanner(Stream &input);
+
+  /**
+   * @brief Reads the response up to the end of the top level object
+   *
+   * @param status Destination, code and message are only set when found
+   * @return boolean false when the response is not valid Json
+   */
+  boolean scan(ResponseStatus &status);
+
+private:
+  Stream &_input;
+  char _buffer[SCANNER_BUFFER_SIZE];
+  size_t _position;
+  size_t _length;
+  int _pending;
+  int read(void);
+  int next(void);
+  int nextKey(String &key, boolean first);
+  boolean readString(String *value, size_t limit);
+  boolean readScalar(int c, String *value);
+  boolean skipValue(int c);
+  boolean scanMessages(ResponseStatus &status);
+  boolean scanResponse(ResponseStatus &status);
+};
+
+#endif
@@ -0,0 +1,398 @@
+/*
+  ResponseStream.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "ResponseStream.h"
+
+#define GZIP_ID1 0x1f
+#define GZIP_ID2 0x8b
+#define GZIP_METHOD_DEFLATE 8
+#define GZIP_FLAG_HCRC 0x02
+#define GZIP_FLAG_EXTRA 0x04
+#define GZIP_FLAG_NAME 0x08
+#define GZIP_FLAG_COMMENT 0x10
+
+DeadlineStream::DeadlineStream(Stream &source, const CancellationToken *token)
+    : _source(source),
+      _token(token)
+{
+}
+
+boolean DeadlineStream::isExpired(void) const
+{
+  return this->_token != NULL && this->_token->isCancelled();
+}
+
+int DeadlineStream::available(void)
+{
+  return this->isExpired() ? 0 : this->_source.available();
+}
+
+int DeadlineStream::read(void)
+{
+  return this->isExpired() ? -1 : this->_source.read();
+}
+
+int DeadlineStream::peek(void)
+{
+  return this->isExpired() ? -1 : this->_source.peek();
+}
+
+/**
+ * @brief Copies what has arrived, waiting for more up to the source's timeout or the deadline
+ *
+ * @param buffer Destination
+ * @param length Maximum number of bytes to copy
+ * @return size_t Number of bytes copied
+ */
+size_t DeadlineStream::readBytes(char *buffer, size_t length)
+{
+  size_t count = 0;
+  unsigned long start = millis();
+  while (count < length && !this->isExpired())
+  {
+    int available = this->_source.available();
+    if (available > 0)
+    {
+      count += this->_source.readBytes(buffer + count, min((size_t)available, length - count));
+      start = millis();
+      continue;
+    }
+    if (millis() - start >= this->_source.getTimeout())
+      break;
+    delay(1);
+  }
+  return count;
+}
+
+size_t DeadlineStream::write(uint8_t data)
+{
+  return 0;
+}
+
+void DeadlineStream::flush(void)
+{
+}
+
+ChunkedStream::ChunkedStream(Stream &source)
+    : _source(source),
+      _chunkRemaining(0),
+      _ended(false),
+      _peeked(-1)
+{
+}
+
+/**
+ * @brief Reads a byte from the source, waiting up to the stream timeout
+ *
+ * @return int The byte or -1 on timeout
+ */
+int ChunkedStream::timedSourceRead(void)
+{
+  char c;
+  return this->_source.readBytes(&c, 1) == 1 ? (uint8_t)c : -1;
+}
+
+/**
+ * @brief Parses the next chunk size line
+ *
+ * @return boolean false when the last chunk was reached or the source failed
+ */
+boolean ChunkedStream::nextChunk(void)
+{
+  size_t size = 0;
+  boolean digits = false;
+  boolean extension = false;
+  while (!this->_ended)
+  {
+    int c = this->timedSourceRead();
+    if (c < 0)
+    {
+      log_e("Chunked body ended unexpectedly");
+      this->_ended = true;
+      return false;
+    }
+    if (c == '\n')
+    {
+      // Blank lines are the CRLF closing the previous chunk data
+      if (!digits)
+        continue;
+      this->_chunkRemaining = size;
+      this->_ended = size == 0;
+      return !this->_ended;
+    }
+    if (c == ';')
+      extension = true;
+    if (extension || c == '\r')
+      continue;
+    if (c >= '0' && c <= '9')
+      size = (size << 4) | (c - '0');
+    else if (c >= 'a' && c <= 'f')
+      size = (size << 4) | (c - 'a' + 10);
+    else if (c >= 'A' && c <= 'F')
+      size = (size << 4) | (c - 'A' + 10);
+    else
+      continue;
+    digits = true;
+  }
+  return false;
+}
+
+int ChunkedStream::available(void)
+{
+  if (this->_peeked >= 0)
+    return 1;
+  if (this->_ended)
+    return 0;
+  int available = this->_source.available();
+  if (this->_chunkRemaining > 0 && (size_t)available > this->_chunkRemaining)
+    return this->_chunkRemaining;
+  return this->_chunkRemaining > 0 ? available : 0;
+}
+
+int ChunkedStream::read(void)
+{
+  if (this->_peeked >= 0)
+  {
+    int c = this->_peeked;
+    this->_peeked = -1;
+    return c;
+  }
+  if (this->_chunkRemaining == 0 && !this->nextChunk())
+    return -1;
+  int c = this->timedSourceRead();
+  if (c >= 0)
+    this->_chunkRemaining--;
+  return c;
+}
+
+int ChunkedStream::peek(void)
+{
+  if (this->_peeked < 0)
+    this->_peeked = this->read();
+  return this->_peeked;
+}
+
+size_t ChunkedStream::write(uint8_t data)
+{
+  return 0;
+}
+
+void ChunkedStream::flush(void)
+{
+}
+
+/**
+ * @brief Construct a new Inflate Stream object
+ *
+ * @param source Compressed body
+ * @param encoding Gzip or Deflate (zlib wrapped)
+ * @param length Compressed length, -1 when the source ends with the connection
+ */
+InflateStream::InflateStream(Stream &source, ContentEncoding encoding, int length)
+    : _source(source),
+      _encoding(encoding),
+      _remaining(length),
+      _inputPosition(0),
+      _inputLength(0),
+      _windowOffset(0),
+      _outputPosition(0),
+      _outputLength(0),
+      _status(TINFL_STATUS_NEEDS_MORE_INPUT),
+      _headerParsed(encoding != ContentEncoding::GzipEncoding)
+{
+  this->_decompressor = (tinfl_decompressor *)malloc(sizeof(tinfl_decompressor));
+  this->_window = (uint8_t *)malloc(INFLATE_WINDOW_SIZE);
+  if (this->_decompressor == NULL || this->_window == NULL)
+  {
+    log_e("Not enough memory to inflate the response");
+    this->_status = TINFL_STATUS_FAILED;
+    return;
+  }
+  tinfl_init(this->_decompressor);
+}
+
+InflateStream::~InflateStream(void)
+{
+  free(this->_decompressor);
+  free(this->_window);
+}
+
+boolean InflateStream::isDone(void) const
+{
+  return this->_status == TINFL_STATUS_DONE;
+}
+
+/**
+ * @brief Reads the next block of compressed data from the source
+ *
+ * @return boolean false when the source is exhausted
+ */
+boolean InflateStream::fillInput(void)
+{
+  if (this->_remaining == 0)
+    return false;
+  size_t count = sizeof(this->_input);
+  if (this->_remaining > 0 && count > (size_t)this->_remaining)
+    count = this->_remaining;
+  // Only take what has arrived, asking readBytes() for a full buffer waits
+  // out the stream timeout at the end of a chunked or unsized body. The
+  // deflate data ends by itself, so a blocking read of a single byte only
+  // happens while the decompressor still needs input.
+  int available = this->_source.available();
+  if (available > 0 && count > (size_t)available)
+    count = available;
+  else if (available <= 0)
+    count = 1;
+  count = this->_source.readBytes(this->_input, count);
+  if (count == 0)
+    return false;
+  this->_inputPosition = 0;
+  this->_inputLength = count;
+  if (this->_remaining > 0)
+    this->_remaining -= count;
+  return true;
+}
+
+int InflateStream::nextInputByte(void)
+{
+  if (this->_inputPosition == this->_inputLength && !this->fillInput())
+    return -1;
+  return this->_input[this->_inputPosition++];
+}
+
+/**
+ * @brief Skips the gzip member header, leaving the raw deflate data
+ *
+ * @return boolean false when the header is not valid
+ */
+boolean InflateStream::skipGzipHeader(void)
+{
+  uint8_t header[10];
+  for (size_t i = 0; i < sizeof(header); i++)
+  {
+    int c = this->nextInputByte();
+    if (c < 0)
+      return false;
+    header[i] = c;
+  }
+  if (header[0] != GZIP_ID1 || header[1] != GZIP_ID2 || header[2] != GZIP_METHOD_DEFLATE)
+  {
+    log_e("Invalid gzip header");
+    return false;
+  }
+  uint8_t flags = header[3];
+  if (flags & GZIP_FLAG_EXTRA)
+  {
+    int low = this->nextInputByte();
+    int high = this->nextInputByte();
+    if (low < 0 || high < 0)
+      return false;
+    for (int length = low | (high << 8); length > 0; length--)
+      if (this->nextInputByte() < 0)
+        return false;
+  }
+  if (flags & GZIP_FLAG_NAME)
+  {
+    int c;
+    while ((c = this->nextInputByte()) > 0)
+      ;
+    if (c < 0)
+      return false;
+  }
+  if (flags & GZIP_FLAG_COMMENT)
+  {
+    int c;
+    while ((c = this->nextInputByte()) > 0)
+      ;
+    if (c < 0)
+      return false;
+  }
+  if (flags & GZIP_FLAG_HCRC)
+  {
+    if (this->nextInputByte() < 0 || this->nextInputByte() < 0)
+      return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Decompresses until there is output to read
+ *
+ * @return boolean false at the end of the stream or on error
+ */
+boolean InflateStream::inflate(void)
+{
+  if (!this->_headerParsed)
+  {
+    if (!this->skipGzipHeader())
+    {
+      this->_status = TINFL_STATUS_FAILED;
+      return false;
+    }
+    this->_headerParsed = true;
+  }
+  while (this->_outputPosition == this->_outputLength)
+  {
+    if (this->_status <= TINFL_STATUS_DONE)
+      return false;
+    if (this->_status == TINFL_STATUS_NEEDS_MORE_INPUT &&
+        this->_inputPosition == this->_inputLength &&
+        !this->fillInput())
+    {
+      log_e("Compressed body ended unexpectedly");
+      this->_status = TINFL_STATUS_FAILED;
+      return false;
+    }
+    size_t in = this->_inputLength - this->_inputPosition;
+    size_t out = INFLATE_WINDOW_SIZE - this->_windowOffset;
+    mz_uint32 flags = this->_remaining != 0 ? TINFL_FLAG_HAS_MORE_INPUT : 0;
+    if (this->_encoding == ContentEncoding::DeflateEncoding)
+      flags |= TINFL_FLAG_PARSE_ZLIB_HEADER;
+    this->_status = tinfl_decompress(
+        this->_decompressor,
+        this->_input + this->_inputPosition, &in,
+        this->_window, this->_window + this->_windowOffset, &out,
+        flags);
+    this->_inputPosition += in;
+    this->_outputPosition = this->_windowOffset;
+    this->_outputLength = this->_windowOffset + out;
+    this->_windowOffset = (this->_windowOffset + out) & (INFLATE_WINDOW_SIZE - 1);
+    if (this->_status < TINFL_STATUS_DONE)
+    {
+      log_e("Inflate error: %d", this->_status);
+    }
+  }
+  return true;
+}
+
+int InflateStream::available(void)
+{
+  if (this->_outputPosition == this->_outputLength)
+    this->inflate();
+  return this->_outputLength - this->_outputPosition;
+}
+
+int InflateStream::read(void)
+{
+  if (this->_outputPosition == this->_outputLength && !this->inflate())
+    return -1;
+  return this->_window[this->_outputPosition++];
+}
+
+int InflateStream::peek(void)
+{
+  if (this->_outputPosition == this->_outputLength && !this->inflate())
+    return -1;
+  return this->_window[this->_outputPosition];
+}
+
+size_t InflateStream::write(uint8_t data)
+{
+  return 0;
+}
+
+void InflateStream::flush(void)
+{
+}
@@ -0,0 +1,136 @@
+/*
+  ResponseStream.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef ResponseStream_h
+#define ResponseStream_h
+
+#include <Arduino.h>
+#include "CancellationToken.h"
+#if __has_include("esp32/rom/miniz.h")
+#include "esp32/rom/miniz.h"
+#else
+#include "rom/miniz.h"
+#endif
+
+#define INFLATE_INPUT_BUFFER_SIZE 512
+#define INFLATE_WINDOW_SIZE TINFL_LZ_DICT_SIZE
+
+/**
+ * @brief Passes a response body through until the deadline of its request
+ * Reads wait for data up to the source's timeout, like Stream::readBytes(),
+ * but never past the deadline; once the token is cancelled nothing more is
+ * read. Put it between the connection and the decoders.
+ */
+class DeadlineStream : public Stream
+{
+public:
+  /**
+   * @brief Construct a new Deadline Stream object
+   *
+   * @param source Connection
+   * @param token Deadline and cancellation, NULL to only wait up to the source's timeout
+   */
+  DeadlineStream(Stream &source, const CancellationToken *token);
+  int available(void);
+  int read(void);
+  int peek(void);
+  size_t readBytes(char *buffer, size_t length);
+  using Stream::readBytes;
+  size_t write(uint8_t data);
+  void flush(void);
+
+private:
+  Stream &_source;
+  const CancellationToken *_token;
+  boolean isExpired(void) const;
+};
+
+/**
+ * @brief Decodes a HTTP/1.1 chunked transfer encoded body
+ * @see https://tools.ietf.org/html/rfc7230#section-4.1
+ */
+class ChunkedStream : public Stream
+{
+public:
+  ChunkedStream(Stream &source);
+  int available(void);
+  int read(void);
+  int peek(void);
+  size_t write(uint8_t data);
+  void flush(void);
+
+private:
+  Stream &_source;
+  size_t _chunkRemaining;
+  boolean _ended;
+  int _peeked;
+  boolean nextChunk(void);
+  int timedSourceRead(void);
+};
+
+/**
+ * @brief Content encoding of a response body
+ */
+enum ContentEncoding
+{
+  IdentityEncoding,
+  GzipEncoding,
+  DeflateEncoding
+};
+
+/**
+ * @brief Inflates a gzip or deflate encoded body while it is being read
+ * Uses a fixed 32 KB window and a small input buffer, the decompressed body
+ * is never held in memory as a whole, so it can be handed straight to
+ * deserializeJson().
+ * @see https://tools.ietf.org/html/rfc1952
+ * @see https://tools.ietf.org/html/rfc1950
+ */
+class InflateStream : public Stream
+{
+public:
+  /**
+   * @brief Construct a new Inflate Stream object
+   *
+   * @param source Compressed body
+   * @param encoding Gzip or Deflate (zlib wrapped)
+   * @param length Compressed length, -1 when the source ends with the connection
+   */
+  InflateStream(Stream &source, ContentEncoding encoding, int length = -1);
+  ~InflateStream(void);
+  /**
+   * @brief Whether the whole body was inflated without errors
+   *
+   * @return boolean
+   */
+  boolean isDone(void) const;
+  int available(void);
+  int read(void);
+  int peek(void);
+  size_t write(uint8_t data);
+  void flush(void);
+
+private:
+  Stream &_source;
+  ContentEncoding _encoding;
+  int _remaining;
+  tinfl_decompressor *_decompressor;
+  uint8_t *_window;
+  uint8_t _input[INFLATE_INPUT_BUFFER_SIZE];
+  size_t _inputPosition;
+  size_t _inputLength;
+  size_t _windowOffset;
+  size_t _outputPosition;
+  size_t _outputLength;
+  tinfl_status _status;
+  boolean _headerParsed;
+  boolean fillInput(void);
+  int nextInputByte(void);
+  boolean skipGzipHeader(void);
+  boolean inflate(void);
+};
+
+#endif
@@ -0,0 +1,185 @@
+/*
+  RetryPolicy.cpp - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+#include "RetryPolicy.h"
+#include "RateLimiter.h"
+#include <HTTPClient.h>
+
+// Filemaker: record is in use by another user
+#define FILEMAKER_RECORD_IN_USE 301
+
+RetryPolicy::RetryPolicy(void)
+    : _maxAttempts(RETRY_MAX_ATTEMPTS),
+      _baseDelay(RETRY_BASE_DELAY),
+      _maxDelay(RETRY_MAX_DELAY),
+      _threshold(BREAKER_FAILURE_THRESHOLD),
+      _openTime(BREAKER_OPEN_TIME)
+{
+  this->reset();
+}
+
+void RetryPolicy::reset(void)
+{
+  this->_state = BreakerState::ClosedBreaker;
+  this->_consecutiveFailures = 0;
+  this->_currentOpenTime = this->_openTime;
+  this->_openedAt = 0;
+  this->_trips = 0;
+  memset(this->_attempts, 0, sizeof(this->_attempts));
+  memset(this->_retries, 0, sizeof(this->_retries));
+  memset(this->_failures, 0, sizeof(this->_failures));
+  memset(this->_rejected, 0, sizeof(this->_rejected));
+}
+
+void RetryPolicy::setRetries(uint8_t maxAttempts, uint32_t baseDelay, uint32_t maxDelay)
+{
+  this->_maxAttempts = max(maxAttempts, (uint8_t)1);
+  this->_baseDelay = baseDelay;
+  this->_maxDelay = max(maxDelay, baseDelay);
+}
+
+void RetryPolicy::setBreaker(uint8_t threshold, uint32_t openTime)
+{
+  this->_threshold = max(threshold, (uint8_t)1);
+  this->_openTime = openTime;
+  this->_currentOpenTime = openTime;
+}
+
+boolean RetryPolicy::isRetryable(RequestOperation operation, int httpCode, int fileMakerCode)
+{
+  // Creating twice makes two records, the others can be repeated
+  boolean idempotent = operation != RequestOperation::CreateRecordOperation &&
+                       operation != RequestOperation::UploadContainerOperation;
+  switch (httpCode)
+  {
+  // The request was not sent
+  case HTTP_ERROR_CIRCUIT_OPEN:
+  case HTTPC_ERROR_CONNECTION_REFUSED:
+  case HTTPC_ERROR_SEND_HEADER_FAILED:
+  case HTTPC_ERROR_NOT_CONNECTED:
+  case 429:
+  case 503:
+    return true;
+  // The request may have been processed
+  case HTTPC_ERROR_SEND_PAYLOAD_FAILED:
+  case HTTPC_ERROR_CONNECTION_LOST:
+  case HTTPC_ERROR_READ_TIMEOUT:
+  case 502:
+  case 504:
+    return idempotent;
+  default:
+    return idempotent && fileMakerCode == FILEMAKER_RECORD_IN_USE;
+  }
+}
+
+boolean RetryPolicy::isHostFailure(int httpCode)
+{
+  // A cancelled or rate limited request says nothing about the host
+  return (httpCode < 0 && httpCode != HTTP_ERROR_CANCELLED && httpCode != HTTP_ERROR_RATE_LIMITED) || httpCode == 502 || httpCode == 503 || httpCode == 504;
+}
+
+boolean RetryPolicy::allow(RequestOperation operation)
+{
+  if (this->_state == BreakerState::OpenBreaker)
+  {
+    if (millis() - this->_openedAt < this->_currentOpenTime)
+    {
+      this->_rejected[operation]++;
+      return false;
+    }
+    log_d("Circuit breaker half open");
+    this->_state = BreakerState::HalfOpenBreaker;
+  }
+  this->_attempts[operation]++;
+  return true;
+}
+
+uint32_t RetryPolicy::record(RequestOperation operation, int httpCode, int fileMakerCode, uint8_t attempt)
+{
+  if (RetryPolicy::isHostFailure(httpCode))
+  {
+    this->_consecutiveFailures++;
+    if (this->_state == BreakerState::HalfOpenBreaker)
+    {
+      this->_currentOpenTime = min(this->_currentOpenTime * 2, (uint32_t)BREAKER_MAX_OPEN_TIME);
+      this->open();
+    }
+    else if (this->_consecutiveFailures >= this->_threshold && this->_state == BreakerState::ClosedBreaker)
+    {
+      this->open();
+    }
+  }
+  else
+  {
+    if (this->_state != BreakerState::ClosedBreaker)
+      log_d("Circuit breaker closed");
+    this->_state = BreakerState::ClosedBreaker;
+    this->_consecutiveFailures = 0;
+    this->_currentOpenTime = this->_openTime;
+  }
+  boolean success = httpCode == 200 && fileMakerCode <= 0;
+  if (success)
+    return 0;
+  if (attempt >= this->_maxAttempts ||
+      this->_state == BreakerState::OpenBreaker ||
+      !RetryPolicy::isRetryable(operation, httpCode, fileMakerCode))
+  {
+    this->_failures[operation]++;
+    return 0;
+  }
+  this->_retries[operation]++;
+  return max(this->getDelay(attempt), (uint32_t)1);
+}
+
+/**
+ * @brief Full jitter: a random delay up to base * 2^(attempt - 1), capped
+ */
+uint32_t RetryPolicy::getDelay(uint8_t attempt) const
+{
+  uint32_t cap = this->_baseDelay;
+  for (uint8_t i = 1; i < attempt && cap < this->_maxDelay; i++)
+    cap *= 2;
+  cap = min(cap, this->_maxDelay);
+  return esp_random() % (cap + 1);
+}
+
+void RetryPolicy::open(void)
+{
+  this->_state = BreakerState::OpenBreaker;
+  // Jitter the open time too, so devices do not probe in lockstep
+  this->_openedAt = millis() - esp_random() % (this->_currentOpenTime / 4 + 1);
+  this->_trips++;
+  log_w("Circuit breaker open for %u ms", this->_currentOpenTime);
+}
+
+BreakerState RetryPolicy::getState(void) const
+{
+  return this->_state;
+}
+
+uint32_t RetryPolicy::getAttempts(RequestOperation operation) const
+{
+  return this->_attempts[operation];
+}
+
+uint32_t RetryPolicy::getRetries(RequestOperation operation) const
+{
+  return this->_retries[operation];
+}
+
+uint32_t RetryPolicy::getFailures(RequestOperation operation) const
+{
+  return this->_failures[operation];
+}
+
+uint32_t RetryPolicy::getRejected(RequestOperation operation) const
+{
+  return this->_rejected[operation];
+}
+
+uint32_t RetryPolicy::getTrips(void) const
+{
+  return this->_trips;
+}
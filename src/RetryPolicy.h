@@ -0,0 +1,140 @@
+/*
+  RetryPolicy.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef RetryPolicy_h
+#define RetryPolicy_h
+
+#include <Arduino.h>
+#include "RequestMetrics.h"
+#include "CancellationToken.h"
+
+#define RETRY_MAX_ATTEMPTS 4
+#define RETRY_BASE_DELAY 250
+#define RETRY_MAX_DELAY 8000
+#define BREAKER_FAILURE_THRESHOLD 5
+#define BREAKER_OPEN_TIME 10000
+#define BREAKER_MAX_OPEN_TIME 120000
+
+/** Http code reported while the circuit breaker is open, below the HTTPClient errors */
+#define HTTP_ERROR_CIRCUIT_OPEN -100
+
+/**
+ * @brief State of the circuit breaker
+ */
+enum BreakerState
+{
+  /** Requests are sent */
+  ClosedBreaker,
+  /** The host is considered down, requests fail without being sent */
+  OpenBreaker,
+  /** The open time passed, the next request is sent as a probe */
+  HalfOpenBreaker
+};
+
+/**
+ * @brief Retries failed requests with exponential backoff and full jitter,
+ * and fails fast while the host is down
+ * A request is retried when its failure is transient and repeating it is
+ * safe for the operation: connection errors before the request was sent,
+ * 429, 503, and for idempotent operations also timeouts, 502, 504 and
+ * Filemaker's record in use. Delays are drawn at random up to an
+ * exponentially growing cap, so devices that failed together do not retry
+ * together. After BREAKER_FAILURE_THRESHOLD consecutive host failures the
+ * breaker opens, the open time doubles with every failed probe.
+ */
+class RetryPolicy
+{
+public:
+  RetryPolicy(void);
+
+  /**
+   * @brief Sets the retry limits
+   *
+   * @param maxAttempts Attempts including the first one
+   * @param baseDelay Cap of the first delay in milliseconds
+   * @param maxDelay Cap of any delay in milliseconds
+   */
+  void setRetries(uint8_t maxAttempts, uint32_t baseDelay, uint32_t maxDelay);
+
+  /**
+   * @brief Sets the circuit breaker limits
+   *
+   * @param threshold Consecutive host failures that open the breaker
+   * @param openTime Milliseconds until the first probe
+   */
+  void setBreaker(uint8_t threshold, uint32_t openTime);
+
+  /**
+   * @brief Whether a failed request may be repeated
+   *
+   * @param operation
+   * @param httpCode Http status code or HTTPClient error
+   * @param fileMakerCode Filemaker error code, -1 when unknown
+   * @return boolean
+   */
+  static boolean isRetryable(RequestOperation operation, int httpCode, int fileMakerCode);
+
+  /**
+   * @brief Whether a failure says the host is unhealthy, counts towards opening the breaker
+   *
+   * @param httpCode Http status code or HTTPClient error
+   * @return boolean
+   */
+  static boolean isHostFailure(int httpCode);
+
+  /**
+   * @brief Asks the breaker whether a request may be sent
+   *
+   * @param operation
+   * @return boolean false while the breaker is open
+   */
+  boolean allow(RequestOperation operation);
+
+  /**
+   * @brief Records the outcome of an attempt
+   *
+   * @param operation
+   * @param httpCode Http status code or HTTPClient error
+   * @param fileMakerCode Filemaker error code, -1 when unknown
+   * @param attempt Attempt number, starting at 1
+   * @return uint32_t Milliseconds to wait before retrying, 0 not to retry
+   */
+  uint32_t record(RequestOperation operation, int httpCode, int fileMakerCode, uint8_t attempt);
+
+  BreakerState getState(void) const;
+  /** Attempts sent, including retries */
+  uint32_t getAttempts(RequestOperation operation) const;
+  /** Retries sent */
+  uint32_t getRetries(RequestOperation operation) const;
+  /** Requests that failed after the last allowed attempt or a non retryable error */
+  uint32_t getFailures(RequestOperation operation) const;
+  /** Requests refused while the breaker was open */
+  uint32_t getRejected(RequestOperation operation) const;
+  /** Number of times the breaker opened */
+  uint32_t getTrips(void) const;
+
+  void reset(void);
+
+private:
+  uint32_t getDelay(uint8_t attempt) const;
+  void open(void);
+  uint8_t _maxAttempts;
+  uint32_t _baseDelay;
+  uint32_t _maxDelay;
+  uint8_t _threshold;
+  uint32_t _openTime;
+  BreakerState _state;
+  uint8_t _consecutiveFailures;
+  uint32_t _currentOpenTime;
+  unsigned long _openedAt;
+  uint32_t _attempts[RequestOperationCount];
+  uint32_t _retries[RequestOperationCount];
+  uint32_t _failures[RequestOperationCount];
+  uint32_t _rejected[RequestOperationCount];
+  uint32_t _trips;
+};
+
+#endif
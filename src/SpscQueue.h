@@ -0,0 +1,105 @@
+/*
+  SpscQueue.h - Filemaker DATA API library
+  Copyright (c) 2020 Bruno Silva.  DrM, Dr. Mueller AG.
+*/
+
+// ensure this library description is only included once
+#ifndef SpscQueue_h
+#define SpscQueue_h
+
+#include <Arduino.h>
+#include <atomic>
+#include <utility>
+
+/**
+ * @brief Lock free single producer, single consumer ring buffer
+ * One task may push and one other task may pop, without locks. Holds up to
+ * N - 1 items, items are moved in and out of preallocated slots.
+ *
+ * @tparam T Item type, default constructible and movable
+ * @tparam N Number of slots
+ */
+template <typename T, size_t N>
+class SpscQueue
+{
+public:
+  SpscQueue(void) : _head(0), _tail(0) {}
+
+  /**
+   * @brief Adds an item, producer only
+   *
+   * @param item Moved into the queue on success
+   * @return boolean false when the queue is full
+   */
+  boolean push(T &&item)
+  {
+    size_t tail = this->_tail.load(std::memory_order_relaxed);
+    size_t next = (tail + 1) % N;
+    if (next == this->_head.load(std::memory_order_acquire))
+      return false;
+    this->_items[tail] = std::move(item);
+    this->_tail.store(next, std::memory_order_release);
+    return true;
+  }
+
+  boolean push(const T &item)
+  {
+    T copy(item);
+    return this->push(std::move(copy));
+  }
+
+  /**
+   * @brief Removes the oldest item, consumer only
+   *
+   * @param item Destination
+   * @return boolean false when the queue is empty
+   */
+  boolean pop(T &item)
+  {
+    size_t head = this->_head.load(std::memory_order_relaxed);
+    if (head == this->_tail.load(std::memory_order_acquire))
+      return false;
+    item = std::move(this->_items[head]);
+    this->_head.store((head + 1) % N, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Reads the oldest item without removing it, consumer only
+   *
+   * @param item Destination
+   * @return boolean false when the queue is empty
+   */
+  boolean front(T &item) const
+  {
+    size_t head = this->_head.load(std::memory_order_relaxed);
+    if (head == this->_tail.load(std::memory_order_acquire))
+      return false;
+    item = this->_items[head];
+    return true;
+  }
+
+  /**
+   * @brief Number of items, exact only when called by the producer or the consumer
+   *
+   * @return size_t
+   */
+  size_t size(void) const
+  {
+    size_t head = this->_head.load(std::memory_order_acquire);
+    size_t tail = this->_tail.load(std::memory_order_acquire);
+    return (tail + N - head) % N;
+  }
+
+  boolean empty(void) const
+  {
+    return this->size() == 0;
+  }
+
+private:
+  T _items[N];
+  std::atomic<size_t> _head;
+  std::atomic<size_t> _tail;
+};
+
+#endif